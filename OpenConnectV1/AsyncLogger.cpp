@@ -0,0 +1,680 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cwchar>
+#include <cstddef>
+
+#include "AsyncLogger.h"
+
+namespace OpenConnectV1 {
+    namespace {
+        constexpr size_t MAX_FORMAT_LENGTH = 1024;
+        constexpr size_t MAX_STRING_LENGTH = 1024;
+        constexpr size_t MAX_BATCH_RECORDS = 1024;
+
+        struct RecordHeader {
+            uint32_t size;          // Whole record including the header, a multiple of 8
+            uint8_t level;
+            uint8_t filler;         // Set on the filler written when a record would straddle the end of the ring
+            uint16_t formatLength;
+            int64_t timestamp;
+        };
+        static_assert(sizeof(RecordHeader) == 16, "Records are laid out in 8 byte words");
+
+        size_t alignWord(size_t size) {
+            return (size + 7) & ~static_cast<size_t>(7);
+        }
+
+        size_t roundUpToPowerOfTwo(size_t value) {
+            size_t result = 1;
+            while (result < value) {
+                result <<= 1;
+            }
+            return result;
+        }
+
+        int64_t timestampNow() {
+            return std::chrono::steady_clock::now().time_since_epoch().count();
+        }
+
+        enum class Length { None, Char, Short, Long, LongLong, LongDouble, Size, IntMax, PtrDiff };
+
+        // One printf conversion, pointers are into the (copied) format string
+        struct FormatSpec {
+            const char* start;
+            const char* end;
+            const char* flagsBegin;
+            const char* flagsEnd;
+            const char* widthBegin;
+            const char* widthEnd;
+            const char* precisionBegin;
+            const char* precisionEnd;
+            bool widthStar = false;
+            bool hasPrecision = false;
+            bool precisionStar = false;
+            Length length = Length::None;
+            char conversion = 0;
+        };
+
+        // Parses the conversion starting at the '%', returns false for an incomplete/unknown one (printed as is)
+        bool parseSpec(const char* p, const char* end, FormatSpec& spec) {
+            spec = FormatSpec();
+            spec.start = p++;
+
+            spec.flagsBegin = p;
+            while (p < end && strchr("-+ #0'", *p) != nullptr) p++;
+            spec.flagsEnd = p;
+
+            spec.widthBegin = p;
+            if (p < end && *p == '*') {
+                spec.widthStar = true;
+                p++;
+            }
+            else {
+                while (p < end && *p >= '0' && *p <= '9') p++;
+            }
+            spec.widthEnd = p;
+
+            spec.precisionBegin = spec.precisionEnd = p;
+            if (p < end && *p == '.') {
+                spec.hasPrecision = true;
+                p++;
+                spec.precisionBegin = p;
+                if (p < end && *p == '*') {
+                    spec.precisionStar = true;
+                    p++;
+                }
+                else {
+                    while (p < end && *p >= '0' && *p <= '9') p++;
+                }
+                spec.precisionEnd = p;
+            }
+
+            if (p < end) {
+                switch (*p) {
+                case 'h':
+                    p++;
+                    spec.length = Length::Short;
+                    if (p < end && *p == 'h') {
+                        p++;
+                        spec.length = Length::Char;
+                    }
+                    break;
+                case 'l':
+                    p++;
+                    spec.length = Length::Long;
+                    if (p < end && *p == 'l') {
+                        p++;
+                        spec.length = Length::LongLong;
+                    }
+                    break;
+                case 'L': p++; spec.length = Length::LongDouble; break;
+                case 'z': p++; spec.length = Length::Size; break;
+                case 'j': p++; spec.length = Length::IntMax; break;
+                case 't': p++; spec.length = Length::PtrDiff; break;
+                }
+            }
+
+            if (p >= end || strchr("diuoxXfFeEgGaAcspn%", *p) == nullptr) {
+                return false;
+            }
+            spec.conversion = *p++;
+            spec.end = p;
+            return true;
+        }
+
+        bool isSigned(char conversion) {
+            return conversion == 'd' || conversion == 'i';
+        }
+
+        bool isUnsigned(char conversion) {
+            return conversion == 'u' || conversion == 'o' || conversion == 'x' || conversion == 'X';
+        }
+
+        bool isFloat(char conversion) {
+            return strchr("fFeEgGaA", conversion) != nullptr;
+        }
+
+        // Appends printf arguments to a record as 8 byte words, stops (consistently with Unpacker) when full
+        class Packer {
+        public:
+            Packer(char* data, size_t capacity) : data(data), capacity(capacity) {}
+
+            bool word(uint64_t value) {
+                if (this->full || this->position + 8 > this->capacity) {
+                    this->full = true;
+                    return false;
+                }
+                memcpy(this->data + this->position, &value, 8);
+                this->position += 8;
+                return true;
+            }
+
+            void bytes(const void* source, size_t length) {
+                size_t padded = alignWord(length);
+                if (this->full || this->position + 8 + padded > this->capacity) {
+                    // Keep whatever still fits, strings are the one thing worth truncating
+                    size_t room = this->capacity > this->position + 8 ? this->capacity - this->position - 8 : 0;
+                    length = std::min(length, room & ~static_cast<size_t>(7));
+                    padded = alignWord(length);
+                }
+                if (!this->word(length)) {
+                    return;
+                }
+                memcpy(this->data + this->position, source, length);
+                this->position += padded;
+            }
+
+            size_t size() const { return this->position; }
+
+        private:
+            char* data;
+            size_t capacity;
+            size_t position = 0;
+            bool full = false;
+        };
+
+        class Unpacker {
+        public:
+            Unpacker(const char* data, size_t size) : data(data), size(size) {}
+
+            bool word(uint64_t& value) {
+                if (this->position + 8 > this->size) {
+                    return false;
+                }
+                memcpy(&value, this->data + this->position, 8);
+                this->position += 8;
+                return true;
+            }
+
+            bool bytes(const char*& source, size_t& length) {
+                uint64_t stored;
+                if (!this->word(stored) || this->position + alignWord(stored) > this->size) {
+                    return false;
+                }
+                source = this->data + this->position;
+                length = stored;
+                this->position += alignWord(stored);
+                return true;
+            }
+
+        private:
+            const char* data;
+            size_t size;
+            size_t position = 0;
+        };
+
+        void packArgument(const FormatSpec& spec, va_list& args, Packer& packer) {
+            if (spec.widthStar) {
+                packer.word(static_cast<uint64_t>(static_cast<int64_t>(va_arg(args, int))));
+            }
+            int precision = -1;
+            if (spec.precisionStar) {
+                precision = va_arg(args, int);
+                packer.word(static_cast<uint64_t>(static_cast<int64_t>(precision)));
+            }
+            else if (spec.hasPrecision) {
+                precision = atoi(std::string(spec.precisionBegin, spec.precisionEnd).c_str());
+            }
+
+            char conversion = spec.conversion;
+            if (isSigned(conversion)) {
+                int64_t value;
+                switch (spec.length) {
+                case Length::Char: value = static_cast<signed char>(va_arg(args, int)); break;
+                case Length::Short: value = static_cast<short>(va_arg(args, int)); break;
+                case Length::Long: value = va_arg(args, long); break;
+                case Length::LongLong: value = va_arg(args, long long); break;
+                case Length::Size: value = static_cast<int64_t>(va_arg(args, size_t)); break;
+                case Length::IntMax: value = va_arg(args, intmax_t); break;
+                case Length::PtrDiff: value = va_arg(args, ptrdiff_t); break;
+                default: value = va_arg(args, int); break;
+                }
+                packer.word(static_cast<uint64_t>(value));
+            }
+            else if (isUnsigned(conversion)) {
+                uint64_t value;
+                switch (spec.length) {
+                case Length::Char: value = static_cast<unsigned char>(va_arg(args, unsigned int)); break;
+                case Length::Short: value = static_cast<unsigned short>(va_arg(args, unsigned int)); break;
+                case Length::Long: value = va_arg(args, unsigned long); break;
+                case Length::LongLong: value = va_arg(args, unsigned long long); break;
+                case Length::Size: value = va_arg(args, size_t); break;
+                case Length::IntMax: value = va_arg(args, uintmax_t); break;
+                case Length::PtrDiff: value = static_cast<uint64_t>(va_arg(args, ptrdiff_t)); break;
+                default: value = va_arg(args, unsigned int); break;
+                }
+                packer.word(value);
+            }
+            else if (isFloat(conversion)) {
+                if (spec.length == Length::LongDouble) {
+                    long double value = va_arg(args, long double);
+                    packer.bytes(&value, sizeof(value));
+                }
+                else {
+                    double value = va_arg(args, double);
+                    uint64_t bits;
+                    memcpy(&bits, &value, 8);
+                    packer.word(bits);
+                }
+            }
+            else if (conversion == 'c') {
+                packer.word(static_cast<uint64_t>(static_cast<unsigned char>(va_arg(args, int))));
+            }
+            else if (conversion == 'p') {
+                packer.word(reinterpret_cast<uintptr_t>(va_arg(args, void*)));
+            }
+            else if (conversion == 's') {
+                if (spec.length == Length::Long) {
+                    va_arg(args, const wchar_t*);
+                    packer.bytes("(wide string)", 13);
+                    return;
+                }
+                const char* value = va_arg(args, const char*);
+                if (value == nullptr) {
+                    value = "(null)";
+                }
+                // The precision bounds the read, %.*s is used with views that aren't null terminated
+                size_t limit = precision >= 0 ? std::min(static_cast<size_t>(precision), MAX_STRING_LENGTH) : MAX_STRING_LENGTH;
+                const void* terminator = memchr(value, '\0', limit);
+                size_t length = terminator ? static_cast<const char*>(terminator) - value : limit;
+                packer.bytes(value, length);
+            }
+            else if (conversion == 'n') {
+                va_arg(args, void*);    // Never written through
+            }
+        }
+
+        void appendFormatted(std::string& out, const char* spec, ...) {
+            va_list args;
+            va_start(args, spec);
+            va_list copy;
+            va_copy(copy, args);
+            int length = vsnprintf(nullptr, 0, spec, copy);
+            va_end(copy);
+            if (length > 0) {
+                size_t offset = out.size();
+                out.resize(offset + length + 1);
+                vsnprintf(&out[offset], length + 1, spec, args);
+                out.resize(offset + length);
+            }
+            va_end(args);
+        }
+
+        // Formats one argument, returns false when the record ran out of arguments
+        bool formatArgument(const FormatSpec& spec, Unpacker& unpacker, std::string& out) {
+            // Rebuild the conversion with '*' replaced by the packed values and the length normalised
+            std::string format(spec.start, spec.flagsEnd);
+            uint64_t word;
+            if (spec.widthStar) {
+                if (!unpacker.word(word)) return false;
+                format += std::to_string(static_cast<int64_t>(word));
+            }
+            else {
+                format.append(spec.widthBegin, spec.widthEnd);
+            }
+
+            std::string precision;
+            if (spec.precisionStar) {
+                if (!unpacker.word(word)) return false;
+                if (static_cast<int64_t>(word) >= 0) {
+                    precision = "." + std::to_string(static_cast<int64_t>(word));
+                }
+            }
+            else if (spec.hasPrecision) {
+                precision = "." + std::string(spec.precisionBegin, spec.precisionEnd);
+            }
+
+            char conversion = spec.conversion;
+            if (isSigned(conversion) || isUnsigned(conversion)) {
+                if (!unpacker.word(word)) return false;
+                format += precision + "ll" + conversion;
+                if (isSigned(conversion)) {
+                    appendFormatted(out, format.c_str(), static_cast<long long>(static_cast<int64_t>(word)));
+                }
+                else {
+                    appendFormatted(out, format.c_str(), static_cast<unsigned long long>(word));
+                }
+            }
+            else if (isFloat(conversion)) {
+                if (spec.length == Length::LongDouble) {
+                    const char* source;
+                    size_t length;
+                    if (!unpacker.bytes(source, length) || length != sizeof(long double)) return false;
+                    long double value;
+                    memcpy(&value, source, sizeof(value));
+                    format += precision + "L" + conversion;
+                    appendFormatted(out, format.c_str(), value);
+                }
+                else {
+                    if (!unpacker.word(word)) return false;
+                    double value;
+                    memcpy(&value, &word, 8);
+                    format += precision + conversion;
+                    appendFormatted(out, format.c_str(), value);
+                }
+            }
+            else if (conversion == 'c') {
+                if (!unpacker.word(word)) return false;
+                format += 'c';
+                appendFormatted(out, format.c_str(), static_cast<int>(word));
+            }
+            else if (conversion == 'p') {
+                if (!unpacker.word(word)) return false;
+                format += 'p';
+                appendFormatted(out, format.c_str(), reinterpret_cast<void*>(static_cast<uintptr_t>(word)));
+            }
+            else if (conversion == 's') {
+                const char* source;
+                size_t length;
+                if (!unpacker.bytes(source, length)) return false;
+                format += ".*s";
+                appendFormatted(out, format.c_str(), static_cast<int>(length), source);
+            }
+            return true;
+        }
+
+        void formatMessage(const char* format, size_t formatLength, Unpacker& unpacker, std::string& out) {
+            const char* p = format;
+            const char* end = format + formatLength;
+            bool argumentsLeft = true;
+
+            while (p < end) {
+                const char* percent = static_cast<const char*>(memchr(p, '%', end - p));
+                if (percent == nullptr) {
+                    out.append(p, end);
+                    break;
+                }
+                out.append(p, percent);
+
+                FormatSpec spec;
+                if (!parseSpec(percent, end, spec)) {
+                    out += '%';
+                    p = percent + 1;
+                    continue;
+                }
+                p = spec.end;
+
+                if (spec.conversion == '%') {
+                    out += '%';
+                }
+                else if (spec.conversion != 'n' && (!argumentsLeft || !formatArgument(spec, unpacker, out))) {
+                    // Truncated record, show the conversion rather than garbage
+                    argumentsLeft = false;
+                    out.append(spec.start, spec.end);
+                }
+            }
+        }
+    }
+
+    std::atomic<bool> AsyncLogger::active{ false };
+    thread_local AsyncLogger::RingHandle AsyncLogger::threadHandle;
+
+    AsyncLogger::Ring::Ring(size_t capacity)
+        : mask(roundUpToPowerOfTwo(std::max(capacity, 4 * MAX_RECORD_SIZE)) - 1) {
+        this->buffer = std::make_unique<char[]>(this->mask + 1);
+    }
+
+    bool AsyncLogger::Ring::tryWrite(const char* record, size_t size) {
+        size_t tail = this->tail.load(std::memory_order_relaxed);
+        size_t head = this->head.load(std::memory_order_acquire);
+        size_t capacity = this->mask + 1;
+        size_t offset = tail & this->mask;
+
+        // Records never wrap, a filler skips the writer to the start of the ring instead
+        size_t contiguous = capacity - offset;
+        size_t required = contiguous < size ? contiguous + size : size;
+        if (capacity - (tail - head) < required) {
+            return false;
+        }
+
+        if (contiguous < size) {
+            RecordHeader filler{};
+            filler.size = static_cast<uint32_t>(contiguous);
+            filler.filler = 1;
+            memcpy(this->buffer.get() + offset, &filler, std::min(contiguous, sizeof(filler)));
+            tail += contiguous;
+            offset = 0;
+        }
+
+        memcpy(this->buffer.get() + offset, record, size);
+        this->tail.store(tail + size, std::memory_order_release);
+        return true;
+    }
+
+    AsyncLogger::RingHandle::~RingHandle() {
+        if (this->ring) {
+            this->ring->abandoned.store(true, std::memory_order_release);
+        }
+    }
+
+    AsyncLogger& AsyncLogger::instance() {
+        static AsyncLogger logger;
+        return logger;
+    }
+
+    bool AsyncLogger::enabled() {
+        return active.load(std::memory_order_acquire);
+    }
+
+    AsyncLogger::~AsyncLogger() {
+        this->stop();
+    }
+
+    void AsyncLogger::start(const AsyncLoggerOptions& options) {
+        std::lock_guard<std::mutex> lock(this->writerMutex);
+        if (this->running.load()) {
+            return;
+        }
+        this->options = options;
+        this->running.store(true);
+        this->writerThread = std::thread(&AsyncLogger::writerLoop, this);
+        active.store(true, std::memory_order_release);
+    }
+
+    void AsyncLogger::stop() {
+        {
+            std::lock_guard<std::mutex> lock(this->writerMutex);
+            if (!this->running.load()) {
+                return;
+            }
+            active.store(false, std::memory_order_release);
+            this->running.store(false);
+            this->wakeWriter.notify_all();
+        }
+        if (this->writerThread.joinable()) {
+            this->writerThread.join();
+        }
+        // Picks up anything logged while the writer was shutting down
+        while (this->writeBatch()) {}
+    }
+
+    void AsyncLogger::flush() {
+        uint64_t target = this->stats().Enqueued;
+
+        std::unique_lock<std::mutex> lock(this->writerMutex);
+        while (this->running.load() && this->stats().Written < target) {
+            this->wakeWriter.notify_all();
+            this->batchWritten.wait_for(lock, std::chrono::milliseconds(10));
+        }
+    }
+
+    LoggerStats AsyncLogger::stats() {
+        std::lock_guard<std::mutex> lock(this->ringsMutex);
+        LoggerStats stats = this->retiredStats;
+        for (auto& ring : this->rings) {
+            stats.Enqueued += ring->enqueued.load(std::memory_order_relaxed);
+            stats.Written += ring->written.load(std::memory_order_relaxed);
+            stats.Dropped += ring->dropped.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+    AsyncLogger::Ring& AsyncLogger::threadRing() {
+        if (!threadHandle.ring) {
+            auto ring = std::make_shared<Ring>(this->options.RingBytes);
+            std::lock_guard<std::mutex> lock(this->ringsMutex);
+            this->rings.push_back(ring);
+            threadHandle.ring = std::move(ring);
+        }
+        return *threadHandle.ring;
+    }
+
+    bool AsyncLogger::enqueue(LogLevel level, const char* message, va_list args) {
+        alignas(8) thread_local char record[MAX_RECORD_SIZE];
+
+        size_t formatLength = std::min(strlen(message), MAX_FORMAT_LENGTH);
+        size_t argumentsOffset = sizeof(RecordHeader) + alignWord(formatLength);
+        memcpy(record + sizeof(RecordHeader), message, formatLength);
+
+        // Walk the same (possibly truncated) format the writer will walk, so the arguments line up
+        Packer packer(record + argumentsOffset, MAX_RECORD_SIZE - argumentsOffset);
+        const char* format = record + sizeof(RecordHeader);
+        const char* end = format + formatLength;
+        va_list copy;
+        va_copy(copy, args);
+        for (const char* p = format; p < end; p++) {
+            FormatSpec spec;
+            if (*p == '%' && parseSpec(p, end, spec)) {
+                if (spec.conversion != '%') {
+                    packArgument(spec, copy, packer);
+                }
+                p = spec.end - 1;
+            }
+        }
+        va_end(copy);
+
+        RecordHeader header{};
+        header.size = static_cast<uint32_t>(argumentsOffset + packer.size());
+        header.level = static_cast<uint8_t>(level);
+        header.formatLength = static_cast<uint16_t>(formatLength);
+        header.timestamp = timestampNow();
+        memcpy(record, &header, sizeof(header));
+
+        Ring& ring = this->threadRing();
+        bool written = ring.tryWrite(record, header.size);
+        if (!written && (level == LogLevel::Error || this->options.BlockWhenFull)) {
+            while (!written && this->running.load(std::memory_order_relaxed)) {
+                this->wakeWriter.notify_one();
+                std::this_thread::yield();
+                written = ring.tryWrite(record, header.size);
+            }
+        }
+
+        // Only this thread updates its ring's counters, no read-modify-write needed
+        if (written) {
+            ring.enqueued.store(ring.enqueued.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        else {
+            ring.dropped.store(ring.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        return written;
+    }
+
+    size_t AsyncLogger::drain(Ring& ring, std::vector<FormattedRecord>& batch, size_t maxRecords) {
+        size_t head = ring.head.load(std::memory_order_relaxed);
+        size_t tail = ring.tail.load(std::memory_order_acquire);
+        size_t count = 0;
+
+        while (head != tail && count < maxRecords) {
+            const char* data = ring.buffer.get() + (head & ring.mask);
+            RecordHeader header{};
+            memcpy(&header, data, sizeof(header) <= (ring.mask + 1 - (head & ring.mask)) ? sizeof(header) : 8);
+
+            if (header.filler) {
+                head += header.size;
+                continue;
+            }
+
+            auto level = static_cast<LogLevel>(header.level);
+            const char* levelStr = Logger::logLevelToString(level);
+            std::string line;
+            line.reserve(64 + header.formatLength);
+            line += '[';
+            line += levelStr;
+            line.append(strlen(levelStr) < 8 ? 8 - strlen(levelStr) : 0, ' ');
+            line += "] ";
+
+            size_t argumentsOffset = sizeof(RecordHeader) + alignWord(header.formatLength);
+            Unpacker unpacker(data + argumentsOffset, header.size - argumentsOffset);
+            formatMessage(data + sizeof(RecordHeader), header.formatLength, unpacker, line);
+            line += '\n';
+
+            batch.push_back({ header.timestamp, std::move(line) });
+            head += header.size;
+            ring.head.store(head, std::memory_order_release);
+            count++;
+        }
+        ring.head.store(head, std::memory_order_release);
+        return count;
+    }
+
+    bool AsyncLogger::writeBatch() {
+        std::vector<FormattedRecord> batch;
+        std::vector<std::pair<Ring*, size_t>> counts;
+        {
+            std::lock_guard<std::mutex> lock(this->ringsMutex);
+            for (auto it = this->rings.begin(); it != this->rings.end();) {
+                Ring& ring = **it;
+                // Read before draining, so an abandoned ring is only dropped once it has really been emptied
+                bool abandoned = ring.abandoned.load(std::memory_order_acquire);
+                size_t count = drain(ring, batch, MAX_BATCH_RECORDS);
+                if (count > 0) {
+                    counts.push_back({ &ring, count });
+                }
+
+                if (abandoned && count == 0 && ring.head.load() == ring.tail.load()) {
+                    this->retiredStats.Enqueued += ring.enqueued.load();
+                    this->retiredStats.Written += ring.written.load();
+                    this->retiredStats.Dropped += ring.dropped.load();
+                    it = this->rings.erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+        }
+
+        if (batch.empty()) {
+            return false;
+        }
+
+        // Threads only see their own ring, order the batch as it was logged
+        std::stable_sort(batch.begin(), batch.end(),
+            [](const FormattedRecord& a, const FormattedRecord& b) { return a.Timestamp < b.Timestamp; });
+
+        std::string output;
+        for (auto& record : batch) {
+            output += record.Line;
+        }
+        std::cout.write(output.data(), static_cast<std::streamsize>(output.size()));
+        std::cout.flush();
+
+        // Only counted once it has been written, flush() waits on these
+        std::lock_guard<std::mutex> lock(this->ringsMutex);
+        for (auto& count : counts) {
+            count.first->written.fetch_add(count.second, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    void AsyncLogger::writerLoop() {
+        std::unique_lock<std::mutex> lock(this->writerMutex);
+        while (this->running.load()) {
+            lock.unlock();
+            bool wrote = this->writeBatch();
+            lock.lock();
+
+            if (wrote) {
+                this->batchWritten.notify_all();
+            }
+            if (this->running.load()) {
+                this->wakeWriter.wait_for(lock, std::chrono::milliseconds(this->options.FlushIntervalMs));
+            }
+        }
+        lock.unlock();
+
+        while (this->writeBatch()) {}
+        this->batchWritten.notify_all();
+    }
+}
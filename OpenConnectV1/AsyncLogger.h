@@ -0,0 +1,96 @@
+#ifndef OPEN_CONNECT_ASYNC_LOGGER_H
+#define OPEN_CONNECT_ASYNC_LOGGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Logger.h"
+
+namespace OpenConnectV1 {
+    /**
+     * Background writer behind Logger::startAsync().
+     *
+     * Every logging thread owns a single producer/single consumer byte ring.  A record is a small header
+     * (size, level, timestamp), a copy of the format string and the printf arguments packed as 8 byte words
+     * (strings are copied inline, as the caller's buffer may be gone by the time the record is formatted).
+     * The writer thread walks the format string again to unpack and format each record, orders the batch by
+     * timestamp across threads and writes it with a single flush.
+     */
+    class AsyncLogger {
+    public:
+        static constexpr size_t MAX_RECORD_SIZE = 4096;
+
+        static AsyncLogger& instance();
+
+        // Checked by Logger::log() before every record
+        static bool enabled();
+
+        void start(const AsyncLoggerOptions& options);
+        void stop();
+        void flush();
+        LoggerStats stats();
+
+        bool enqueue(LogLevel level, const char* message, va_list args);
+
+        ~AsyncLogger();
+
+    private:
+        struct Ring {
+            explicit Ring(size_t capacity);
+
+            std::unique_ptr<char[]> buffer;
+            size_t mask;
+
+            alignas(64) std::atomic<size_t> head{ 0 };      // Writer thread
+            alignas(64) std::atomic<size_t> tail{ 0 };      // Logging thread
+            std::atomic<uint64_t> enqueued{ 0 };
+            std::atomic<uint64_t> dropped{ 0 };
+            alignas(64) std::atomic<uint64_t> written{ 0 };
+            std::atomic<bool> abandoned{ false };           // The logging thread exited
+
+            bool tryWrite(const char* record, size_t size);
+        };
+
+        // Thread local owner of a logging thread's ring, flags it abandoned when the thread exits
+        struct RingHandle {
+            std::shared_ptr<Ring> ring;
+            ~RingHandle();
+        };
+
+        struct FormattedRecord {
+            int64_t Timestamp;
+            std::string Line;
+        };
+
+        static std::atomic<bool> active;
+        static thread_local RingHandle threadHandle;
+
+        AsyncLoggerOptions options;
+        std::vector<std::shared_ptr<Ring>> rings;
+        std::mutex ringsMutex;
+        LoggerStats retiredStats;   // Totals of the rings whose threads exited, guarded by ringsMutex
+
+        std::thread writerThread;
+        std::atomic<bool> running{ false };
+        std::mutex writerMutex;
+        std::condition_variable wakeWriter;
+        std::condition_variable batchWritten;
+
+        AsyncLogger() = default;
+
+        Ring& threadRing();
+        // Returns false when nothing was left to write
+        bool writeBatch();
+        void writerLoop();
+        static size_t drain(Ring& ring, std::vector<FormattedRecord>& batch, size_t maxRecords);
+    };
+}
+
+#endif
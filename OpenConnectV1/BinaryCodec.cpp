@@ -0,0 +1,190 @@
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "BinaryCodec.h"
+#include "Logger.h"
+
+namespace OpenConnectV1 {
+    namespace {
+        constexpr size_t PREFIX = MessageFramer::LENGTH_PREFIX_SIZE;
+        constexpr size_t MAX_STRING = 0xFFFF;
+        constexpr size_t BALL_FLOATS = 8;
+        constexpr size_t CLUB_FLOATS = 10;
+        static_assert(sizeof(BallData) == BALL_FLOATS * sizeof(float) && sizeof(ClubData) == CLUB_FLOATS * sizeof(float),
+            "BallData/ClubData are copied to and from records as plain float arrays");
+
+        void put16(char* out, uint16_t value) {
+            out[0] = static_cast<char>(value);
+            out[1] = static_cast<char>(value >> 8);
+        }
+
+        void put32(char* out, uint32_t value) {
+            out[0] = static_cast<char>(value);
+            out[1] = static_cast<char>(value >> 8);
+            out[2] = static_cast<char>(value >> 16);
+            out[3] = static_cast<char>(value >> 24);
+        }
+
+        uint16_t get16(const char* in) {
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(in);
+            return static_cast<uint16_t>(bytes[0] | bytes[1] << 8);
+        }
+
+        uint32_t get32(const char* in) {
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(in);
+            return static_cast<uint32_t>(bytes[0]) | static_cast<uint32_t>(bytes[1]) << 8
+                | static_cast<uint32_t>(bytes[2]) << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+        }
+
+        // Bit for bit, NaN payloads included
+        template<size_t N>
+        void putFloats(char* out, const float* values) {
+            for (size_t i = 0; i < N; i++) {
+                uint32_t bits;
+                std::memcpy(&bits, &values[i], sizeof(bits));
+                put32(out + i * 4, bits);
+            }
+        }
+
+        template<size_t N>
+        void getFloats(const char* in, float* values) {
+            for (size_t i = 0; i < N; i++) {
+                uint32_t bits = get32(in + i * 4);
+                std::memcpy(&values[i], &bits, sizeof(bits));
+            }
+        }
+
+        uint16_t stringLength(std::string_view value) {
+            if (value.size() > MAX_STRING) {
+                OC_LOG_ERROR("Can't encode a %zu byte string in a binary record, at most %zu are supported", value.size(), MAX_STRING);
+                throw std::runtime_error("String too long for a binary record");
+            }
+            return static_cast<uint16_t>(value.size());
+        }
+
+        // A connection decodes into the same ShotData every time, a string that hasn't changed isn't interned again
+        void assign(InternedString& target, std::string_view value) {
+            if (target != value) {
+                target = InternedString(value);
+            }
+        }
+
+        uint8_t flagsOf(const ShotDataOptions& options) {
+            return static_cast<uint8_t>(options.ContainsBallData | options.ContainsClubData << 1 | options.LaunchMonitorIsReady << 2
+                | options.LaunchMonitorBallDetected << 3 | options.IsHeartBeat << 4);
+        }
+
+        ShotDataOptions optionsOf(uint8_t flags) {
+            return ShotDataOptions((flags & 1) != 0, (flags & 2) != 0, (flags & 4) != 0, (flags & 8) != 0, (flags & 16) != 0);
+        }
+
+        void checkRecord(std::string_view message, uint8_t type, size_t headerSize) {
+            if (message.size() < headerSize || static_cast<uint8_t>(message[0]) != type) {
+                throw std::runtime_error("Malformed binary record of " + std::to_string(message.size()) + " bytes");
+            }
+        }
+    }
+
+    size_t BinaryCodec::encode(const ShotData& shotData, char* buf, size_t cap) const {
+        std::string_view strings[] = { shotData.DeviceID.view(), shotData.Units.view(), shotData.APIversion.view() };
+        uint16_t lengths[] = { stringLength(strings[0]), stringLength(strings[1]), stringLength(strings[2]) };
+        size_t recordSize = SHOT_HEADER_SIZE + lengths[0] + lengths[1] + lengths[2];
+        if (PREFIX + recordSize > cap) {
+            return PREFIX + recordSize;
+        }
+
+        put32(buf, static_cast<uint32_t>(recordSize));
+        char* record = buf + PREFIX;
+        record[0] = static_cast<char>(SHOT_RECORD);
+        record[1] = static_cast<char>(flagsOf(shotData.ShotDataOptions));
+        put16(record + 2, 0);
+        put32(record + 4, static_cast<uint32_t>(shotData.ShotNumber));
+        float ball[BALL_FLOATS];
+        float club[CLUB_FLOATS];
+        std::memcpy(ball, &shotData.BallData, sizeof(ball));
+        std::memcpy(club, &shotData.ClubData, sizeof(club));
+        putFloats<BALL_FLOATS>(record + 8, ball);
+        putFloats<CLUB_FLOATS>(record + 40, club);
+        char* out = record + 80;
+        for (uint16_t length : lengths) {
+            put16(out, length);
+            out += 2;
+        }
+        for (size_t i = 0; i < 3; i++) {
+            std::memcpy(out, strings[i].data(), lengths[i]);
+            out += lengths[i];
+        }
+        return PREFIX + recordSize;
+    }
+
+    size_t BinaryCodec::encode(const Response& response, char* buf, size_t cap) const {
+        std::string_view strings[] = { response.Message, response.Player.Handed, response.Player.Club };
+        uint16_t lengths[] = { stringLength(strings[0]), stringLength(strings[1]), stringLength(strings[2]) };
+        size_t recordSize = RESPONSE_HEADER_SIZE + lengths[0] + lengths[1] + lengths[2];
+        if (PREFIX + recordSize > cap) {
+            return PREFIX + recordSize;
+        }
+
+        put32(buf, static_cast<uint32_t>(recordSize));
+        char* record = buf + PREFIX;
+        record[0] = static_cast<char>(RESPONSE_RECORD);
+        record[1] = 0;
+        put16(record + 2, static_cast<uint16_t>(response.Code));
+        char* out = record + 4;
+        for (uint16_t length : lengths) {
+            put16(out, length);
+            out += 2;
+        }
+        for (size_t i = 0; i < 3; i++) {
+            std::memcpy(out, strings[i].data(), lengths[i]);
+            out += lengths[i];
+        }
+        return PREFIX + recordSize;
+    }
+
+    void BinaryCodec::decode(std::string_view message, ShotData& shotData) const {
+        checkRecord(message, SHOT_RECORD, SHOT_HEADER_SIZE);
+        const char* record = message.data();
+        size_t lengths[] = { get16(record + 80), get16(record + 82), get16(record + 84) };
+        if (SHOT_HEADER_SIZE + lengths[0] + lengths[1] + lengths[2] != message.size()) {
+            throw std::runtime_error("Binary shot record strings don't match its size");
+        }
+
+        shotData.ShotDataOptions = optionsOf(static_cast<uint8_t>(record[1]));
+        shotData.ShotNumber = static_cast<int32_t>(get32(record + 4));
+        float ball[BALL_FLOATS];
+        float club[CLUB_FLOATS];
+        getFloats<BALL_FLOATS>(record + 8, ball);
+        getFloats<CLUB_FLOATS>(record + 40, club);
+        std::memcpy(&shotData.BallData, ball, sizeof(ball));
+        std::memcpy(&shotData.ClubData, club, sizeof(club));
+        const char* in = record + SHOT_HEADER_SIZE;
+        assign(shotData.DeviceID, std::string_view(in, lengths[0]));
+        in += lengths[0];
+        assign(shotData.Units, std::string_view(in, lengths[1]));
+        in += lengths[1];
+        assign(shotData.APIversion, std::string_view(in, lengths[2]));
+    }
+
+    void BinaryCodec::decodeSkippingHeartbeatData(std::string_view message, ShotData& shotData) const {
+        this->decode(message, shotData);
+    }
+
+    Response BinaryCodec::decodeResponse(std::string_view message) const {
+        checkRecord(message, RESPONSE_RECORD, RESPONSE_HEADER_SIZE);
+        const char* record = message.data();
+        size_t lengths[] = { get16(record + 4), get16(record + 6), get16(record + 8) };
+        if (RESPONSE_HEADER_SIZE + lengths[0] + lengths[1] + lengths[2] != message.size()) {
+            throw std::runtime_error("Binary response record strings don't match its size");
+        }
+
+        const char* in = record + RESPONSE_HEADER_SIZE;
+        Response response(static_cast<ResponseCode>(get16(record + 2)), std::string(in, lengths[0]));
+        in += lengths[0];
+        response.Player.Handed.assign(in, lengths[1]);
+        in += lengths[1];
+        response.Player.Club.assign(in, lengths[2]);
+        return response;
+    }
+}
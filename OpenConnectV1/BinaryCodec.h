@@ -0,0 +1,45 @@
+#ifndef OPEN_CONNECT_BINARY_CODEC_H
+#define OPEN_CONNECT_BINARY_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "WireCodec.h"
+
+namespace OpenConnectV1 {
+    /**
+     * Compact binary encoding of the Open Connect V1 model, for links between our own boxes.  A client selects
+     * it by sending MAGIC before its first message; every message is then a 4 byte length and a record, all
+     * integers and floats little endian:
+     *
+     *   Shot      u8 type (1), u8 flags, u16 0, i32 ShotNumber, f32 BallData[8], f32 ClubData[10],
+     *             u16 DeviceID/Units/APIversion lengths, then their bytes
+     *   Response  u8 type (2), u8 0, u16 Code, u16 Message/Handed/Club lengths, then their bytes
+     *
+     * The flags are ShotDataOptions, bit 0 ContainsBallData to bit 4 IsHeartBeat.  Floats are copied bit for bit,
+     * NaN included, so a shot decodes to exactly what was encoded without any text conversion.  Responses to a
+     * binary client are binary records too.
+     */
+    class BinaryCodec : public WireCodec {
+    public:
+        static constexpr std::string_view MAGIC{ "OCB1", 4 };
+        static constexpr uint8_t SHOT_RECORD = 1;
+        static constexpr uint8_t RESPONSE_RECORD = 2;
+        static constexpr size_t SHOT_HEADER_SIZE = 86;
+        static constexpr size_t RESPONSE_HEADER_SIZE = 10;
+
+        WireFormat format() const override { return WireFormat::Binary; }
+        MessageFramer::Framing framing() const override { return MessageFramer::Framing::LengthPrefixed; }
+
+        // Throw std::runtime_error when a string is longer than 65535 bytes
+        size_t encode(const ShotData& shotData, char* buf, size_t cap) const override;
+        size_t encode(const Response& response, char* buf, size_t cap) const override;
+
+        void decode(std::string_view message, ShotData& shotData) const override;
+        // Fixed layout, the floats are copied whether or not it's a heartbeat
+        void decodeSkippingHeartbeatData(std::string_view message, ShotData& shotData) const override;
+        Response decodeResponse(std::string_view message) const override;
+    };
+}
+
+#endif
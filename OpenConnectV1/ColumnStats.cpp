@@ -0,0 +1,391 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+#include "ColumnStats.h"
+#include "Logger.h"
+#include "Simd.h"
+
+namespace OpenConnectV1 {
+    namespace {
+        constexpr float MISSING = std::numeric_limits<float>::quiet_NaN();
+        constexpr float INFINITE = std::numeric_limits<float>::infinity();
+
+        // Sums are of (value - Shift) in double, the shift (the first value) keeps the variance from cancelling out
+        struct Sums {
+            size_t Count = 0;
+            double Sum = 0;
+            double Squares = 0;
+            float Min = INFINITE;
+            float Max = -INFINITE;
+        };
+
+        void addScalar(Sums& sums, float value, float shift) {
+            if (std::isnan(value)) {
+                return;
+            }
+            double delta = static_cast<double>(value) - shift;
+            sums.Count++;
+            sums.Sum += delta;
+            sums.Squares += delta * delta;
+            sums.Min = std::min(sums.Min, value);
+            sums.Max = std::max(sums.Max, value);
+        }
+
+        float ratio(float numerator, float denominator) {
+            return denominator != 0 ? numerator / denominator : MISSING;
+        }
+
+        void statsScalar(const float* values, size_t count, float shift, Sums& sums) {
+            for (size_t i = 0; i < count; i++) {
+                addScalar(sums, values[i], shift);
+            }
+        }
+
+        void ratioStatsScalar(const float* numerators, const float* denominators, size_t count, float shift, Sums& sums) {
+            for (size_t i = 0; i < count; i++) {
+                addScalar(sums, ratio(numerators[i], denominators[i]), shift);
+            }
+        }
+
+#ifdef OPEN_CONNECT_X86
+        // Lanes of the SIMD passes, folded into Sums once the pass is done.  NaN lanes are swapped for the shift so
+        // they add exactly 0, min/max return their second operand when the first one is NaN.
+        struct Sse2Sums {
+            __m128i Count;
+            __m128d SumLow, SumHigh, SquaresLow, SquaresHigh;
+            __m128 Min, Max;
+        };
+
+        OPEN_CONNECT_TARGET_SSE2 inline void initSse2(Sse2Sums& s) {
+            s.Count = _mm_setzero_si128();
+            s.SumLow = s.SumHigh = s.SquaresLow = s.SquaresHigh = _mm_setzero_pd();
+            s.Min = _mm_set1_ps(INFINITE);
+            s.Max = _mm_set1_ps(-INFINITE);
+        }
+
+        OPEN_CONNECT_TARGET_SSE2 inline void addSse2(Sse2Sums& s, __m128 x, __m128 valid, __m128 shift, __m128d shiftDouble) {
+            s.Count = _mm_sub_epi32(s.Count, _mm_castps_si128(valid));
+            s.Min = _mm_min_ps(x, s.Min);
+            s.Max = _mm_max_ps(x, s.Max);
+            __m128 y = _mm_or_ps(_mm_and_ps(valid, x), _mm_andnot_ps(valid, shift));
+            __m128d low = _mm_sub_pd(_mm_cvtps_pd(y), shiftDouble);
+            __m128d high = _mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(y, y)), shiftDouble);
+            s.SumLow = _mm_add_pd(s.SumLow, low);
+            s.SumHigh = _mm_add_pd(s.SumHigh, high);
+            s.SquaresLow = _mm_add_pd(s.SquaresLow, _mm_mul_pd(low, low));
+            s.SquaresHigh = _mm_add_pd(s.SquaresHigh, _mm_mul_pd(high, high));
+        }
+
+        OPEN_CONNECT_TARGET_SSE2 inline void finishSse2(const Sse2Sums& s, Sums& sums) {
+            alignas(16) int32_t counts[4];
+            alignas(16) double sum[2];
+            alignas(16) double squares[2];
+            alignas(16) float mins[4];
+            alignas(16) float maxes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(counts), s.Count);
+            _mm_store_pd(sum, _mm_add_pd(s.SumLow, s.SumHigh));
+            _mm_store_pd(squares, _mm_add_pd(s.SquaresLow, s.SquaresHigh));
+            _mm_store_ps(mins, s.Min);
+            _mm_store_ps(maxes, s.Max);
+            for (int lane = 0; lane < 4; lane++) {
+                sums.Count += static_cast<uint32_t>(counts[lane]);
+                sums.Min = std::min(sums.Min, mins[lane]);
+                sums.Max = std::max(sums.Max, maxes[lane]);
+            }
+            sums.Sum += sum[0] + sum[1];
+            sums.Squares += squares[0] + squares[1];
+        }
+
+        OPEN_CONNECT_TARGET_SSE2 void statsSse2(const float* values, size_t count, float shift, Sums& sums) {
+            Sse2Sums s;
+            initSse2(s);
+            __m128 shiftVector = _mm_set1_ps(shift);
+            __m128d shiftDouble = _mm_set1_pd(shift);
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m128 x = _mm_loadu_ps(values + i);
+                addSse2(s, x, _mm_cmpord_ps(x, x), shiftVector, shiftDouble);
+            }
+            finishSse2(s, sums);
+            statsScalar(values + i, count - i, shift, sums);
+        }
+
+        OPEN_CONNECT_TARGET_SSE2 void ratioStatsSse2(const float* numerators, const float* denominators, size_t count,
+            float shift, Sums& sums) {
+            Sse2Sums s;
+            initSse2(s);
+            __m128 shiftVector = _mm_set1_ps(shift);
+            __m128d shiftDouble = _mm_set1_pd(shift);
+            __m128 zero = _mm_setzero_ps();
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m128 denominator = _mm_loadu_ps(denominators + i);
+                __m128 x = _mm_div_ps(_mm_loadu_ps(numerators + i), denominator);
+                // cmpneq is true for NaN, the ordered check on x rules those out
+                __m128 valid = _mm_and_ps(_mm_cmpord_ps(x, x), _mm_cmpneq_ps(denominator, zero));
+                // Division by zero lanes become NaN so min/max skip them too
+                x = _mm_or_ps(x, _mm_andnot_ps(valid, _mm_castsi128_ps(_mm_set1_epi32(-1))));
+                addSse2(s, x, valid, shiftVector, shiftDouble);
+            }
+            finishSse2(s, sums);
+            ratioStatsScalar(numerators + i, denominators + i, count - i, shift, sums);
+        }
+
+        struct Avx2Sums {
+            __m256i Count;
+            __m256d SumLow, SumHigh, SquaresLow, SquaresHigh;
+            __m256 Min, Max;
+        };
+
+        OPEN_CONNECT_TARGET_AVX2 inline void initAvx2(Avx2Sums& s) {
+            s.Count = _mm256_setzero_si256();
+            s.SumLow = s.SumHigh = s.SquaresLow = s.SquaresHigh = _mm256_setzero_pd();
+            s.Min = _mm256_set1_ps(INFINITE);
+            s.Max = _mm256_set1_ps(-INFINITE);
+        }
+
+        OPEN_CONNECT_TARGET_AVX2 inline void addAvx2(Avx2Sums& s, __m256 x, __m256 valid, __m256 shift, __m256d shiftDouble) {
+            s.Count = _mm256_sub_epi32(s.Count, _mm256_castps_si256(valid));
+            s.Min = _mm256_min_ps(x, s.Min);
+            s.Max = _mm256_max_ps(x, s.Max);
+            __m256 y = _mm256_blendv_ps(shift, x, valid);
+            __m256d low = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(y)), shiftDouble);
+            __m256d high = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(y, 1)), shiftDouble);
+            s.SumLow = _mm256_add_pd(s.SumLow, low);
+            s.SumHigh = _mm256_add_pd(s.SumHigh, high);
+            s.SquaresLow = _mm256_add_pd(s.SquaresLow, _mm256_mul_pd(low, low));
+            s.SquaresHigh = _mm256_add_pd(s.SquaresHigh, _mm256_mul_pd(high, high));
+        }
+
+        OPEN_CONNECT_TARGET_AVX2 inline void finishAvx2(const Avx2Sums& s, Sums& sums) {
+            alignas(32) int32_t counts[8];
+            alignas(32) double sum[4];
+            alignas(32) double squares[4];
+            alignas(32) float mins[8];
+            alignas(32) float maxes[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(counts), s.Count);
+            _mm256_store_pd(sum, _mm256_add_pd(s.SumLow, s.SumHigh));
+            _mm256_store_pd(squares, _mm256_add_pd(s.SquaresLow, s.SquaresHigh));
+            _mm256_store_ps(mins, s.Min);
+            _mm256_store_ps(maxes, s.Max);
+            for (int lane = 0; lane < 8; lane++) {
+                sums.Count += static_cast<uint32_t>(counts[lane]);
+                sums.Min = std::min(sums.Min, mins[lane]);
+                sums.Max = std::max(sums.Max, maxes[lane]);
+            }
+            sums.Sum += (sum[0] + sum[1]) + (sum[2] + sum[3]);
+            sums.Squares += (squares[0] + squares[1]) + (squares[2] + squares[3]);
+        }
+
+        OPEN_CONNECT_TARGET_AVX2 void statsAvx2(const float* values, size_t count, float shift, Sums& sums) {
+            Avx2Sums s;
+            initAvx2(s);
+            __m256 shiftVector = _mm256_set1_ps(shift);
+            __m256d shiftDouble = _mm256_set1_pd(shift);
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m256 x = _mm256_loadu_ps(values + i);
+                addAvx2(s, x, _mm256_cmp_ps(x, x, _CMP_ORD_Q), shiftVector, shiftDouble);
+            }
+            finishAvx2(s, sums);
+            statsScalar(values + i, count - i, shift, sums);
+        }
+
+        OPEN_CONNECT_TARGET_AVX2 void ratioStatsAvx2(const float* numerators, const float* denominators, size_t count,
+            float shift, Sums& sums) {
+            Avx2Sums s;
+            initAvx2(s);
+            __m256 shiftVector = _mm256_set1_ps(shift);
+            __m256d shiftDouble = _mm256_set1_pd(shift);
+            __m256 zero = _mm256_setzero_ps();
+            __m256 nan = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m256 denominator = _mm256_loadu_ps(denominators + i);
+                __m256 x = _mm256_div_ps(_mm256_loadu_ps(numerators + i), denominator);
+                __m256 valid = _mm256_and_ps(_mm256_cmp_ps(x, x, _CMP_ORD_Q), _mm256_cmp_ps(denominator, zero, _CMP_NEQ_OQ));
+                x = _mm256_blendv_ps(nan, x, valid);
+                addAvx2(s, x, valid, shiftVector, shiftDouble);
+            }
+            finishAvx2(s, sums);
+            ratioStatsScalar(numerators + i, denominators + i, count - i, shift, sums);
+        }
+#endif
+
+        SimdLevel detectSimdLevel() {
+#ifdef OPEN_CONNECT_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 0);
+            int maxLeaf = info[0];
+            __cpuid(info, 1);
+            bool sse2 = (info[3] & (1 << 26)) != 0;
+            // AVX2 also needs the OS to save the upper halves of the registers
+            bool avxEnabled = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+            bool avx2 = false;
+            if (maxLeaf >= 7 && avxEnabled) {
+                __cpuidex(info, 7, 0);
+                avx2 = (info[1] & (1 << 5)) != 0;
+            }
+#else
+            __builtin_cpu_init();
+            bool sse2 = __builtin_cpu_supports("sse2");
+            bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+            return avx2 ? SimdLevel::AVX2 : sse2 ? SimdLevel::SSE2 : SimdLevel::Scalar;
+#else
+            return SimdLevel::Scalar;
+#endif
+        }
+
+        std::atomic<SimdLevel>& activeLevel() {
+            static std::atomic<SimdLevel> level(supportedSimdLevel());
+            return level;
+        }
+
+        ColumnStats finish(const Sums& sums, float shift) {
+            ColumnStats stats;
+            stats.Count = sums.Count;
+            if (sums.Count == 0) {
+                return stats;
+            }
+            double n = static_cast<double>(sums.Count);
+            stats.Mean = shift + sums.Sum / n;
+            if (sums.Count > 1) {
+                stats.Variance = std::max(0.0, (sums.Squares - sums.Sum * sums.Sum / n) / (n - 1));
+            }
+            stats.Min = sums.Min;
+            stats.Max = sums.Max;
+            return stats;
+        }
+
+        size_t firstValid(const float* values, size_t count) {
+            size_t i = 0;
+            while (i < count && std::isnan(values[i])) {
+                i++;
+            }
+            return i;
+        }
+    }
+
+    ColumnStats columnStats(const float* values, size_t count) {
+        size_t first = firstValid(values, count);
+        if (first == count) {
+            return ColumnStats();
+        }
+
+        // Starts at the first value, the NaNs before it have nothing to add
+        values += first;
+        count -= first;
+        float shift = values[0];
+        Sums sums;
+        switch (simdLevel()) {
+#ifdef OPEN_CONNECT_X86
+        case SimdLevel::AVX2: statsAvx2(values, count, shift, sums); break;
+        case SimdLevel::SSE2: statsSse2(values, count, shift, sums); break;
+#endif
+        default: statsScalar(values, count, shift, sums); break;
+        }
+        return finish(sums, shift);
+    }
+
+    ColumnStats columnStats(const ShotColumn& column) {
+        return columnStats(column.Data, column.Size);
+    }
+
+    ColumnStats ratioStats(const float* numerators, const float* denominators, size_t count) {
+        size_t first = 0;
+        while (first < count && std::isnan(ratio(numerators[first], denominators[first]))) {
+            first++;
+        }
+        if (first == count) {
+            return ColumnStats();
+        }
+
+        numerators += first;
+        denominators += first;
+        count -= first;
+        float shift = ratio(numerators[0], denominators[0]);
+        Sums sums;
+        switch (simdLevel()) {
+#ifdef OPEN_CONNECT_X86
+        case SimdLevel::AVX2: ratioStatsAvx2(numerators, denominators, count, shift, sums); break;
+        case SimdLevel::SSE2: ratioStatsSse2(numerators, denominators, count, shift, sums); break;
+#endif
+        default: ratioStatsScalar(numerators, denominators, count, shift, sums); break;
+        }
+        return finish(sums, shift);
+    }
+
+    ColumnStats ratioStats(const ShotColumn& numerators, const ShotColumn& denominators) {
+        return ratioStats(numerators.Data, denominators.Data, std::min(numerators.Size, denominators.Size));
+    }
+
+    std::vector<float> percentiles(const float* values, size_t count, const std::vector<double>& ranks) {
+        for (double rank : ranks) {
+            if (!(rank >= 0 && rank <= 100)) {
+                OC_LOG_ERROR("Invalid percentile %f", rank);
+                throw std::runtime_error("Percentiles have to be between 0 and 100");
+            }
+        }
+
+        std::vector<float> valid;
+        valid.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            if (!std::isnan(values[i])) {
+                valid.push_back(values[i]);
+            }
+        }
+
+        std::vector<float> results(ranks.size(), MISSING);
+        if (valid.empty()) {
+            return results;
+        }
+
+        // Ascending ranks, each selection only has to look at what's right of the previous one
+        std::vector<size_t> order(ranks.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&ranks](size_t a, size_t b) { return ranks[a] < ranks[b]; });
+
+        auto begin = valid.begin();
+        for (size_t index : order) {
+            double position = ranks[index] / 100 * (valid.size() - 1);
+            size_t lower = static_cast<size_t>(position);
+            auto nth = valid.begin() + lower;
+            std::nth_element(begin, nth, valid.end());
+            begin = nth;
+
+            double value = *nth;
+            double fraction = position - lower;
+            if (fraction > 0) {
+                double next = *std::min_element(nth + 1, valid.end());
+                value += fraction * (next - value);
+            }
+            results[index] = static_cast<float>(value);
+        }
+        return results;
+    }
+
+    std::vector<float> percentiles(const ShotColumn& column, const std::vector<double>& ranks) {
+        return percentiles(column.Data, column.Size, ranks);
+    }
+
+    SimdLevel supportedSimdLevel() {
+        static const SimdLevel supported = detectSimdLevel();
+        return supported;
+    }
+
+    SimdLevel simdLevel() {
+        return activeLevel().load(std::memory_order_relaxed);
+    }
+
+    SimdLevel setSimdLevel(SimdLevel level) {
+        SimdLevel used = std::min(level, supportedSimdLevel());
+        activeLevel().store(used, std::memory_order_relaxed);
+        return used;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef OPEN_CONNECT_COLUMN_STATS_H
+#define OPEN_CONNECT_COLUMN_STATS_H
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "ShotStore.h"
+
+/**
+ * Statistics over float columns (ShotStore columns or any float array), NaN values are missing and skipped, as
+ * everywhere else in the library.  Count, mean, variance, min and max come out of a single fused pass; the
+ * passes are vectorized with SSE2 or AVX2, whichever is the best the CPU supports, picked at runtime with a
+ * scalar fallback.  Every level gives the same count, min and max, sums may differ in the last bits.
+ */
+namespace OpenConnectV1 {
+    enum class SimdLevel {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    struct ColumnStats {
+        size_t Count = 0;                                           // Values that aren't NaN
+        double Mean = std::numeric_limits<double>::quiet_NaN();
+        double Variance = std::numeric_limits<double>::quiet_NaN(); // Sample variance, NaN for fewer than 2 values
+        float Min = std::numeric_limits<float>::quiet_NaN();
+        float Max = std::numeric_limits<float>::quiet_NaN();
+
+        double standardDeviation() const { return std::sqrt(this->Variance); }
+    };
+
+    ColumnStats columnStats(const float* values, size_t count);
+    ColumnStats columnStats(const ShotColumn& column);
+
+    // Statistics of numerators[i] / denominators[i] (smash factor is BallSpeed over ClubSpeed), pairs with a NaN
+    // or a zero denominator are skipped.  The ratios are never materialized.
+    ColumnStats ratioStats(const float* numerators, const float* denominators, size_t count);
+    ColumnStats ratioStats(const ShotColumn& numerators, const ShotColumn& denominators);
+
+    // Percentiles (0 to 100, linearly interpolated between the closest ranks) of the values that aren't NaN, in the
+    // order they were asked for.  NaN when there are no values; throws std::runtime_error for a rank out of range.
+    std::vector<float> percentiles(const float* values, size_t count, const std::vector<double>& ranks);
+    std::vector<float> percentiles(const ShotColumn& column, const std::vector<double>& ranks);
+
+    // The best level this CPU supports
+    SimdLevel supportedSimdLevel();
+    SimdLevel simdLevel();
+    // Caps the level used (to compare levels in tests and benchmarks), returns the level now in use
+    SimdLevel setSimdLevel(SimdLevel level);
+}
+
+#endif
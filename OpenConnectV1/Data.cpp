@@ -1,6 +1,716 @@
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
 #include "Data.h"
 
 namespace OpenConnectV1 {
+    namespace {
+        constexpr float MISSING = std::numeric_limits<float>::quiet_NaN();
+
+        enum class Key : uint8_t {
+            Unknown,
+            // ShotData
+            DeviceID, Units, ShotNumber, APIversion, BallData, ClubData, ShotDataOptions,
+            // BallData (Speed is shared with ClubData)
+            Speed, SpinAxis, TotalSpin, BackSpin, SideSpin, HLA, VLA, CarryDistance,
+            // ClubData
+            AngleOfAttack, FaceToTarget, Lie, Loft, Path, SpeedAtImpact, VerticalFaceImpact,
+            HorizontalFaceImpact, ClosureRate,
+            // ShotDataOptions
+            ContainsBallData, ContainsClubData, LaunchMonitorIsReady, LaunchMonitorBallDetected, IsHeartBeat
+        };
+
+        struct KeyName {
+            std::string_view name;
+            Key key = Key::Unknown;
+        };
+
+        constexpr KeyName KEY_NAMES[] = {
+            { "DeviceID", Key::DeviceID }, { "Units", Key::Units }, { "ShotNumber", Key::ShotNumber },
+            { "APIversion", Key::APIversion }, { "BallData", Key::BallData }, { "ClubData", Key::ClubData },
+            { "ShotDataOptions", Key::ShotDataOptions },
+            { "Speed", Key::Speed }, { "SpinAxis", Key::SpinAxis }, { "TotalSpin", Key::TotalSpin },
+            { "BackSpin", Key::BackSpin }, { "SideSpin", Key::SideSpin }, { "HLA", Key::HLA }, { "VLA", Key::VLA },
+            { "CarryDistance", Key::CarryDistance },
+            { "AngleOfAttack", Key::AngleOfAttack }, { "FaceToTarget", Key::FaceToTarget }, { "Lie", Key::Lie },
+            { "Loft", Key::Loft }, { "Path", Key::Path }, { "SpeedAtImpact", Key::SpeedAtImpact },
+            { "VerticalFaceImpact", Key::VerticalFaceImpact }, { "HorizontalFaceImpact", Key::HorizontalFaceImpact },
+            { "ClosureRate", Key::ClosureRate },
+            { "ContainsBallData", Key::ContainsBallData }, { "ContainsClubData", Key::ContainsClubData },
+            { "LaunchMonitorIsReady", Key::LaunchMonitorIsReady },
+            { "LaunchMonitorBallDetected", Key::LaunchMonitorBallDetected }, { "IsHeartBeat", Key::IsHeartBeat }
+        };
+
+        // Perfect hash over the key names above; the static_assert below fails the build if a new key collides.
+        constexpr size_t KEY_TABLE_SIZE = 64;
+
+        constexpr size_t hashKey(std::string_view name) {
+            return (name.size() * 3
+                + static_cast<unsigned char>(name[0]) * 8
+                + static_cast<unsigned char>(name[name.size() - 1]) * 8
+                + static_cast<unsigned char>(name[name.size() / 2]) * 2) & (KEY_TABLE_SIZE - 1);
+        }
+
+        struct KeyTable {
+            KeyName slots[KEY_TABLE_SIZE];
+            bool perfect = true;
+        };
+
+        constexpr KeyTable buildKeyTable() {
+            KeyTable table{};
+            for (const auto& entry : KEY_NAMES) {
+                auto& slot = table.slots[hashKey(entry.name)];
+                if (slot.key != Key::Unknown) {
+                    table.perfect = false;
+                }
+                slot = entry;
+            }
+            return table;
+        }
+
+        constexpr KeyTable KEY_TABLE = buildKeyTable();
+        static_assert(KEY_TABLE.perfect, "ShotData key names collide in KEY_TABLE, adjust hashKey()");
+
+        Key lookupKey(std::string_view name) {
+            if (name.empty()) {
+                return Key::Unknown;
+            }
+            const KeyName& slot = KEY_TABLE.slots[hashKey(name)];
+            return slot.name == name ? slot.key : Key::Unknown;
+        }
+
+        void resetBallData(BallData& b) {
+            b.Speed = b.SpinAxis = b.TotalSpin = b.BackSpin = b.SideSpin = MISSING;
+            b.HLA = b.VLA = b.CarryDistance = MISSING;
+        }
+
+        void resetClubData(ClubData& c) {
+            c.Speed = c.AngleOfAttack = c.FaceToTarget = c.Lie = c.Loft = c.Path = MISSING;
+            c.SpeedAtImpact = c.VerticalFaceImpact = c.HorizontalFaceImpact = c.ClosureRate = MISSING;
+        }
+
+        /**
+         * Single pass decoder for the ShotData document.  Works directly on the raw bytes, the only writes are
+         * into the destination ShotData.  Strings are interned straight from the raw bytes unless they contain escapes.
+         */
+        class ShotDataDecoder {
+        public:
+            explicit ShotDataDecoder(std::string_view raw)
+                : begin(raw.data()), pos(raw.data()), end(raw.data() + raw.size()) {}
+
+            // With heartbeatData false a heartbeat's BallData and ClubData are only skipped over
+            void decode(ShotData& s, bool heartbeatData) {
+                s.DeviceID = InternedString();
+                s.Units = InternedString();
+                s.APIversion = InternedString();
+                s.ShotNumber = 0;
+                resetBallData(s.BallData);
+                resetClubData(s.ClubData);
+                s.ShotDataOptions = OpenConnectV1::ShotDataOptions();
+
+                this->deferData = !heartbeatData && this->looksLikeHeartbeat();
+                this->skipWhitespace();
+                this->parseObject([&](Key key) { this->parseShotField(key, s); });
+                this->skipWhitespace();
+                if (this->pos != this->end) {
+                    this->fail("unexpected trailing characters");
+                }
+                if (this->deferData && !s.ShotDataOptions.IsHeartBeat) {
+                    this->parseDeferredData(s);
+                }
+            }
+
+        private:
+            const char* begin;
+            const char* pos;
+            const char* end;
+            std::string scratch;        // Strings with escapes are unescaped here before being interned
+            bool deferData = false;
+            const char* ballData = nullptr;     // Where the skipped BallData/ClubData objects start
+            const char* clubData = nullptr;
+
+            [[noreturn]] void fail(const char* reason) const {
+                throw std::runtime_error(std::string("Invalid ShotData JSON, ") + reason + " at offset "
+                    + std::to_string(this->pos - this->begin));
+            }
+
+            char peek() const {
+                return this->pos < this->end ? *this->pos : '\0';
+            }
+
+            void skipWhitespace() {
+                while (this->pos < this->end && (*this->pos == ' ' || *this->pos == '\n' || *this->pos == '\r' || *this->pos == '\t')) {
+                    this->pos++;
+                }
+            }
+
+            void expect(char c) {
+                if (this->peek() != c) {
+                    this->fail("unexpected character");
+                }
+                this->pos++;
+            }
+
+            void expectLiteral(std::string_view literal) {
+                if (static_cast<size_t>(this->end - this->pos) < literal.size()
+                    || std::string_view(this->pos, literal.size()) != literal) {
+                    this->fail("invalid literal");
+                }
+                this->pos += literal.size();
+            }
+
+            template <typename FieldHandler>
+            void parseObject(FieldHandler&& onField) {
+                this->expect('{');
+                this->skipWhitespace();
+                if (this->peek() == '}') {
+                    this->pos++;
+                    return;
+                }
+
+                while (true) {
+                    this->skipWhitespace();
+                    Key key = lookupKey(this->parseKey());
+                    this->skipWhitespace();
+                    this->expect(':');
+                    this->skipWhitespace();
+                    onField(key);
+                    this->skipWhitespace();
+
+                    if (this->peek() == ',') {
+                        this->pos++;
+                        continue;
+                    }
+                    this->expect('}');
+                    return;
+                }
+            }
+
+            void parseShotField(Key key, ShotData& s) {
+                switch (key) {
+                case Key::DeviceID: this->parseInterned(s.DeviceID); break;
+                case Key::Units: this->parseInterned(s.Units); break;
+                case Key::APIversion: this->parseInterned(s.APIversion); break;
+                case Key::ShotNumber: s.ShotNumber = this->parseInt(); break;
+                case Key::BallData:
+                    if (this->peek() == '{' && this->deferData) {
+                        this->ballData = this->pos;
+                        this->skipValue();
+                    }
+                    else if (this->peek() == '{') {
+                        this->parseObject([&](Key k) { this->parseBallField(k, s.BallData); });
+                    }
+                    else {
+                        this->skipValue();
+                    }
+                    break;
+                case Key::ClubData:
+                    if (this->peek() == '{' && this->deferData) {
+                        this->clubData = this->pos;
+                        this->skipValue();
+                    }
+                    else if (this->peek() == '{') {
+                        this->parseObject([&](Key k) { this->parseClubField(k, s.ClubData); });
+                    }
+                    else {
+                        this->skipValue();
+                    }
+                    break;
+                case Key::ShotDataOptions:
+                    if (this->peek() == '{') {
+                        this->parseObject([&](Key k) { this->parseOptionsField(k, s.ShotDataOptions); });
+                    }
+                    else {
+                        this->skipValue();
+                    }
+                    break;
+                default: this->skipValue(); break;
+                }
+            }
+
+            // The options usually come after the data, so whether to skip it is decided up front from the raw
+            // bytes.  Only a guess: a skipped shot's data is parsed after all, it just takes a second pass.
+            bool looksLikeHeartbeat() const {
+                constexpr std::string_view KEY = "IsHeartBeat\"";
+                std::string_view raw(this->begin, static_cast<size_t>(this->end - this->begin));
+                size_t key = raw.find(KEY);
+                if (key == std::string_view::npos) {
+                    return false;
+                }
+                size_t value = raw.find_first_not_of(" \t\r\n:", key + KEY.size());
+                return value != std::string_view::npos && raw[value] == 't';
+            }
+
+            // A repeated BallData/ClubData key only keeps its last object here, where decoding as it goes merges them
+            void parseDeferredData(ShotData& s) {
+                if (this->ballData != nullptr) {
+                    this->pos = this->ballData;
+                    this->parseObject([&](Key k) { this->parseBallField(k, s.BallData); });
+                }
+                if (this->clubData != nullptr) {
+                    this->pos = this->clubData;
+                    this->parseObject([&](Key k) { this->parseClubField(k, s.ClubData); });
+                }
+                this->pos = this->end;
+            }
+
+            void parseBallField(Key key, BallData& b) {
+                switch (key) {
+                case Key::Speed: b.Speed = this->parseFloat(); break;
+                case Key::SpinAxis: b.SpinAxis = this->parseFloat(); break;
+                case Key::TotalSpin: b.TotalSpin = this->parseFloat(); break;
+                case Key::BackSpin: b.BackSpin = this->parseFloat(); break;
+                case Key::SideSpin: b.SideSpin = this->parseFloat(); break;
+                case Key::HLA: b.HLA = this->parseFloat(); break;
+                case Key::VLA: b.VLA = this->parseFloat(); break;
+                case Key::CarryDistance: b.CarryDistance = this->parseFloat(); break;
+                default: this->skipValue(); break;
+                }
+            }
+
+            void parseClubField(Key key, ClubData& c) {
+                switch (key) {
+                case Key::Speed: c.Speed = this->parseFloat(); break;
+                case Key::AngleOfAttack: c.AngleOfAttack = this->parseFloat(); break;
+                case Key::FaceToTarget: c.FaceToTarget = this->parseFloat(); break;
+                case Key::Lie: c.Lie = this->parseFloat(); break;
+                case Key::Loft: c.Loft = this->parseFloat(); break;
+                case Key::Path: c.Path = this->parseFloat(); break;
+                case Key::SpeedAtImpact: c.SpeedAtImpact = this->parseFloat(); break;
+                case Key::VerticalFaceImpact: c.VerticalFaceImpact = this->parseFloat(); break;
+                case Key::HorizontalFaceImpact: c.HorizontalFaceImpact = this->parseFloat(); break;
+                case Key::ClosureRate: c.ClosureRate = this->parseFloat(); break;
+                default: this->skipValue(); break;
+                }
+            }
+
+            void parseOptionsField(Key key, ShotDataOptions& o) {
+                switch (key) {
+                case Key::ContainsBallData: o.ContainsBallData = this->parseBool(); break;
+                case Key::ContainsClubData: o.ContainsClubData = this->parseBool(); break;
+                case Key::LaunchMonitorIsReady: o.LaunchMonitorIsReady = this->parseBool(); break;
+                case Key::LaunchMonitorBallDetected: o.LaunchMonitorBallDetected = this->parseBool(); break;
+                case Key::IsHeartBeat: o.IsHeartBeat = this->parseBool(); break;
+                default: this->skipValue(); break;
+                }
+            }
+
+            // Keys are returned raw; a key containing escapes simply won't match the table and is skipped.
+            std::string_view parseKey() {
+                this->expect('"');
+                const char* start = this->pos;
+                while (this->pos < this->end && *this->pos != '"') {
+                    this->pos += *this->pos == '\\' ? 2 : 1;
+                }
+                if (this->pos >= this->end) {
+                    this->fail("unterminated key");
+                }
+                std::string_view key(start, this->pos - start);
+                this->pos++;
+                return key;
+            }
+
+            void parseInterned(InternedString& out) {
+                if (this->peek() == '"') {
+                    // Without escapes the raw bytes are the string, nothing to unescape into
+                    const char* start = this->pos + 1;
+                    const char* c = start;
+                    while (c < this->end && *c != '"' && *c != '\\' && static_cast<unsigned char>(*c) >= 0x20) {
+                        c++;
+                    }
+                    if (c < this->end && *c == '"') {
+                        out = InternedString(std::string_view(start, c - start));
+                        this->pos = c + 1;
+                        return;
+                    }
+                }
+                this->parseString(this->scratch);
+                out = InternedString(this->scratch);
+            }
+
+            void parseString(std::string& out) {
+                out.clear();
+                if (this->peek() == 'n') {
+                    this->expectLiteral("null");
+                    return;
+                }
+
+                this->expect('"');
+                while (true) {
+                    const char* run = this->pos;
+                    while (this->pos < this->end && *this->pos != '"' && *this->pos != '\\'
+                        && static_cast<unsigned char>(*this->pos) >= 0x20) {
+                        this->pos++;
+                    }
+                    out.append(run, this->pos - run);
+
+                    if (this->pos >= this->end) {
+                        this->fail("unterminated string");
+                    }
+                    if (*this->pos == '"') {
+                        this->pos++;
+                        return;
+                    }
+                    if (*this->pos != '\\') {
+                        this->fail("control character in string");
+                    }
+
+                    this->pos++;
+                    switch (this->peek()) {
+                    case '"': out.push_back('"'); break;
+                    case '\\': out.push_back('\\'); break;
+                    case '/': out.push_back('/'); break;
+                    case 'b': out.push_back('\b'); break;
+                    case 'f': out.push_back('\f'); break;
+                    case 'n': out.push_back('\n'); break;
+                    case 'r': out.push_back('\r'); break;
+                    case 't': out.push_back('\t'); break;
+                    case 'u': this->parseUnicodeEscape(out); continue;
+                    default: this->fail("invalid escape");
+                    }
+                    this->pos++;
+                }
+            }
+
+            // Called with pos on the 'u' of a unicode escape, leaves pos after the escape (and any low surrogate)
+            void parseUnicodeEscape(std::string& out) {
+                uint32_t codepoint = this->parseHex4();
+                if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+                    if (this->peek() != '\\') {
+                        this->fail("missing low surrogate");
+                    }
+                    this->pos++;
+                    uint32_t low = this->parseHex4();
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        this->fail("invalid low surrogate");
+                    }
+                    codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+
+                if (codepoint < 0x80) {
+                    out.push_back(static_cast<char>(codepoint));
+                }
+                else if (codepoint < 0x800) {
+                    out.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+                    out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+                }
+                else if (codepoint < 0x10000) {
+                    out.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+                    out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+                }
+                else {
+                    out.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+                    out.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+                }
+            }
+
+            uint32_t parseHex4() {
+                this->expect('u');
+                if (this->end - this->pos < 4) {
+                    this->fail("truncated unicode escape");
+                }
+                uint32_t value = 0;
+                auto result = std::from_chars(this->pos, this->pos + 4, value, 16);
+                if (result.ptr != this->pos + 4) {
+                    this->fail("invalid unicode escape");
+                }
+                this->pos += 4;
+                return value;
+            }
+
+            bool atNumber() const {
+                char c = this->peek();
+                return c == '-' || (c >= '0' && c <= '9');
+            }
+
+            // Parsed as double and narrowed, so results are bit-identical to json::get<float>()
+            double parseNumber() {
+                const char* start = this->pos;
+                if (*start == '-' && (this->end - start < 2 || start[1] < '0' || start[1] > '9')) {
+                    this->fail("invalid number");
+                }
+
+                double value = 0;
+                auto result = std::from_chars(start, this->end, value);
+                if (result.ec == std::errc::invalid_argument) {
+                    this->fail("invalid number");
+                }
+                this->pos = result.ptr;
+                return value;
+            }
+
+            float parseFloat() {
+                if (this->atNumber()) {
+                    return static_cast<float>(this->parseNumber());
+                }
+                this->skipValue();
+                return MISSING;
+            }
+
+            int parseInt() {
+                if (!this->atNumber()) {
+                    this->skipValue();
+                    return 0;
+                }
+
+                int value = 0;
+                auto result = std::from_chars(this->pos, this->end, value);
+                if (result.ec == std::errc() && result.ptr < this->end
+                    && (*result.ptr == '.' || *result.ptr == 'e' || *result.ptr == 'E')) {
+                    return static_cast<int>(this->parseNumber());
+                }
+                if (result.ec != std::errc()) {
+                    this->fail("invalid integer");
+                }
+                this->pos = result.ptr;
+                return value;
+            }
+
+            bool parseBool() {
+                switch (this->peek()) {
+                case 't': this->expectLiteral("true"); return true;
+                case 'f': this->expectLiteral("false"); return false;
+                case 'n': this->expectLiteral("null"); return false;
+                default: this->fail("expected boolean");
+                }
+            }
+
+            void skipString() {
+                this->expect('"');
+                while (this->pos < this->end && *this->pos != '"') {
+                    this->pos += *this->pos == '\\' ? 2 : 1;
+                }
+                if (this->pos >= this->end) {
+                    this->fail("unterminated string");
+                }
+                this->pos++;
+            }
+
+            // Skips any value (including nested objects/arrays) without recursion
+            void skipValue() {
+                switch (this->peek()) {
+                case '"': this->skipString(); return;
+                case 't': this->expectLiteral("true"); return;
+                case 'f': this->expectLiteral("false"); return;
+                case 'n': this->expectLiteral("null"); return;
+                case '{':
+                case '[': {
+                    int depth = 0;
+                    do {
+                        char c = this->peek();
+                        if (c == '"') {
+                            this->skipString();
+                            continue;
+                        }
+                        if (c == '\0' && this->pos >= this->end) {
+                            this->fail("unterminated object");
+                        }
+                        if (c == '{' || c == '[') depth++;
+                        else if (c == '}' || c == ']') depth--;
+                        this->pos++;
+                    } while (depth > 0);
+                    return;
+                }
+                default:
+                    if (!this->atNumber()) {
+                        this->fail("unexpected value");
+                    }
+                    this->parseNumber();
+                }
+            }
+        };
+
+        /**
+         * Append only writer used by encode().  Once a write doesn't fit nothing else is written, but the position
+         * keeps counting so the caller learns the full length.  Output follows nlohmann::json::dump(): keys in
+         * sorted order, no whitespace, floats widened to double and printed shortest round-trip with ".0"/exponent
+         * formatting identical to its Grisu2 printer, NaN/inf as null.
+         */
+        class JsonWriter {
+        public:
+            JsonWriter(char* buf, size_t cap) : buf(buf), cap(cap) {}
+
+            size_t length() const {
+                return this->pos;
+            }
+
+            void raw(std::string_view s) {
+                if (this->pos + s.size() <= this->cap) {
+                    memcpy(this->buf + this->pos, s.data(), s.size());
+                }
+                this->pos += s.size();
+            }
+
+            void boolean(bool value) {
+                this->raw(value ? std::string_view("true") : std::string_view("false"));
+            }
+
+            void integer(int value) {
+                char digits[16];
+                auto result = std::to_chars(digits, digits + sizeof(digits), value);
+                this->raw(std::string_view(digits, result.ptr - digits));
+            }
+
+            void number(float value) {
+                double d = value;
+                if (!std::isfinite(d)) {
+                    this->raw("null");
+                    return;
+                }
+
+                char out[40];
+                char* o = out;
+                if (std::signbit(d)) {
+                    *o++ = '-';
+                    d = -d;
+                }
+                if (d == 0) {
+                    memcpy(o, "0.0", 3);
+                    this->raw(std::string_view(out, o + 3 - out));
+                    return;
+                }
+
+                // Shortest round-trip digits and exponent, d.ddde+XX
+                char sci[32];
+                auto result = std::to_chars(sci, sci + sizeof(sci), d, std::chars_format::scientific);
+                char digits[20];
+                int k = 0;
+                const char* p = sci;
+                for (; p < result.ptr && *p != 'e'; p++) {
+                    if (*p != '.') {
+                        digits[k++] = *p;
+                    }
+                }
+                int exponent = 0;
+                std::from_chars(p + (p[1] == '+' ? 2 : 1), result.ptr, exponent);
+                int n = exponent + 1;   // position of the decimal point relative to the digits
+
+                constexpr int MIN_EXP = -4;
+                constexpr int MAX_EXP = std::numeric_limits<double>::digits10;
+
+                if (k <= n && n <= MAX_EXP) {
+                    // digits[000].0
+                    memcpy(o, digits, k);
+                    memset(o + k, '0', n - k);
+                    o += n;
+                    *o++ = '.';
+                    *o++ = '0';
+                }
+                else if (0 < n && n <= MAX_EXP) {
+                    // dig.its
+                    memcpy(o, digits, n);
+                    o[n] = '.';
+                    memcpy(o + n + 1, digits + n, k - n);
+                    o += k + 1;
+                }
+                else if (MIN_EXP < n && n <= 0) {
+                    // 0.[000]digits
+                    *o++ = '0';
+                    *o++ = '.';
+                    memset(o, '0', -n);
+                    o += -n;
+                    memcpy(o, digits, k);
+                    o += k;
+                }
+                else {
+                    // d[.igits]e+XX
+                    *o++ = digits[0];
+                    if (k > 1) {
+                        *o++ = '.';
+                        memcpy(o, digits + 1, k - 1);
+                        o += k - 1;
+                    }
+                    int e = n - 1;
+                    *o++ = 'e';
+                    *o++ = e < 0 ? '-' : '+';
+                    e = e < 0 ? -e : e;
+                    if (e < 10) {
+                        *o++ = '0';
+                    }
+                    o = std::to_chars(o, out + sizeof(out), e).ptr;
+                }
+                this->raw(std::string_view(out, o - out));
+            }
+
+            void string(std::string_view value) {
+                static constexpr char HEX[] = "0123456789abcdef";
+
+                this->raw("\"");
+                const char* run = value.data();
+                const char* end = value.data() + value.size();
+                for (const char* c = run; c < end; c++) {
+                    unsigned char ch = static_cast<unsigned char>(*c);
+                    if (ch >= 0x20 && ch != '"' && ch != '\\') {
+                        continue;
+                    }
+
+                    this->raw(std::string_view(run, c - run));
+                    run = c + 1;
+                    switch (ch) {
+                    case '"': this->raw("\\\""); break;
+                    case '\\': this->raw("\\\\"); break;
+                    case '\b': this->raw("\\b"); break;
+                    case '\f': this->raw("\\f"); break;
+                    case '\n': this->raw("\\n"); break;
+                    case '\r': this->raw("\\r"); break;
+                    case '\t': this->raw("\\t"); break;
+                    default: {
+                        char escape[6] = { '\\', 'u', '0', '0', HEX[ch >> 4], HEX[ch & 0xF] };
+                        this->raw(std::string_view(escape, sizeof(escape)));
+                    }
+                    }
+                }
+                this->raw(std::string_view(run, end - run));
+                this->raw("\"");
+            }
+
+        private:
+            char* buf;
+            size_t cap;
+            size_t pos = 0;
+        };
+
+        void writeBallData(JsonWriter& w, const BallData& b) {
+            w.raw("{\"BackSpin\":"); w.number(b.BackSpin);
+            w.raw(",\"CarryDistance\":"); w.number(b.CarryDistance);
+            w.raw(",\"HLA\":"); w.number(b.HLA);
+            w.raw(",\"SideSpin\":"); w.number(b.SideSpin);
+            w.raw(",\"Speed\":"); w.number(b.Speed);
+            w.raw(",\"SpinAxis\":"); w.number(b.SpinAxis);
+            w.raw(",\"TotalSpin\":"); w.number(b.TotalSpin);
+            w.raw(",\"VLA\":"); w.number(b.VLA);
+            w.raw("}");
+        }
+
+        void writeClubData(JsonWriter& w, const ClubData& c) {
+            w.raw("{\"AngleOfAttack\":"); w.number(c.AngleOfAttack);
+            w.raw(",\"ClosureRate\":"); w.number(c.ClosureRate);
+            w.raw(",\"FaceToTarget\":"); w.number(c.FaceToTarget);
+            w.raw(",\"HorizontalFaceImpact\":"); w.number(c.HorizontalFaceImpact);
+            w.raw(",\"Lie\":"); w.number(c.Lie);
+            w.raw(",\"Loft\":"); w.number(c.Loft);
+            w.raw(",\"Path\":"); w.number(c.Path);
+            w.raw(",\"Speed\":"); w.number(c.Speed);
+            w.raw(",\"SpeedAtImpact\":"); w.number(c.SpeedAtImpact);
+            w.raw(",\"VerticalFaceImpact\":"); w.number(c.VerticalFaceImpact);
+            w.raw("}");
+        }
+
+        void writeShotDataOptions(JsonWriter& w, const ShotDataOptions& o) {
+            w.raw("{\"ContainsBallData\":"); w.boolean(o.ContainsBallData);
+            w.raw(",\"ContainsClubData\":"); w.boolean(o.ContainsClubData);
+            w.raw(",\"IsHeartBeat\":"); w.boolean(o.IsHeartBeat);
+            w.raw(",\"LaunchMonitorBallDetected\":"); w.boolean(o.LaunchMonitorBallDetected);
+            w.raw(",\"LaunchMonitorIsReady\":"); w.boolean(o.LaunchMonitorIsReady);
+            w.raw("}");
+        }
+    }
 
     BallData::BallData()
         : Speed(0), SpinAxis(0), TotalSpin(0), BackSpin(0), SideSpin(0), HLA(0), VLA(0), CarryDistance(0) {}
@@ -72,15 +782,13 @@ namespace OpenConnectV1 {
     }
 
     ShotData::ShotData()
-        : DeviceID(""), Units(""), ShotNumber(0), APIversion("") {}
+        : ShotNumber(0) {}
 
-    ShotData::ShotData(std::string deviceID, std::string units, int shotNumber, std::string apiVersion,
+    ShotData::ShotData(InternedString deviceID, InternedString units, int shotNumber, InternedString apiVersion,
         OpenConnectV1::BallData ballData, OpenConnectV1::ClubData clubData, OpenConnectV1::ShotDataOptions shotDataOptions)
         : DeviceID(deviceID), Units(units), ShotNumber(shotNumber), APIversion(apiVersion),
         BallData(ballData), ClubData(clubData), ShotDataOptions(shotDataOptions) {}
 
-    ShotData::~ShotData() { }
-
     void ShotData::from_json(const json& j, ShotData& s) {
         s.DeviceID = j["DeviceID"].get<std::string>();
         s.Units = j["Units"].get<std::string>();
@@ -91,6 +799,14 @@ namespace OpenConnectV1 {
         ShotDataOptions::from_json(j["ShotDataOptions"], s.ShotDataOptions);
     }
 
+    void ShotData::decode(std::string_view raw, ShotData& s) {
+        ShotDataDecoder(raw).decode(s, true);
+    }
+
+    void ShotData::decodeSkippingHeartbeatData(std::string_view raw, ShotData& s) {
+        ShotDataDecoder(raw).decode(s, false);
+    }
+
     void to_json(json& j, const BallData& b) {
         j = json{
             {"Speed", b.Speed},
@@ -132,13 +848,36 @@ namespace OpenConnectV1 {
 
     void to_json(json& j, const ShotData& s) {
         j = json{
-            {"DeviceID", s.DeviceID},
-            {"Units", s.Units},
+            {"DeviceID", s.DeviceID.str()},
+            {"Units", s.Units.str()},
             {"ShotNumber", s.ShotNumber},
-            {"APIversion", s.APIversion},
+            {"APIversion", s.APIversion.str()},
             {"BallData", s.BallData},
             {"ClubData", s.ClubData},
             {"ShotDataOptions", s.ShotDataOptions}
         };
     }
+
+    size_t encode(const ShotData& s, char* buf, size_t cap) {
+        JsonWriter w(buf, cap);
+        w.raw("{\"APIversion\":"); w.string(s.APIversion.view());
+        w.raw(",\"BallData\":"); writeBallData(w, s.BallData);
+        w.raw(",\"ClubData\":"); writeClubData(w, s.ClubData);
+        w.raw(",\"DeviceID\":"); w.string(s.DeviceID.view());
+        w.raw(",\"ShotDataOptions\":"); writeShotDataOptions(w, s.ShotDataOptions);
+        w.raw(",\"ShotNumber\":"); w.integer(s.ShotNumber);
+        w.raw(",\"Units\":"); w.string(s.Units.view());
+        w.raw("}");
+        return w.length();
+    }
+
+    size_t encode(const Response& r, char* buf, size_t cap) {
+        JsonWriter w(buf, cap);
+        w.raw("{\"Code\":"); w.integer(static_cast<int>(r.Code));
+        w.raw(",\"Message\":"); w.string(r.Message);
+        w.raw(",\"Player\":{\"Club\":"); w.string(r.Player.Club);
+        w.raw(",\"Handed\":"); w.string(r.Player.Handed);
+        w.raw("}}");
+        return w.length();
+    }
 }
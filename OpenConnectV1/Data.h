@@ -2,7 +2,12 @@
 #define OPEN_CONNECT_DATA_H
 
 #include <string>
+#include <string_view>
+#include <limits>
+#include <type_traits>
 #include <nlohmann/json.hpp>
+#include "InternedString.h"
+#include "Units.h"
 
 using json = nlohmann::json;
 
@@ -62,22 +67,35 @@ namespace OpenConnectV1 {
         static void from_json(const json& j, ShotDataOptions& s);
     };
 
+    // Trivially copyable: the strings a monitor repeats on every message are interned handles
     struct ShotData {
-        std::string DeviceID;
-        std::string Units;
+        InternedString DeviceID;
+        InternedString Units;
         int ShotNumber;
-        std::string APIversion;
-        BallData BallData;
-        ClubData ClubData;
-        ShotDataOptions ShotDataOptions;
+        InternedString APIversion;
+        OpenConnectV1::BallData BallData;
+        OpenConnectV1::ClubData ClubData;
+        OpenConnectV1::ShotDataOptions ShotDataOptions;
 
-        ShotData();       
-        ShotData(std::string deviceID, std::string units, int shotNumber, std::string apiVersion,
+        ShotData();
+        ShotData(InternedString deviceID, InternedString units, int shotNumber, InternedString apiVersion,
             OpenConnectV1::BallData ballData, OpenConnectV1::ClubData clubData, OpenConnectV1::ShotDataOptions shotDataOptions);
-        ~ShotData();
+
+        // Units parsed, a read of the interned handle (see unitSystemOf())
+        OpenConnectV1::UnitSystem unitSystem() const { return unitSystemOf(this->Units); }
 
         static void from_json(const json& j, ShotData& s);
+
+        // Decodes a raw Open Connect V1 document straight into s, in a single pass and without building a json
+        // DOM.  Strings are interned, so only the first document carrying a new DeviceID/Units/APIversion allocates.
+        // Missing/null/non-numeric floats are NaN (as BallData::from_json), throws std::runtime_error if the
+        // document isn't valid JSON.
+        static void decode(std::string_view raw, ShotData& s);
+        // decode(), except that a heartbeat's BallData and ClubData are left missing: they are skipped over and
+        // only converted once the document turns out to be a shot.  For callers with no use for heartbeat data.
+        static void decodeSkippingHeartbeatData(std::string_view raw, ShotData& s);
     };
+    static_assert(std::is_trivially_copyable<ShotData>::value, "ShotData is copied around by value, keep it trivially copyable");
 
     // Function declarations for serialization
     void to_json(json& j, const BallData& b);
@@ -85,6 +103,11 @@ namespace OpenConnectV1 {
     void to_json(json& j, const ShotDataOptions& sdo);
     void to_json(json& j, const ShotData& s);
 
+    // Writes s as JSON straight into buf, byte-for-byte what to_json(j, s) followed by j.dump() produces, without
+    // allocating.  Returns the length of the complete document; when that is larger than cap only a prefix was
+    // written and the call should be repeated with a larger buffer.
+    size_t encode(const ShotData& s, char* buf, size_t cap);
+
 }
 
 namespace OpenConnectV1 {
@@ -111,6 +134,9 @@ namespace OpenConnectV1 {
         Response(ResponseCode code, const std::string& message, const PlayerData& player = {})
             : Code(code), Message(message), Player(player) {}
     };
+
+    // Same contract as encode(const ShotData&, ...), the document has no trailing newline.
+    size_t encode(const Response& r, char* buf, size_t cap);
 }
 
 #endif // OPEN_CONNECT_DATA_H
@@ -0,0 +1,334 @@
+#ifdef __linux__
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "EpollTransport.h"
+#include "Logger.h"
+
+namespace OpenConnectV1 {
+    namespace {
+        constexpr uint64_t LISTEN_TOKEN = UINT64_MAX;
+        constexpr uint64_t WAKE_TOKEN = UINT64_MAX - 1;
+        constexpr int MAX_EVENTS = 64;
+        constexpr size_t MAX_SEND_BUFFERS = 64;
+
+        std::string lastError() {
+            return std::to_string(errno) + " (" + strerror(errno) + ")";
+        }
+    }
+
+    EpollTransport::EpollTransport() {
+        this->epollFd = epoll_create1(EPOLL_CLOEXEC);
+        this->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (this->epollFd < 0 || this->wakeFd < 0) {
+            std::string errorMsg = "Failed to create epoll instance, due to: " + lastError();
+            OC_LOG_ERROR(errorMsg.c_str());
+            throw std::runtime_error(errorMsg);
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = WAKE_TOKEN;
+        epoll_ctl(this->epollFd, EPOLL_CTL_ADD, this->wakeFd, &event);
+    }
+
+    EpollTransport::~EpollTransport() {
+        this->closeAll();
+        ::close(this->wakeFd);
+        ::close(this->epollFd);
+    }
+
+    void EpollTransport::open(int port) {
+        this->port = port;
+
+        try {
+            initializeSocket();
+            bindSocket();
+            listenOnSocket();
+        }
+        catch (const std::runtime_error&) {
+            this->closeAll();
+            throw;
+        }
+    }
+
+    void EpollTransport::initializeSocket() {
+        OC_LOG_DEBUG("Creating listening socket...");
+        this->listenSocket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (this->listenSocket < 0) {
+            std::string errorMsg = "Error at socket(): " + lastError();
+            OC_LOG_ERROR(errorMsg.c_str());
+            throw std::runtime_error(errorMsg);
+        }
+
+        // Allows an immediate restart while old connections sit in TIME_WAIT
+        int reuse = 1;
+        setsockopt(this->listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    }
+
+    void EpollTransport::bindSocket() {
+        sockaddr_in serverAddress{};
+        serverAddress.sin_addr.s_addr = INADDR_ANY;
+        serverAddress.sin_family = AF_INET;
+        serverAddress.sin_port = htons(this->port);
+
+        OC_LOG_DEBUG("Attempting to bind to socket...");
+        if (bind(this->listenSocket, reinterpret_cast<sockaddr*>(&serverAddress), sizeof(serverAddress)) < 0) {
+            std::string errorMsg = "Bind failed with error: " + lastError();
+            OC_LOG_ERROR(errorMsg.c_str());
+            throw std::runtime_error(errorMsg);
+        }
+    }
+
+    void EpollTransport::listenOnSocket() {
+        OC_LOG_DEBUG("Start listening on the requested port: %d...", this->port);
+        if (listen(this->listenSocket, SOMAXCONN) < 0) {
+            std::string errorMsg = "Listen failed with error: " + lastError();
+            OC_LOG_ERROR(errorMsg.c_str());
+            throw std::runtime_error(errorMsg);
+        }
+        this->updateAcceptingConnections();
+    }
+
+    void EpollTransport::run(TransportHandler& handler) {
+        epoll_event events[MAX_EVENTS];
+
+        while (!this->stopRequested.load()) {
+            int count = epoll_wait(this->epollFd, events, MAX_EVENTS, handler.onTimer());
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                OC_LOG_ERROR("epoll_wait failed with error: %s", lastError().c_str());
+                break;
+            }
+
+            for (int i = 0; i < count && !this->stopRequested.load(); i++) {
+                uint64_t token = events[i].data.u64;
+                if (token == WAKE_TOKEN) {
+                    uint64_t value;
+                    while (read(this->wakeFd, &value, sizeof(value)) > 0) {}
+                    if (!this->stopRequested.load()) {
+                        handler.onWake();
+                    }
+                }
+                else if (token == LISTEN_TOKEN) {
+                    this->acceptConnections(handler);
+                }
+                else {
+                    // Errors and hang ups show up as readable, the receive() reports them
+                    if ((events[i].events & ~static_cast<uint32_t>(EPOLLOUT)) != 0 && this->socketFor(token) >= 0) {
+                        handler.onReadable(token);
+                    }
+                    if ((events[i].events & EPOLLOUT) != 0 && this->socketFor(token) >= 0) {
+                        handler.onWritable(token);
+                    }
+                }
+            }
+        }
+
+        this->closeAll();
+    }
+
+    void EpollTransport::stop() {
+        this->stopRequested.store(true);
+        this->wake();
+    }
+
+    void EpollTransport::wake() {
+        uint64_t value = 1;
+        if (write(this->wakeFd, &value, sizeof(value)) < 0) {
+            OC_LOG_DEBUG("Unable to wake the event loop: %s", lastError().c_str());
+        }
+    }
+
+    void EpollTransport::acceptConnections(TransportHandler& handler) {
+        while (this->acceptingConnections) {
+            sockaddr_in clientAddress{};
+            socklen_t clientAddressSize = sizeof(clientAddress);
+
+            OC_LOG_DEBUG("Attempting to accept client connection...");
+            int clientSocket = accept4(this->listenSocket, reinterpret_cast<sockaddr*>(&clientAddress),
+                &clientAddressSize, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (clientSocket < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    OC_LOG_ERROR("Accepting connection failed with error: %s", lastError().c_str());
+                }
+                return;
+            }
+
+            ConnectionId connection = this->nextConnectionId++;
+            epoll_event event{};
+            event.events = EPOLLIN | EPOLLRDHUP;
+            event.data.u64 = connection;
+            epoll_ctl(this->epollFd, EPOLL_CTL_ADD, clientSocket, &event);
+            {
+                std::lock_guard<std::mutex> lock(this->connectionsMutex);
+                this->connections[connection] = clientSocket;
+            }
+            this->updateAcceptingConnections();
+
+            char host[INET_ADDRSTRLEN]{};
+            inet_ntop(AF_INET, &clientAddress.sin_addr, host, sizeof(host));
+            handler.onAccepted(connection, std::string(host) + ":" + std::to_string(ntohs(clientAddress.sin_port)));
+        }
+    }
+
+    // Stops polling the listen socket while at capacity, further clients wait in the backlog
+    void EpollTransport::updateAcceptingConnections() {
+        if (this->listenSocket < 0) {
+            return;
+        }
+
+        size_t connectionCount;
+        {
+            std::lock_guard<std::mutex> lock(this->connectionsMutex);
+            connectionCount = this->connections.size();
+        }
+
+        bool accept = connectionCount < this->maxConnections.load();
+        if (accept == this->acceptingConnections) {
+            return;
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = LISTEN_TOKEN;
+        epoll_ctl(this->epollFd, accept ? EPOLL_CTL_ADD : EPOLL_CTL_DEL, this->listenSocket, &event);
+        this->acceptingConnections = accept;
+    }
+
+    int EpollTransport::receive(ConnectionId connection, char* buffer, size_t length) {
+        int clientSocket = this->socketFor(connection);
+        if (clientSocket < 0) {
+            return -1;
+        }
+
+        while (true) {
+            ssize_t bytesReceived = recv(clientSocket, buffer, length, 0);
+            if (bytesReceived > 0) {
+                return static_cast<int>(bytesReceived);
+            }
+            if (bytesReceived == 0) {
+                OC_LOG_DEBUG("Client closed the connection");
+                return -1;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;
+            }
+            OC_LOG_ERROR("Client disconnect or error: %s", lastError().c_str());
+            return -1;
+        }
+    }
+
+    int EpollTransport::sendSome(ConnectionId connection, const SendBuffer* buffers, size_t count) {
+        int clientSocket = this->socketFor(connection);
+        if (clientSocket < 0) {
+            return -1;
+        }
+
+        iovec vectors[MAX_SEND_BUFFERS];
+        size_t vectorCount = std::min(count, MAX_SEND_BUFFERS);
+        size_t total = 0;
+        for (size_t i = 0; i < vectorCount; i++) {
+            vectors[i].iov_base = const_cast<char*>(buffers[i].Data);
+            vectors[i].iov_len = buffers[i].Length;
+            total += buffers[i].Length;
+        }
+        // The result has to fit the int, a shorter write is reported like any partial write
+        while (total > static_cast<size_t>(INT_MAX) && vectorCount > 1) {
+            total -= vectors[--vectorCount].iov_len;
+        }
+        if (total > static_cast<size_t>(INT_MAX)) {
+            vectors[0].iov_len = INT_MAX;
+        }
+
+        msghdr message{};
+        message.msg_iov = vectors;
+        message.msg_iovlen = vectorCount;
+        while (true) {
+            ssize_t result = sendmsg(clientSocket, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (result >= 0) {
+                return static_cast<int>(result);
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;
+            }
+            OC_LOG_ERROR("Unable to send to client: %s", lastError().c_str());
+            return -1;
+        }
+    }
+
+    void EpollTransport::watchWritable(ConnectionId connection, bool enabled) {
+        std::lock_guard<std::mutex> lock(this->connectionsMutex);
+        auto it = this->connections.find(connection);
+        if (it == this->connections.end()) {
+            return;
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP | (enabled ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+        event.data.u64 = connection;
+        epoll_ctl(this->epollFd, EPOLL_CTL_MOD, it->second, &event);
+    }
+
+    void EpollTransport::close(ConnectionId connection) {
+        {
+            std::lock_guard<std::mutex> lock(this->connectionsMutex);
+            auto it = this->connections.find(connection);
+            if (it == this->connections.end()) {
+                return;
+            }
+            epoll_ctl(this->epollFd, EPOLL_CTL_DEL, it->second, nullptr);
+            ::close(it->second);
+            this->connections.erase(it);
+        }
+        this->updateAcceptingConnections();
+    }
+
+    void EpollTransport::setMaxConnections(size_t maxConnections) {
+        this->maxConnections.store(maxConnections > 0 ? maxConnections : 1);
+    }
+
+    void EpollTransport::closeAll() {
+        std::lock_guard<std::mutex> lock(this->connectionsMutex);
+        for (auto& connection : this->connections) {
+            epoll_ctl(this->epollFd, EPOLL_CTL_DEL, connection.second, nullptr);
+            ::close(connection.second);
+        }
+        this->connections.clear();
+
+        if (this->listenSocket >= 0) {
+            epoll_ctl(this->epollFd, EPOLL_CTL_DEL, this->listenSocket, nullptr);
+            ::close(this->listenSocket);
+            this->listenSocket = -1;
+            this->acceptingConnections = false;
+        }
+    }
+
+    int EpollTransport::socketFor(ConnectionId connection) {
+        std::lock_guard<std::mutex> lock(this->connectionsMutex);
+        auto it = this->connections.find(connection);
+        return it == this->connections.end() ? -1 : it->second;
+    }
+}
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef OPEN_CONNECT_EPOLL_TRANSPORT_H
+#define OPEN_CONNECT_EPOLL_TRANSPORT_H
+
+#ifdef __linux__
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include "Transport.h"
+
+namespace OpenConnectV1 {
+    /**
+     * Linux Transport built on non-blocking sockets and a level triggered epoll set.  An eventfd is registered
+     * alongside the sockets so stop() can wake the loop from another thread.
+     */
+    class EpollTransport : public Transport {
+    public:
+        EpollTransport();
+        ~EpollTransport() override;
+
+        void open(int port) override;
+        void run(TransportHandler& handler) override;
+        void stop() override;
+        void wake() override;
+
+        int receive(ConnectionId connection, char* buffer, size_t length) override;
+        int sendSome(ConnectionId connection, const SendBuffer* buffers, size_t count) override;
+        void watchWritable(ConnectionId connection, bool enabled) override;
+        void close(ConnectionId connection) override;
+
+        void setMaxConnections(size_t maxConnections) override;
+
+    private:
+        int port = 0;
+        int listenSocket = -1;
+        int epollFd = -1;
+        int wakeFd = -1;
+        bool acceptingConnections = false;
+
+        std::atomic<bool> stopRequested{ false };
+        std::atomic<size_t> maxConnections{ 1 };
+
+        ConnectionId nextConnectionId = 1;
+        std::unordered_map<ConnectionId, int> connections;
+        std::mutex connectionsMutex;
+
+        void initializeSocket();
+        void bindSocket();
+        void listenOnSocket();
+        void acceptConnections(TransportHandler& handler);
+        void updateAcceptingConnections();
+        void closeAll();
+
+        int socketFor(ConnectionId connection);
+    };
+}
+
+#endif
+
+#endif
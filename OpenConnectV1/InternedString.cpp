@@ -0,0 +1,100 @@
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "InternedString.h"
+#include "Units.h"
+
+namespace OpenConnectV1 {
+    namespace {
+        // Sharded so threads interning different strings don't contend on one lock
+        constexpr size_t SHARDS = 16;
+
+        struct Shard {
+            std::shared_mutex mutex;
+            std::deque<InternedString::Entry> strings;  // A deque never moves its elements, handles point into it
+            std::unordered_map<std::string_view, const InternedString::Entry*> index;
+        };
+
+        Shard* shards() {
+            // Leaked on purpose, handles held by other statics stay valid while those are destroyed
+            static Shard* table = new Shard[SHARDS];
+            return table;
+        }
+
+        const std::string EMPTY;
+
+        std::atomic<size_t> internedCount{ 0 };
+        std::atomic<size_t> internLimit{ InternedString::DEFAULT_TABLE_LIMIT };
+        std::atomic<size_t> overflows{ 0 };
+
+        // Claims one of the remaining entries, throws InternTableFull when there are none
+        void reserveEntry(std::string_view value) {
+            size_t count = internedCount.load(std::memory_order_relaxed);
+            do {
+                if (count >= internLimit.load(std::memory_order_relaxed)) {
+                    overflows.fetch_add(1, std::memory_order_relaxed);
+                    throw InternTableFull("Intern table is full (" + std::to_string(count) + " strings), can't intern '"
+                        + std::string(value.substr(0, 64)) + "'");
+                }
+            } while (!internedCount.compare_exchange_weak(count, count + 1, std::memory_order_relaxed));
+        }
+    }
+
+    InternedString::InternedString(std::string_view value) : value(nullptr) {
+        if (value.empty()) {
+            return;
+        }
+
+        Shard& shard = shards()[std::hash<std::string_view>()(value) % SHARDS];
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.index.find(value);
+            if (it != shard.index.end()) {
+                this->value = it->second;
+                return;
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.index.find(value);
+        if (it != shard.index.end()) {
+            this->value = it->second;
+            return;
+        }
+        reserveEntry(value);
+        // Units are parsed here once, so a shot's UnitSystem is a read of its handle
+        shard.strings.push_back(Entry{ std::string(value), static_cast<uint8_t>(parseUnitSystem(value)) });
+        const Entry& interned = shard.strings.back();
+        shard.index.emplace(std::string_view(interned.Text), &interned);
+        this->value = &interned;
+    }
+
+    const std::string& InternedString::str() const noexcept {
+        return this->value != nullptr ? this->value->Text : EMPTY;
+    }
+
+    size_t InternedString::tableSize() {
+        size_t size = 0;
+        Shard* table = shards();
+        for (size_t i = 0; i < SHARDS; i++) {
+            std::shared_lock<std::shared_mutex> lock(table[i].mutex);
+            size += table[i].strings.size();
+        }
+        return size;
+    }
+
+    size_t InternedString::tableLimit() {
+        return internLimit.load(std::memory_order_relaxed);
+    }
+
+    void InternedString::setTableLimit(size_t entries) {
+        internLimit.store(entries, std::memory_order_relaxed);
+    }
+
+    size_t InternedString::overflowCount() {
+        return overflows.load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef OPEN_CONNECT_INTERNED_STRING_H
+#define OPEN_CONNECT_INTERNED_STRING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace OpenConnectV1 {
+    /**
+     * Immutable handle to a string in the process wide intern table.  Equal strings share one entry, so a handle is
+     * a single pointer: copying one never allocates and comparing two is a pointer compare.  Interning a string the
+     * table already has takes a shared lock and allocates nothing, only the first sighting of a string allocates.
+     *
+     * Entries are never freed; this is for the handful of device names, units and API versions a server sees, not
+     * for arbitrary data.  Those come off the wire though, so the table is capped: once it holds tableLimit()
+     * strings, interning a string it doesn't have yet throws InternTableFull instead of growing it.  Safe to use
+     * from any thread.
+     */
+    // Thrown when a new string is interned with the table at its limit
+    class InternTableFull : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    class InternedString {
+    public:
+        constexpr InternedString() noexcept : value(nullptr) {}
+        InternedString(std::string_view value);
+        InternedString(const std::string& value) : InternedString(std::string_view(value)) {}
+        InternedString(const char* value) : InternedString(std::string_view(value)) {}
+
+        std::string_view view() const noexcept {
+            return this->value != nullptr ? std::string_view(this->value->Text) : std::string_view();
+        }
+        const std::string& str() const noexcept;
+        const char* c_str() const noexcept { return this->str().c_str(); }
+        size_t size() const noexcept { return this->view().size(); }
+        bool empty() const noexcept { return this->value == nullptr; }
+        // parseUnitSystem() of the string as a UnitSystem value, worked out when it was interned; see unitSystemOf()
+        uint8_t unitSystemCode() const noexcept { return this->value != nullptr ? this->value->UnitSystemCode : 0; }
+
+        friend bool operator==(InternedString a, InternedString b) noexcept { return a.value == b.value; }
+        friend bool operator!=(InternedString a, InternedString b) noexcept { return a.value != b.value; }
+        friend bool operator==(InternedString a, std::string_view b) noexcept { return a.view() == b; }
+        friend bool operator!=(InternedString a, std::string_view b) noexcept { return a.view() != b; }
+        friend bool operator==(std::string_view a, InternedString b) noexcept { return a == b.view(); }
+        friend bool operator!=(std::string_view a, InternedString b) noexcept { return a != b.view(); }
+        friend bool operator==(InternedString a, const std::string& b) noexcept { return a.view() == b; }
+        friend bool operator!=(InternedString a, const std::string& b) noexcept { return a.view() != b; }
+        friend bool operator==(const std::string& a, InternedString b) noexcept { return a == b.view(); }
+        friend bool operator!=(const std::string& a, InternedString b) noexcept { return a != b.view(); }
+        friend bool operator==(InternedString a, const char* b) noexcept { return a.view() == b; }
+        friend bool operator!=(InternedString a, const char* b) noexcept { return a.view() != b; }
+        friend bool operator==(const char* a, InternedString b) noexcept { return a == b.view(); }
+        friend bool operator!=(const char* a, InternedString b) noexcept { return a != b.view(); }
+
+        friend std::ostream& operator<<(std::ostream& out, InternedString s) { return out << s.view(); }
+
+        static constexpr size_t DEFAULT_TABLE_LIMIT = 4096;
+
+        // Distinct strings interned so far
+        static size_t tableSize();
+        static size_t tableLimit();
+        // Strings already interned stay valid when the limit is lowered below tableSize()
+        static void setTableLimit(size_t entries);
+        // Strings that weren't interned because the table was full
+        static size_t overflowCount();
+
+        // One string in the table
+        struct Entry {
+            std::string Text;
+            uint8_t UnitSystemCode;
+        };
+
+    private:
+        const Entry* value;             // nullptr is the empty string
+    };
+}
+
+namespace std {
+    // Hashes the handle rather than the characters, equal strings share a handle
+    template <>
+    struct hash<OpenConnectV1::InternedString> {
+        size_t operator()(OpenConnectV1::InternedString s) const noexcept {
+            return std::hash<const void*>()(s.empty() ? nullptr : s.view().data());
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,47 @@
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+#include "JsonCodec.h"
+
+namespace OpenConnectV1 {
+    namespace {
+        // The document, then a newline when it fits
+        size_t terminate(size_t length, char* buf, size_t cap) {
+            if (length < cap) {
+                buf[length] = '\n';
+            }
+            return length + 1;
+        }
+    }
+
+    size_t JsonCodec::encode(const ShotData& shotData, char* buf, size_t cap) const {
+        return terminate(OpenConnectV1::encode(shotData, buf, cap), buf, cap);
+    }
+
+    size_t JsonCodec::encode(const Response& response, char* buf, size_t cap) const {
+        return terminate(OpenConnectV1::encode(response, buf, cap), buf, cap);
+    }
+
+    void JsonCodec::decode(std::string_view message, ShotData& shotData) const {
+        ShotData::decode(message, shotData);
+    }
+
+    void JsonCodec::decodeSkippingHeartbeatData(std::string_view message, ShotData& shotData) const {
+        ShotData::decodeSkippingHeartbeatData(message, shotData);
+    }
+
+    Response JsonCodec::decodeResponse(std::string_view message) const {
+        try {
+            json j = json::parse(message);
+            Response response(static_cast<ResponseCode>(j.at("Code").get<int>()), j.value("Message", std::string()));
+            if (j.contains("Player") && j["Player"].is_object()) {
+                const json& player = j["Player"];
+                response.Player = PlayerData(player.value("Handed", std::string()), player.value("Club", std::string()));
+            }
+            return response;
+        }
+        catch (const json::exception& e) {
+            throw std::runtime_error(std::string("Invalid response: ") + e.what());
+        }
+    }
+}
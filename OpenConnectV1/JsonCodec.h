@@ -0,0 +1,23 @@
+#ifndef OPEN_CONNECT_JSON_CODEC_H
+#define OPEN_CONNECT_JSON_CODEC_H
+
+#include "WireCodec.h"
+
+namespace OpenConnectV1 {
+    // Open Connect V1 JSON, the default: ShotData::decode()/encode() with a newline after every document
+    class JsonCodec : public WireCodec {
+    public:
+        WireFormat format() const override { return WireFormat::Json; }
+        MessageFramer::Framing framing() const override { return MessageFramer::Framing::JsonObjects; }
+
+        size_t encode(const ShotData& shotData, char* buf, size_t cap) const override;
+        size_t encode(const Response& response, char* buf, size_t cap) const override;
+
+        void decode(std::string_view message, ShotData& shotData) const override;
+        void decodeSkippingHeartbeatData(std::string_view message, ShotData& shotData) const override;
+        // Through a json DOM, responses are only decoded by clients
+        Response decodeResponse(std::string_view message) const override;
+    };
+}
+
+#endif
@@ -1,11 +1,13 @@
 #include <cstdarg>
+#include <cstring>
 #include <iomanip>
 
+#include "AsyncLogger.h"
 #include "Logger.h"
 
 namespace OpenConnectV1 {
     // Define the static member variable
-    LogLevel Logger::minLogLevel = LogLevel::Info;
+    std::atomic<LogLevel> Logger::minLogLevel{ LogLevel::Info };
 
     // LogLevel helper functions
     const char* Logger::logLevelToString(LogLevel level) {
@@ -26,7 +28,12 @@ namespace OpenConnectV1 {
 
     // Implement logging functions
     void Logger::log(LogLevel level, const char* message, va_list args) {
-        if (level > minLogLevel) return;
+        if (!isEnabled(level)) return;
+
+        if (AsyncLogger::enabled()) {
+            AsyncLogger::instance().enqueue(level, message, args);
+            return;
+        }
 
         constexpr size_t BUFFER_SIZE = 1024; 
         char buffer[BUFFER_SIZE];
@@ -38,7 +45,35 @@ namespace OpenConnectV1 {
         std::cout << "[" << std::left << std::setw(8) << levelStr << "] " << buffer << std::endl;
     }
 
+    void Logger::startAsync(const AsyncLoggerOptions& options) {
+        AsyncLogger::instance().start(options);
+    }
+
+    void Logger::stopAsync() {
+        AsyncLogger::instance().stop();
+    }
+
+    void Logger::flush() {
+        if (AsyncLogger::enabled()) {
+            AsyncLogger::instance().flush();
+        }
+        std::cout.flush();
+    }
+
+    LoggerStats Logger::stats() {
+        return AsyncLogger::instance().stats();
+    }
+
+    void Logger::write(LogLevel level, const char* message, ...) {
+        va_list args;
+        va_start(args, message);
+        log(level, message, args);
+        va_end(args);
+    }
+
     void Logger::error(const char* message, ...) {
+        if (!isEnabled(LogLevel::Error)) return;
+
         va_list args;
         va_start(args, message);
         log(LogLevel::Error, message, args);
@@ -46,6 +81,8 @@ namespace OpenConnectV1 {
     }
 
     void Logger::info(const char* message, ...) {
+        if (!isEnabled(LogLevel::Info)) return;
+
         va_list args;
         va_start(args, message);
         log(LogLevel::Info, message, args);
@@ -53,6 +90,8 @@ namespace OpenConnectV1 {
     }
 
     void Logger::debug(const char* message, ...) {
+        if (!isEnabled(LogLevel::Debug)) return;
+
         va_list args;
         va_start(args, message);
         log(LogLevel::Debug, message, args);
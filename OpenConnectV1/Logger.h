@@ -3,31 +3,86 @@
 
 #include <string>
 #include <iostream>
+#include <atomic>
 #include <cstdarg>
+#include <cstdint>
 #include <cstdio>
 
+// Most verbose level compiled into the OC_LOG_* macros (0 Error, 1 Info, 2 Debug); release builds drop Debug.
+// Define it (e.g. -DOPEN_CONNECT_LOG_LEVEL=2) to keep debug logging in a release build.
+#ifndef OPEN_CONNECT_LOG_LEVEL
+#ifdef NDEBUG
+#define OPEN_CONNECT_LOG_LEVEL 1
+#else
+#define OPEN_CONNECT_LOG_LEVEL 2
+#endif
+#endif
+
+// Logs only when the level is compiled in and enabled at runtime; the arguments aren't evaluated otherwise.
+// The level has to be a constant expression.
+#define OC_LOG(level, ...) \
+    do { \
+        if constexpr (static_cast<int>(level) <= OPEN_CONNECT_LOG_LEVEL) { \
+            if (::OpenConnectV1::Logger::isEnabled(level)) { \
+                ::OpenConnectV1::Logger::write(level, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+#define OC_LOG_ERROR(...) OC_LOG(::OpenConnectV1::LogLevel::Error, __VA_ARGS__)
+#define OC_LOG_INFO(...) OC_LOG(::OpenConnectV1::LogLevel::Info, __VA_ARGS__)
+#define OC_LOG_DEBUG(...) OC_LOG(::OpenConnectV1::LogLevel::Debug, __VA_ARGS__)
+
 namespace OpenConnectV1 {
     enum class LogLevel {
         Error,
         Info,
         Debug
     };
+
+    struct AsyncLoggerOptions {
+        size_t RingBytes = 64 * 1024;   // Per logging thread, rounded up to a power of two
+        unsigned FlushIntervalMs = 10;  // How long the writer thread sleeps between batches
+        bool BlockWhenFull = false;     // Wait for the writer instead of dropping; errors always wait
+    };
+
+    struct LoggerStats {
+        uint64_t Enqueued = 0;
+        uint64_t Written = 0;
+        uint64_t Dropped = 0;
+    };
 }
 
 namespace OpenConnectV1 {
     class Logger {
     public:
-        // Static member definition of LogLevel
-        static LogLevel minLogLevel;
+        // Can be changed at runtime from any thread
+        static std::atomic<LogLevel> minLogLevel;
+
+        static bool isEnabled(LogLevel level) {
+            return level <= minLogLevel.load(std::memory_order_relaxed);
+        }
 
         static void error(const char* message, ...);
         static void info(const char* message, ...);
         static void debug(const char* message, ...);
+        static void write(LogLevel level, const char* message, ...);
+
+        // Async mode: error/info/debug only pack their arguments into a per-thread ring, formatting and the
+        // (batched) writes to std::cout happen on a background thread.
+        static void startAsync(const AsyncLoggerOptions& options = AsyncLoggerOptions());
+        // Writes everything still queued and goes back to logging synchronously
+        static void stopAsync();
+        // Waits until everything logged before the call has been written
+        static void flush();
+        static LoggerStats stats();
 
     private:
         static void log(LogLevel level, const char* message, va_list args);
         static const char* logLevelToString(LogLevel level);
         static LogLevel stringToLogLevel(const char* level);
+
+        friend class AsyncLogger;
     };
 }
 
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "MessageFramer.h"
+
+namespace OpenConnectV1 {
+    MessageFramer::MessageFramer(size_t initialCapacity, size_t maxMessageSize)
+        : buffer(initialCapacity > 0 ? initialCapacity : DEFAULT_CAPACITY), maxMessageSize(maxMessageSize) {}
+
+    char* MessageFramer::prepare(size_t minSpace) {
+        if (this->buffer.size() - this->writePos < minSpace) {
+            this->compact();
+        }
+
+        if (this->buffer.size() - this->writePos < minSpace) {
+            size_t newSize = this->buffer.size() * 2;
+            while (newSize - this->writePos < minSpace) {
+                newSize *= 2;
+            }
+            this->buffer.resize(newSize);
+        }
+
+        return this->buffer.data() + this->writePos;
+    }
+
+    void MessageFramer::commit(size_t length) {
+        if (length > this->buffer.size() - this->writePos) {
+            throw std::out_of_range("Committed more bytes than were prepared");
+        }
+        this->writePos += length;
+    }
+
+    void MessageFramer::append(const char* data, size_t length) {
+        char* dst = this->prepare(length);
+        memcpy(dst, data, length);
+        this->commit(length);
+    }
+
+    bool MessageFramer::next(std::string_view& message) {
+        if (this->mode == Framing::LengthPrefixed) {
+            return this->nextLengthPrefixed(message);
+        }
+        const char* data = this->buffer.data();
+
+        while (this->scanPos < this->writePos) {
+            char c = data[this->scanPos];
+
+            if (this->depth == 0) {
+                // Between messages; skip whitespace/newlines (or junk) until the next object starts
+                if (c == '{') {
+                    this->messageStart = this->scanPos;
+                    this->depth = 1;
+                }
+                this->scanPos++;
+                this->readPos = this->depth == 0 ? this->scanPos : this->messageStart;
+                continue;
+            }
+
+            if (this->inString) {
+                if (this->escaped) {
+                    this->escaped = false;
+                }
+                else if (c == '\\') {
+                    this->escaped = true;
+                }
+                else if (c == '"') {
+                    this->inString = false;
+                }
+            }
+            else if (c == '"') {
+                this->inString = true;
+            }
+            else if (c == '{' || c == '[') {
+                this->depth++;
+            }
+            else if (c == '}' || c == ']') {
+                this->depth--;
+            }
+            this->scanPos++;
+
+            if (this->depth == 0) {
+                message = std::string_view(data + this->messageStart, this->scanPos - this->messageStart);
+                this->readPos = this->scanPos;
+                this->resetScanState();
+                return true;
+            }
+        }
+
+        if (this->depth > 0 && this->scanPos - this->messageStart > this->maxMessageSize) {
+            size_t size = this->scanPos - this->messageStart;
+            this->readPos = this->scanPos;
+            this->resetScanState();
+            throw std::runtime_error("Message exceeded maximum size of " + std::to_string(this->maxMessageSize)
+                + " bytes (" + std::to_string(size) + " buffered), discarding");
+        }
+
+        return false;
+    }
+
+    bool MessageFramer::nextLengthPrefixed(std::string_view& message) {
+        size_t available = this->writePos - this->readPos;
+        if (available < LENGTH_PREFIX_SIZE) {
+            return false;
+        }
+
+        const unsigned char* prefix = reinterpret_cast<const unsigned char*>(this->buffer.data() + this->readPos);
+        size_t length = static_cast<size_t>(prefix[0]) | static_cast<size_t>(prefix[1]) << 8
+            | static_cast<size_t>(prefix[2]) << 16 | static_cast<size_t>(prefix[3]) << 24;
+        if (length > this->maxMessageSize) {
+            this->readPos = this->writePos;
+            this->scanPos = this->writePos;
+            throw std::runtime_error("Message of " + std::to_string(length) + " bytes exceeds the maximum size of "
+                + std::to_string(this->maxMessageSize) + " bytes, discarding the stream");
+        }
+        if (available - LENGTH_PREFIX_SIZE < length) {
+            return false;
+        }
+
+        message = std::string_view(this->buffer.data() + this->readPos + LENGTH_PREFIX_SIZE, length);
+        this->readPos += LENGTH_PREFIX_SIZE + length;
+        this->scanPos = this->readPos;
+        return true;
+    }
+
+    void MessageFramer::setFraming(Framing framing) {
+        this->mode = framing;
+        this->scanPos = this->readPos;
+        this->resetScanState();
+    }
+
+    MessageFramer::Framing MessageFramer::framing() const {
+        return this->mode;
+    }
+
+    std::string_view MessageFramer::pending() const {
+        return std::string_view(this->buffer.data() + this->readPos, this->writePos - this->readPos);
+    }
+
+    void MessageFramer::consume(size_t length) {
+        if (length > this->writePos - this->readPos) {
+            throw std::out_of_range("Consumed more bytes than are pending");
+        }
+        this->readPos += length;
+        this->scanPos = std::max(this->scanPos, this->readPos);
+    }
+
+    void MessageFramer::reset() {
+        this->readPos = 0;
+        this->scanPos = 0;
+        this->writePos = 0;
+        this->messageStart = 0;
+        this->resetScanState();
+    }
+
+    size_t MessageFramer::buffered() const {
+        return this->writePos - this->readPos;
+    }
+
+    size_t MessageFramer::capacity() const {
+        return this->buffer.size();
+    }
+
+    void MessageFramer::compact() {
+        if (this->readPos == 0) {
+            return;
+        }
+
+        size_t remaining = this->writePos - this->readPos;
+        if (remaining > 0) {
+            memmove(this->buffer.data(), this->buffer.data() + this->readPos, remaining);
+        }
+        this->scanPos -= this->readPos;
+        this->messageStart = this->messageStart >= this->readPos ? this->messageStart - this->readPos : 0;
+        this->writePos = remaining;
+        this->readPos = 0;
+    }
+
+    void MessageFramer::resetScanState() {
+        this->depth = 0;
+        this->inString = false;
+        this->escaped = false;
+    }
+}
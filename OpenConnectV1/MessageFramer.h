@@ -0,0 +1,83 @@
+#ifndef OPEN_CONNECT_MESSAGE_FRAMER_H
+#define OPEN_CONNECT_MESSAGE_FRAMER_H
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace OpenConnectV1 {
+    /**
+     * Splits a TCP byte stream into complete top level JSON objects.
+     *
+     * Launch monitors write one JSON document per shot/heartbeat, but TCP is free to coalesce several
+     * documents into a single recv or to split one document across reads.  Bytes are received directly
+     * into the framer (prepare/commit), the object boundaries are found by tracking brace depth (aware of
+     * strings and escapes) and each byte is only ever scanned once, no matter how many reads it takes
+     * for the object to complete.
+     *
+     * With Framing::LengthPrefixed the stream is instead a 4 byte little endian length followed by that many
+     * bytes of message, for the binary wire codec.
+     */
+    class MessageFramer {
+    public:
+        static constexpr size_t DEFAULT_CAPACITY = 4096;
+        static constexpr size_t DEFAULT_MAX_MESSAGE_SIZE = 1024 * 1024;
+        static constexpr size_t LENGTH_PREFIX_SIZE = 4;
+
+        enum class Framing {
+            JsonObjects = 0,
+            LengthPrefixed = 1
+        };
+
+        explicit MessageFramer(size_t initialCapacity = DEFAULT_CAPACITY,
+            size_t maxMessageSize = DEFAULT_MAX_MESSAGE_SIZE);
+
+        // Returns a pointer with at least minSpace writable bytes, compacting or growing the buffer as required.
+        // Any view previously returned from next() is invalidated.
+        char* prepare(size_t minSpace);
+        // Marks length bytes written into the region returned by prepare() as received.
+        void commit(size_t length);
+        // Convenience for prepare/memcpy/commit when the bytes are already somewhere else.
+        void append(const char* data, size_t length);
+
+        // Extracts the next complete JSON object, returns false when more bytes are required.  The view is
+        // valid until the next call to prepare/append/reset.  Throws std::runtime_error when a single object
+        // grows beyond the maximum message size, the partial object is discarded so the stream can recover.
+        // Length prefixed messages are returned without their length; one announcing more than the maximum
+        // message size throws and discards everything buffered, such a stream can't be recovered.
+        bool next(std::string_view& message);
+
+        // Switches framing between messages, the next call to next() starts scanning the new way
+        void setFraming(Framing framing);
+        Framing framing() const;
+        // Received bytes not yet handed out by next(), to sniff a protocol prefix before the first message
+        std::string_view pending() const;
+        // Drops the first length pending bytes; only between messages
+        void consume(size_t length);
+
+        void reset();
+
+        size_t buffered() const;
+        size_t capacity() const;
+
+    private:
+        std::vector<char> buffer;
+        size_t maxMessageSize;
+        Framing mode = Framing::JsonObjects;
+
+        size_t readPos = 0;     // First byte not yet handed out by next()
+        size_t scanPos = 0;     // First byte not yet scanned
+        size_t writePos = 0;    // End of the received bytes
+        size_t messageStart = 0;
+
+        int depth = 0;
+        bool inString = false;
+        bool escaped = false;
+
+        bool nextLengthPrefixed(std::string_view& message);
+        void compact();
+        void resetScanState();
+    };
+}
+
+#endif
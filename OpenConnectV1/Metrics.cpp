@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "Metrics.h"
+
+namespace OpenConnectV1 {
+    const std::array<int64_t, HistogramSnapshot::BUCKETS - 1> HistogramSnapshot::BOUNDS_NS = {
+        250, 500,
+        1'000, 2'500, 5'000, 10'000, 25'000, 50'000, 100'000, 250'000, 500'000,
+        1'000'000, 2'500'000, 5'000'000, 10'000'000, 25'000'000, 50'000'000, 100'000'000, 250'000'000, 500'000'000,
+        1'000'000'000, 5'000'000'000
+    };
+
+    namespace {
+        std::atomic<uint64_t> nextMetricsId{ 1 };
+
+        // Only the owning thread writes to a shard, so the increments don't need to be atomic read-modify-writes
+        void increment(std::atomic<uint64_t>& value, uint64_t amount) {
+            value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        size_t bucketOf(int64_t durationNs) {
+            const auto& bounds = HistogramSnapshot::BOUNDS_NS;
+            return static_cast<size_t>(std::lower_bound(bounds.begin(), bounds.end(), durationNs) - bounds.begin());
+        }
+    }
+
+    struct alignas(64) Metrics::Shard {
+        std::atomic<uint64_t> counters[METRIC_COUNTERS]{};
+        struct Histogram {
+            std::atomic<uint64_t> buckets[HistogramSnapshot::BUCKETS]{};
+            std::atomic<uint64_t> count{ 0 };
+            std::atomic<uint64_t> sum{ 0 };
+        } histograms[METRIC_HISTOGRAMS];
+
+        void addTo(MetricsSnapshot& snapshot) const {
+            for (size_t i = 0; i < METRIC_COUNTERS; i++) {
+                snapshot.Counters[i] += this->counters[i].load(std::memory_order_relaxed);
+            }
+            for (size_t h = 0; h < METRIC_HISTOGRAMS; h++) {
+                const Histogram& source = this->histograms[h];
+                HistogramSnapshot& target = snapshot.Histograms[h];
+                for (size_t b = 0; b < HistogramSnapshot::BUCKETS; b++) {
+                    target.Buckets[b] += source.buckets[b].load(std::memory_order_relaxed);
+                }
+                target.Count += source.count.load(std::memory_order_relaxed);
+                target.SumNs += source.sum.load(std::memory_order_relaxed);
+            }
+        }
+
+        // Only with Shards::mutex held, the retired totals are written by whichever thread exits
+        void absorb(const Shard& other) {
+            for (size_t i = 0; i < METRIC_COUNTERS; i++) {
+                increment(this->counters[i], other.counters[i].load(std::memory_order_relaxed));
+            }
+            for (size_t h = 0; h < METRIC_HISTOGRAMS; h++) {
+                const Histogram& source = other.histograms[h];
+                Histogram& target = this->histograms[h];
+                for (size_t b = 0; b < HistogramSnapshot::BUCKETS; b++) {
+                    increment(target.buckets[b], source.buckets[b].load(std::memory_order_relaxed));
+                }
+                increment(target.count, source.count.load(std::memory_order_relaxed));
+                increment(target.sum, source.sum.load(std::memory_order_relaxed));
+            }
+        }
+    };
+
+    struct Metrics::Shards {
+        std::mutex mutex;               // Guards the list, never taken while recording
+        std::vector<std::unique_ptr<Shard>> live;
+        Shard retired;                  // Totals of the threads that have exited
+
+        void retire(const Shard* shard) {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            auto it = std::find_if(this->live.begin(), this->live.end(),
+                [shard](const std::unique_ptr<Shard>& candidate) { return candidate.get() == shard; });
+            if (it != this->live.end()) {
+                this->retired.absorb(**it);
+                this->live.erase(it);
+            }
+        }
+    };
+
+    // Every Metrics instance a thread has recorded into, few enough to search.  Ids are never reused so an entry
+    // left by a destroyed instance can't match; those are dropped the next time the thread adds one.
+    struct Metrics::ThreadShards {
+        struct Entry {
+            uint64_t owner;
+            Shard* shard;
+            std::weak_ptr<Shards> shards;
+        };
+        std::vector<Entry> entries;
+
+        ~ThreadShards() {
+            for (const Entry& entry : this->entries) {
+                if (auto shards = entry.shards.lock()) {
+                    shards->retire(entry.shard);
+                }
+            }
+        }
+    };
+
+    int64_t HistogramSnapshot::percentileNs(double percentile) const {
+        if (this->Count == 0) {
+            return 0;
+        }
+        double clamped = std::min(std::max(percentile, 0.0), 100.0);
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(clamped / 100.0 * static_cast<double>(this->Count) + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS - 1; i++) {
+            seen += this->Buckets[i];
+            if (seen >= rank) {
+                return BOUNDS_NS[i];
+            }
+        }
+        return BOUNDS_NS.back();
+    }
+
+    Metrics::Metrics() : id(nextMetricsId.fetch_add(1)), shards(std::make_shared<Shards>()) {}
+
+    Metrics::~Metrics() = default;
+
+    Metrics::Shard& Metrics::shard() {
+        static thread_local ThreadShards threadShards;
+        for (const auto& entry : threadShards.entries) {
+            if (entry.owner == this->id) {
+                return *entry.shard;
+            }
+        }
+
+        auto& entries = threadShards.entries;
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+            [](const ThreadShards::Entry& entry) { return entry.shards.expired(); }), entries.end());
+        Shard* shard;
+        {
+            std::lock_guard<std::mutex> lock(this->shards->mutex);
+            this->shards->live.push_back(std::make_unique<Shard>());
+            shard = this->shards->live.back().get();
+        }
+        entries.push_back({ this->id, shard, this->shards });
+        return *shard;
+    }
+
+    size_t Metrics::shardCount() const {
+        std::lock_guard<std::mutex> lock(this->shards->mutex);
+        return this->shards->live.size();
+    }
+
+    void Metrics::add(MetricCounter counter, uint64_t value) {
+        increment(this->shard().counters[static_cast<size_t>(counter)], value);
+    }
+
+    void Metrics::record(MetricHistogram histogram, int64_t durationNs) {
+        int64_t duration = std::max<int64_t>(durationNs, 0);
+        Shard::Histogram& shardHistogram = this->shard().histograms[static_cast<size_t>(histogram)];
+        increment(shardHistogram.buckets[bucketOf(duration)], 1);
+        increment(shardHistogram.count, 1);
+        increment(shardHistogram.sum, static_cast<uint64_t>(duration));
+    }
+
+    void Metrics::collect(MetricsSnapshot& snapshot) const {
+        std::lock_guard<std::mutex> lock(this->shards->mutex);
+        this->shards->retired.addTo(snapshot);
+        for (const auto& shard : this->shards->live) {
+            shard->addTo(snapshot);
+        }
+    }
+
+    int64_t Metrics::now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    const char* metricName(MetricCounter counter) {
+        switch (counter) {
+        case MetricCounter::BytesReceived: return "openconnect_received_bytes";
+        case MetricCounter::MessagesParsed: return "openconnect_messages_parsed";
+        case MetricCounter::ParseFailures: return "openconnect_parse_failures";
+        case MetricCounter::ShotsReceived: return "openconnect_shots_received";
+        case MetricCounter::HeartbeatsReceived: return "openconnect_heartbeats_received";
+        case MetricCounter::ListenerErrors: return "openconnect_listener_errors";
+        case MetricCounter::ConnectionsAccepted: return "openconnect_connections_accepted";
+        case MetricCounter::Disconnects: return "openconnect_disconnects";
+        case MetricCounter::Reconnects: return "openconnect_reconnects";
+        case MetricCounter::ResponsesSent: return "openconnect_responses_sent";
+        case MetricCounter::BytesSent: return "openconnect_sent_bytes";
+        case MetricCounter::SendErrors: return "openconnect_send_errors";
+        case MetricCounter::StaleConnections: return "openconnect_stale_connections";
+        case MetricCounter::ResponsesCoalesced: return "openconnect_responses_coalesced";
+        case MetricCounter::ResponsesDropped: return "openconnect_responses_dropped";
+        case MetricCounter::ShotsRejectedMissing: return "openconnect_shots_rejected_missing_value";
+        case MetricCounter::ShotsRejectedRange: return "openconnect_shots_rejected_out_of_range";
+        case MetricCounter::ShotsRejectedSpin: return "openconnect_shots_rejected_spin_mismatch";
+        case MetricCounter::ShotsRejectedDuplicate: return "openconnect_shots_rejected_duplicate";
+        default: return "openconnect_unknown";
+        }
+    }
+
+    const char* metricName(MetricHistogram histogram) {
+        switch (histogram) {
+        case MetricHistogram::RecvToParse: return "openconnect_recv_to_parse";
+        case MetricHistogram::ParseToDispatch: return "openconnect_parse_to_dispatch";
+        case MetricHistogram::ListenerDuration: return "openconnect_listener_duration";
+        case MetricHistogram::SendResponse: return "openconnect_send_response_duration";
+        default: return "openconnect_unknown";
+        }
+    }
+}
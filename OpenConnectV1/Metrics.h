@@ -0,0 +1,113 @@
+#ifndef OPEN_CONNECT_METRICS_H
+#define OPEN_CONNECT_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "ResponseCache.h"
+#include "ShotQueue.h"
+
+namespace OpenConnectV1 {
+    enum class MetricCounter {
+        BytesReceived = 0,
+        MessagesParsed,
+        ParseFailures,
+        ShotsReceived,
+        HeartbeatsReceived,
+        ListenerErrors,
+        ConnectionsAccepted,
+        Disconnects,
+        Reconnects,             // Connections from a host that had disconnected before
+        ResponsesSent,
+        BytesSent,
+        SendErrors,
+        StaleConnections,       // Connections that went quiet for longer than the liveness timeout
+        ResponsesCoalesced,     // Queued PlayerInfo responses replaced by a newer one
+        ResponsesDropped,       // Responses over a connection's outbound high water mark
+        ShotsRejectedMissing,   // Shots the validator rejected, by ShotRejection
+        ShotsRejectedRange,
+        ShotsRejectedSpin,
+        ShotsRejectedDuplicate,
+        Count
+    };
+
+    enum class MetricHistogram {
+        RecvToParse = 0,        // recv() returning to the message being decoded
+        ParseToDispatch,        // Decoded to the listeners being called, the dispatch queue wait included
+        ListenerDuration,       // Every listener's callbacks for one message
+        SendResponse,           // Server::sendResponse(), encoding included
+        Count
+    };
+
+    constexpr size_t METRIC_COUNTERS = static_cast<size_t>(MetricCounter::Count);
+    constexpr size_t METRIC_HISTOGRAMS = static_cast<size_t>(MetricHistogram::Count);
+
+    struct HistogramSnapshot {
+        // Upper bounds (inclusive, nanoseconds) of every bucket but the last, which takes everything larger
+        static constexpr size_t BUCKETS = 23;
+        static const std::array<int64_t, BUCKETS - 1> BOUNDS_NS;
+
+        std::array<uint64_t, BUCKETS> Buckets{};
+        uint64_t Count = 0;
+        uint64_t SumNs = 0;
+
+        // Upper bound of the bucket the percentile (0-100) falls in, the last bound for the overflow bucket
+        int64_t percentileNs(double percentile) const;
+    };
+
+    struct MetricsSnapshot {
+        std::array<uint64_t, METRIC_COUNTERS> Counters{};
+        std::array<HistogramSnapshot, METRIC_HISTOGRAMS> Histograms{};
+        size_t ActiveConnections = 0;
+        ShotQueueStats Queue;
+        ResponseCacheStats Responses;
+
+        uint64_t counter(MetricCounter counter) const { return this->Counters[static_cast<size_t>(counter)]; }
+        const HistogramSnapshot& histogram(MetricHistogram histogram) const { return this->Histograms[static_cast<size_t>(histogram)]; }
+    };
+
+    /**
+     * Counters and fixed bucket latency histograms for the Server hot path.  Every recording thread gets its own
+     * cache line aligned shard that only it writes to (relaxed loads and stores, no read-modify-write), collect()
+     * sums the shards while they are being written.  A thread's shard is folded into the totals when it exits.
+     */
+    class Metrics {
+    public:
+        Metrics();
+        ~Metrics();
+
+        Metrics(const Metrics&) = delete;
+        Metrics& operator=(const Metrics&) = delete;
+
+        void add(MetricCounter counter, uint64_t value = 1);
+        void record(MetricHistogram histogram, int64_t durationNs);
+
+        // Adds the totals so far into snapshot, safe to call from any thread at any time
+        void collect(MetricsSnapshot& snapshot) const;
+
+        // Shards of the threads that have recorded and not exited yet
+        size_t shardCount() const;
+
+        // Steady clock timestamp for durations, in nanoseconds
+        static int64_t now();
+
+    private:
+        struct Shard;
+        struct Shards;
+        struct ThreadShards;
+
+        uint64_t id;
+        // Shared with the recording threads so they can retire their shard on exit, whichever goes first
+        std::shared_ptr<Shards> shards;
+
+        Shard& shard();
+    };
+
+    // Prometheus metric names, without the _total/_seconds suffixes
+    const char* metricName(MetricCounter counter);
+    const char* metricName(MetricHistogram histogram);
+}
+
+#endif
@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+#include "Logger.h"
+#include "MetricsExporter.h"
+
+namespace OpenConnectV1 {
+    namespace {
+        const size_t MAX_REQUEST_BYTES = 8192;
+
+        const char* counterHelp(MetricCounter counter) {
+            switch (counter) {
+            case MetricCounter::BytesReceived: return "Bytes read from launch monitor connections";
+            case MetricCounter::MessagesParsed: return "ShotData messages decoded";
+            case MetricCounter::ParseFailures: return "Messages that failed to decode";
+            case MetricCounter::ShotsReceived: return "Decoded messages that weren't heartbeats";
+            case MetricCounter::HeartbeatsReceived: return "Decoded heartbeats";
+            case MetricCounter::ListenerErrors: return "Exceptions thrown by listener callbacks";
+            case MetricCounter::ConnectionsAccepted: return "Launch monitor connections accepted";
+            case MetricCounter::Disconnects: return "Launch monitor connections closed";
+            case MetricCounter::Reconnects: return "Connections from a host that had disconnected before";
+            case MetricCounter::ResponsesSent: return "Responses sent to launch monitors";
+            case MetricCounter::BytesSent: return "Response bytes sent to launch monitors";
+            case MetricCounter::SendErrors: return "Responses that failed to send";
+            case MetricCounter::StaleConnections: return "Connections that sent nothing within the liveness timeout";
+            case MetricCounter::ResponsesCoalesced: return "Queued PlayerInfo responses replaced by a newer one";
+            case MetricCounter::ResponsesDropped: return "Responses dropped over a connection's outbound high water mark";
+            case MetricCounter::ShotsRejectedMissing: return "Shots rejected for a required field not being reported";
+            case MetricCounter::ShotsRejectedRange: return "Shots rejected for a field outside its range";
+            case MetricCounter::ShotsRejectedSpin: return "Shots rejected for TotalSpin not matching BackSpin and SideSpin";
+            case MetricCounter::ShotsRejectedDuplicate: return "Shots rejected for repeating the monitor's last ShotNumber";
+            default: return "";
+            }
+        }
+
+        const char* histogramHelp(MetricHistogram histogram) {
+            switch (histogram) {
+            case MetricHistogram::RecvToParse: return "Time from recv() returning to the message being decoded";
+            case MetricHistogram::ParseToDispatch: return "Time from a message being decoded to its listeners being called";
+            case MetricHistogram::ListenerDuration: return "Time spent in the listeners for one message";
+            case MetricHistogram::SendResponse: return "Time taken by Server::sendResponse()";
+            default: return "";
+            }
+        }
+
+        void appendf(std::string& out, const char* format, ...) {
+            char line[512];
+            va_list args;
+            va_start(args, format);
+            int length = vsnprintf(line, sizeof(line), format, args);
+            va_end(args);
+            if (length > 0) {
+                out.append(line, std::min<size_t>(static_cast<size_t>(length), sizeof(line) - 1));
+            }
+        }
+
+        void appendMetric(std::string& out, const char* name, const char* type, const char* help, unsigned long long value) {
+            appendf(out, "# HELP %s %s\n# TYPE %s %s\n%s %llu\n", name, help, name, type, name, value);
+        }
+    }
+
+    std::string formatPrometheus(const MetricsSnapshot& snapshot) {
+        std::string out;
+        out.reserve(8192);
+
+        for (size_t i = 0; i < METRIC_COUNTERS; i++) {
+            auto counter = static_cast<MetricCounter>(i);
+            std::string name = std::string(metricName(counter)) + "_total";
+            appendMetric(out, name.c_str(), "counter", counterHelp(counter), static_cast<unsigned long long>(snapshot.Counters[i]));
+        }
+
+        for (size_t i = 0; i < METRIC_HISTOGRAMS; i++) {
+            auto histogram = static_cast<MetricHistogram>(i);
+            const HistogramSnapshot& values = snapshot.Histograms[i];
+            std::string name = std::string(metricName(histogram)) + "_seconds";
+
+            appendf(out, "# HELP %s %s\n# TYPE %s histogram\n", name.c_str(), histogramHelp(histogram), name.c_str());
+            uint64_t cumulative = 0;
+            for (size_t b = 0; b < HistogramSnapshot::BUCKETS; b++) {
+                cumulative += values.Buckets[b];
+                if (b < HistogramSnapshot::BOUNDS_NS.size()) {
+                    appendf(out, "%s_bucket{le=\"%g\"} %llu\n", name.c_str(), HistogramSnapshot::BOUNDS_NS[b] / 1e9,
+                        static_cast<unsigned long long>(cumulative));
+                }
+                else {
+                    appendf(out, "%s_bucket{le=\"+Inf\"} %llu\n", name.c_str(), static_cast<unsigned long long>(cumulative));
+                }
+            }
+            appendf(out, "%s_sum %.9f\n%s_count %llu\n", name.c_str(), values.SumNs / 1e9, name.c_str(),
+                static_cast<unsigned long long>(values.Count));
+        }
+
+        appendMetric(out, "openconnect_connections", "gauge", "Launch monitors currently connected",
+            static_cast<unsigned long long>(snapshot.ActiveConnections));
+        appendMetric(out, "openconnect_shot_queue_depth", "gauge", "Shots waiting in the dispatch queue",
+            static_cast<unsigned long long>(snapshot.Queue.Depth));
+        appendMetric(out, "openconnect_shot_queue_high_watermark", "gauge", "Deepest the dispatch queue has been",
+            static_cast<unsigned long long>(snapshot.Queue.HighWatermark));
+        appendMetric(out, "openconnect_shot_queue_dropped_total", "counter", "Shots the dispatch queue dropped, heartbeats included",
+            static_cast<unsigned long long>(snapshot.Queue.Dropped));
+        appendMetric(out, "openconnect_response_cache_hits_total", "counter", "Responses sent without encoding them again",
+            static_cast<unsigned long long>(snapshot.Responses.Hits));
+        appendMetric(out, "openconnect_response_cache_misses_total", "counter", "Responses that had to be encoded",
+            static_cast<unsigned long long>(snapshot.Responses.Misses));
+        appendMetric(out, "openconnect_response_cache_evictions_total", "counter", "Encoded responses evicted from the cache",
+            static_cast<unsigned long long>(snapshot.Responses.Evictions));
+        return out;
+    }
+
+    PrometheusFileExporter::PrometheusFileExporter(const std::string& path) : path(path) {}
+
+    void PrometheusFileExporter::exportMetrics(const MetricsSnapshot& snapshot) {
+        std::string text = formatPrometheus(snapshot);
+        std::string temporary = this->path + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write(text.data(), static_cast<std::streamsize>(text.size()));
+            if (!file) {
+                OC_LOG_ERROR("Unable to write metrics to %s", temporary.c_str());
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporary, this->path, error);
+        if (error) {
+            OC_LOG_ERROR("Unable to replace %s: %s", this->path.c_str(), error.message().c_str());
+        }
+    }
+
+    PrometheusEndpoint::PrometheusEndpoint(int port, std::unique_ptr<Transport> transport)
+        : transport(std::move(transport)) {
+        this->transport->open(port);
+        this->thread = std::thread([this] { this->transport->run(*this); });
+    }
+
+    PrometheusEndpoint::~PrometheusEndpoint() {
+        this->transport->stop();
+        if (this->thread.joinable()) {
+            this->thread.join();
+        }
+    }
+
+    void PrometheusEndpoint::exportMetrics(const MetricsSnapshot& snapshot) {
+        std::string text = formatPrometheus(snapshot);
+        std::lock_guard<std::mutex> lock(this->bodyMutex);
+        this->body.swap(text);
+    }
+
+    void PrometheusEndpoint::onAccepted(ConnectionId connection, const std::string& address) {
+        if (address.rfind("127.", 0) != 0) {
+            OC_LOG_INFO("Refusing metrics scrape from %s", address.c_str());
+            this->transport->close(connection);
+            return;
+        }
+        this->scrapes[connection] = Scrape();
+    }
+
+    void PrometheusEndpoint::onReadable(ConnectionId connection) {
+        auto it = this->scrapes.find(connection);
+        if (it == this->scrapes.end()) {
+            return;
+        }
+        Scrape& scrape = it->second;
+
+        // Anything sent after the request is read and dropped, only a hang up matters then
+        char buffer[1024];
+        int bytesReceived = 0;
+        while ((!scrape.Response.empty() || scrape.Request.size() <= MAX_REQUEST_BYTES)
+            && (bytesReceived = this->transport->receive(connection, buffer, sizeof(buffer))) > 0) {
+            if (scrape.Response.empty()) {
+                scrape.Request.append(buffer, static_cast<size_t>(bytesReceived));
+            }
+        }
+        if (bytesReceived < 0) {
+            this->closeScrape(connection);
+            return;
+        }
+
+        // Any request gets the metrics, once its headers are complete
+        if (scrape.Response.empty()
+            && (scrape.Request.find("\r\n\r\n") != std::string::npos || scrape.Request.size() > MAX_REQUEST_BYTES)) {
+            this->respond(connection, scrape);
+        }
+    }
+
+    void PrometheusEndpoint::onWritable(ConnectionId connection) {
+        auto it = this->scrapes.find(connection);
+        if (it != this->scrapes.end()) {
+            this->writeResponse(connection, it->second);
+        }
+    }
+
+    void PrometheusEndpoint::respond(ConnectionId connection, Scrape& scrape) {
+        {
+            std::lock_guard<std::mutex> lock(this->bodyMutex);
+            scrape.Response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+                + std::to_string(this->body.size()) + "\r\nConnection: close\r\n\r\n" + this->body;
+        }
+        scrape.Request.clear();
+        this->writeResponse(connection, scrape);
+    }
+
+    void PrometheusEndpoint::writeResponse(ConnectionId connection, Scrape& scrape) {
+        SendBuffer buffer{ scrape.Response.data() + scrape.Sent, scrape.Response.size() - scrape.Sent };
+        int written = this->transport->sendSome(connection, &buffer, 1);
+        if (written < 0) {
+            OC_LOG_ERROR("Unable to send metrics to scrape connection %llu", static_cast<unsigned long long>(connection));
+            this->closeScrape(connection);
+            return;
+        }
+        scrape.Sent += static_cast<size_t>(written);
+        if (scrape.Sent == scrape.Response.size()) {
+            this->closeScrape(connection);
+            return;
+        }
+        this->transport->watchWritable(connection, true);
+    }
+
+    void PrometheusEndpoint::closeScrape(ConnectionId connection) {
+        this->scrapes.erase(connection);
+        this->transport->close(connection);
+    }
+
+    MetricsReporter::MetricsReporter(Server& server, std::shared_ptr<MetricsExporter> exporter, std::chrono::milliseconds interval)
+        : server(server), exporter(std::move(exporter)), interval(interval), stopRequested(false) {
+        this->reportNow();
+        this->thread = std::thread(&MetricsReporter::run, this);
+    }
+
+    MetricsReporter::~MetricsReporter() {
+        this->stop();
+    }
+
+    void MetricsReporter::reportNow() {
+        try {
+            this->exporter->exportMetrics(this->server.metricsSnapshot());
+        }
+        catch (const std::exception& e) {
+            OC_LOG_ERROR("Exporting metrics failed: %s", e.what());
+        }
+    }
+
+    void MetricsReporter::stop() {
+        {
+            std::lock_guard<std::mutex> lock(this->stopMutex);
+            this->stopRequested = true;
+        }
+        this->stopped.notify_all();
+        if (this->thread.joinable()) {
+            this->thread.join();
+        }
+    }
+
+    void MetricsReporter::run() {
+        auto next = std::chrono::steady_clock::now() + this->interval;
+        std::unique_lock<std::mutex> lock(this->stopMutex);
+        while (!this->stopRequested) {
+            if (this->stopped.wait_until(lock, next) == std::cv_status::timeout) {
+                lock.unlock();
+                this->reportNow();
+                lock.lock();
+                next += this->interval;
+            }
+        }
+    }
+}
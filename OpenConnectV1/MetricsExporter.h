@@ -0,0 +1,104 @@
+#ifndef OPEN_CONNECT_METRICS_EXPORTER_H
+#define OPEN_CONNECT_METRICS_EXPORTER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include "Metrics.h"
+#include "Server.h"
+#include "Transport.h"
+
+namespace OpenConnectV1 {
+    class MetricsExporter {
+    public:
+        virtual ~MetricsExporter() = default;
+        virtual void exportMetrics(const MetricsSnapshot& snapshot) = 0;
+    };
+
+    // Prometheus text exposition format (0.0.4); durations in seconds, counters with a _total suffix
+    std::string formatPrometheus(const MetricsSnapshot& snapshot);
+
+    // Rewrites the file on every export (through a temporary file and a rename, so readers never see half of it),
+    // e.g. for the node_exporter textfile collector.
+    class PrometheusFileExporter : public MetricsExporter {
+    public:
+        explicit PrometheusFileExporter(const std::string& path);
+
+        void exportMetrics(const MetricsSnapshot& snapshot) override;
+
+    private:
+        std::string path;
+    };
+
+    /**
+     * Answers HTTP scrapes on the port with the most recent export, from its own thread.  Only clients
+     * connecting over loopback are answered, anything else is disconnected straight away.
+     */
+    class PrometheusEndpoint : public MetricsExporter, private TransportHandler {
+    public:
+        // Throws std::runtime_error when the port can't be opened
+        explicit PrometheusEndpoint(int port, std::unique_ptr<Transport> transport = createTransport());
+        ~PrometheusEndpoint();
+
+        PrometheusEndpoint(const PrometheusEndpoint&) = delete;
+        PrometheusEndpoint& operator=(const PrometheusEndpoint&) = delete;
+
+        void exportMetrics(const MetricsSnapshot& snapshot) override;
+
+    private:
+        std::unique_ptr<Transport> transport;
+        std::thread thread;
+
+        std::mutex bodyMutex;
+        std::string body;
+
+        // One scrape connection, loop thread only
+        struct Scrape {
+            std::string Request;        // Bytes read so far
+            std::string Response;       // Empty until the request is complete
+            size_t Sent = 0;
+        };
+        std::unordered_map<ConnectionId, Scrape> scrapes;
+
+        void onAccepted(ConnectionId connection, const std::string& address) override;
+        void onReadable(ConnectionId connection) override;
+        void onWritable(ConnectionId connection) override;
+        void respond(ConnectionId connection, Scrape& scrape);
+        // Writes what the socket takes without blocking and closes the connection once the response is out; a
+        // scraper that stops reading only holds up itself
+        void writeResponse(ConnectionId connection, Scrape& scrape);
+        void closeScrape(ConnectionId connection);
+    };
+
+    // Snapshots a Server's metrics into an exporter at a fixed interval, from its own thread
+    class MetricsReporter {
+    public:
+        MetricsReporter(Server& server, std::shared_ptr<MetricsExporter> exporter,
+            std::chrono::milliseconds interval = std::chrono::seconds(5));
+        ~MetricsReporter();
+
+        MetricsReporter(const MetricsReporter&) = delete;
+        MetricsReporter& operator=(const MetricsReporter&) = delete;
+
+        void reportNow();
+        void stop();
+
+    private:
+        Server& server;
+        std::shared_ptr<MetricsExporter> exporter;
+        std::chrono::milliseconds interval;
+
+        std::mutex stopMutex;
+        std::condition_variable stopped;
+        bool stopRequested;
+        std::thread thread;
+
+        void run();
+    };
+}
+
+#endif
@@ -0,0 +1,111 @@
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <string_view>
+
+#include "ResponseCache.h"
+
+namespace OpenConnectV1 {
+    namespace {
+        size_t hashOf(const Response& response) {
+            std::hash<std::string_view> hashString;
+            size_t hash = std::hash<int>()(static_cast<int>(response.Code));
+            for (const std::string* field : { &response.Message, &response.Player.Handed, &response.Player.Club }) {
+                hash ^= hashString(*field) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+            }
+            return hash;
+        }
+
+        bool sameKey(const Response& a, const Response& b) {
+            return a.Code == b.Code && a.Message == b.Message && a.Player.Handed == b.Player.Handed && a.Player.Club == b.Player.Club;
+        }
+    }
+
+    ResponseCache::ResponseCache(size_t capacity) : capacity(capacity) {}
+
+    std::shared_ptr<const EncodedResponse> ResponseCache::encodeAll(const Response& response) {
+        auto encoded = std::make_shared<EncodedResponse>();
+        for (size_t format = 0; format < WIRE_FORMAT_COUNT; format++) {
+            encoded->Bytes[format] = codecFor(static_cast<WireFormat>(format)).encodeToString(response);
+        }
+        return encoded;
+    }
+
+    std::shared_ptr<const std::string> ResponseCache::get(const Response& response, WireFormat format) {
+        std::shared_ptr<const EncodedResponse> bytes = this->encoded(response);
+        return std::shared_ptr<const std::string>(bytes, &(*bytes)[format]);
+    }
+
+    std::shared_ptr<const EncodedResponse> ResponseCache::encoded(const Response& response) {
+        size_t hash = hashOf(response);
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (this->capacity == 0) {
+                this->misses++;
+                return encodeAll(response);
+            }
+
+            if (auto bytes = this->find(hash, response)) {
+                this->hits++;
+                return bytes;
+            }
+            this->misses++;
+        }
+
+        // Encoded outside the lock, so another thread missing on the same key may have inserted it meanwhile
+        std::shared_ptr<const EncodedResponse> bytes = encodeAll(response);
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (auto inserted = this->find(hash, response)) {
+            return inserted;
+        }
+        if (this->capacity > 0) {
+            this->evictTo(this->capacity - 1);
+            this->entries.push_front({ hash, response, bytes });
+            this->index.emplace(hash, this->entries.begin());
+        }
+        return bytes;
+    }
+
+    std::shared_ptr<const EncodedResponse> ResponseCache::find(size_t hash, const Response& response) {
+        auto range = this->index.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (sameKey(it->second->Key, response)) {
+                this->entries.splice(this->entries.begin(), this->entries, it->second);
+                return it->second->Bytes;
+            }
+        }
+        return nullptr;
+    }
+
+    void ResponseCache::setCapacity(size_t capacity) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->capacity = capacity;
+        this->evictTo(capacity);
+    }
+
+    ResponseCacheStats ResponseCache::stats() const {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        ResponseCacheStats stats;
+        stats.Capacity = this->capacity;
+        stats.Size = this->entries.size();
+        stats.Hits = this->hits;
+        stats.Misses = this->misses;
+        stats.Evictions = this->evictions;
+        return stats;
+    }
+
+    void ResponseCache::evictTo(size_t size) {
+        while (this->entries.size() > size) {
+            auto last = std::prev(this->entries.end());
+            auto range = this->index.equal_range(last->Hash);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == last) {
+                    this->index.erase(it);
+                    break;
+                }
+            }
+            this->entries.pop_back();
+            this->evictions++;
+        }
+    }
+}
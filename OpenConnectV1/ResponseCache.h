@@ -0,0 +1,81 @@
+#ifndef OPEN_CONNECT_RESPONSE_CACHE_H
+#define OPEN_CONNECT_RESPONSE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "Data.h"
+#include "WireCodec.h"
+
+namespace OpenConnectV1 {
+    struct ResponseCacheStats {
+        size_t Capacity = 0;
+        size_t Size = 0;
+        uint64_t Hits = 0;
+        uint64_t Misses = 0;
+        uint64_t Evictions = 0;
+    };
+
+    // One response's complete wire bytes in every WireFormat
+    struct EncodedResponse {
+        std::array<std::string, WIRE_FORMAT_COUNT> Bytes;
+
+        const std::string& operator[](WireFormat format) const { return this->Bytes[static_cast<size_t>(format)]; }
+    };
+
+    /**
+     * Encoded responses keyed on (Code, Message, Player.Handed, Player.Club).  A server sends the same few
+     * OK/PlayerInfo responses over and over, so a hit hands back the wire bytes (in every WireFormat, a connection
+     * may speak either) without encoding or allocating anything; the buffers are immutable and shared with
+     * whoever still holds them.
+     * Bounded, least recently used entries are evicted first.  Safe to call from any thread.
+     */
+    class ResponseCache {
+    public:
+        static constexpr size_t DEFAULT_CAPACITY = 64;
+
+        // A capacity of 0 encodes every response
+        explicit ResponseCache(size_t capacity = DEFAULT_CAPACITY);
+
+        ResponseCache(const ResponseCache&) = delete;
+        ResponseCache& operator=(const ResponseCache&) = delete;
+
+        std::shared_ptr<const EncodedResponse> encoded(const Response& response);
+        // One format's bytes out of encoded(), sharing its ownership
+        std::shared_ptr<const std::string> get(const Response& response, WireFormat format = WireFormat::Json);
+
+        // Evicts down to the new capacity straight away
+        void setCapacity(size_t capacity);
+        ResponseCacheStats stats() const;
+
+        static std::shared_ptr<const EncodedResponse> encodeAll(const Response& response);
+
+    private:
+        struct Entry {
+            size_t Hash;
+            Response Key;
+            std::shared_ptr<const EncodedResponse> Bytes;
+        };
+        using EntryList = std::list<Entry>;
+
+        mutable std::mutex mutex;
+        size_t capacity;
+        EntryList entries;          // Most recently used first
+        // By hash rather than by key, so a lookup doesn't copy the key's strings
+        std::unordered_multimap<size_t, EntryList::iterator> index;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+
+        // With the mutex held; moves a hit to the front
+        std::shared_ptr<const EncodedResponse> find(size_t hash, const Response& response);
+        void evictTo(size_t size);
+    };
+}
+
+#endif
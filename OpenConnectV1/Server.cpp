@@ -1,235 +1,812 @@
+#include <algorithm>
+#include <climits>
 #include <iostream>
 #include <nlohmann/json.hpp>
 #include "Server.h"
 #include "Logger.h"
 
 namespace OpenConnectV1 {
-    Server::Server()
-        : connectionStatus(ServerStatus::Disconnected), shutdownRequested(false),
-        serverAddress{}, clientAddress{}, serverListener(nullptr),
-        clientSocket(std::make_shared<SOCKET>(INVALID_SOCKET)) {
+    namespace {
+        // Listener callbacks running on this thread, lets a callback add/remove listeners without waiting on itself
+        thread_local int listenerCallbackDepth = 0;
+
+        // Marks the calling thread as reading the listener snapshot for the lifetime of the guard, counted against
+        // the epoch it started in
+        class ListenerReadGuard {
+        public:
+            ListenerReadGuard(const std::atomic<uint64_t>& epoch, std::atomic<int>* readers)
+                : readers(readers[epoch.load(std::memory_order_seq_cst) & 1]) {
+                this->readers.fetch_add(1, std::memory_order_seq_cst);
+                listenerCallbackDepth++;
+            }
+
+            ~ListenerReadGuard() {
+                listenerCallbackDepth--;
+                this->readers.fetch_sub(1, std::memory_order_release);
+            }
+
+        private:
+            std::atomic<int>& readers;
+        };
 
-        Logger::debug("Initializing Winsock; should get a popup asking for access to the network...");
-        int startupResult = WSAStartup(MAKEWORD(2, 2), &this->wsaData);
-        if (startupResult != 0) {
-            std::string errorMsg = "Failed to initialize WSAStartup, due to: " + std::to_string(WSAGetLastError());
-            Logger::error(errorMsg.c_str());
-            throw std::runtime_error(errorMsg);
+        // "host:port" to host, a monitor reconnecting comes back from another port
+        std::string hostOf(const std::string& address) {
+            size_t colon = address.rfind(':');
+            return colon == std::string::npos ? address : address.substr(0, colon);
+        }
+
+        MetricCounter rejectionCounter(ShotRejection rejection) {
+            switch (rejection) {
+            case ShotRejection::MissingValue: return MetricCounter::ShotsRejectedMissing;
+            case ShotRejection::OutOfRange: return MetricCounter::ShotsRejectedRange;
+            case ShotRejection::SpinMismatch: return MetricCounter::ShotsRejectedSpin;
+            default: return MetricCounter::ShotsRejectedDuplicate;
+            }
+        }
+
+        int64_t nowMs() {
+            return Metrics::now() / 1'000'000;
+        }
+
+        bool matchesFilter(ListenerFilter filter, const ShotData& shotData) {
+            switch (filter) {
+            case ListenerFilter::HeartBeatsOnly:
+                return shotData.ShotDataOptions.IsHeartBeat;
+            case ListenerFilter::ShotsOnly:
+                return !shotData.ShotDataOptions.IsHeartBeat;
+            case ListenerFilter::BallDataOnly:
+                return !shotData.ShotDataOptions.IsHeartBeat && shotData.ShotDataOptions.ContainsBallData;
+            default:
+                return true;
+            }
         }
     }
 
+    Server::Server()
+        : Server(createTransport()) {}
+
+    Server::Server(std::unique_ptr<Transport> transport)
+        : port(0), connectionStatus(ServerStatus::Disconnected), shutdownRequested(false),
+        transport(std::move(transport)), maxConnections(DEFAULT_MAX_CONNECTIONS), staleConnections(0), wakePending(false),
+        outboundHighWaterMark(DEFAULT_OUTBOUND_HIGH_WATER_MARK), latencyMetrics(true), listeners(new ListenerSnapshot()), listenerEpoch(0), listenerReaders{ {0}, {0} }, heartbeatListeners(false), nextListenerToken(1) {}
+
     Server::~Server() {
-        Logger::debug("Cleaning up Server and shutting down Winsock.");
-        this->cleanup();
-        WSACleanup();
+        OC_LOG_DEBUG("Cleaning up Server.");
+        this->transport->stop();
+        delete this->listeners.load();
     }
 
     OpenConnectV1::ServerStatus Server::getStatus() {
         return this->connectionStatus.load();
     }
 
-    void Server::startup(int port) {
+    ConnectionInfo Server::Connection::info() const {
+        ConnectionInfo info = this->Info;
+        info.LaunchMonitorIsReady = this->LaunchMonitorIsReady.load(std::memory_order_relaxed);
+        info.LaunchMonitorBallDetected = this->LaunchMonitorBallDetected.load(std::memory_order_relaxed);
+        info.Heartbeats = this->Heartbeats.load(std::memory_order_relaxed);
+        return info;
+    }
+
+    std::vector<ConnectionInfo> Server::getConnections() {
+        std::lock_guard<std::mutex> lock(this->connectionsMutex);
+        std::vector<ConnectionInfo> infos;
+        infos.reserve(this->connections.size());
+        for (auto& connection : this->connections) {
+            infos.push_back(connection.second->info());
+        }
+        return infos;
+    }
+
+    void Server::setMaxConnections(size_t maxConnections) {
+        this->maxConnections = maxConnections;
+    }
+
+    void Server::setOutboundHighWaterMark(size_t bytes) {
+        this->outboundHighWaterMark.store(bytes);
+    }
+
+    void Server::setResponseCacheCapacity(size_t capacity) {
+        this->responseCache.setCapacity(capacity);
+    }
+
+    void Server::setDispatchQueue(size_t capacity, OverflowPolicy policy) {
+        if (capacity == 0) {
+            this->shotQueue.reset();
+        }
+        else {
+            this->shotQueue = std::make_unique<ShotQueue>(capacity, policy);
+        }
+    }
+
+    ShotQueueStats Server::getShotQueueStats() {
+        return this->shotQueue ? this->shotQueue->stats() : ShotQueueStats();
+    }
+
+    void Server::setShotValidation(bool enabled, const ShotValidationRules& rules) {
+        if (enabled) {
+            this->shotValidator = std::make_unique<ShotValidator>(rules);
+        }
+        else {
+            this->shotValidator.reset();
+        }
+    }
+
+    MetricsSnapshot Server::metricsSnapshot() {
+        MetricsSnapshot snapshot;
+        this->metrics.collect(snapshot);
+        {
+            std::lock_guard<std::mutex> lock(this->connectionsMutex);
+            snapshot.ActiveConnections = this->connections.size();
+        }
+        snapshot.Queue = this->getShotQueueStats();
+        snapshot.Responses = this->responseCache.stats();
+        return snapshot;
+    }
+
+    void Server::setLatencyMetrics(bool enabled) {
+        this->latencyMetrics.store(enabled, std::memory_order_relaxed);
+    }
+
+    void Server::startup(int port, const LivenessOptions& liveness) {
         this->port = port;
 
+        if (liveness.Timeout.count() < 0 || liveness.FirstMessageTimeout.count() < 0 || liveness.Resolution.count() <= 0) {
+            OC_LOG_ERROR("Server startup failed: invalid liveness timeouts");
+            throw std::runtime_error("Invalid liveness timeouts");
+        }
+        this->liveness = liveness;
+        if (liveness.Timeout.count() > 0) {
+            this->livenessTimers = std::make_unique<TimerWheel>(liveness.Resolution.count(), nowMs());
+        }
+
         try {
-            initializeSocket();
-            bindSocket();
-            listenOnSocket();
-            acceptConnections();
+            this->transport->setMaxConnections(this->maxConnections);
+            this->transport->open(port);
         }
         catch (const std::runtime_error& e) {
-            Logger::error("Server startup failed: %s", e.what());
-            this->cleanup();
+            OC_LOG_ERROR("Server startup failed: %s", e.what());
             throw;
         }
+
+        if (this->shotQueue) {
+            this->shotQueue->reset();
+            this->dispatchThread = std::thread(&Server::dispatchShots, this);
+        }
+
+        OC_LOG_DEBUG("Waiting for client connection(s)...");
+        this->notifyStatus(OpenConnectV1::ServerStatus::Listening);
+        this->transport->run(*this);
+
+        if (this->dispatchThread.joinable()) {
+            // Shots already queued are still delivered before startup() returns
+            this->shotQueue->close();
+            this->dispatchThread.join();
+        }
+
+        this->livenessTimers.reset();
+        this->staleConnections = 0;
+        std::lock_guard<std::mutex> lock(this->connectionsMutex);
+        this->connections.clear();
     }
 
-    void Server::initializeSocket() {
-        Logger::debug("Creating listening socket and waiting for connection(s)...");
-        this->listenSocket = socket(AF_INET, SOCK_STREAM, 0);
-        if (this->listenSocket == INVALID_SOCKET) {
-            std::string errorMsg = "Error at socket(): " + std::to_string(WSAGetLastError());
-            Logger::error(errorMsg.c_str());
-            throw std::runtime_error(errorMsg);
+    void Server::onAccepted(ConnectionId connection, const std::string& address) {
+        OC_LOG_DEBUG("Accepted client connection %llu from %s", static_cast<unsigned long long>(connection), address.c_str());
+
+        auto state = std::make_unique<Connection>();
+        state->Info.Id = connection;
+        state->Info.Address = address;
+        state->Info.Status = OpenConnectV1::ServerStatus::Connected;
+        ConnectionInfo info = state->Info;
+        bool reconnect;
+        {
+            std::lock_guard<std::mutex> lock(this->connectionsMutex);
+            reconnect = this->disconnectedHosts.count(hostOf(address)) != 0;
+            this->connections[connection] = std::move(state);
+        }
+        this->metrics.add(MetricCounter::ConnectionsAccepted);
+        if (reconnect) {
+            this->metrics.add(MetricCounter::Reconnects);
         }
+        if (this->livenessTimers) {
+            auto timeout = this->liveness.FirstMessageTimeout.count() > 0 ? this->liveness.FirstMessageTimeout : this->liveness.Timeout;
+            this->livenessTimers->schedule(connection, nowMs() + timeout.count());
+        }
+
+        this->notifyConnectionStatus(info);
+        this->notifyStatus(OpenConnectV1::ServerStatus::Connected);
     }
 
-    void Server::bindSocket() {
-        this->serverAddress.sin_addr.s_addr = INADDR_ANY;
-        this->serverAddress.sin_family = AF_INET;
-        this->serverAddress.sin_port = htons(this->port);
+    void Server::onReadable(ConnectionId connection) {
+        const int BUFFER_SIZE = 4092;
+        // Bounded so one chatty monitor can't starve the others, the level triggered loop comes back for the rest
+        const int MAX_READS = 16;
 
-        Logger::debug("Attempting to bind to socket...");
-        auto bindResult = bind(this->listenSocket, reinterpret_cast<SOCKADDR*>(&this->serverAddress), sizeof(this->serverAddress));
-        if (bindResult == SOCKET_ERROR) {
-            std::string errorMsg = "Bind failed with error: " + std::to_string(WSAGetLastError());
-            Logger::error(errorMsg.c_str());
-            throw std::runtime_error(errorMsg);
+        auto it = this->connections.find(connection);
+        if (it == this->connections.end()) {
+            return;
+        }
+        Connection& state = *it->second;
+
+        bool active = false;
+        for (int reads = 0; reads < MAX_READS && !this->shutdownRequested.load(); reads++) {
+            char* buffer = state.Framer.prepare(BUFFER_SIZE);
+            int bytesReceived = this->transport->receive(connection, buffer, BUFFER_SIZE);
+            if (bytesReceived > 0) {
+                int64_t receivedNs = this->latencyMetrics.load(std::memory_order_relaxed) ? Metrics::now() : 0;
+                this->metrics.add(MetricCounter::BytesReceived, static_cast<uint64_t>(bytesReceived));
+                state.Framer.commit(bytesReceived);
+                if (!this->processMessages(state, receivedNs)) {
+                    return;
+                }
+                active = true;
+            }
+            else if (bytesReceived == 0) {
+                break;
+            }
+            else {
+                OC_LOG_ERROR("Client %s disconnected", state.Info.Address.c_str());
+                this->closeClient(connection);
+                return;
+            }
+        }
+
+        if (active) {
+            this->touch(state);
         }
     }
 
-    void Server::listenOnSocket() {
-        Logger::debug("Start listening on the requested port: %d...", this->port);
-        auto listenResult = listen(this->listenSocket, 0);
-        if (listenResult == SOCKET_ERROR) {
-            std::string errorMsg = "Listen failed with error: " + std::to_string(WSAGetLastError());
-            Logger::error(errorMsg.c_str());
-            throw std::runtime_error(errorMsg);
+    int Server::onTimer() {
+        if (!this->livenessTimers) {
+            return -1;
         }
+
+        int64_t now = nowMs();
+        this->expiredConnections.clear();
+        this->livenessTimers->advance(now, this->expiredConnections);
+        for (uint64_t connection : this->expiredConnections) {
+            this->expireConnection(connection);
+        }
+
+        int64_t next = this->livenessTimers->nextExpiryMs(now);
+        return next < 0 ? -1 : static_cast<int>(std::min<int64_t>(next, INT_MAX));
     }
 
-    void Server::acceptConnections() {
-        int clientSocketSize = sizeof(this->clientAddress);
-        while (!this->shutdownRequested.load()) {
-            Logger::debug("Attempting to accept client connection...");
+    // Anything received pushes the connection's deadline back, once per read rather than per message
+    void Server::touch(Connection& connection) {
+        if (!this->livenessTimers) {
+            return;
+        }
+        this->livenessTimers->schedule(connection.Info.Id, nowMs() + this->liveness.Timeout.count());
+
+        if (connection.Info.Stale) {
+            ConnectionInfo info;
+            {
+                std::lock_guard<std::mutex> lock(this->connectionsMutex);
+                connection.Info.Stale = false;
+                info = connection.info();
+            }
+            this->staleConnections--;
+            OC_LOG_INFO("Launch monitor %s is sending again", info.Address.c_str());
+            this->notifyConnectionStatus(info);
+            this->notifyStatus(OpenConnectV1::ServerStatus::Connected);
+        }
+    }
+
+    void Server::expireConnection(ConnectionId connection) {
+        auto it = this->connections.find(connection);
+        if (it == this->connections.end()) {
+            return;
+        }
+        this->metrics.add(MetricCounter::StaleConnections);
+
+        if (this->liveness.Policy == IdlePolicy::Close) {
+            OC_LOG_INFO("Closing %s, nothing received within the liveness timeout", it->second->Info.Address.c_str());
+            this->closeClient(connection);
+            return;
+        }
+
+        ConnectionInfo info;
+        bool allStale;
+        {
+            std::lock_guard<std::mutex> lock(this->connectionsMutex);
+            it->second->Info.Stale = true;
+            info = it->second->info();
+            allStale = ++this->staleConnections == this->connections.size();
+        }
+        OC_LOG_INFO("Launch monitor %s is stale, nothing received within the liveness timeout", info.Address.c_str());
+        this->notifyConnectionStatus(info);
+        if (allStale && !this->shutdownRequested.load()) {
             this->notifyStatus(OpenConnectV1::ServerStatus::Listening);
-            *this->clientSocket = accept(this->listenSocket, reinterpret_cast<SOCKADDR*>(&this->clientAddress), &clientSocketSize);
-            if (*this->clientSocket == INVALID_SOCKET) {
-                if (this->shutdownRequested.load()) {
+        }
+    }
+
+    bool Server::negotiateCodec(Connection& connection) {
+        WireFormat format;
+        size_t prefixLength;
+        if (!negotiateWireFormat(connection.Framer.pending(), format, prefixLength)) {
+            return false;
+        }
+
+        connection.Framer.consume(prefixLength);
+        connection.Codec = &codecFor(format);
+        connection.Framer.setFraming(connection.Codec->framing());
+        if (format != connection.Info.Format) {
+            std::lock_guard<std::mutex> lock(this->connectionsMutex);
+            connection.Info.Format = format;
+        }
+        OC_LOG_DEBUG("%s speaks %s", connection.Info.Address.c_str(), toString(format));
+        return true;
+    }
+
+    bool Server::processMessages(Connection& connection, int64_t receivedNs) {
+        if (connection.Codec == nullptr && !this->negotiateCodec(connection)) {
+            return true;
+        }
+
+        const WireCodec& codec = *connection.Codec;
+        ShotData& shotData = connection.ShotData;
+        std::string_view message;
+        while (true) {
+            bool parsed = false;
+            try {
+                if (!connection.Framer.next(message)) {
                     break;
                 }
-                std::string errorMsg = "Accepting connection failed with error: " + std::to_string(WSAGetLastError());
-                Logger::error(errorMsg.c_str());
-                Logger::debug("See: https://learn.microsoft.com/en-us/windows/win32/api/winsock2/nf-winsock2-accept ");
-                continue; // Attempt to accept the next connection
+
+                // Heartbeats are most of the traffic from an idle bay; unless somebody wants them as ShotData,
+                // their ball and club data is left undecoded and only their options are passed on
+                bool heartbeatOptionsOnly = !this->shotQueue && !this->heartbeatListeners.load(std::memory_order_relaxed);
+                if (heartbeatOptionsOnly) {
+                    codec.decodeSkippingHeartbeatData(message, shotData);
+                }
+                else {
+                    codec.decode(message, shotData);
+                }
+                parsed = true;
+
+                this->metrics.add(MetricCounter::MessagesParsed);
+                this->metrics.add(shotData.ShotDataOptions.IsHeartBeat ? MetricCounter::HeartbeatsReceived : MetricCounter::ShotsReceived);
+                int64_t parsedNs = 0;
+                if (receivedNs != 0) {
+                    parsedNs = Metrics::now();
+                    this->metrics.record(MetricHistogram::RecvToParse, parsedNs - receivedNs);
+                }
+
+                this->updateLiveness(connection, shotData.ShotDataOptions);
+                if (!connection.Identified) {
+                    this->adoptHistory(connection, shotData.DeviceID.view());
+                }
+                if (heartbeatOptionsOnly && shotData.ShotDataOptions.IsHeartBeat) {
+                    this->notifyHeartbeat(connection.Info.Id, shotData.ShotDataOptions, parsedNs);
+                    continue;
+                }
+                if (this->shotValidator && !shotData.ShotDataOptions.IsHeartBeat) {
+                    ShotVerdict verdict = this->shotValidator->validate(shotData, connection.History);
+                    if (!verdict.accepted()) {
+                        this->metrics.add(rejectionCounter(verdict.Rejection));
+                        OC_LOG_DEBUG("Rejected shot %d from %s: %s (fields 0x%05x)", shotData.ShotNumber, connection.Info.Address.c_str(),
+                            toString(verdict.Rejection), static_cast<unsigned>(verdict.Fields));
+                        continue;
+                    }
+                }
+                if (!shotData.ShotDataOptions.IsHeartBeat) {
+                    std::lock_guard<std::mutex> lock(this->connectionsMutex);
+                    connection.Info.LastShotNumber = shotData.ShotNumber;
+                }
+                if (this->shotQueue) {
+                    if (!this->shotQueue->push(connection.Info.Id, shotData, parsedNs)) {
+                        OC_LOG_DEBUG("Shot queue full, dropped %s from %s", shotData.ShotDataOptions.IsHeartBeat ? "heartbeat" : "shot",
+                            connection.Info.Address.c_str());
+                    }
+                }
+                else {
+                    this->notifyShotData(connection.Info.Id, shotData, parsedNs);
+                }
+
+                OC_LOG_DEBUG("Raw: %.*s", static_cast<int>(message.size()), message.data());
+                OC_LOG_DEBUG("From Launch Monitor: ShotDataOptions");
+                OC_LOG_DEBUG("ContainsBallData: %s", shotData.ShotDataOptions.ContainsBallData ? "true" : "false");
+                OC_LOG_DEBUG("ContainsClubData: %s", shotData.ShotDataOptions.ContainsClubData ? "true" : "false");
+                OC_LOG_DEBUG("LaunchMonitorIsReady: %s", shotData.ShotDataOptions.LaunchMonitorIsReady ? "true" : "false");
+                OC_LOG_DEBUG("LaunchMonitorBallDetected: %s", shotData.ShotDataOptions.LaunchMonitorBallDetected ? "true" : "false");
+                OC_LOG_DEBUG("IsHeartBeat: %s", shotData.ShotDataOptions.IsHeartBeat ? "true" : "false");
+            }
+            catch (const std::exception& e) {
+                if (parsed) {
+                    OC_LOG_ERROR("Listener failed to handle ShotData: %s", e.what());
+                    this->metrics.add(MetricCounter::ListenerErrors);
+                }
+                else {
+                    OC_LOG_ERROR("Failed to deserialize ShotData: %s", e.what());
+                    this->metrics.add(MetricCounter::ParseFailures);
+                    // A length prefixed stream can't be resynchronized after a bad record, and a client filling the
+                    // intern table with new DeviceIDs isn't a launch monitor
+                    if (codec.framing() == MessageFramer::Framing::LengthPrefixed || dynamic_cast<const InternTableFull*>(&e) != nullptr) {
+                        this->closeClient(connection.Info.Id);
+                        return false;
+                    }
+                }
             }
-            this->notifyStatus(OpenConnectV1::ServerStatus::Connected);
-            handleClientCommunication();
         }
+        return true;
     }
 
-    void Server::handleClientCommunication() {
-        const int BUFFER_SIZE = 4092;
-        char buffer[BUFFER_SIZE]{};
+    void Server::updateLiveness(Connection& connection, const ShotDataOptions& options) {
+        // Only stored here, on the event loop thread, so the count needs no read-modify-write
+        connection.LaunchMonitorIsReady.store(options.LaunchMonitorIsReady, std::memory_order_relaxed);
+        connection.LaunchMonitorBallDetected.store(options.LaunchMonitorBallDetected, std::memory_order_relaxed);
+        if (options.IsHeartBeat) {
+            connection.Heartbeats.store(connection.Heartbeats.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
 
-        while (!this->shutdownRequested.load()) {
-            int bytesReceived = recv(*this->clientSocket, buffer, BUFFER_SIZE, 0);
-            if (bytesReceived > 0) {
-                Logger::debug("Raw data: %s", buffer);
-                try {
-                    std::string jsonStr(buffer, bytesReceived);
-                    json j = json::parse(jsonStr);
-                    ShotData shotData;
-                    ShotData::from_json(j, shotData);
-                    this->notifyShotData(shotData);
-
-                    Logger::debug("Raw: %s", jsonStr.c_str());
-                    Logger::debug("From Launch Monitor: ShotDataOptions");
-                    Logger::debug("ContainsBallData: %s", shotData.ShotDataOptions.ContainsBallData ? "true" : "false");
-                    Logger::debug("ContainsClubData: %s", shotData.ShotDataOptions.ContainsClubData ? "true" : "false");
-                    Logger::debug("LaunchMonitorIsReady: %s", shotData.ShotDataOptions.LaunchMonitorIsReady ? "true" : "false");
-                    Logger::debug("LaunchMonitorBallDetected: %s", shotData.ShotDataOptions.LaunchMonitorBallDetected ? "true" : "false");
-                    Logger::debug("IsHeartBeat: %s", shotData.ShotDataOptions.IsHeartBeat ? "true" : "false");
-                }
-                catch (const std::exception& e) {
-                    Logger::error("Failed to deserialize ShotData: %s", e.what());
-                }
-                memset(buffer, 0, BUFFER_SIZE);
-            }
-            else if (!this->shutdownRequested.load()) {
-                std::string errorMsg = "Client disconnect or error: " + std::to_string(WSAGetLastError());
-                Logger::error(errorMsg.c_str());
-                Logger::debug("See: https://learn.microsoft.com/en-us/windows/win32/api/winsock2/nf-winsock2-recv ");
-                break;
+    void Server::injectShotData(ConnectionId connection, const OpenConnectV1::ShotData& shotData) {
+        // The shot queue only takes shots from the network thread
+        this->notifyShotData(connection, shotData);
+    }
+
+    void Server::dispatchShots() {
+        OC_LOG_DEBUG("Dispatch thread started");
+        ConnectionId connection = INVALID_CONNECTION;
+        ShotData shotData;
+        int64_t parsedNs = 0;
+        while (this->shotQueue->pop(connection, shotData, &parsedNs)) {
+            try {
+                this->notifyShotData(connection, shotData, parsedNs);
+            }
+            catch (const std::exception& e) {
+                OC_LOG_ERROR("Listener failed to handle ShotData: %s", e.what());
+                this->metrics.add(MetricCounter::ListenerErrors);
             }
         }
-        closesocket(*this->clientSocket);
-        *this->clientSocket = INVALID_SOCKET;
+        OC_LOG_DEBUG("Dispatch thread stopped");
+    }
+
+    void Server::adoptHistory(Connection& connection, std::string_view deviceId) {
+        connection.DeviceID = deviceId;
+        connection.Identified = true;
+
+        std::lock_guard<std::mutex> lock(this->connectionsMutex);
+        auto host = this->disconnectedHosts.find(hostOf(connection.Info.Address));
+        if (host == this->disconnectedHosts.end()) {
+            return;
+        }
+        auto previous = host->second.find(connection.DeviceID);
+        if (previous != host->second.end()) {
+            connection.History = previous->second;
+            host->second.erase(previous);
+        }
+    }
+
+    void Server::closeClient(ConnectionId connection) {
+        this->transport->close(connection);
+        if (this->livenessTimers) {
+            this->livenessTimers->cancel(connection);
+        }
+
+        ConnectionInfo info;
+        bool lastLiveConnection;
+        {
+            std::lock_guard<std::mutex> lock(this->connectionsMutex);
+            auto it = this->connections.find(connection);
+            if (it == this->connections.end()) {
+                return;
+            }
+            info = it->second->info();
+            auto& monitors = this->disconnectedHosts[hostOf(info.Address)];
+            if (it->second->Identified) {
+                monitors[it->second->DeviceID] = it->second->History;
+            }
+            this->connections.erase(it);
+            if (info.Stale) {
+                this->staleConnections--;
+            }
+            lastLiveConnection = this->connections.size() == this->staleConnections;
+        }
+        this->metrics.add(MetricCounter::Disconnects);
+
+        info.Status = OpenConnectV1::ServerStatus::Disconnected;
+        this->notifyConnectionStatus(info);
+
+        if (lastLiveConnection && !this->shutdownRequested.load()) {
+            this->notifyStatus(OpenConnectV1::ServerStatus::Listening);
+        }
+    }
+
+    ListenerToken Server::addListener(std::shared_ptr<ServerListener> listener, ListenerFilter filter) {
+        if (!listener) {
+            return INVALID_LISTENER;
+        }
+
+        std::unique_lock<std::mutex> lock(this->listenersMutex);
+        ListenerToken token = this->nextListenerToken++;
+        auto snapshot = std::make_unique<ListenerSnapshot>(*this->listeners.load());
+        snapshot->push_back({ token, std::move(listener), filter });
+        this->publishListeners(lock, std::move(snapshot));
+        return token;
+    }
+
+    bool Server::removeListener(ListenerToken token) {
+        std::unique_lock<std::mutex> lock(this->listenersMutex);
+        auto snapshot = std::make_unique<ListenerSnapshot>(*this->listeners.load());
+        auto it = std::find_if(snapshot->begin(), snapshot->end(),
+            [token](const ListenerSubscription& subscription) { return subscription.Token == token; });
+        if (it == snapshot->end()) {
+            return false;
+        }
+        snapshot->erase(it);
+        this->publishListeners(lock, std::move(snapshot));
+        return true;
     }
 
     void Server::setListener(std::shared_ptr<ServerListener> listener) {
-        std::lock_guard<std::mutex> lock(this->listenersMutex);
-        this->serverListener = listener;
+        std::unique_lock<std::mutex> lock(this->listenersMutex);
+        auto snapshot = std::make_unique<ListenerSnapshot>();
+        if (listener) {
+            snapshot->push_back({ this->nextListenerToken++, std::move(listener), ListenerFilter::All });
+        }
+        this->publishListeners(lock, std::move(snapshot));
     }
 
     void Server::removeListener() {
-        std::lock_guard<std::mutex> lock(this->listenersMutex);
-        this->serverListener.reset();
+        std::unique_lock<std::mutex> lock(this->listenersMutex);
+        this->publishListeners(lock, std::make_unique<ListenerSnapshot>());
     }
 
+    void Server::publishListeners(std::unique_lock<std::mutex>& lock, std::unique_ptr<ListenerSnapshot> snapshot) {
+        bool heartbeats = std::any_of(snapshot->begin(), snapshot->end(), [](const ListenerSubscription& subscription) {
+            return subscription.Filter == ListenerFilter::All || subscription.Filter == ListenerFilter::HeartBeatsOnly;
+        });
+        this->heartbeatListeners.store(heartbeats, std::memory_order_relaxed);
+        const ListenerSnapshot* previous = this->listeners.exchange(snapshot.release(), std::memory_order_seq_cst);
+        this->retiredListeners.emplace_back(previous);
 
-    void Server::notifyShotData(const OpenConnectV1::ShotData& shotData) {
-        std::lock_guard<std::mutex> lock(this->listenersMutex);
-        if (this->serverListener) {
-            this->serverListener->onShotDataReceived(shotData);  // Notify each listener
+        // A callback can't wait for itself to finish, whoever publishes next frees the snapshot instead
+        if (listenerCallbackDepth > 0) {
+            return;
+        }
+
+        std::vector<std::unique_ptr<const ListenerSnapshot>> retired;
+        retired.swap(this->retiredListeners);
+        lock.unlock();
+
+        // Every reader that could still hold one of the retired snapshots started before the exchange above, so in
+        // the current epoch (the writer before waited out the one before that).  Readers starting after the flip
+        // count against the other epoch, the wait only has to outlast callbacks already running.
+        std::lock_guard<std::mutex> grace(this->listenerGraceMutex);
+        uint64_t epoch = this->listenerEpoch.fetch_add(1, std::memory_order_seq_cst);
+        while (this->listenerReaders[epoch & 1].load(std::memory_order_seq_cst) != 0) {
+            std::this_thread::yield();
         }
     }
 
-    void Server::notifyStatus(const ServerStatus& status) {
-        std::lock_guard<std::mutex> lock(this->listenersMutex);
-        this->connectionStatus.store(status);
+    void Server::notifyShotData(ConnectionId connection, const OpenConnectV1::ShotData& shotData, int64_t parsedNs) {
+        bool timed = this->latencyMetrics.load(std::memory_order_relaxed);
+        int64_t dispatchedNs = timed ? Metrics::now() : 0;
+        if (timed && parsedNs != 0) {
+            this->metrics.record(MetricHistogram::ParseToDispatch, dispatchedNs - parsedNs);
+        }
+
+        {
+            ListenerReadGuard guard(this->listenerEpoch, this->listenerReaders);
+            const ListenerSnapshot* snapshot = this->listeners.load(std::memory_order_seq_cst);
+            for (const ListenerSubscription& subscription : *snapshot) {
+                if (shotData.ShotDataOptions.IsHeartBeat) {
+                    subscription.Listener->onHeartbeat(connection, shotData.ShotDataOptions);
+                }
+                if (matchesFilter(subscription.Filter, shotData)) {
+                    subscription.Listener->onShotDataReceived(connection, shotData);
+                }
+            }
+        }
+
+        if (timed) {
+            this->metrics.record(MetricHistogram::ListenerDuration, Metrics::now() - dispatchedNs);
+        }
+    }
 
-        if (this->connectionStatus.load() != status) {
-            if (this->serverListener) {
-                this->serverListener->onStatusChanged(status);
+    void Server::notifyHeartbeat(ConnectionId connection, const ShotDataOptions& options, int64_t parsedNs) {
+        bool timed = this->latencyMetrics.load(std::memory_order_relaxed);
+        int64_t dispatchedNs = timed ? Metrics::now() : 0;
+        if (timed && parsedNs != 0) {
+            this->metrics.record(MetricHistogram::ParseToDispatch, dispatchedNs - parsedNs);
+        }
+
+        {
+            ListenerReadGuard guard(this->listenerEpoch, this->listenerReaders);
+            const ListenerSnapshot* snapshot = this->listeners.load(std::memory_order_seq_cst);
+            for (const ListenerSubscription& subscription : *snapshot) {
+                subscription.Listener->onHeartbeat(connection, options);
             }
         }
+
+        if (timed) {
+            this->metrics.record(MetricHistogram::ListenerDuration, Metrics::now() - dispatchedNs);
+        }
+    }
+
+    void Server::notifyStatus(const ServerStatus& status) {
+        ServerStatus previous = this->connectionStatus.exchange(status);
+        if (previous == status) {
+            return;
+        }
+
+        ListenerReadGuard guard(this->listenerEpoch, this->listenerReaders);
+        const ListenerSnapshot* snapshot = this->listeners.load(std::memory_order_seq_cst);
+        for (const ListenerSubscription& subscription : *snapshot) {
+            subscription.Listener->onStatusChanged(status);
+        }
+    }
+
+    void Server::notifyConnectionStatus(const ConnectionInfo& connection) {
+        ListenerReadGuard guard(this->listenerEpoch, this->listenerReaders);
+        const ListenerSnapshot* snapshot = this->listeners.load(std::memory_order_seq_cst);
+        for (const ListenerSubscription& subscription : *snapshot) {
+            subscription.Listener->onConnectionStatusChanged(connection);
+        }
     }
 
     void Server::shutdown() {
         this->shutdownRequested.store(true);
         this->notifyStatus(OpenConnectV1::ServerStatus::Disconnected);
-        this->cleanup();
+        this->transport->stop();
     }
 
-    void Server::cleanup() {
-        closeClientSocket();
-        resetClientAddress();
-        closeListenSocket();
-        resetServerAddress();
+    void Server::sendResponse(OpenConnectV1::Response& response) {
+        this->queueResponse(INVALID_CONNECTION, response);
     }
 
-    void Server::closeClientSocket() {
-        closesocket(*this->clientSocket);
-        *this->clientSocket = INVALID_SOCKET;
+    void Server::sendResponse(ConnectionId connection, OpenConnectV1::Response& response) {
+        this->queueResponse(connection, response);
     }
 
-    void Server::resetClientAddress() {
-        memset(&this->clientAddress, 0, sizeof(this->clientAddress));
+    void Server::queueResponse(ConnectionId connection, OpenConnectV1::Response& response) {
+        int64_t startNs = this->latencyMetrics.load(std::memory_order_relaxed) ? Metrics::now() : 0;
+        std::shared_ptr<const EncodedResponse> encoded = this->responseCache.encoded(response);
+        OC_LOG_DEBUG("Queueing response to monitor/client %llu (0 for all): %s", static_cast<unsigned long long>(connection),
+            (*encoded)[WireFormat::Json].c_str());
+
+        {
+            std::lock_guard<std::mutex> lock(this->pendingMutex);
+            this->pendingResponses.push_back({ connection, std::move(encoded), response.Code == ResponseCode::PlayerInfo });
+        }
+        // One wake up covers everything queued until the event loop picks the responses up
+        if (!this->wakePending.exchange(true)) {
+            this->transport->wake();
+        }
+        if (startNs != 0) {
+            this->metrics.record(MetricHistogram::SendResponse, Metrics::now() - startNs);
+        }
     }
 
-    void Server::closeListenSocket() {
-        closesocket(this->listenSocket);
-        this->listenSocket = INVALID_SOCKET;
+    void Server::onWake() {
+        this->wakePending.store(false);
+        {
+            std::lock_guard<std::mutex> lock(this->pendingMutex);
+            this->drainingResponses.swap(this->pendingResponses);
+        }
+        if (this->drainingResponses.empty()) {
+            return;
+        }
+
+        this->flushConnections.clear();
+        for (const PendingResponse& pending : this->drainingResponses) {
+            if (pending.Connection == INVALID_CONNECTION) {
+                if (this->connections.empty()) {
+                    OC_LOG_DEBUG("Client is not connected!");
+                }
+                for (auto& connection : this->connections) {
+                    if (this->enqueue(*connection.second, pending)) {
+                        this->flushConnections.push_back(connection.first);
+                    }
+                }
+                continue;
+            }
+
+            auto it = this->connections.find(pending.Connection);
+            if (it == this->connections.end()) {
+                OC_LOG_ERROR("Unable to send response to monitor/client %llu", static_cast<unsigned long long>(pending.Connection));
+                this->metrics.add(MetricCounter::SendErrors);
+            }
+            else if (this->enqueue(*it->second, pending)) {
+                this->flushConnections.push_back(pending.Connection);
+            }
+        }
+        this->drainingResponses.clear();
+
+        // Everything queued for a connection goes out in one gather write
+        std::sort(this->flushConnections.begin(), this->flushConnections.end());
+        this->flushConnections.erase(std::unique(this->flushConnections.begin(), this->flushConnections.end()), this->flushConnections.end());
+        for (ConnectionId connection : this->flushConnections) {
+            auto it = this->connections.find(connection);
+            if (it != this->connections.end() && !it->second->WatchingWritable) {
+                this->flush(*it->second);
+            }
+        }
     }
 
-    void Server::resetServerAddress() {
-        memset(&this->serverAddress, 0, sizeof(this->serverAddress));
+    void Server::onWritable(ConnectionId connection) {
+        auto it = this->connections.find(connection);
+        if (it != this->connections.end()) {
+            this->flush(*it->second);
+        }
     }
 
-    void Server::sendResponse(OpenConnectV1::Response& response) {
-        std::string jsonStr = createJsonResponse(response);
-        Logger::debug("Simulating response to monitor/client: %s", jsonStr.c_str());
+    bool Server::enqueue(Connection& connection, const PendingResponse& pending) {
+        OutboundResponse response{ std::shared_ptr<const std::string>(pending.Encoded, &(*pending.Encoded)[connection.Info.Format]), pending.PlayerInfo };
+        if (response.PlayerInfo) {
+            // The front response may be partly written already, it has to go out whole
+            for (size_t i = connection.OutboundOffset > 0 ? 1 : 0; i < connection.Outbound.size(); i++) {
+                if (connection.Outbound[i].PlayerInfo) {
+                    connection.OutboundBytes -= connection.Outbound[i].Bytes->size();
+                    connection.Outbound.erase(connection.Outbound.begin() + static_cast<std::ptrdiff_t>(i));
+                    this->metrics.add(MetricCounter::ResponsesCoalesced);
+                    break;
+                }
+            }
+        }
 
-        sendJsonResponse(jsonStr);
-    }
+        size_t size = response.Bytes->size();
+        if (!connection.Outbound.empty() && connection.OutboundBytes + size > this->outboundHighWaterMark.load(std::memory_order_relaxed)) {
+            OC_LOG_ERROR("Dropping response to %s, %zu bytes are already waiting to be sent", connection.Info.Address.c_str(),
+                connection.OutboundBytes);
+            this->metrics.add(MetricCounter::ResponsesDropped);
+            return false;
+        }
 
-    std::string Server::createJsonResponse(OpenConnectV1::Response& response) {
-        nlohmann::json jsonResponse = {
-            {"Code", response.Code},
-            {"Message", response.Message},
-            {"Player", {
-                {"Handed", response.Player.Handed},
-                {"Club", response.Player.Club}
-            }}
-        };
-        return jsonResponse.dump() + "\n";
+        connection.Outbound.push_back(std::move(response));
+        connection.OutboundBytes += size;
+        return true;
     }
 
-    void Server::sendJsonResponse(const std::string& jsonStr) {
-        if (*this->clientSocket != INVALID_SOCKET) {
-            int bytesSent = send(*this->clientSocket, jsonStr.c_str(), jsonStr.length(), 0);
+    void Server::flush(Connection& connection) {
+        const size_t MAX_BUFFERS = 64;
+        SendBuffer buffers[MAX_BUFFERS];
+        ConnectionId id = connection.Info.Id;
+
+        while (!connection.Outbound.empty()) {
+            size_t count = 0;
+            for (const OutboundResponse& response : connection.Outbound) {
+                if (count == MAX_BUFFERS) {
+                    break;
+                }
+                size_t offset = count == 0 ? connection.OutboundOffset : 0;
+                buffers[count++] = { response.Bytes->data() + offset, response.Bytes->size() - offset };
+            }
+
+            int bytesSent = this->transport->sendSome(id, buffers, count);
             if (bytesSent < 0) {
-                std::string errorMsg = "Unable to send response to monitor/client: " + std::to_string(WSAGetLastError());
-                Logger::error(errorMsg.c_str());
-                Logger::debug("See: https://learn.microsoft.com/en-us/windows/win32/api/winsock2/nf-winsock2-send ");
+                OC_LOG_ERROR("Unable to send response to monitor/client %llu", static_cast<unsigned long long>(id));
+                this->metrics.add(MetricCounter::SendErrors, connection.Outbound.size());
+                this->closeClient(id);
+                return;
             }
-            else {
-                Logger::debug("Write was successful: %d of %d bytes sent", bytesSent, jsonStr.length());
+            if (bytesSent == 0) {
+                break;
+            }
+
+            this->metrics.add(MetricCounter::BytesSent, static_cast<uint64_t>(bytesSent));
+            connection.OutboundBytes -= static_cast<size_t>(bytesSent);
+            size_t remaining = static_cast<size_t>(bytesSent);
+            while (remaining > 0) {
+                size_t left = connection.Outbound.front().Bytes->size() - connection.OutboundOffset;
+                if (remaining < left) {
+                    connection.OutboundOffset += remaining;
+                    break;
+                }
+                remaining -= left;
+                connection.Outbound.pop_front();
+                connection.OutboundOffset = 0;
+                this->metrics.add(MetricCounter::ResponsesSent);
             }
         }
-        else {
-            Logger::debug("Client is not connected!");
+
+        // Partly written, carry on once the socket drains
+        bool watch = !connection.Outbound.empty();
+        if (watch != connection.WatchingWritable) {
+            this->transport->watchWritable(id, watch);
+            connection.WatchingWritable = watch;
         }
     }
-}
\ No newline at end of file
+}
@@ -1,16 +1,26 @@
 #ifndef OPEN_CONNECT_SERVER_H
 #define OPEN_CONNECT_SERVER_H
 
-#include <winsock2.h>
 #include <stdio.h>
+#include <chrono>
+#include <deque>
 #include <mutex>
 #include <atomic>
 #include <memory>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include <nlohmann/json.hpp>
 #include "Data.h"
-
-#pragma comment(lib, "Ws2_32.lib")
+#include "MessageFramer.h"
+#include "Metrics.h"
+#include "ResponseCache.h"
+#include "ShotQueue.h"
+#include "ShotValidator.h"
+#include "TimerWheel.h"
+#include "Transport.h"
+#include "WireCodec.h"
 
 namespace OpenConnectV1 {
     enum class ServerStatus {
@@ -19,25 +29,131 @@ namespace OpenConnectV1 {
         Connected = 2
     };
 
+    // Snapshot of a single launch monitor connection
+    struct ConnectionInfo {
+        ConnectionId Id = INVALID_CONNECTION;
+        std::string Address;
+        ServerStatus Status = ServerStatus::Disconnected;
+        int LastShotNumber = 0;
+        // Launch monitor state from the latest message, heartbeats included
+        bool LaunchMonitorIsReady = false;
+        bool LaunchMonitorBallDetected = false;
+        uint64_t Heartbeats = 0;
+        // Still connected but silent for longer than the liveness timeout (IdlePolicy::MarkStale)
+        bool Stale = false;
+        // Picked by the connection's first bytes, Json until then
+        WireFormat Format = WireFormat::Json;
+    };
+
+    // What happens to a connection that hasn't sent anything within the liveness timeout
+    enum class IdlePolicy {
+        Close = 0,          // Close it, freeing its slot for the monitor to reconnect
+        MarkStale = 1       // Keep it open but report it stale until it sends again
+    };
+
+    struct LivenessOptions {
+        // A connection that sends nothing for this long is stale, zero (the default) disables liveness tracking
+        std::chrono::milliseconds Timeout{ 0 };
+        // Allowed from accepting a connection to its first bytes, zero for Timeout
+        std::chrono::milliseconds FirstMessageTimeout{ 0 };
+        IdlePolicy Policy = IdlePolicy::Close;
+        // How late a timeout may be noticed
+        std::chrono::milliseconds Resolution{ 100 };
+    };
+
     class ServerListener {
     public:
         virtual ~ServerListener() = default;
         virtual void onShotDataReceived(const OpenConnectV1::ShotData& shotData) = 0;
         virtual void onStatusChanged(const ServerStatus& status) = 0;
+
+        // Connection aware variants, override these to know which launch monitor sent the shot (for
+        // Server::sendResponse(connection, ...)) or to follow individual connections coming and going.
+        virtual void onShotDataReceived(ConnectionId connection, const OpenConnectV1::ShotData& shotData) {
+            this->onShotDataReceived(shotData);
+        }
+        virtual void onConnectionStatusChanged(const ConnectionInfo& connection) {}
+        // Every heartbeat, whatever the listener's filter.  While no listener is subscribed to heartbeats
+        // (ListenerFilter::All or HeartBeatsOnly) and there's no dispatch queue, heartbeats only get this far:
+        // their ball and club data is never decoded.
+        virtual void onHeartbeat(ConnectionId connection, const OpenConnectV1::ShotDataOptions& options) {}
+    };
+
+    // Which shots a listener is called with, status changes always go to every listener
+    enum class ListenerFilter {
+        All = 0,
+        HeartBeatsOnly = 1,
+        ShotsOnly = 2,          // Everything except heartbeats
+        BallDataOnly = 3        // Shots with ContainsBallData set
     };
 
-    class Server {
+    using ListenerToken = uint64_t;
+    constexpr ListenerToken INVALID_LISTENER = 0;
+
+    /**
+     * Single threaded event loop server; every launch monitor connected to the port is multiplexed on the
+     * thread that called startup().  getStatus() is Connected while at least one monitor is connected (and,
+     * with liveness tracking, not stale).
+     */
+    class Server : private TransportHandler {
     public:
+        static constexpr size_t DEFAULT_MAX_CONNECTIONS = 1024;
+        static constexpr size_t DEFAULT_OUTBOUND_HIGH_WATER_MARK = 256 * 1024;
+
         Server();
+        explicit Server(std::unique_ptr<Transport> transport);
         ~Server();
 
-        void startup(int port);
+        // Runs the event loop until shutdown(); throws std::runtime_error when the port can't be opened or the
+        // liveness options are invalid
+        void startup(int port, const LivenessOptions& liveness = LivenessOptions());
         void shutdown();
+        // Responses are encoded on the calling thread (or found in the response cache) and queued; the event loop
+        // thread writes them out, so these never block (safe from a listener callback).  A PlayerInfo response
+        // replaces any PlayerInfo still queued for the connection, the monitor only needs the latest.
+        // Sends to every connected launch monitor
         void sendResponse(OpenConnectV1::Response& response);
+        void sendResponse(ConnectionId connection, OpenConnectV1::Response& response);
 
         ServerStatus getStatus();
+        std::vector<ConnectionInfo> getConnections();
+        // Takes effect on the next startup()
+        void setMaxConnections(size_t maxConnections);
+        // Responses queued for a connection beyond this many bytes are dropped (and counted) until the monitor
+        // reads what it has been sent
+        void setOutboundHighWaterMark(size_t bytes);
+        // Encoded responses kept for reuse (ResponseCache::DEFAULT_CAPACITY by default), 0 encodes every response
+        void setResponseCacheCapacity(size_t capacity);
+
+        // Delivers shots to the listener from a dedicated thread, through a bounded queue, so a slow listener
+        // can't stall the socket reads.  Call before startup(); a capacity of 0 switches back to delivering on
+        // the network thread.
+        void setDispatchQueue(size_t capacity, OverflowPolicy policy = OverflowPolicy::DropHeartbeats);
+        // All zero unless a dispatch queue is configured
+        ShotQueueStats getShotQueueStats();
+
+        // Checks every decoded shot against the rules before it is queued or passed to the listeners; rejected
+        // shots are dropped and counted (the ShotsRejected counters).  Off by default, call before startup().
+        // Shots from injectShotData() aren't checked.
+        void setShotValidation(bool enabled, const ShotValidationRules& rules = ShotValidationRules());
 
+        // Counters and latency histograms since construction, gathered without pausing the event loop
+        MetricsSnapshot metricsSnapshot();
+        // The latency histograms are on by default, switching them off takes the clock reads off the hot path.
+        // Counters are always kept.
+        void setLatencyMetrics(bool enabled);
+
+        // Notifies the listeners (filters included) as if the connection had sent the shot, used to replay
+        // recordings.  The listeners are called on the calling thread, bypassing any dispatch queue.
+        void injectShotData(ConnectionId connection, const OpenConnectV1::ShotData& shotData);
+
+        // Safe to call from any thread, including from inside a listener callback
+        ListenerToken addListener(std::shared_ptr<ServerListener> listener, ListenerFilter filter = ListenerFilter::All);
+        // Once this returns the listener is no longer being called (unless called from one of its own callbacks)
+        bool removeListener(ListenerToken token);
+        // Replaces every listener with this one
         void setListener(std::shared_ptr<ServerListener> listener);
+        // Removes every listener
         void removeListener();
 
     private:
@@ -45,35 +161,119 @@ namespace OpenConnectV1 {
         std::atomic<ServerStatus> connectionStatus;
         std::atomic<bool> shutdownRequested;
 
-        WSADATA wsaData;
+        struct OutboundResponse {
+            std::shared_ptr<const std::string> Bytes;     // Shared by every connection a broadcast goes to
+            bool PlayerInfo;
+        };
 
-        SOCKET listenSocket = INVALID_SOCKET;
-        SOCKADDR_IN serverAddress;
+        struct Connection {
+            ConnectionInfo Info;
+            MessageFramer Framer;
+            OpenConnectV1::ShotData ShotData;
+            const WireCodec* Codec = nullptr;   // Null until the first bytes pick the format
+            ShotHistory History;            // Last accepted ShotNumber, for duplicate suppression
+            // Info's launch monitor state, stored by the event loop thread on every message without connectionsMutex
+            std::atomic<bool> LaunchMonitorIsReady{ false };
+            std::atomic<bool> LaunchMonitorBallDetected{ false };
+            std::atomic<uint64_t> Heartbeats{ 0 };
+            std::string DeviceID;           // From the first message, which adopts the monitor's previous History
+            bool Identified = false;
 
-        std::shared_ptr<SOCKET> clientSocket;
-        SOCKADDR_IN clientAddress;
+            std::deque<OutboundResponse> Outbound;
+            size_t OutboundOffset = 0;      // Bytes of the front response already written
+            size_t OutboundBytes = 0;       // Not yet written
+            bool WatchingWritable = false;
 
-        std::shared_ptr<ServerListener> serverListener;
-        std::mutex listenersMutex;
+            // Info with the launch monitor state filled in
+            ConnectionInfo info() const;
+        };
 
-        void notifyShotData(const OpenConnectV1::ShotData& shotData);
-        void notifyStatus(const ServerStatus& status);
-        void cleanup();
+        std::unique_ptr<Transport> transport;
+        size_t maxConnections;
+
+        // Only modified on the event loop thread, the mutex guards reads from other threads
+        std::unordered_map<ConnectionId, std::unique_ptr<Connection>> connections;
+        // Host, then DeviceID.  To count reconnects, and so a monitor resending its last shot after reconnecting is
+        // caught as a duplicate; a history is erased once a connection adopts it.
+        std::unordered_map<std::string, std::unordered_map<std::string, ShotHistory>> disconnectedHosts;
+        std::mutex connectionsMutex;
+
+        // Connection deadlines, event loop thread only; null while liveness tracking is off
+        LivenessOptions liveness;
+        std::unique_ptr<TimerWheel> livenessTimers;
+        std::vector<uint64_t> expiredConnections;
+        size_t staleConnections;
+
+        // Responses from sendResponse() waiting for the event loop thread to queue them on their connections
+        struct PendingResponse {
+            ConnectionId Connection;        // INVALID_CONNECTION for every connection
+            std::shared_ptr<const EncodedResponse> Encoded;     // Each connection takes the bytes in its format
+            bool PlayerInfo;
+        };
+        std::mutex pendingMutex;
+        std::vector<PendingResponse> pendingResponses;
+        std::vector<PendingResponse> drainingResponses;     // Event loop thread only
+        std::vector<ConnectionId> flushConnections;         // Event loop thread only
+        std::atomic<bool> wakePending;
+        std::atomic<size_t> outboundHighWaterMark;
+        ResponseCache responseCache;
+
+        Metrics metrics;
+        std::atomic<bool> latencyMetrics;
 
-        void initializeSocket();
-        void bindSocket();
-        void listenOnSocket();
-        void acceptConnections();
-        void handleClientCommunication();
+        struct ListenerSubscription {
+            ListenerToken Token;
+            std::shared_ptr<ServerListener> Listener;
+            ListenerFilter Filter;
+        };
+        using ListenerSnapshot = std::vector<ListenerSubscription>;
+
+        // Immutable snapshot read without locking on every notification; writers copy it, swap the pointer, flip
+        // listenerEpoch and free the previous one once the readers of the epoch before the flip are done.
+        std::atomic<const ListenerSnapshot*> listeners;
+        std::atomic<uint64_t> listenerEpoch;
+        std::atomic<int> listenerReaders[2];    // By epoch parity
+        std::mutex listenerGraceMutex;          // One writer at a time flips the epoch and waits
+        // Set with the snapshot, whether any subscription gets heartbeats as ShotData
+        std::atomic<bool> heartbeatListeners;
+        std::mutex listenersMutex;  // Serialises writers only
+        std::vector<std::unique_ptr<const ListenerSnapshot>> retiredListeners;
+        ListenerToken nextListenerToken;
+
+        void publishListeners(std::unique_lock<std::mutex>& lock, std::unique_ptr<ListenerSnapshot> snapshot);
+
+        std::unique_ptr<ShotQueue> shotQueue;
+        std::unique_ptr<ShotValidator> shotValidator;   // Null while validation is off
+        std::thread dispatchThread;
+
+        void dispatchShots();
+
+        // parsedNs is when the shot was decoded, 0 for shots that weren't received by this Server
+        void notifyShotData(ConnectionId connection, const OpenConnectV1::ShotData& shotData, int64_t parsedNs = 0);
+        void notifyHeartbeat(ConnectionId connection, const OpenConnectV1::ShotDataOptions& options, int64_t parsedNs);
+        void notifyStatus(const ServerStatus& status);
+        void notifyConnectionStatus(const ConnectionInfo& connection);
 
-        void closeClientSocket();
-        void resetClientAddress();
-        void closeListenSocket();
-        void resetServerAddress();
+        void onAccepted(ConnectionId connection, const std::string& address) override;
+        void onReadable(ConnectionId connection) override;
+        int onTimer() override;
+        void onWritable(ConnectionId connection) override;
+        void onWake() override;
+        void touch(Connection& connection);
+        void expireConnection(ConnectionId connection);
+        // False when the connection had to be closed
+        bool processMessages(Connection& connection, int64_t receivedNs);
+        bool negotiateCodec(Connection& connection);
+        void updateLiveness(Connection& connection, const OpenConnectV1::ShotDataOptions& options);
+        // Takes over the History the same monitor (host and DeviceID) left when it last disconnected
+        void adoptHistory(Connection& connection, std::string_view deviceId);
+        void closeClient(ConnectionId connection);
 
-        std::string createJsonResponse(OpenConnectV1::Response& response);
-        void sendJsonResponse(const std::string& jsonStr);
+        void queueResponse(ConnectionId connection, OpenConnectV1::Response& response);
+        bool enqueue(Connection& connection, const PendingResponse& pending);
+        // May close the connection
+        void flush(Connection& connection);
     };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,77 @@
+#include <cstdio>
+#include <cstring>
+
+#include "ShotLog.h"
+
+namespace OpenConnectV1 {
+    namespace ShotLog {
+        void pack(ConnectionId connection, const ShotData& shotData, int64_t timestampNs, ShotRecord& record) {
+            memset(&record, 0, sizeof(record));
+            record.Kind = RecordKind::Shot;
+            record.TimestampNs = timestampNs;
+            record.Connection = connection;
+            record.ShotNumber = shotData.ShotNumber;
+
+            const auto& options = shotData.ShotDataOptions;
+            record.Flags = (options.ContainsBallData ? static_cast<uint32_t>(CONTAINS_BALL_DATA) : 0u)
+                | (options.ContainsClubData ? static_cast<uint32_t>(CONTAINS_CLUB_DATA) : 0u)
+                | (options.LaunchMonitorIsReady ? static_cast<uint32_t>(LAUNCH_MONITOR_IS_READY) : 0u)
+                | (options.LaunchMonitorBallDetected ? static_cast<uint32_t>(LAUNCH_MONITOR_BALL_DETECTED) : 0u)
+                | (options.IsHeartBeat ? static_cast<uint32_t>(IS_HEART_BEAT) : 0u);
+
+            const auto& ball = shotData.BallData;
+            float ballData[] = { ball.Speed, ball.SpinAxis, ball.TotalSpin, ball.BackSpin, ball.SideSpin,
+                ball.HLA, ball.VLA, ball.CarryDistance };
+            memcpy(record.BallData, ballData, sizeof(record.BallData));
+
+            const auto& club = shotData.ClubData;
+            float clubData[] = { club.Speed, club.AngleOfAttack, club.FaceToTarget, club.Lie, club.Loft, club.Path,
+                club.SpeedAtImpact, club.VerticalFaceImpact, club.HorizontalFaceImpact, club.ClosureRate };
+            memcpy(record.ClubData, clubData, sizeof(record.ClubData));
+        }
+
+        void unpack(const ShotRecord& record, ShotData& shotData) {
+            shotData.ShotNumber = record.ShotNumber;
+
+            auto& options = shotData.ShotDataOptions;
+            options.ContainsBallData = (record.Flags & CONTAINS_BALL_DATA) != 0;
+            options.ContainsClubData = (record.Flags & CONTAINS_CLUB_DATA) != 0;
+            options.LaunchMonitorIsReady = (record.Flags & LAUNCH_MONITOR_IS_READY) != 0;
+            options.LaunchMonitorBallDetected = (record.Flags & LAUNCH_MONITOR_BALL_DETECTED) != 0;
+            options.IsHeartBeat = (record.Flags & IS_HEART_BEAT) != 0;
+
+            const float* ball = record.BallData;
+            shotData.BallData = OpenConnectV1::BallData(ball[0], ball[1], ball[2], ball[3], ball[4], ball[5], ball[6], ball[7]);
+
+            const float* club = record.ClubData;
+            shotData.ClubData = OpenConnectV1::ClubData(club[0], club[1], club[2], club[3], club[4], club[5], club[6],
+                club[7], club[8], club[9]);
+        }
+
+        std::string segmentFileName(uint32_t index) {
+            char name[32];
+            snprintf(name, sizeof(name), "%s%06u%s", SEGMENT_PREFIX, index, SEGMENT_EXTENSION);
+            return name;
+        }
+
+        uint32_t segmentIndex(const std::string& fileName) {
+            size_t prefixLength = strlen(SEGMENT_PREFIX);
+            size_t extensionLength = strlen(SEGMENT_EXTENSION);
+            if (fileName.size() <= prefixLength + extensionLength
+                || fileName.compare(0, prefixLength, SEGMENT_PREFIX) != 0
+                || fileName.compare(fileName.size() - extensionLength, extensionLength, SEGMENT_EXTENSION) != 0) {
+                return 0;
+            }
+
+            uint32_t index = 0;
+            for (size_t i = prefixLength; i < fileName.size() - extensionLength; i++) {
+                char c = fileName[i];
+                if (c < '0' || c > '9') {
+                    return 0;
+                }
+                index = index * 10 + static_cast<uint32_t>(c - '0');
+            }
+            return index;
+        }
+    }
+}
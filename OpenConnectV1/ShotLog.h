@@ -0,0 +1,87 @@
+#ifndef OPEN_CONNECT_SHOT_LOG_H
+#define OPEN_CONNECT_SHOT_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Data.h"
+#include "Transport.h"
+
+/**
+ * On-disk layout of recorded shots (ShotRecorder/ShotLogReader).
+ *
+ * A recording is a directory of append-only segments (shots-000001.ocshot, ...).  Every segment starts with a
+ * SegmentHeader followed by fixed size records, either a ShotRecord or a StringRecord that defines an
+ * interned DeviceID/Units/APIversion string.  Strings are interned per segment so each segment can be read on
+ * its own.  Everything is little endian and laid out so the records can be used in place from a mapping.
+ */
+namespace OpenConnectV1 {
+    namespace ShotLog {
+        constexpr char MAGIC[8] = { 'O', 'C', 'S', 'H', 'O', 'T', '0', '1' };
+        constexpr uint32_t VERSION = 1;
+        constexpr const char* SEGMENT_PREFIX = "shots-";
+        constexpr const char* SEGMENT_EXTENSION = ".ocshot";
+
+        enum class RecordKind : uint32_t {
+            Shot = 1,
+            String = 2
+        };
+
+        // ShotDataOptions packed into ShotRecord::Flags
+        enum OptionFlags : uint32_t {
+            CONTAINS_BALL_DATA = 1 << 0,
+            CONTAINS_CLUB_DATA = 1 << 1,
+            LAUNCH_MONITOR_IS_READY = 1 << 2,
+            LAUNCH_MONITOR_BALL_DETECTED = 1 << 3,
+            IS_HEART_BEAT = 1 << 4
+        };
+
+        struct SegmentHeader {
+            char Magic[8];
+            uint32_t Version;
+            uint32_t RecordSize;
+            int64_t CreatedNs;      // System clock, nanoseconds since the epoch
+            uint8_t Reserved[40];
+        };
+        static_assert(sizeof(SegmentHeader) == 64, "Segment header layout changed");
+
+        struct ShotRecord {
+            RecordKind Kind;
+            uint32_t Flags;
+            int64_t TimestampNs;    // System clock, nanoseconds since the epoch
+            uint64_t Connection;
+            int32_t ShotNumber;
+            uint16_t DeviceID;      // Interned string ids, 0 is the empty string
+            uint16_t Units;
+            uint16_t APIversion;
+            uint16_t Reserved;
+            float BallData[8];      // In BallData member order, NaN when missing
+            float ClubData[10];     // In ClubData member order
+            uint32_t Padding;
+        };
+        static_assert(sizeof(ShotRecord) == 112, "Shot record layout changed");
+
+        constexpr size_t MAX_STRING_LENGTH = sizeof(ShotRecord) - 8;
+
+        struct StringRecord {
+            RecordKind Kind;
+            uint16_t Id;
+            uint16_t Length;
+            char Value[MAX_STRING_LENGTH];
+        };
+        static_assert(sizeof(StringRecord) == sizeof(ShotRecord), "Records have to be the same size");
+
+        constexpr size_t RECORD_SIZE = sizeof(ShotRecord);
+
+        // Fills everything but the interned string ids
+        void pack(ConnectionId connection, const ShotData& shotData, int64_t timestampNs, ShotRecord& record);
+        // Fills everything but the strings
+        void unpack(const ShotRecord& record, ShotData& shotData);
+
+        std::string segmentFileName(uint32_t index);
+        // Returns 0 when the name isn't a segment file name
+        uint32_t segmentIndex(const std::string& fileName);
+    }
+}
+
+#endif
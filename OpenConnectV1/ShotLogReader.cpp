@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Logger.h"
+#include "ShotLogReader.h"
+
+namespace OpenConnectV1 {
+    // Read only mapping of one segment file
+    class ShotLogReader::MappedSegment {
+    public:
+        explicit MappedSegment(const std::string& path) : path(path) {
+#ifdef _WIN32
+            this->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (this->file == INVALID_HANDLE_VALUE) {
+                throw std::runtime_error("Unable to open " + path + ", error: " + std::to_string(GetLastError()));
+            }
+            LARGE_INTEGER size;
+            GetFileSizeEx(this->file, &size);
+            this->length = static_cast<size_t>(size.QuadPart);
+            if (this->length == 0) {
+                return;
+            }
+            this->mapping = CreateFileMappingA(this->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (this->mapping == nullptr) {
+                throw std::runtime_error("Unable to map " + path + ", error: " + std::to_string(GetLastError()));
+            }
+            this->data = static_cast<const char*>(MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0));
+            if (this->data == nullptr) {
+                throw std::runtime_error("Unable to map " + path + ", error: " + std::to_string(GetLastError()));
+            }
+#else
+            this->file = open(path.c_str(), O_RDONLY);
+            if (this->file < 0) {
+                throw std::runtime_error("Unable to open " + path + ": " + strerror(errno));
+            }
+            struct stat status;
+            if (fstat(this->file, &status) < 0) {
+                throw std::runtime_error("Unable to stat " + path + ": " + strerror(errno));
+            }
+            this->length = static_cast<size_t>(status.st_size);
+            if (this->length == 0) {
+                return;
+            }
+            void* mapped = mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE, this->file, 0);
+            if (mapped == MAP_FAILED) {
+                throw std::runtime_error("Unable to map " + path + ": " + strerror(errno));
+            }
+            // Records are read front to back
+            madvise(mapped, this->length, MADV_SEQUENTIAL);
+            this->data = static_cast<const char*>(mapped);
+#endif
+        }
+
+        ~MappedSegment() {
+#ifdef _WIN32
+            if (this->data != nullptr) UnmapViewOfFile(this->data);
+            if (this->mapping != nullptr) CloseHandle(this->mapping);
+            if (this->file != INVALID_HANDLE_VALUE) CloseHandle(this->file);
+#else
+            if (this->data != nullptr) munmap(const_cast<char*>(this->data), this->length);
+            if (this->file >= 0) ::close(this->file);
+#endif
+        }
+
+        const std::string& name() const { return this->path; }
+
+        // Checks the header and counts the complete records, throws for anything that isn't a segment
+        void validate() {
+            if (this->length < sizeof(ShotLog::SegmentHeader)) {
+                this->records = 0;
+                return;
+            }
+            const auto* header = reinterpret_cast<const ShotLog::SegmentHeader*>(this->data);
+            if (memcmp(header->Magic, ShotLog::MAGIC, sizeof(ShotLog::MAGIC)) != 0
+                || header->Version != ShotLog::VERSION || header->RecordSize != ShotLog::RECORD_SIZE) {
+                throw std::runtime_error(this->path + " is not a version " + std::to_string(ShotLog::VERSION) + " shot recording segment");
+            }
+            this->records = (this->length - sizeof(ShotLog::SegmentHeader)) / ShotLog::RECORD_SIZE;
+        }
+
+        size_t recordCount() const { return this->records; }
+
+        const ShotLog::ShotRecord* record(size_t index) const {
+            return reinterpret_cast<const ShotLog::ShotRecord*>(this->data + sizeof(ShotLog::SegmentHeader) + index * ShotLog::RECORD_SIZE);
+        }
+
+    private:
+        std::string path;
+        const char* data = nullptr;
+        size_t length = 0;
+        size_t records = 0;
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#else
+        int file = -1;
+#endif
+    };
+
+    void RecordedShot::toShotData(ShotData& shotData) const {
+        ShotLog::unpack(*this->Record, shotData);
+        shotData.DeviceID = InternedString(this->DeviceID);
+        shotData.Units = InternedString(this->Units);
+        shotData.APIversion = InternedString(this->APIversion);
+    }
+
+    ShotLogReader::ShotLogReader(const std::string& directory) {
+        std::vector<std::pair<uint32_t, std::string>> paths;
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            uint32_t index = ShotLog::segmentIndex(entry.path().filename().string());
+            if (index > 0) {
+                paths.emplace_back(index, entry.path().string());
+            }
+        }
+        if (paths.empty()) {
+            std::string errorMsg = "No shot recording segments in " + directory;
+            OC_LOG_ERROR(errorMsg.c_str());
+            throw std::runtime_error(errorMsg);
+        }
+
+        std::sort(paths.begin(), paths.end());
+        for (auto& path : paths) {
+            this->openSegment(path.second);
+        }
+    }
+
+    ShotLogReader::~ShotLogReader() = default;
+
+    void ShotLogReader::openSegment(const std::string& path) {
+        auto segment = std::make_unique<MappedSegment>(path);
+        segment->validate();
+        this->segments.push_back(std::move(segment));
+    }
+
+    bool ShotLogReader::next(RecordedShot& shot) {
+        while (this->segmentPosition < this->segments.size()) {
+            const MappedSegment& segment = *this->segments[this->segmentPosition];
+            size_t count = segment.recordCount();
+
+            while (this->recordPosition < count) {
+                const ShotLog::ShotRecord* record = segment.record(this->recordPosition++);
+
+                if (record->Kind == ShotLog::RecordKind::String) {
+                    const auto* string = reinterpret_cast<const ShotLog::StringRecord*>(record);
+                    if (this->strings.size() <= string->Id) {
+                        this->strings.resize(string->Id + 1);
+                    }
+                    size_t length = std::min<size_t>(string->Length, ShotLog::MAX_STRING_LENGTH);
+                    this->strings[string->Id] = std::string_view(string->Value, length);
+                    continue;
+                }
+                if (record->Kind != ShotLog::RecordKind::Shot) {
+                    OC_LOG_ERROR("Skipping unknown record in %s", segment.name().c_str());
+                    continue;
+                }
+
+                auto lookup = [this](uint16_t id) {
+                    return id < this->strings.size() ? this->strings[id] : std::string_view();
+                };
+                shot.Record = record;
+                shot.DeviceID = lookup(record->DeviceID);
+                shot.Units = lookup(record->Units);
+                shot.APIversion = lookup(record->APIversion);
+                return true;
+            }
+
+            this->segmentPosition++;
+            this->recordPosition = 0;
+            this->strings.clear();
+        }
+        return false;
+    }
+
+    void ShotLogReader::rewind() {
+        this->segmentPosition = 0;
+        this->recordPosition = 0;
+        this->strings.clear();
+    }
+
+    size_t ShotLogReader::segmentCount() const {
+        return this->segments.size();
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef OPEN_CONNECT_SHOT_LOG_READER_H
+#define OPEN_CONNECT_SHOT_LOG_READER_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ShotLog.h"
+
+namespace OpenConnectV1 {
+    // A recorded shot, pointing straight into the mapped segment
+    struct RecordedShot {
+        const ShotLog::ShotRecord* Record = nullptr;
+        std::string_view DeviceID;
+        std::string_view Units;
+        std::string_view APIversion;
+
+        int64_t timestampNs() const { return this->Record->TimestampNs; }
+        ConnectionId connection() const { return this->Record->Connection; }
+        // Copies the shot into shotData, interning its strings
+        void toShotData(ShotData& shotData) const;
+    };
+
+    /**
+     * Memory maps every segment of a recording and iterates the shots in place, in recording order.  A partially
+     * written record at the end of a segment (the recorder died mid write) is ignored.
+     */
+    class ShotLogReader {
+    public:
+        // Throws std::runtime_error when the directory has no readable segments
+        explicit ShotLogReader(const std::string& directory);
+        ~ShotLogReader();
+
+        ShotLogReader(const ShotLogReader&) = delete;
+        ShotLogReader& operator=(const ShotLogReader&) = delete;
+
+        // Returns false once every segment has been read
+        bool next(RecordedShot& shot);
+        void rewind();
+
+        size_t segmentCount() const;
+
+    private:
+        class MappedSegment;
+
+        std::vector<std::unique_ptr<MappedSegment>> segments;
+        size_t segmentPosition = 0;
+        size_t recordPosition = 0;
+        std::vector<std::string_view> strings;    // Interned strings of the current segment, by id
+
+        void openSegment(const std::string& path);
+    };
+}
+
+#endif
@@ -0,0 +1,211 @@
+#include <chrono>
+#include <thread>
+
+#include "ShotQueue.h"
+
+namespace OpenConnectV1 {
+    namespace {
+        size_t roundUpToPowerOfTwo(size_t value) {
+            size_t result = 1;
+            while (result < value) {
+                result <<= 1;
+            }
+            return result;
+        }
+    }
+
+    ShotQueue::ShotQueue(size_t capacity, OverflowPolicy policy)
+        : mask(roundUpToPowerOfTwo(capacity > 0 ? capacity : 1) - 1), overflowPolicy(policy) {
+        this->slots = std::make_unique<Slot[]>(this->mask + 1);
+        for (size_t i = 0; i <= this->mask; i++) {
+            this->slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ShotQueue::~ShotQueue() {
+        this->close();
+    }
+
+    bool ShotQueue::push(ConnectionId connection, const ShotData& shotData, int64_t timestampNs) {
+        bool isHeartBeat = shotData.ShotDataOptions.IsHeartBeat;
+
+        while (!this->closed.load(std::memory_order_acquire)) {
+            if (this->tryPush(connection, shotData, timestampNs, isHeartBeat)) {
+                this->enqueued.fetch_add(1, std::memory_order_relaxed);
+                this->wakeConsumer();
+                return true;
+            }
+
+            switch (this->overflowPolicy) {
+            case OverflowPolicy::DropOldest:
+                this->dropOldest(false);
+                break;
+            case OverflowPolicy::DropHeartbeats:
+                if (isHeartBeat) {
+                    this->dropped.fetch_add(1, std::memory_order_relaxed);
+                    this->droppedHeartbeats.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                if (!this->dropOldest(true)) {
+                    this->waitForRoom();
+                }
+                break;
+            case OverflowPolicy::Block:
+                this->waitForRoom();
+                break;
+            }
+        }
+
+        this->dropped.fetch_add(1, std::memory_order_relaxed);
+        if (isHeartBeat) {
+            this->droppedHeartbeats.fetch_add(1, std::memory_order_relaxed);
+        }
+        return false;
+    }
+
+    bool ShotQueue::tryPush(ConnectionId connection, const ShotData& shotData, int64_t timestampNs, bool isHeartBeat) {
+        size_t position = this->tail.load(std::memory_order_relaxed);
+        Slot& slot = this->slots[position & this->mask];
+
+        // Anything other than our position means the slot is still queued, or being read by the consumer
+        if (slot.sequence.load(std::memory_order_acquire) != position) {
+            return false;
+        }
+
+        slot.isHeartBeat = isHeartBeat;
+        slot.connection = connection;
+        slot.timestampNs = timestampNs;
+        slot.shotData = shotData;   // Trivially copyable, nothing to allocate
+        slot.sequence.store(position + 1, std::memory_order_release);
+        this->tail.store(position + 1, std::memory_order_release);
+
+        size_t depth = position + 1 - this->head.load(std::memory_order_relaxed);
+        if (depth > this->highWatermark.load(std::memory_order_relaxed)) {
+            this->highWatermark.store(depth, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    bool ShotQueue::tryPop(ConnectionId& connection, ShotData& shotData, int64_t* timestampNs) {
+        size_t position = this->head.load(std::memory_order_relaxed);
+
+        while (true) {
+            Slot& slot = this->slots[position & this->mask];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+
+            if (difference < 0) {
+                return false;   // Nothing published at the head yet
+            }
+            if (difference > 0) {
+                // The producer dropped the entry we were looking at
+                position = this->head.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (this->head.compare_exchange_weak(position, position + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                connection = slot.connection;
+                if (timestampNs != nullptr) {
+                    *timestampNs = slot.timestampNs;
+                }
+                std::swap(shotData, slot.shotData);
+                slot.sequence.store(position + this->mask + 1, std::memory_order_release);
+                return true;
+            }
+        }
+    }
+
+    bool ShotQueue::pop(ConnectionId& connection, ShotData& shotData, int64_t* timestampNs) {
+        while (true) {
+            if (this->tryPop(connection, shotData, timestampNs)) {
+                return true;
+            }
+            if (this->closed.load(std::memory_order_acquire)) {
+                return this->tryPop(connection, shotData, timestampNs);
+            }
+
+            std::unique_lock<std::mutex> lock(this->waitMutex);
+            this->consumerWaiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (this->depth() == 0 && !this->closed.load(std::memory_order_acquire)) {
+                // The timeout is only a backstop, push() notifies whenever the consumer is parked
+                this->notEmpty.wait_for(lock, std::chrono::milliseconds(100));
+            }
+            this->consumerWaiting.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    bool ShotQueue::dropOldest(bool heartbeatsOnly) {
+        size_t position = this->head.load(std::memory_order_acquire);
+        Slot& slot = this->slots[position & this->mask];
+
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+            return false;
+        }
+        // isHeartBeat is only ever written by this (the producer) thread
+        bool isHeartBeat = slot.isHeartBeat;
+        if (heartbeatsOnly && !isHeartBeat) {
+            return false;
+        }
+        // Losing the race means the consumer just took it, which made room anyway
+        if (!this->head.compare_exchange_strong(position, position + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            return false;
+        }
+
+        slot.sequence.store(position + this->mask + 1, std::memory_order_release);
+        this->dropped.fetch_add(1, std::memory_order_relaxed);
+        if (isHeartBeat) {
+            this->droppedHeartbeats.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    void ShotQueue::waitForRoom() {
+        this->wakeConsumer();
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    void ShotQueue::wakeConsumer() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (this->consumerWaiting.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(this->waitMutex);
+            this->notEmpty.notify_one();
+        }
+    }
+
+    void ShotQueue::close() {
+        this->closed.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(this->waitMutex);
+        this->notEmpty.notify_all();
+    }
+
+    void ShotQueue::reset() {
+        this->closed.store(false, std::memory_order_release);
+    }
+
+    size_t ShotQueue::capacity() const {
+        return this->mask + 1;
+    }
+
+    size_t ShotQueue::depth() const {
+        size_t head = this->head.load(std::memory_order_acquire);
+        size_t tail = this->tail.load(std::memory_order_acquire);
+        size_t depth = tail - head;
+        return depth > this->capacity() ? this->capacity() : depth;
+    }
+
+    OverflowPolicy ShotQueue::policy() const {
+        return this->overflowPolicy;
+    }
+
+    ShotQueueStats ShotQueue::stats() const {
+        ShotQueueStats stats;
+        stats.Capacity = this->capacity();
+        stats.Depth = this->depth();
+        stats.HighWatermark = this->highWatermark.load(std::memory_order_relaxed);
+        stats.Enqueued = this->enqueued.load(std::memory_order_relaxed);
+        stats.Dropped = this->dropped.load(std::memory_order_relaxed);
+        stats.DroppedHeartbeats = this->droppedHeartbeats.load(std::memory_order_relaxed);
+        return stats;
+    }
+}
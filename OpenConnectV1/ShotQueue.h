@@ -0,0 +1,103 @@
+#ifndef OPEN_CONNECT_SHOT_QUEUE_H
+#define OPEN_CONNECT_SHOT_QUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include "Data.h"
+#include "Transport.h"
+
+namespace OpenConnectV1 {
+    // What push() does when the queue is full
+    enum class OverflowPolicy {
+        DropHeartbeats = 0,     // Drop the incoming (or oldest queued) heartbeat, wait for room for real shots
+        Block = 1,              // Wait for the listener thread to make room
+        DropOldest = 2          // Discard the oldest queued entry
+    };
+
+    struct ShotQueueStats {
+        size_t Capacity = 0;
+        size_t Depth = 0;
+        size_t HighWatermark = 0;
+        uint64_t Enqueued = 0;
+        uint64_t Dropped = 0;           // Includes DroppedHeartbeats
+        uint64_t DroppedHeartbeats = 0;
+    };
+
+    /**
+     * Bounded lock-free single producer/single consumer ring of decoded shots, used to hand ShotData from the
+     * network thread to the listener thread.
+     *
+     * Every slot carries a sequence number (Vyukov style) so that, besides the consumer, the producer can also
+     * claim the oldest slot with a CAS on the head when it has to drop something.  ShotData is trivially
+     * copyable, so filling or emptying a slot is a plain copy that never allocates.  The only lock is the one
+     * the consumer parks on while the queue is empty.
+     */
+    class ShotQueue {
+    public:
+        static constexpr size_t DEFAULT_CAPACITY = 256;
+
+        // The capacity is rounded up to a power of two
+        explicit ShotQueue(size_t capacity = DEFAULT_CAPACITY, OverflowPolicy policy = OverflowPolicy::DropHeartbeats);
+        ~ShotQueue();
+
+        ShotQueue(const ShotQueue&) = delete;
+        ShotQueue& operator=(const ShotQueue&) = delete;
+
+        // Producer thread only.  Returns false when the shot was dropped (or the queue was closed while waiting).
+        // The timestamp is handed to the consumer with the shot.
+        bool push(ConnectionId connection, const ShotData& shotData, int64_t timestampNs = 0);
+
+        // Consumer thread only.  Swaps the oldest entry into shotData, returns false when the queue is empty.
+        bool tryPop(ConnectionId& connection, ShotData& shotData, int64_t* timestampNs = nullptr);
+        // Consumer thread only.  Waits for an entry, returns false once the queue is closed and drained.
+        bool pop(ConnectionId& connection, ShotData& shotData, int64_t* timestampNs = nullptr);
+
+        // Wakes both sides; push() fails from then on, pop() keeps returning what is left.
+        void close();
+        // Reopens a closed (and drained) queue
+        void reset();
+
+        size_t capacity() const;
+        size_t depth() const;
+        OverflowPolicy policy() const;
+        ShotQueueStats stats() const;
+
+    private:
+        struct Slot {
+            std::atomic<size_t> sequence{ 0 };
+            bool isHeartBeat = false;   // Written by the producer before the sequence is published
+            ConnectionId connection = INVALID_CONNECTION;
+            int64_t timestampNs = 0;
+            ShotData shotData;
+        };
+
+        std::unique_ptr<Slot[]> slots;
+        size_t mask;
+        OverflowPolicy overflowPolicy;
+
+        // Separate cache lines so the producer and consumer don't false share
+        alignas(64) std::atomic<size_t> head{ 0 };
+        alignas(64) std::atomic<size_t> tail{ 0 };
+
+        alignas(64) std::atomic<uint64_t> enqueued{ 0 };
+        std::atomic<uint64_t> dropped{ 0 };
+        std::atomic<uint64_t> droppedHeartbeats{ 0 };
+        std::atomic<size_t> highWatermark{ 0 };
+
+        std::atomic<bool> closed{ false };
+        std::atomic<bool> consumerWaiting{ false };
+        std::mutex waitMutex;
+        std::condition_variable notEmpty;
+
+        bool tryPush(ConnectionId connection, const ShotData& shotData, int64_t timestampNs, bool isHeartBeat);
+        bool dropOldest(bool heartbeatsOnly);
+        void waitForRoom();
+        void wakeConsumer();
+    };
+}
+
+#endif
@@ -0,0 +1,159 @@
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+
+#include "Logger.h"
+#include "ShotRecorder.h"
+
+namespace OpenConnectV1 {
+    namespace {
+        int64_t nowNs() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    ShotRecorder::ShotRecorder(const ShotRecorderOptions& options)
+        : options(options) {
+        std::error_code error;
+        std::filesystem::create_directories(this->options.Directory, error);
+        if (error) {
+            std::string errorMsg = "Unable to create shot recording directory " + this->options.Directory + ": " + error.message();
+            OC_LOG_ERROR(errorMsg.c_str());
+            throw std::runtime_error(errorMsg);
+        }
+
+        // Continue after the last existing segment
+        for (const auto& entry : std::filesystem::directory_iterator(this->options.Directory, error)) {
+            uint32_t index = ShotLog::segmentIndex(entry.path().filename().string());
+            if (index > this->segmentIndex.load(std::memory_order_relaxed)) {
+                this->segmentIndex.store(index, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    ShotRecorder::~ShotRecorder() {
+        this->close();
+    }
+
+    void ShotRecorder::onShotDataReceived(const ShotData& shotData) {
+        this->record(INVALID_CONNECTION, shotData, nowNs());
+    }
+
+    void ShotRecorder::onShotDataReceived(ConnectionId connection, const ShotData& shotData) {
+        this->record(connection, shotData, nowNs());
+    }
+
+    void ShotRecorder::record(ConnectionId connection, const ShotData& shotData, int64_t timestampNs) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        if (this->segment == nullptr || this->segmentBytes >= this->options.SegmentBytes) {
+            this->closeSegment();
+            this->openSegment(timestampNs);
+        }
+
+        ShotLog::ShotRecord record;
+        ShotLog::pack(connection, shotData, timestampNs, record);
+        record.DeviceID = this->intern(shotData.DeviceID);
+        record.Units = this->intern(shotData.Units);
+        record.APIversion = this->intern(shotData.APIversion);
+        this->write(&record, sizeof(record));
+
+        if (this->options.FlushEachRecord) {
+            fflush(this->segment);
+        }
+        this->shots.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void ShotRecorder::flush() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->segment != nullptr) {
+            fflush(this->segment);
+        }
+    }
+
+    void ShotRecorder::close() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->closeSegment();
+    }
+
+    uint64_t ShotRecorder::recordedShots() const {
+        return this->shots.load(std::memory_order_relaxed);
+    }
+
+    uint32_t ShotRecorder::currentSegment() const {
+        return this->segmentIndex.load(std::memory_order_relaxed);
+    }
+
+    void ShotRecorder::openSegment(int64_t timestampNs) {
+        uint32_t index = this->segmentIndex.load(std::memory_order_relaxed) + 1;
+        this->segmentIndex.store(index, std::memory_order_relaxed);
+        std::filesystem::path path = std::filesystem::path(this->options.Directory) / ShotLog::segmentFileName(index);
+
+        this->segment = fopen(path.string().c_str(), "wb");
+        if (this->segment == nullptr) {
+            std::string errorMsg = "Unable to create shot recording segment " + path.string() + ": " + strerror(errno);
+            OC_LOG_ERROR(errorMsg.c_str());
+            throw std::runtime_error(errorMsg);
+        }
+        setvbuf(this->segment, nullptr, _IOFBF, 64 * 1024);
+
+        ShotLog::SegmentHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.Magic, ShotLog::MAGIC, sizeof(header.Magic));
+        header.Version = ShotLog::VERSION;
+        header.RecordSize = static_cast<uint32_t>(ShotLog::RECORD_SIZE);
+        header.CreatedNs = timestampNs;
+
+        this->segmentBytes = 0;
+        this->strings.clear();
+        this->write(&header, sizeof(header));
+        OC_LOG_DEBUG("Recording shots to %s", path.string().c_str());
+    }
+
+    void ShotRecorder::closeSegment() {
+        if (this->segment != nullptr) {
+            fclose(this->segment);
+            this->segment = nullptr;
+        }
+    }
+
+    uint16_t ShotRecorder::intern(InternedString value) {
+        if (value.empty()) {
+            return 0;
+        }
+
+        auto it = this->strings.find(value);
+        if (it != this->strings.end()) {
+            return it->second;
+        }
+        if (this->strings.size() >= UINT16_MAX) {
+            OC_LOG_ERROR("Too many distinct strings in shot recording segment, dropping %s", value.c_str());
+            return 0;
+        }
+
+        std::string_view key = value.view().substr(0, ShotLog::MAX_STRING_LENGTH);
+
+        ShotLog::StringRecord record;
+        memset(&record, 0, sizeof(record));
+        record.Kind = ShotLog::RecordKind::String;
+        record.Id = static_cast<uint16_t>(this->strings.size() + 1);
+        record.Length = static_cast<uint16_t>(key.size());
+        memcpy(record.Value, key.data(), key.size());
+        this->write(&record, sizeof(record));
+
+        this->strings.emplace(value, record.Id);
+        return record.Id;
+    }
+
+    void ShotRecorder::write(const void* record, size_t size) {
+        if (fwrite(record, 1, size, this->segment) != size) {
+            std::string errorMsg = std::string("Failed writing shot recording: ") + strerror(errno);
+            OC_LOG_ERROR(errorMsg.c_str());
+            throw std::runtime_error(errorMsg);
+        }
+        this->segmentBytes += size;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef OPEN_CONNECT_SHOT_RECORDER_H
+#define OPEN_CONNECT_SHOT_RECORDER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "Server.h"
+#include "ShotLog.h"
+
+namespace OpenConnectV1 {
+    struct ShotRecorderOptions {
+        std::string Directory;
+        size_t SegmentBytes = 64 * 1024 * 1024;     // A new segment is started once a segment reaches this size
+        bool FlushEachRecord = true;                // Survive a crash with at most the record being written lost
+    };
+
+    /**
+     * Listener that appends every shot it receives to a binary recording (see ShotLog.h), subscribe it with a
+     * ListenerFilter to leave heartbeats out.  Recording into an existing directory starts a new segment after
+     * the last one, earlier segments are never modified.
+     */
+    class ShotRecorder : public ServerListener {
+    public:
+        // Creates the directory if required, throws std::runtime_error when it can't be written to
+        explicit ShotRecorder(const ShotRecorderOptions& options);
+        ~ShotRecorder();
+
+        ShotRecorder(const ShotRecorder&) = delete;
+        ShotRecorder& operator=(const ShotRecorder&) = delete;
+
+        void onShotDataReceived(const ShotData& shotData) override;
+        void onShotDataReceived(ConnectionId connection, const ShotData& shotData) override;
+        void onStatusChanged(const ServerStatus& status) override {}
+
+        // Records with an explicit timestamp (system clock nanoseconds since the epoch)
+        void record(ConnectionId connection, const ShotData& shotData, int64_t timestampNs);
+
+        void flush();
+        void close();
+
+        uint64_t recordedShots() const;
+        uint32_t currentSegment() const;
+
+    private:
+        ShotRecorderOptions options;
+        std::mutex mutex;
+
+        FILE* segment = nullptr;
+        std::atomic<uint32_t> segmentIndex{ 0 };     // Changed under mutex, read without it by currentSegment()
+        size_t segmentBytes = 0;
+        std::unordered_map<InternedString, uint16_t> strings;   // Strings written to the current segment
+        std::atomic<uint64_t> shots{ 0 };
+
+        void openSegment(int64_t timestampNs);
+        void closeSegment();
+        uint16_t intern(InternedString value);
+        void write(const void* record, size_t size);
+    };
+}
+
+#endif
@@ -0,0 +1,50 @@
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "Logger.h"
+#include "ShotReplayer.h"
+
+namespace OpenConnectV1 {
+    ShotReplayer::ShotReplayer(Server& server)
+        : server(server), stopRequested(false) {}
+
+    size_t ShotReplayer::replay(ShotLogReader& log, ReplayTiming timing) {
+        RecordedShot recorded;
+        ShotData shotData;
+        size_t delivered = 0;
+        int64_t firstTimestampNs = 0;
+        auto start = std::chrono::steady_clock::now();
+
+        while (!this->stopRequested.load() && log.next(recorded)) {
+            if (timing == ReplayTiming::Original) {
+                if (delivered == 0) {
+                    firstTimestampNs = recorded.timestampNs();
+                }
+                auto due = start + std::chrono::nanoseconds(std::max<int64_t>(0, recorded.timestampNs() - firstTimestampNs));
+                // Sleep in slices so stop() doesn't have to wait out a long gap between shots
+                while (!this->stopRequested.load() && std::chrono::steady_clock::now() < due) {
+                    std::this_thread::sleep_until(std::min(due, std::chrono::steady_clock::now() + std::chrono::milliseconds(100)));
+                }
+                if (this->stopRequested.load()) {
+                    break;
+                }
+            }
+
+            recorded.toShotData(shotData);
+            this->server.injectShotData(recorded.connection(), shotData);
+            delivered++;
+        }
+
+        OC_LOG_INFO("Replayed %d shots", static_cast<int>(delivered));
+        return delivered;
+    }
+
+    void ShotReplayer::stop() {
+        this->stopRequested.store(true);
+    }
+
+    void ShotReplayer::reset() {
+        this->stopRequested.store(false);
+    }
+}
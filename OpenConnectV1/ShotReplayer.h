@@ -0,0 +1,36 @@
+#ifndef OPEN_CONNECT_SHOT_REPLAYER_H
+#define OPEN_CONNECT_SHOT_REPLAYER_H
+
+#include <atomic>
+#include <cstddef>
+#include "Server.h"
+#include "ShotLogReader.h"
+
+namespace OpenConnectV1 {
+    enum class ReplayTiming {
+        Original = 0,   // Keep the recorded gaps between shots
+        MaxSpeed = 1    // Deliver back to back
+    };
+
+    /**
+     * Feeds a recording back through Server::injectShotData(), so every listener sees the shots (with their
+     * original connection ids) the way it did when they were recorded.
+     */
+    class ShotReplayer {
+    public:
+        explicit ShotReplayer(Server& server);
+
+        // Blocks until the recording has been replayed or stop() is called, returns the number of shots delivered
+        size_t replay(ShotLogReader& log, ReplayTiming timing = ReplayTiming::MaxSpeed);
+        // Safe to call from any thread.  Sticks until reset(), a stop() just before replay() starts isn't lost.
+        void stop();
+        // Lets a stopped replayer replay again
+        void reset();
+
+    private:
+        Server& server;
+        std::atomic<bool> stopRequested;
+    };
+}
+
+#endif
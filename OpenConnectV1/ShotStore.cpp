@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <new>
+
+#include "ShotLogReader.h"
+#include "ShotStore.h"
+
+namespace OpenConnectV1 {
+    namespace {
+        constexpr float MISSING = std::numeric_limits<float>::quiet_NaN();
+        constexpr size_t MIN_CAPACITY = 256;
+        constexpr size_t BLOCK_FLOATS = ShotStore::ALIGNMENT / sizeof(float);
+
+        size_t popCount(uint64_t word) {
+            word -= (word >> 1) & 0x5555555555555555ull;
+            word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+            word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+            return static_cast<size_t>((word * 0x0101010101010101ull) >> 56);
+        }
+    }
+
+    size_t ShotColumn::validCount() const {
+        size_t count = 0;
+        for (size_t word = 0; word < (this->Size + 63) / 64; word++) {
+            count += popCount(this->Valid[word]);
+        }
+        return count;
+    }
+
+    void ShotStore::AlignedDelete::operator()(float* data) const {
+        ::operator delete(data, std::align_val_t(ALIGNMENT));
+    }
+
+    bool ShotStore::append(ConnectionId connection, const ShotData& shotData, int64_t timestampNs) {
+        if (shotData.ShotDataOptions.IsHeartBeat) {
+            return false;
+        }
+        ShotLog::ShotRecord record;
+        ShotLog::pack(connection, shotData, timestampNs, record);
+        this->appendRecord(record, shotData.DeviceID, shotData.Units);
+        return true;
+    }
+
+    size_t ShotStore::load(ShotLogReader& reader) {
+        size_t stored = 0;
+        RecordedShot shot;
+        while (reader.next(shot)) {
+            if ((shot.Record->Flags & ShotLog::IS_HEART_BEAT) != 0) {
+                continue;
+            }
+            this->appendRecord(*shot.Record, InternedString(shot.DeviceID), InternedString(shot.Units));
+            stored++;
+        }
+        return stored;
+    }
+
+    void ShotStore::reserve(size_t rows) {
+        if (rows > this->allocated) {
+            this->grow(rows);
+        }
+    }
+
+    void ShotStore::clear() {
+        for (size_t field = 0; field < SHOT_FIELD_COUNT; field++) {
+            std::fill(this->values[field].get(), this->values[field].get() + this->allocated, MISSING);
+            std::fill(this->validity[field].begin(), this->validity[field].end(), 0);
+        }
+        this->timestampColumn.clear();
+        this->connectionColumn.clear();
+        this->shotNumberColumn.clear();
+        this->deviceIdColumn.clear();
+        this->unitsColumn.clear();
+        this->unitSystemColumn.clear();
+        this->rows = 0;
+    }
+
+    ShotColumn ShotStore::column(ShotField field) const {
+        size_t index = static_cast<size_t>(field);
+        ShotColumn column;
+        column.Data = this->values[index].get();
+        column.Valid = this->validity[index].data();
+        column.Size = this->rows;
+        return column;
+    }
+
+    void ShotStore::normalizedColumn(ShotField field, float* out) const {
+        size_t index = static_cast<size_t>(field);
+        float factors[UNIT_SYSTEM_COUNT];
+        for (size_t units = 0; units < UNIT_SYSTEM_COUNT; units++) {
+            UnitSystem system = static_cast<UnitSystem>(units);
+            factors[units] = index < BALL_FIELD_COUNT ? ballScales(system)[index] : clubScales(system)[index - BALL_FIELD_COUNT];
+        }
+
+        const float* data = this->values[index].get();
+        const UnitSystem* systems = this->unitSystemColumn.data();
+        for (size_t row = 0; row < this->rows; row++) {
+            out[row] = data[row] * factors[static_cast<size_t>(systems[row])];
+        }
+    }
+
+    void ShotStore::appendRecord(const ShotLog::ShotRecord& record, InternedString deviceID, InternedString units) {
+        if (this->rows == this->allocated) {
+            this->grow(this->rows + 1);
+        }
+
+        // Monitors send zeroes for what they don't measure, the Contains flags say whether the values mean anything
+        bool hasBall = (record.Flags & ShotLog::CONTAINS_BALL_DATA) != 0;
+        bool hasClub = (record.Flags & ShotLog::CONTAINS_CLUB_DATA) != 0;
+
+        size_t row = this->rows;
+        uint64_t bit = uint64_t(1) << (row % 64);
+        for (size_t field = 0; field < SHOT_FIELD_COUNT; field++) {
+            float value = field < BALL_FIELD_COUNT
+                ? (hasBall ? record.BallData[field] : MISSING)
+                : (hasClub ? record.ClubData[field - BALL_FIELD_COUNT] : MISSING);
+            this->values[field][row] = value;
+            if (!std::isnan(value)) {
+                this->validity[field][row / 64] |= bit;
+            }
+        }
+        this->timestampColumn.push_back(record.TimestampNs);
+        this->connectionColumn.push_back(record.Connection);
+        this->shotNumberColumn.push_back(record.ShotNumber);
+        this->deviceIdColumn.push_back(deviceID);
+        this->unitsColumn.push_back(units);
+        this->unitSystemColumn.push_back(unitSystemOf(units));
+        this->rows++;
+    }
+
+    // Every column is reallocated together, the new rows are NaN and invalid
+    void ShotStore::grow(size_t rows) {
+        size_t capacity = std::max({ rows, this->allocated * 2, MIN_CAPACITY });
+        capacity = (capacity + BLOCK_FLOATS - 1) / BLOCK_FLOATS * BLOCK_FLOATS;
+
+        for (size_t field = 0; field < SHOT_FIELD_COUNT; field++) {
+            FloatColumn column(static_cast<float*>(::operator new(capacity * sizeof(float), std::align_val_t(ALIGNMENT))));
+            if (this->rows > 0) {
+                memcpy(column.get(), this->values[field].get(), this->rows * sizeof(float));
+            }
+            std::fill(column.get() + this->rows, column.get() + capacity, MISSING);
+            this->values[field] = std::move(column);
+            this->validity[field].resize((capacity + 63) / 64, 0);
+        }
+        this->timestampColumn.reserve(capacity);
+        this->connectionColumn.reserve(capacity);
+        this->shotNumberColumn.reserve(capacity);
+        this->deviceIdColumn.reserve(capacity);
+        this->unitsColumn.reserve(capacity);
+        this->unitSystemColumn.reserve(capacity);
+        this->allocated = capacity;
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef OPEN_CONNECT_SHOT_STORE_H
+#define OPEN_CONNECT_SHOT_STORE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Data.h"
+#include "ShotLog.h"
+#include "Units.h"
+#include "Transport.h"
+
+namespace OpenConnectV1 {
+    class ShotLogReader;
+
+    // Every float of a shot, BallData then ClubData in member order (the order of ShotLog::ShotRecord)
+    enum class ShotField : uint8_t {
+        BallSpeed, SpinAxis, TotalSpin, BackSpin, SideSpin, HLA, VLA, CarryDistance,
+        ClubSpeed, AngleOfAttack, FaceToTarget, Lie, Loft, Path, SpeedAtImpact, VerticalFaceImpact,
+        HorizontalFaceImpact, ClosureRate
+    };
+    constexpr size_t SHOT_FIELD_COUNT = 18;
+    constexpr size_t BALL_FIELD_COUNT = 8;
+
+    // Read only view of one column, valid until the store is next modified
+    struct ShotColumn {
+        const float* Data = nullptr;        // 64 byte aligned, NaN where the shot has no value
+        const uint64_t* Valid = nullptr;    // Bit (row % 64) of word (row / 64) is set when the row has a value
+        size_t Size = 0;
+
+        const float* begin() const { return this->Data; }
+        const float* end() const { return this->Data + this->Size; }
+        float operator[](size_t row) const { return this->Data[row]; }
+        bool valid(size_t row) const { return ((this->Valid[row / 64] >> (row % 64)) & 1) != 0; }
+        size_t validCount() const;
+    };
+
+    /**
+     * Shots stored column by column for analytics over long histories: every BallData/ClubData field is a
+     * contiguous, 64 byte aligned float column, so a scan over one field reads nothing else.  Missing values keep
+     * the NaN convention (ball or club data a shot doesn't contain is NaN too) and are also recorded in a validity
+     * bitmap per column.  The rows past size() up to the next multiple of 16 are NaN and invalid, scans can work
+     * on whole 64 byte blocks.
+     *
+     * Appending is amortized O(1), columns double in capacity as they fill.  Heartbeats carry no shot and are
+     * not stored.  Not thread safe; a listener appending from onShotDataReceived() shares it with readers under
+     * its own lock.
+     */
+    class ShotStore {
+    public:
+        static constexpr size_t ALIGNMENT = 64;
+
+        ShotStore() = default;
+        ShotStore(ShotStore&&) = default;
+        ShotStore& operator=(ShotStore&&) = default;
+
+        // Returns false (and stores nothing) for a heartbeat
+        bool append(ConnectionId connection, const ShotData& shotData, int64_t timestampNs = 0);
+        // Appends every shot of a recording, returns how many were stored
+        size_t load(ShotLogReader& reader);
+
+        void reserve(size_t rows);
+        void clear();
+        size_t size() const { return this->rows; }
+        size_t capacity() const { return this->allocated; }
+
+        ShotColumn column(ShotField field) const;
+        const std::vector<int64_t>& timestamps() const { return this->timestampColumn; }
+        const std::vector<ConnectionId>& connections() const { return this->connectionColumn; }
+        const std::vector<int32_t>& shotNumbers() const { return this->shotNumberColumn; }
+        const std::vector<InternedString>& deviceIds() const { return this->deviceIdColumn; }
+        const std::vector<InternedString>& units() const { return this->unitsColumn; }
+        const std::vector<UnitSystem>& unitSystems() const { return this->unitSystemColumn; }
+
+        // The column in SI (see Units.h), each row scaled by its shot's UnitSystem, into out[0, size())
+        void normalizedColumn(ShotField field, float* out) const;
+
+    private:
+        struct AlignedDelete {
+            void operator()(float* data) const;
+        };
+        using FloatColumn = std::unique_ptr<float[], AlignedDelete>;
+
+        size_t rows = 0;
+        size_t allocated = 0;
+        std::array<FloatColumn, SHOT_FIELD_COUNT> values;
+        std::array<std::vector<uint64_t>, SHOT_FIELD_COUNT> validity;
+        std::vector<int64_t> timestampColumn;
+        std::vector<ConnectionId> connectionColumn;
+        std::vector<int32_t> shotNumberColumn;
+        std::vector<InternedString> deviceIdColumn;
+        std::vector<InternedString> unitsColumn;
+        std::vector<UnitSystem> unitSystemColumn;
+
+        void appendRecord(const ShotLog::ShotRecord& record, InternedString deviceID, InternedString units);
+        void grow(size_t rows);
+    };
+}
+
+#endif
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "ShotValidator.h"
+
+namespace OpenConnectV1 {
+    namespace {
+        constexpr uint32_t BALL_FIELDS = (1u << BALL_FIELD_COUNT) - 1;
+        constexpr uint32_t CLUB_FIELDS = ((1u << SHOT_FIELD_COUNT) - 1) & ~BALL_FIELDS;
+        constexpr uint32_t SPIN_FIELDS = 1u << static_cast<size_t>(ShotField::TotalSpin)
+            | 1u << static_cast<size_t>(ShotField::BackSpin) | 1u << static_cast<size_t>(ShotField::SideSpin);
+
+        constexpr uint32_t FIELD_BITS[ShotValidator::PADDED_FIELD_COUNT] = {
+            1u << 0, 1u << 1, 1u << 2, 1u << 3, 1u << 4, 1u << 5, 1u << 6, 1u << 7,
+            1u << 8, 1u << 9, 1u << 10, 1u << 11, 1u << 12, 1u << 13, 1u << 14, 1u << 15,
+            1u << 16, 1u << 17, 0, 0, 0, 0, 0, 0
+        };
+
+        size_t indexOf(UnitSystem units) {
+            return std::min(static_cast<size_t>(units), UNIT_SYSTEM_COUNT - 1);
+        }
+
+        FieldRule range(float min, float max, bool required = false) {
+            FieldRule rule;
+            rule.Min = min;
+            rule.Max = max;
+            rule.Required = required;
+            return rule;
+        }
+    }
+
+    const char* toString(ShotRejection rejection) {
+        switch (rejection) {
+        case ShotRejection::None: return "None";
+        case ShotRejection::MissingValue: return "MissingValue";
+        case ShotRejection::OutOfRange: return "OutOfRange";
+        case ShotRejection::SpinMismatch: return "SpinMismatch";
+        case ShotRejection::DuplicateShotNumber: return "DuplicateShotNumber";
+        default: return "Unknown";
+        }
+    }
+
+    ShotValidationRules::ShotValidationRules() {
+        ShotValidationRules& rules = *this;
+        rules[ShotField::BallSpeed] = range(0.0f, 250.0f, true);
+        rules[ShotField::SpinAxis] = range(-90.0f, 90.0f);
+        rules[ShotField::TotalSpin] = range(0.0f, 20000.0f);
+        rules[ShotField::BackSpin] = range(-10000.0f, 20000.0f);
+        rules[ShotField::SideSpin] = range(-10000.0f, 10000.0f);
+        rules[ShotField::HLA] = range(-90.0f, 90.0f);
+        rules[ShotField::VLA] = range(-20.0f, 90.0f);
+        rules[ShotField::CarryDistance] = range(0.0f, 500.0f);
+        rules[ShotField::ClubSpeed] = range(0.0f, 200.0f);
+        rules[ShotField::AngleOfAttack] = range(-45.0f, 45.0f);
+        rules[ShotField::FaceToTarget] = range(-90.0f, 90.0f);
+        rules[ShotField::Lie] = range(-90.0f, 90.0f);
+        rules[ShotField::Loft] = range(-30.0f, 90.0f);
+        rules[ShotField::Path] = range(-90.0f, 90.0f);
+        rules[ShotField::SpeedAtImpact] = range(0.0f, 200.0f);
+    }
+
+    ShotValidator::ShotValidator(const ShotValidationRules& rules) : validationRules(rules) {
+        // Bounds for a Meters shot are the Yards bounds taken through SI into metres
+        for (size_t system = 0; system < UNIT_SYSTEM_COUNT; system++) {
+            const float* yardBall = ballScales(UnitSystem::Yards);
+            const float* yardClub = clubScales(UnitSystem::Yards);
+            const float* ball = ballScales(static_cast<UnitSystem>(system));
+            const float* club = clubScales(static_cast<UnitSystem>(system));
+            std::fill(this->minimums[system], this->minimums[system] + PADDED_FIELD_COUNT, 0.0f);
+            std::fill(this->maximums[system], this->maximums[system] + PADDED_FIELD_COUNT, 0.0f);
+            for (size_t field = 0; field < SHOT_FIELD_COUNT; field++) {
+                float factor = field < BALL_FIELD_COUNT ? yardBall[field] / ball[field]
+                    : yardClub[field - BALL_FIELD_COUNT] / club[field - BALL_FIELD_COUNT];
+                this->minimums[system][field] = rules.Fields[field].Min * factor;
+                this->maximums[system][field] = rules.Fields[field].Max * factor;
+            }
+        }
+        for (size_t field = 0; field < SHOT_FIELD_COUNT; field++) {
+            this->required |= static_cast<uint32_t>(rules.Fields[field].Required) << field;
+        }
+    }
+
+    ShotVerdict ShotValidator::check(const ShotData& shotData) const {
+        ShotVerdict verdict;
+        const OpenConnectV1::ShotDataOptions& options = shotData.ShotDataOptions;
+        if (options.IsHeartBeat) {
+            return verdict;
+        }
+
+        float values[PADDED_FIELD_COUNT] = {};
+        std::memcpy(values, &shotData.BallData, sizeof(float) * BALL_FIELD_COUNT);
+        std::memcpy(values + BALL_FIELD_COUNT, &shotData.ClubData, sizeof(float) * (SHOT_FIELD_COUNT - BALL_FIELD_COUNT));
+
+        // Every field gets the same compares, NaN fails the range; the masks pick out what counts.  Written as
+        // selects of each field's bit rather than shifts so the loop vectorizes.
+        size_t system = indexOf(shotData.unitSystem());
+        const float* minimum = this->minimums[system];
+        const float* maximum = this->maximums[system];
+        uint32_t missing = 0;
+        uint32_t outside = 0;
+        for (size_t field = 0; field < PADDED_FIELD_COUNT; field++) {
+            float value = values[field];
+            missing |= value != value ? FIELD_BITS[field] : 0;
+            outside |= (value >= minimum[field]) & (value <= maximum[field]) ? 0 : FIELD_BITS[field];
+        }
+        uint32_t reported = (options.ContainsBallData ? BALL_FIELDS : 0) | (options.ContainsClubData ? CLUB_FIELDS : 0);
+        uint32_t missingFailed = missing & this->required & reported;
+        uint32_t rangeFailed = outside & ~missing & reported;
+
+        // A NaN on either side compares false and passes, the three are only checked against each other when reported.
+        // Components of 0 are a monitor that only measures TotalSpin.  Not hypot(), its overflow handling costs more
+        // than the rest of the check; a square overflowing is a mismatch.
+        const BallData& ball = shotData.BallData;
+        float components = std::sqrt(ball.BackSpin * ball.BackSpin + ball.SideSpin * ball.SideSpin);
+        float tolerance = std::max(this->validationRules.SpinToleranceRpm, this->validationRules.SpinToleranceRatio * std::fabs(ball.TotalSpin));
+        bool spinMismatch = options.ContainsBallData & (this->validationRules.SpinToleranceRpm >= 0.0f)
+            & (components != 0.0f) & (std::fabs(std::fabs(ball.TotalSpin) - components) > tolerance);
+
+        if (missingFailed != 0) {
+            verdict.Rejection = ShotRejection::MissingValue;
+            verdict.Fields = missingFailed;
+        }
+        else if (rangeFailed != 0) {
+            verdict.Rejection = ShotRejection::OutOfRange;
+            verdict.Fields = rangeFailed;
+        }
+        else if (spinMismatch) {
+            verdict.Rejection = ShotRejection::SpinMismatch;
+            verdict.Fields = SPIN_FIELDS;
+        }
+        return verdict;
+    }
+
+    ShotVerdict ShotValidator::validate(const ShotData& shotData, ShotHistory& history) const {
+        ShotVerdict verdict = this->check(shotData);
+        if (!verdict.accepted() || shotData.ShotDataOptions.IsHeartBeat) {
+            return verdict;
+        }
+
+        // Rejected shots aren't remembered, a corrected resend of the same number still gets through
+        if (this->validationRules.RejectDuplicates && history.HasShot && history.LastShotNumber == shotData.ShotNumber) {
+            verdict.Rejection = ShotRejection::DuplicateShotNumber;
+            return verdict;
+        }
+        history.HasShot = true;
+        history.LastShotNumber = shotData.ShotNumber;
+        return verdict;
+    }
+}
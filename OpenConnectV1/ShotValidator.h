@@ -0,0 +1,97 @@
+#ifndef OPEN_CONNECT_SHOT_VALIDATOR_H
+#define OPEN_CONNECT_SHOT_VALIDATOR_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include "Data.h"
+#include "ShotStore.h"
+#include "Units.h"
+
+namespace OpenConnectV1 {
+    // Why a shot was rejected, in the order the checks are made
+    enum class ShotRejection : uint8_t {
+        None = 0,
+        MissingValue,           // A required field is NaN
+        OutOfRange,             // A field is outside its range
+        SpinMismatch,           // TotalSpin isn't the magnitude of BackSpin and SideSpin
+        DuplicateShotNumber,    // Same ShotNumber as the connection's last accepted shot
+        Count
+    };
+    constexpr size_t SHOT_REJECTION_COUNT = static_cast<size_t>(ShotRejection::Count);
+
+    const char* toString(ShotRejection rejection);
+
+    // Allowed values of one field; NaN (not reported) passes unless the field is required
+    struct FieldRule {
+        float Min = -std::numeric_limits<float>::infinity();
+        float Max = std::numeric_limits<float>::infinity();
+        bool Required = false;
+    };
+
+    /**
+     * What a shot must look like to reach the listeners.  Ranges are in the Yards system (mph, yards, degrees,
+     * rpm) and apply to Meters shots converted; the defaults only reject what no launch monitor can measure.
+     */
+    struct ShotValidationRules {
+        // Indexed by ShotField
+        std::array<FieldRule, SHOT_FIELD_COUNT> Fields;
+        // |TotalSpin - hypot(BackSpin, SideSpin)| may be up to the larger of these, checked when all three are
+        // reported and BackSpin or SideSpin isn't 0.  Off by default (a negative tolerance): monitors measure
+        // TotalSpin on its own and don't all keep it consistent with the components.
+        float SpinToleranceRpm = -1.0f;
+        float SpinToleranceRatio = 0.05f;
+        // Drop a shot with the same ShotNumber as the last one accepted from the connection, or from the host's
+        // previous connection when a monitor reconnects and resends it
+        bool RejectDuplicates = true;
+
+        ShotValidationRules();
+
+        FieldRule& operator[](ShotField field) { return this->Fields[static_cast<size_t>(field)]; }
+        const FieldRule& operator[](ShotField field) const { return this->Fields[static_cast<size_t>(field)]; }
+    };
+
+    // Duplicate suppression state of one connection
+    struct ShotHistory {
+        bool HasShot = false;
+        int LastShotNumber = 0;
+    };
+
+    struct ShotVerdict {
+        ShotRejection Rejection = ShotRejection::None;
+        uint32_t Fields = 0;        // Bit ShotField of every field that failed its rule
+
+        bool accepted() const { return this->Rejection == ShotRejection::None; }
+    };
+
+    /**
+     * Checks decoded shots against ShotValidationRules.  The rules are compiled once into per unit system bound
+     * arrays, a shot is then checked with the same comparisons for every field and a mask of what it reports
+     * rather than a branch per rule.  Heartbeats carry no shot and are always accepted.
+     *
+     * Immutable once constructed, every ShotHistory belongs to one thread.
+     */
+    class ShotValidator {
+    public:
+        explicit ShotValidator(const ShotValidationRules& rules = ShotValidationRules());
+
+        // The field and spin rules only
+        ShotVerdict check(const ShotData& shotData) const;
+        // The duplicate rule as well; an accepted shot becomes history's last shot
+        ShotVerdict validate(const ShotData& shotData, ShotHistory& history) const;
+
+        const ShotValidationRules& rules() const { return this->validationRules; }
+
+        // The fields rounded up to whole 8 float vectors, the padding always passes
+        static constexpr size_t PADDED_FIELD_COUNT = 24;
+
+    private:
+        ShotValidationRules validationRules;
+        alignas(32) float minimums[UNIT_SYSTEM_COUNT][PADDED_FIELD_COUNT];
+        alignas(32) float maximums[UNIT_SYSTEM_COUNT][PADDED_FIELD_COUNT];
+        uint32_t required = 0;
+    };
+}
+
+#endif
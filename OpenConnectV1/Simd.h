@@ -0,0 +1,22 @@
+#ifndef OPEN_CONNECT_SIMD_H
+#define OPEN_CONNECT_SIMD_H
+
+// Internal to the library's translation units: which x86 SIMD paths can be compiled, and the attributes that
+// let a function use an instruction set the rest of the build doesn't assume.  Whether the CPU has it is
+// supportedSimdLevel()'s business (ColumnStats.h).
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define OPEN_CONNECT_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC compiles any intrinsic without extra flags
+#define OPEN_CONNECT_TARGET_SSE2
+#define OPEN_CONNECT_TARGET_AVX2
+#else
+#define OPEN_CONNECT_TARGET_SSE2 __attribute__((target("sse2")))
+#define OPEN_CONNECT_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+#endif
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "Logger.h"
+#include "TimerWheel.h"
+
+namespace OpenConnectV1 {
+    namespace {
+        constexpr uint64_t SPAN_TICKS = uint64_t(1) << (TimerWheel::SLOT_BITS * TimerWheel::LEVELS);
+    }
+
+    TimerWheel::TimerWheel(int64_t tickMs, int64_t nowMs)
+        : tickMs(tickMs), originMs(nowMs), currentTick(0) {
+        if (tickMs <= 0) {
+            OC_LOG_ERROR("Invalid timer wheel tick of %lld ms", static_cast<long long>(tickMs));
+            throw std::runtime_error("Timer wheel tick must be positive");
+        }
+        this->slots.fill(NONE);
+    }
+
+    void TimerWheel::schedule(uint64_t key, int64_t deadlineMs) {
+        // Rounded up, so the timer can't fire before its deadline
+        int64_t sinceOrigin = deadlineMs - this->originMs;
+        uint64_t expiry = sinceOrigin <= 0 ? 0 : static_cast<uint64_t>((sinceOrigin + this->tickMs - 1) / this->tickMs);
+        expiry = std::min(std::max(expiry, this->currentTick + 1), this->currentTick + SPAN_TICKS - 1);
+
+        uint32_t node;
+        auto it = this->timers.find(key);
+        if (it != this->timers.end()) {
+            node = it->second;
+            this->unlink(node);
+        }
+        else {
+            if (this->freeNodes.empty()) {
+                node = static_cast<uint32_t>(this->nodes.size());
+                this->nodes.emplace_back();
+            }
+            else {
+                node = this->freeNodes.back();
+                this->freeNodes.pop_back();
+            }
+            this->timers.emplace(key, node);
+        }
+
+        this->nodes[node].Key = key;
+        this->nodes[node].Expiry = expiry;
+        this->link(node);
+    }
+
+    bool TimerWheel::cancel(uint64_t key) {
+        auto it = this->timers.find(key);
+        if (it == this->timers.end()) {
+            return false;
+        }
+        this->unlink(it->second);
+        this->freeNodes.push_back(it->second);
+        this->timers.erase(it);
+        return true;
+    }
+
+    bool TimerWheel::contains(uint64_t key) const {
+        return this->timers.count(key) > 0;
+    }
+
+    size_t TimerWheel::size() const {
+        return this->timers.size();
+    }
+
+    void TimerWheel::advance(int64_t nowMs, std::vector<uint64_t>& expired) {
+        if (nowMs < this->originMs) {
+            return;
+        }
+        uint64_t target = static_cast<uint64_t>((nowMs - this->originMs) / this->tickMs);
+        while (this->currentTick < target) {
+            if (this->timers.empty()) {
+                // Nothing can expire on the way, an idle wheel doesn't tick through the gap
+                this->currentTick = target;
+                return;
+            }
+            this->tick(expired);
+        }
+    }
+
+    int64_t TimerWheel::nextExpiryMs(int64_t nowMs) const {
+        if (this->timers.empty()) {
+            return -1;
+        }
+
+        // The nearest non-empty slot on the bottom level, or the next cascade if that comes first
+        uint64_t next = (this->currentTick | (SLOTS - 1)) + 1;
+        for (uint64_t tick = this->currentTick + 1; tick < next; tick++) {
+            if (this->slots[tick & (SLOTS - 1)] != NONE) {
+                next = tick;
+                break;
+            }
+        }
+
+        int64_t dueMs = this->originMs + static_cast<int64_t>(next) * this->tickMs;
+        return std::max<int64_t>(dueMs - nowMs, 0);
+    }
+
+    void TimerWheel::link(uint32_t node) {
+        Node& entry = this->nodes[node];
+        uint64_t delta = entry.Expiry - this->currentTick;
+
+        size_t level = 0;
+        while (level + 1 < LEVELS && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+            level++;
+        }
+        size_t slot = level * SLOTS + static_cast<size_t>((entry.Expiry >> (SLOT_BITS * level)) & (SLOTS - 1));
+
+        entry.Slot = static_cast<uint32_t>(slot);
+        entry.Prev = NONE;
+        entry.Next = this->slots[slot];
+        if (entry.Next != NONE) {
+            this->nodes[entry.Next].Prev = node;
+        }
+        this->slots[slot] = node;
+    }
+
+    void TimerWheel::unlink(uint32_t node) {
+        Node& entry = this->nodes[node];
+        if (entry.Prev != NONE) {
+            this->nodes[entry.Prev].Next = entry.Next;
+        }
+        else {
+            this->slots[entry.Slot] = entry.Next;
+        }
+        if (entry.Next != NONE) {
+            this->nodes[entry.Next].Prev = entry.Prev;
+        }
+        entry.Prev = entry.Next = entry.Slot = NONE;
+    }
+
+    // Moves every timer in the slot down to where it belongs now that its turn has come
+    void TimerWheel::cascade(size_t level, size_t slot) {
+        uint32_t node = this->slots[level * SLOTS + slot];
+        this->slots[level * SLOTS + slot] = NONE;
+        while (node != NONE) {
+            uint32_t next = this->nodes[node].Next;
+            this->link(node);
+            node = next;
+        }
+    }
+
+    void TimerWheel::tick(std::vector<uint64_t>& expired) {
+        this->currentTick++;
+
+        // Higher levels are cascaded whenever every level below them wraps around
+        for (size_t level = 1; level < LEVELS; level++) {
+            if ((this->currentTick & ((uint64_t(1) << (SLOT_BITS * level)) - 1)) != 0) {
+                break;
+            }
+            this->cascade(level, static_cast<size_t>((this->currentTick >> (SLOT_BITS * level)) & (SLOTS - 1)));
+        }
+
+        size_t slot = static_cast<size_t>(this->currentTick & (SLOTS - 1));
+        uint32_t node = this->slots[slot];
+        this->slots[slot] = NONE;
+        while (node != NONE) {
+            Node& entry = this->nodes[node];
+            uint32_t next = entry.Next;
+            expired.push_back(entry.Key);
+            this->timers.erase(entry.Key);
+            entry.Prev = entry.Next = entry.Slot = NONE;
+            this->freeNodes.push_back(node);
+            node = next;
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef OPEN_CONNECT_TIMER_WHEEL_H
+#define OPEN_CONNECT_TIMER_WHEEL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace OpenConnectV1 {
+    /**
+     * Hierarchical timer wheel (four levels of 64 slots) of one-shot timers identified by a key.  Arming,
+     * re-arming and cancelling a timer are O(1) whatever the number of timers, which is what makes pushing a
+     * connection's deadline back on every message cheap.  Timers are cascaded down a level as their slot comes
+     * up; deadlines further away than the wheel spans (64^4 ticks) are clamped to the end of the wheel.
+     *
+     * Times are milliseconds on any monotonic clock.  Timers never fire early, and at most a tick late.
+     * Not thread safe.
+     */
+    class TimerWheel {
+    public:
+        static constexpr size_t LEVELS = 4;
+        static constexpr size_t SLOT_BITS = 6;
+        static constexpr size_t SLOTS = size_t(1) << SLOT_BITS;
+
+        TimerWheel(int64_t tickMs, int64_t nowMs);
+
+        // Arms the key's timer, replacing the deadline it had
+        void schedule(uint64_t key, int64_t deadlineMs);
+        // Returns false when the key had no timer
+        bool cancel(uint64_t key);
+        bool contains(uint64_t key) const;
+        size_t size() const;
+
+        // Moves the wheel on to nowMs, appending the keys whose timers expired (and are now disarmed) to expired
+        void advance(int64_t nowMs, std::vector<uint64_t>& expired);
+        // Milliseconds from nowMs until advance() has anything to do, -1 while no timer is armed
+        int64_t nextExpiryMs(int64_t nowMs) const;
+
+    private:
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        struct Node {
+            uint64_t Key = 0;
+            uint64_t Expiry = 0;        // Tick
+            uint32_t Prev = NONE;
+            uint32_t Next = NONE;
+            uint32_t Slot = NONE;       // Index into slots
+        };
+
+        int64_t tickMs;
+        int64_t originMs;
+        uint64_t currentTick;           // Every tick up to this one has been processed
+
+        std::array<uint32_t, LEVELS * SLOTS> slots;     // Head node of each slot's list
+        std::vector<Node> nodes;
+        std::vector<uint32_t> freeNodes;
+        std::unordered_map<uint64_t, uint32_t> timers;  // Key to node
+
+        void link(uint32_t node);
+        void unlink(uint32_t node);
+        void cascade(size_t level, size_t slot);
+        void tick(std::vector<uint64_t>& expired);
+    };
+}
+
+#endif
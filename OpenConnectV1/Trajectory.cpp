@@ -0,0 +1,434 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "ColumnStats.h"
+#include "Logger.h"
+#include "Simd.h"
+#include "Trajectory.h"
+
+// The SIMD entry points inline the whole flight into themselves, so the pack operators get their target
+#if defined(_MSC_VER) && !defined(__clang__)
+#define OPEN_CONNECT_FLATTEN
+#else
+#define OPEN_CONNECT_FLATTEN __attribute__((flatten))
+#endif
+
+namespace OpenConnectV1 {
+    namespace {
+        constexpr float PI = 3.14159265f;
+        constexpr float GRAVITY = 9.80665f;
+        constexpr float BALL_MASS = 0.04593f;       // kg, the most the rules allow
+        constexpr float BALL_RADIUS = 0.021335f;    // m, 1.68 inches across
+        constexpr float MPH = 0.44704f;             // m/s
+        constexpr float RPM = 2 * PI / 60;          // rad/s
+        constexpr float DEGREES = PI / 180;
+        constexpr size_t LANES = 8;
+
+        // Drag and lift coefficients by spin factor (radius * angular speed / speed) from 0 to 0.5, for a dimpled
+        // ball above the drag crisis; spin factors beyond the table use its last entry.
+        constexpr float SPIN_FACTOR_STEP = 0.05f;
+        constexpr size_t TABLE_SIZE = 11;
+        constexpr float DRAG[TABLE_SIZE] = { 0.210f, 0.215f, 0.225f, 0.240f, 0.255f, 0.270f, 0.285f, 0.300f, 0.315f, 0.330f, 0.345f };
+        constexpr float LIFT[TABLE_SIZE] = { 0.000f, 0.100f, 0.170f, 0.210f, 0.240f, 0.260f, 0.275f, 0.285f, 0.295f, 0.300f, 0.305f };
+
+        // A table rewritten as a sum of hinges, base + sum of slope[k] * max(0, spinFactor - k * step), so that looking
+        // a coefficient up is arithmetic rather than a gather and vectorizes
+        struct Hinges {
+            float Base = 0;
+            float Slope[TABLE_SIZE - 1] = {};
+        };
+
+        constexpr Hinges hingesOf(const float (&table)[TABLE_SIZE]) {
+            Hinges hinges;
+            hinges.Base = table[0];
+            float previous = 0;
+            for (size_t k = 0; k + 1 < TABLE_SIZE; k++) {
+                float slope = (table[k + 1] - table[k]) / SPIN_FACTOR_STEP;
+                hinges.Slope[k] = slope - previous;
+                previous = slope;
+            }
+            return hinges;
+        }
+
+        constexpr Hinges DRAG_HINGES = hingesOf(DRAG);
+        constexpr Hinges LIFT_HINGES = hingesOf(LIFT);
+
+        struct Constants {
+            float DragScale;        // Air density * cross section / (2 * mass)
+            float Step;
+            float HalfStepDecay;    // Spin kept over half a step
+            float StepDecay;
+            size_t SampleSteps;     // Steps between path points
+            size_t MaxSteps;
+        };
+
+        // Where a shot starts: its velocity and its spin about a fixed axis
+        struct Launch {
+            bool Valid = false;
+            float VX = 0, VY = 0, VZ = 0;
+            float Spin = 0;         // rad/s
+            float AxisX = 0, AxisY = 0, AxisZ = 0;
+        };
+
+        template <size_t N>
+        struct Lanes {
+            float X[N], Y[N], Z[N];
+            float VX[N], VY[N], VZ[N];
+            float Spin[N];
+            float AxisX[N], AxisY[N], AxisZ[N];
+        };
+
+        Constants constantsOf(const TrajectoryOptions& options) {
+            Constants constants;
+            constants.DragScale = options.AirDensity * PI * BALL_RADIUS * BALL_RADIUS / (2 * BALL_MASS);
+            constants.Step = options.TimeStep;
+            constants.HalfStepDecay = std::pow(1 - options.SpinDecay, options.TimeStep / 2);
+            constants.StepDecay = std::pow(1 - options.SpinDecay, options.TimeStep);
+            constants.SampleSteps = std::max<size_t>(1, static_cast<size_t>(std::lround(options.SampleInterval / options.TimeStep)));
+            constants.MaxSteps = static_cast<size_t>(std::ceil(options.MaxFlightTime / options.TimeStep));
+            return constants;
+        }
+
+        Launch launchOf(const BallData& ball) {
+            Launch launch;
+            if (std::isnan(ball.Speed) || std::isnan(ball.VLA)) {
+                return launch;
+            }
+            launch.Valid = true;
+
+            float speed = ball.Speed * MPH;
+            float vla = ball.VLA * DEGREES;
+            float hla = std::isnan(ball.HLA) ? 0 : ball.HLA * DEGREES;
+            launch.VX = speed * std::cos(vla) * std::cos(hla);
+            launch.VY = speed * std::sin(vla);
+            launch.VZ = speed * std::cos(vla) * std::sin(hla);
+
+            float backSpin = 0;
+            float sideSpin = 0;
+            if (!std::isnan(ball.BackSpin) && !std::isnan(ball.SideSpin)) {
+                backSpin = ball.BackSpin;
+                sideSpin = ball.SideSpin;
+            }
+            else if (!std::isnan(ball.TotalSpin)) {
+                float axis = std::isnan(ball.SpinAxis) ? 0 : ball.SpinAxis * DEGREES;
+                backSpin = ball.TotalSpin * std::cos(axis);
+                sideSpin = ball.TotalSpin * std::sin(axis);
+            }
+            else if (!std::isnan(ball.BackSpin)) {
+                backSpin = ball.BackSpin;
+            }
+
+            // Pure backspin spins about the horizontal axis to the right of the launch direction, lifting the ball;
+            // tilting that axis by the spin axis angle turns some of the lift sideways.
+            float tilt = std::atan2(sideSpin, backSpin);
+            launch.Spin = std::sqrt(backSpin * backSpin + sideSpin * sideSpin) * RPM;
+            launch.AxisX = -std::cos(tilt) * std::sin(hla);
+            launch.AxisY = -std::sin(tilt);
+            launch.AxisZ = std::cos(tilt) * std::cos(hla);
+            return launch;
+        }
+
+        template <size_t N>
+        void place(Lanes<N>& lanes, size_t lane, const Launch& launch) {
+            lanes.X[lane] = lanes.Y[lane] = lanes.Z[lane] = 0;
+            lanes.VX[lane] = launch.VX;
+            lanes.VY[lane] = launch.VY;
+            lanes.VZ[lane] = launch.VZ;
+            lanes.Spin[lane] = launch.Spin;
+            lanes.AxisX[lane] = launch.AxisX;
+            lanes.AxisY[lane] = launch.AxisY;
+            lanes.AxisZ[lane] = launch.AxisZ;
+        }
+
+        // A pack of WIDTH lanes and the few operations the flight needs.  The steps are written once against these
+        // and flown with a scalar, an SSE2 or an AVX2 pack.
+        struct ScalarPack {
+            static constexpr size_t WIDTH = 1;
+            float V;
+
+            ScalarPack(float value) : V(value) {}
+            static ScalarPack load(const float* p) { return *p; }
+            void store(float* p) const { *p = this->V; }
+        };
+
+        inline ScalarPack operator+(ScalarPack a, ScalarPack b) { return a.V + b.V; }
+        inline ScalarPack operator-(ScalarPack a, ScalarPack b) { return a.V - b.V; }
+        inline ScalarPack operator*(ScalarPack a, ScalarPack b) { return a.V * b.V; }
+        inline ScalarPack operator/(ScalarPack a, ScalarPack b) { return a.V / b.V; }
+        inline ScalarPack sqrt(ScalarPack a) { return std::sqrt(a.V); }
+        inline ScalarPack min(ScalarPack a, ScalarPack b) { return a.V < b.V ? a.V : b.V; }
+        inline ScalarPack max(ScalarPack a, ScalarPack b) { return a.V > b.V ? a.V : b.V; }
+
+#ifdef OPEN_CONNECT_X86
+        struct Sse2Pack {
+            static constexpr size_t WIDTH = 4;
+            __m128 V;
+
+            OPEN_CONNECT_TARGET_SSE2 Sse2Pack(__m128 value) : V(value) {}
+            OPEN_CONNECT_TARGET_SSE2 Sse2Pack(float value) : V(_mm_set1_ps(value)) {}
+            OPEN_CONNECT_TARGET_SSE2 static Sse2Pack load(const float* p) { return _mm_loadu_ps(p); }
+            OPEN_CONNECT_TARGET_SSE2 void store(float* p) const { _mm_storeu_ps(p, this->V); }
+        };
+
+        OPEN_CONNECT_TARGET_SSE2 inline Sse2Pack operator+(Sse2Pack a, Sse2Pack b) { return _mm_add_ps(a.V, b.V); }
+        OPEN_CONNECT_TARGET_SSE2 inline Sse2Pack operator-(Sse2Pack a, Sse2Pack b) { return _mm_sub_ps(a.V, b.V); }
+        OPEN_CONNECT_TARGET_SSE2 inline Sse2Pack operator*(Sse2Pack a, Sse2Pack b) { return _mm_mul_ps(a.V, b.V); }
+        OPEN_CONNECT_TARGET_SSE2 inline Sse2Pack operator/(Sse2Pack a, Sse2Pack b) { return _mm_div_ps(a.V, b.V); }
+        OPEN_CONNECT_TARGET_SSE2 inline Sse2Pack sqrt(Sse2Pack a) { return _mm_sqrt_ps(a.V); }
+        OPEN_CONNECT_TARGET_SSE2 inline Sse2Pack min(Sse2Pack a, Sse2Pack b) { return _mm_min_ps(a.V, b.V); }
+        OPEN_CONNECT_TARGET_SSE2 inline Sse2Pack max(Sse2Pack a, Sse2Pack b) { return _mm_max_ps(a.V, b.V); }
+
+        struct Avx2Pack {
+            static constexpr size_t WIDTH = 8;
+            __m256 V;
+
+            OPEN_CONNECT_TARGET_AVX2 Avx2Pack(__m256 value) : V(value) {}
+            OPEN_CONNECT_TARGET_AVX2 Avx2Pack(float value) : V(_mm256_set1_ps(value)) {}
+            OPEN_CONNECT_TARGET_AVX2 static Avx2Pack load(const float* p) { return _mm256_loadu_ps(p); }
+            OPEN_CONNECT_TARGET_AVX2 void store(float* p) const { _mm256_storeu_ps(p, this->V); }
+        };
+
+        OPEN_CONNECT_TARGET_AVX2 inline Avx2Pack operator+(Avx2Pack a, Avx2Pack b) { return _mm256_add_ps(a.V, b.V); }
+        OPEN_CONNECT_TARGET_AVX2 inline Avx2Pack operator-(Avx2Pack a, Avx2Pack b) { return _mm256_sub_ps(a.V, b.V); }
+        OPEN_CONNECT_TARGET_AVX2 inline Avx2Pack operator*(Avx2Pack a, Avx2Pack b) { return _mm256_mul_ps(a.V, b.V); }
+        OPEN_CONNECT_TARGET_AVX2 inline Avx2Pack operator/(Avx2Pack a, Avx2Pack b) { return _mm256_div_ps(a.V, b.V); }
+        OPEN_CONNECT_TARGET_AVX2 inline Avx2Pack sqrt(Avx2Pack a) { return _mm256_sqrt_ps(a.V); }
+        OPEN_CONNECT_TARGET_AVX2 inline Avx2Pack min(Avx2Pack a, Avx2Pack b) { return _mm256_min_ps(a.V, b.V); }
+        OPEN_CONNECT_TARGET_AVX2 inline Avx2Pack max(Avx2Pack a, Avx2Pack b) { return _mm256_max_ps(a.V, b.V); }
+#endif
+
+        template <typename Pack>
+        inline Pack coefficient(const Hinges& hinges, Pack spinFactor) {
+            Pack clamped = min(spinFactor, Pack(SPIN_FACTOR_STEP * (TABLE_SIZE - 1)));
+            Pack value = hinges.Base;
+            for (size_t k = 0; k + 1 < TABLE_SIZE; k++) {
+                value = value + Pack(hinges.Slope[k]) * max(clamped - Pack(SPIN_FACTOR_STEP * k), Pack(0.0f));
+            }
+            return value;
+        }
+
+        template <typename Pack>
+        struct Vector {
+            Pack X, Y, Z;
+        };
+
+        // Drag, lift and gravity for velocity v with spin (already decayed) about axis
+        template <typename Pack>
+        inline Vector<Pack> accelerate(const Constants& c, const Vector<Pack>& v, Pack spin, const Vector<Pack>& axis) {
+            Pack speed = sqrt(v.X * v.X + v.Y * v.Y + v.Z * v.Z);
+            Pack spinFactor = Pack(BALL_RADIUS) * spin / (speed + Pack(1e-6f));
+            Pack k = Pack(c.DragScale) * speed;
+            Pack drag = k * coefficient(DRAG_HINGES, spinFactor);
+            Pack lift = k * coefficient(LIFT_HINGES, spinFactor);
+            return {
+                lift * (axis.Y * v.Z - axis.Z * v.Y) - drag * v.X,
+                lift * (axis.Z * v.X - axis.X * v.Z) - drag * v.Y - Pack(GRAVITY),
+                lift * (axis.X * v.Y - axis.Y * v.X) - drag * v.Z
+            };
+        }
+
+        template <typename Pack>
+        inline Vector<Pack> advance(const Vector<Pack>& v, Pack h, const Vector<Pack>& a) {
+            return { v.X + h * a.X, v.Y + h * a.Y, v.Z + h * a.Z };
+        }
+
+        // One RK4 step for every lane, WIDTH lanes at a time.  The accelerations don't depend on the position, only
+        // the velocities are staged.
+        template <typename Pack, size_t N>
+        inline void step(const Constants& c, Lanes<N>& s) {
+            static_assert(N % Pack::WIDTH == 0, "Lanes must be a multiple of the pack width");
+            const Pack h = c.Step;
+            const Pack half = c.Step / 2;
+            const Pack sixth = c.Step / 6;
+            const Pack two = 2.0f;
+
+            for (size_t l = 0; l < N; l += Pack::WIDTH) {
+                Vector<Pack> v1 = { Pack::load(s.VX + l), Pack::load(s.VY + l), Pack::load(s.VZ + l) };
+                Vector<Pack> axis = { Pack::load(s.AxisX + l), Pack::load(s.AxisY + l), Pack::load(s.AxisZ + l) };
+                Pack spin = Pack::load(s.Spin + l);
+                Pack halfSpin = spin * Pack(c.HalfStepDecay);
+                Pack endSpin = spin * Pack(c.StepDecay);
+
+                Vector<Pack> a1 = accelerate(c, v1, spin, axis);
+                Vector<Pack> v2 = advance(v1, half, a1);
+                Vector<Pack> a2 = accelerate(c, v2, halfSpin, axis);
+                Vector<Pack> v3 = advance(v1, half, a2);
+                Vector<Pack> a3 = accelerate(c, v3, halfSpin, axis);
+                Vector<Pack> v4 = advance(v1, h, a3);
+                Vector<Pack> a4 = accelerate(c, v4, endSpin, axis);
+
+                (Pack::load(s.X + l) + sixth * (v1.X + two * (v2.X + v3.X) + v4.X)).store(s.X + l);
+                (Pack::load(s.Y + l) + sixth * (v1.Y + two * (v2.Y + v3.Y) + v4.Y)).store(s.Y + l);
+                (Pack::load(s.Z + l) + sixth * (v1.Z + two * (v2.Z + v3.Z) + v4.Z)).store(s.Z + l);
+                (v1.X + sixth * (a1.X + two * (a2.X + a3.X) + a4.X)).store(s.VX + l);
+                (v1.Y + sixth * (a1.Y + two * (a2.Y + a3.Y) + a4.Y)).store(s.VY + l);
+                (v1.Z + sixth * (a1.Z + two * (a2.Z + a3.Z) + a4.Z)).store(s.VZ + l);
+                endSpin.store(s.Spin + l);
+            }
+        }
+
+        // Fills the summary from where the lane was fraction of the way between the last two steps
+        template <size_t N>
+        void land(const TrajectoryOptions& options, const Lanes<N>& before, const Lanes<N>& after, size_t l,
+            float fraction, float time, float apex, FlightSummary& summary) {
+            auto between = [fraction](float a, float b) { return a + fraction * (b - a); };
+            float x = between(before.X[l], after.X[l]);
+            float z = between(before.Z[l], after.Z[l]);
+            float vx = between(before.VX[l], after.VX[l]);
+            float vy = between(before.VY[l], after.VY[l]);
+            float vz = between(before.VZ[l], after.VZ[l]);
+            float spinRpm = between(before.Spin[l], after.Spin[l]) / RPM;
+
+            summary.Carry = x;
+            summary.Offline = z;
+            summary.Apex = apex;
+            summary.FlightTime = time;
+            float horizontal = std::sqrt(vx * vx + vz * vz);
+            summary.DescentAngle = std::atan2(-vy, horizontal) / DEGREES;
+
+            float checkUp = std::max(0.0f, 1 - spinRpm / options.SpinStopRpm);
+            float rollSpeed = horizontal * options.GroundRetention * checkUp;
+            float rollDistance = rollSpeed * rollSpeed / (2 * options.RollingDeceleration);
+            float dx = horizontal > 0 ? vx / horizontal : 1;
+            float dz = horizontal > 0 ? vz / horizontal : 0;
+            summary.Roll = rollDistance * dx;
+            summary.Total = x + summary.Roll;
+            summary.RestOffline = z + rollDistance * dz;
+        }
+
+        // Steps every lane until each one has landed (or MaxFlightTime is up); lanes already marked landed are
+        // carried along but never summarized.  The path, when there is one, follows lane 0.
+        template <typename Pack, size_t N>
+        inline void fly(const TrajectoryOptions& options, const Constants& c, Lanes<N>& s, bool* landed,
+            FlightSummary* summaries, std::vector<TrajectoryPoint>* path) {
+            float apex[N];
+            size_t flying = 0;
+            for (size_t l = 0; l < N; l++) {
+                apex[l] = 0;
+                flying += landed[l] ? 0 : 1;
+            }
+            if (path != nullptr) {
+                path->push_back({ 0, 0, 0, 0 });
+            }
+
+            for (size_t n = 1; n <= c.MaxSteps && flying > 0; n++) {
+                Lanes<N> before = s;
+                step<Pack, N>(c, s);
+                for (size_t l = 0; l < N; l++) {
+                    apex[l] = s.Y[l] > apex[l] ? s.Y[l] : apex[l];
+                }
+
+                float time = n * c.Step;
+                for (size_t l = 0; l < N; l++) {
+                    if (landed[l] || !(s.Y[l] < 0 && s.VY[l] < 0)) {
+                        continue;
+                    }
+                    float fraction = before.Y[l] / (before.Y[l] - s.Y[l]);
+                    land<N>(options, before, s, l, fraction, time - c.Step * (1 - fraction), apex[l], summaries[l]);
+                    landed[l] = true;
+                    flying--;
+                    if (path != nullptr && l == 0) {
+                        path->push_back({ summaries[l].FlightTime, summaries[l].Carry, 0, summaries[l].Offline });
+                    }
+                }
+
+                if (path != nullptr && !landed[0] && n % c.SampleSteps == 0) {
+                    path->push_back({ time, s.X[0], s.Y[0], s.Z[0] });
+                }
+            }
+
+            // Cut short, summarized where they are
+            for (size_t l = 0; l < N; l++) {
+                if (!landed[l]) {
+                    land<N>(options, s, s, l, 0, c.MaxSteps * c.Step, apex[l], summaries[l]);
+                }
+            }
+        }
+
+        void flyScalar(const TrajectoryOptions& options, const Constants& c, Lanes<LANES>& s, bool* landed,
+            FlightSummary* summaries) {
+            fly<ScalarPack, LANES>(options, c, s, landed, summaries, nullptr);
+        }
+
+#ifdef OPEN_CONNECT_X86
+        OPEN_CONNECT_TARGET_SSE2 OPEN_CONNECT_FLATTEN void flySse2(const TrajectoryOptions& options, const Constants& c,
+            Lanes<LANES>& s, bool* landed, FlightSummary* summaries) {
+            fly<Sse2Pack, LANES>(options, c, s, landed, summaries, nullptr);
+        }
+
+        OPEN_CONNECT_TARGET_AVX2 OPEN_CONNECT_FLATTEN void flyAvx2(const TrajectoryOptions& options, const Constants& c,
+            Lanes<LANES>& s, bool* landed, FlightSummary* summaries) {
+            fly<Avx2Pack, LANES>(options, c, s, landed, summaries, nullptr);
+        }
+#endif
+    }
+
+    TrajectoryEngine::TrajectoryEngine(const TrajectoryOptions& options) : settings(options) {
+        if (!(options.TimeStep > 0) || !(options.SampleInterval > 0) || !(options.MaxFlightTime > 0)
+            || !(options.AirDensity > 0)) {
+            OC_LOG_ERROR("Invalid trajectory options, step %f s, sample interval %f s, flight time %f s, air density %f",
+                options.TimeStep, options.SampleInterval, options.MaxFlightTime, options.AirDensity);
+            throw std::runtime_error("Trajectory step, sample interval, flight time and air density must be positive");
+        }
+        if (!(options.SpinDecay >= 0 && options.SpinDecay < 1) || !(options.GroundRetention >= 0)
+            || !(options.SpinStopRpm > 0) || !(options.RollingDeceleration > 0)) {
+            OC_LOG_ERROR("Invalid trajectory options, spin decay %f, ground retention %f, spin stop %f rpm, rolling deceleration %f",
+                options.SpinDecay, options.GroundRetention, options.SpinStopRpm, options.RollingDeceleration);
+            throw std::runtime_error("Invalid trajectory spin decay or ground model");
+        }
+    }
+
+    Trajectory TrajectoryEngine::simulate(const BallData& ball) const {
+        Trajectory trajectory;
+        Launch launch = launchOf(ball);
+        if (!launch.Valid) {
+            return trajectory;
+        }
+
+        Lanes<1> lanes;
+        place(lanes, 0, launch);
+        bool landed[1] = { false };
+        fly<ScalarPack, 1>(this->settings, constantsOf(this->settings), lanes, landed, &trajectory.Summary, &trajectory.Path);
+        return trajectory;
+    }
+
+    void TrajectoryEngine::simulate(const BallData* balls, size_t count, FlightSummary* summaries) const {
+        Constants constants = constantsOf(this->settings);
+        auto flyLanes = flyScalar;
+#ifdef OPEN_CONNECT_X86
+        switch (simdLevel()) {
+        case SimdLevel::AVX2:
+            flyLanes = flyAvx2;
+            break;
+        case SimdLevel::SSE2:
+            flyLanes = flySse2;
+            break;
+        default:
+            break;
+        }
+#endif
+
+        for (size_t first = 0; first < count; first += LANES) {
+            size_t shots = std::min(LANES, count - first);
+            Lanes<LANES> lanes;
+            bool landed[LANES];
+            FlightSummary flights[LANES];
+            for (size_t l = 0; l < LANES; l++) {
+                // Lanes without a shot fly a ball at rest, it never gets summarized
+                Launch launch = l < shots ? launchOf(balls[first + l]) : Launch();
+                place(lanes, l, launch);
+                landed[l] = !launch.Valid;
+            }
+
+            flyLanes(this->settings, constants, lanes, landed, flights);
+            std::copy(flights, flights + shots, summaries + first);
+        }
+    }
+
+    std::vector<FlightSummary> TrajectoryEngine::simulate(const std::vector<BallData>& balls) const {
+        std::vector<FlightSummary> summaries(balls.size());
+        this->simulate(balls.data(), balls.size(), summaries.data());
+        return summaries;
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef OPEN_CONNECT_TRAJECTORY_H
+#define OPEN_CONNECT_TRAJECTORY_H
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "Data.h"
+
+namespace OpenConnectV1 {
+    struct TrajectoryOptions {
+        float TimeStep = 0.01f;             // Seconds per RK4 step
+        float SampleInterval = 0.05f;       // Seconds between the points of a flight path
+        float MaxFlightTime = 20.0f;        // Seconds, a flight still in the air by then is cut short
+        float AirDensity = 1.225f;          // kg/m^3, sea level at 15 C
+        float SpinDecay = 0.04f;            // Fraction of the spin lost per second of flight
+        // Ground model: the ball keeps GroundRetention of its horizontal speed through the first bounce, less the
+        // closer its spin is to SpinStopRpm (where it checks up), then rolls out against RollingDeceleration.
+        float GroundRetention = 0.5f;
+        float SpinStopRpm = 10000.0f;
+        float RollingDeceleration = 2.5f;   // m/s^2
+    };
+
+    // Metres on a frame with x down the target line, y up and z to the right of the target line
+    struct TrajectoryPoint {
+        float Time;
+        float X;
+        float Y;
+        float Z;
+    };
+
+    // NaN when the BallData had no Speed or VLA to fly
+    struct FlightSummary {
+        float Carry = std::numeric_limits<float>::quiet_NaN();          // Metres down the target line to landing
+        float Offline = std::numeric_limits<float>::quiet_NaN();        // Metres right (+) or left (-) at landing
+        float Apex = std::numeric_limits<float>::quiet_NaN();           // Metres
+        float FlightTime = std::numeric_limits<float>::quiet_NaN();     // Seconds
+        float DescentAngle = std::numeric_limits<float>::quiet_NaN();   // Degrees below horizontal at landing
+        float Roll = std::numeric_limits<float>::quiet_NaN();           // Metres down the target line after landing
+        float Total = std::numeric_limits<float>::quiet_NaN();          // Metres down the target line at rest
+        float RestOffline = std::numeric_limits<float>::quiet_NaN();    // Metres right (+) or left (-) at rest
+    };
+
+    struct Trajectory {
+        FlightSummary Summary;
+        std::vector<TrajectoryPoint> Path;  // From the tee to the landing point, every SampleInterval
+    };
+
+    /**
+     * Ball flight from BallData (Speed in mph, VLA/HLA in degrees, spin in rpm): drag, lift from the spin
+     * (Magnus) and gravity integrated with a fixed step RK4, with the drag and lift coefficients looked up by
+     * spin factor.  BackSpin/SideSpin are used when present, TotalSpin/SpinAxis otherwise; a positive SpinAxis
+     * or SideSpin curves the ball right.  No wind, the air is still and the ground flat.
+     *
+     * The batched overload flies eight shots at a time, in AVX2 or SSE2 registers as simdLevel() allows (see
+     * ColumnStats.h).  Thread safe, the engine is immutable.
+     */
+    class TrajectoryEngine {
+    public:
+        // Throws std::runtime_error for a non-positive step, interval, flight time or density
+        explicit TrajectoryEngine(const TrajectoryOptions& options = TrajectoryOptions());
+
+        Trajectory simulate(const BallData& ball) const;
+        // Summaries only, summaries[i] is the flight of balls[i]
+        void simulate(const BallData* balls, size_t count, FlightSummary* summaries) const;
+        std::vector<FlightSummary> simulate(const std::vector<BallData>& balls) const;
+
+        const TrajectoryOptions& options() const { return this->settings; }
+
+    private:
+        TrajectoryOptions settings;
+    };
+}
+
+#endif
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "Logger.h"
+#include "TrajectorySolver.h"
+
+namespace OpenConnectV1 {
+    namespace {
+        void checkRows(size_t rows, size_t count) {
+            if (rows < count) {
+                OC_LOG_ERROR("Flight summary columns have %zu rows for %zu shots", rows, count);
+                throw std::runtime_error("Flight summary columns are too small for the shots");
+            }
+        }
+
+        // Flies the chunk starting at first and writes its rows; ballAt(i) is the BallData of shot i in mph
+        template <typename BallAt>
+        void solveChunk(const TrajectoryEngine& engine, size_t first, size_t count, BallAt ballAt,
+            FlightSummaryColumns& results) {
+            BallData balls[TrajectorySolver::CHUNK_SIZE];
+            FlightSummary summaries[TrajectorySolver::CHUNK_SIZE];
+            size_t shots = std::min(TrajectorySolver::CHUNK_SIZE, count - first);
+            for (size_t i = 0; i < shots; i++) {
+                balls[i] = ballAt(first + i);
+            }
+
+            engine.simulate(balls, shots, summaries);
+
+            for (size_t i = 0; i < shots; i++) {
+                size_t row = first + i;
+                results.Carry[row] = summaries[i].Carry;
+                results.Offline[row] = summaries[i].Offline;
+                results.Apex[row] = summaries[i].Apex;
+                results.FlightTime[row] = summaries[i].FlightTime;
+                results.DescentAngle[row] = summaries[i].DescentAngle;
+                results.Roll[row] = summaries[i].Roll;
+                results.Total[row] = summaries[i].Total;
+                results.RestOffline[row] = summaries[i].RestOffline;
+            }
+        }
+
+        BallData inMph(const BallData& ball, UnitSystem units) {
+            // The engine flies mph, whatever the shot was reported in
+            BallData converted = ball;
+            converted.Speed *= ballScales(units)[0] / ballScales(UnitSystem::Yards)[0];
+            return converted;
+        }
+    }
+
+    void FlightSummaryColumns::resize(size_t rows) {
+        for (std::vector<float>* column : { &this->Carry, &this->Offline, &this->Apex, &this->FlightTime,
+            &this->DescentAngle, &this->Roll, &this->Total, &this->RestOffline }) {
+            column->resize(rows, std::numeric_limits<float>::quiet_NaN());
+        }
+    }
+
+    FlightSummary FlightSummaryColumns::row(size_t index) const {
+        FlightSummary summary;
+        summary.Carry = this->Carry[index];
+        summary.Offline = this->Offline[index];
+        summary.Apex = this->Apex[index];
+        summary.FlightTime = this->FlightTime[index];
+        summary.DescentAngle = this->DescentAngle[index];
+        summary.Roll = this->Roll[index];
+        summary.Total = this->Total[index];
+        summary.RestOffline = this->RestOffline[index];
+        return summary;
+    }
+
+    TrajectorySolver::TrajectorySolver(const TrajectoryOptions& options, size_t threads)
+        : trajectoryEngine(options), pool(threads) {
+    }
+
+    void TrajectorySolver::solve(const BallData* balls, const UnitSystem* units, size_t count,
+        FlightSummaryColumns& results) {
+        checkRows(results.size(), count);
+        size_t chunks = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        this->pool.parallelFor(chunks, [&](size_t chunk) {
+            solveChunk(this->trajectoryEngine, chunk * CHUNK_SIZE, count, [balls, units](size_t i) {
+                return units != nullptr ? inMph(balls[i], units[i]) : balls[i];
+            }, results);
+        });
+    }
+
+    void TrajectorySolver::solve(const std::vector<ShotData>& shots, FlightSummaryColumns& results) {
+        checkRows(results.size(), shots.size());
+        size_t chunks = (shots.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        this->pool.parallelFor(chunks, [&](size_t chunk) {
+            solveChunk(this->trajectoryEngine, chunk * CHUNK_SIZE, shots.size(), [&shots](size_t i) {
+                const ShotData& shot = shots[i];
+                if (shot.ShotDataOptions.IsHeartBeat || !shot.ShotDataOptions.ContainsBallData) {
+                    // BallData() is all zeros, which would fly
+                    BallData missing;
+                    missing.Speed = std::numeric_limits<float>::quiet_NaN();
+                    return missing;
+                }
+                return inMph(shot.BallData, shot.unitSystem());
+            }, results);
+        });
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef OPEN_CONNECT_TRAJECTORY_SOLVER_H
+#define OPEN_CONNECT_TRAJECTORY_SOLVER_H
+
+#include <cstddef>
+#include <vector>
+#include "Data.h"
+#include "Trajectory.h"
+#include "Units.h"
+#include "WorkStealingPool.h"
+
+namespace OpenConnectV1 {
+    // FlightSummary fields column by column, one row per shot
+    struct FlightSummaryColumns {
+        std::vector<float> Carry;
+        std::vector<float> Offline;
+        std::vector<float> Apex;
+        std::vector<float> FlightTime;
+        std::vector<float> DescentAngle;
+        std::vector<float> Roll;
+        std::vector<float> Total;
+        std::vector<float> RestOffline;
+
+        FlightSummaryColumns() = default;
+        explicit FlightSummaryColumns(size_t rows) { this->resize(rows); }
+
+        void resize(size_t rows);
+        size_t size() const { return this->Carry.size(); }
+        FlightSummary row(size_t index) const;
+    };
+
+    /**
+     * Flies whole shot histories across a WorkStealingPool.  The shots are cut into CHUNK_SIZE chunks that are
+     * flown with TrajectoryEngine's batched overload and written straight into the result columns, so the
+     * results are the same whatever the number of threads.
+     */
+    class TrajectorySolver {
+    public:
+        static constexpr size_t CHUNK_SIZE = 256;
+
+        // Threads counts the calling thread, 0 uses every hardware thread
+        explicit TrajectorySolver(const TrajectoryOptions& options = TrajectoryOptions(), size_t threads = 0);
+
+        // Row i of results is the flight of balls[i], reported in units[i]; units may be null when every shot is
+        // in Yards (mph).  Throws std::runtime_error when results has fewer than count rows, it is never resized
+        // here.
+        void solve(const BallData* balls, const UnitSystem* units, size_t count, FlightSummaryColumns& results);
+        // Heartbeats and shots without BallData get a NaN row
+        void solve(const std::vector<ShotData>& shots, FlightSummaryColumns& results);
+
+        const TrajectoryEngine& engine() const { return this->trajectoryEngine; }
+        size_t threadCount() const { return this->pool.threadCount(); }
+
+    private:
+        TrajectoryEngine trajectoryEngine;
+        WorkStealingPool pool;
+    };
+}
+
+#endif
@@ -0,0 +1,17 @@
+#include "Transport.h"
+
+#ifdef _WIN32
+#include "WinsockTransport.h"
+#else
+#include "EpollTransport.h"
+#endif
+
+namespace OpenConnectV1 {
+    std::unique_ptr<Transport> createTransport() {
+#ifdef _WIN32
+        return std::make_unique<WinsockTransport>();
+#else
+        return std::make_unique<EpollTransport>();
+#endif
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef OPEN_CONNECT_TRANSPORT_H
+#define OPEN_CONNECT_TRANSPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace OpenConnectV1 {
+    using ConnectionId = uint64_t;
+    constexpr ConnectionId INVALID_CONNECTION = 0;
+
+    // One piece of a gather write
+    struct SendBuffer {
+        const char* Data;
+        size_t Length;
+    };
+
+    /**
+     * Receives readiness events from a Transport; all calls are made on the thread running Transport::run().
+     */
+    class TransportHandler {
+    public:
+        virtual ~TransportHandler() = default;
+        virtual void onAccepted(ConnectionId connection, const std::string& address) = 0;
+        // The connection has bytes (or a hang up) waiting, drain it with Transport::receive()
+        virtual void onReadable(ConnectionId connection) = 0;
+        // Called before every wait for events, for the handler's timers.  Returns how long (in milliseconds) the
+        // transport may wait before calling it again, negative for no limit.
+        virtual int onTimer() { return -1; }
+        // The connection has room to send again, while Transport::watchWritable() is enabled for it
+        virtual void onWritable(ConnectionId connection) {}
+        // Transport::wake() was called
+        virtual void onWake() {}
+    };
+
+    /**
+     * Non-blocking, readiness based socket layer used by the Server.  The platform implementations are
+     * WinsockTransport (WSAPoll) and EpollTransport (Linux epoll).
+     */
+    class Transport {
+    public:
+        virtual ~Transport() = default;
+
+        // Binds and listens on the port, throws std::runtime_error on failure
+        virtual void open(int port) = 0;
+        // Runs the event loop on the calling thread until stop() is called, then closes every socket
+        virtual void run(TransportHandler& handler) = 0;
+        // Safe to call from any thread, wakes run() so it returns promptly
+        virtual void stop() = 0;
+        // Safe to call from any thread, makes run() call the handler's onWake() promptly
+        virtual void wake() = 0;
+
+        // Returns the number of bytes received, 0 when nothing is available yet and -1 when the peer closed
+        // the connection or it failed (the connection should then be closed).
+        virtual int receive(ConnectionId connection, char* buffer, size_t length) = 0;
+        // Writes as much of the buffers (in order) as the socket takes without blocking, in a single gather write.
+        // Returns the number of bytes written, 0 when the socket is full and -1 on failure.  Event loop thread only.
+        virtual int sendSome(ConnectionId connection, const SendBuffer* buffers, size_t count) = 0;
+        // While enabled the handler's onWritable() is called whenever the connection has room.  Event loop thread only.
+        virtual void watchWritable(ConnectionId connection, bool enabled) = 0;
+        virtual void close(ConnectionId connection) = 0;
+
+        // Limits the number of simultaneous connections, further clients wait in the listen backlog
+        virtual void setMaxConnections(size_t maxConnections) = 0;
+    };
+
+    // Creates the Transport for the current platform
+    std::unique_ptr<Transport> createTransport();
+}
+
+#endif
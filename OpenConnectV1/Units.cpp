@@ -0,0 +1,120 @@
+#include <cctype>
+#include <cstring>
+#include <type_traits>
+
+#include "Data.h"
+#include "Units.h"
+
+namespace OpenConnectV1 {
+    namespace {
+        constexpr size_t BALL_FLOATS = sizeof(BallData) / sizeof(float);
+        constexpr size_t CLUB_FLOATS = sizeof(ClubData) / sizeof(float);
+        static_assert(BALL_FLOATS == 8 && sizeof(BallData) == BALL_FLOATS * sizeof(float), "BallData has to be its floats");
+        static_assert(CLUB_FLOATS == 10 && sizeof(ClubData) == CLUB_FLOATS * sizeof(float), "ClubData has to be its floats");
+        static_assert(std::is_trivially_copyable<BallData>::value && std::is_trivially_copyable<ClubData>::value,
+            "BallData and ClubData are scaled as float arrays");
+
+        constexpr float MPH = 0.44704f;             // m/s
+        constexpr float YARD = 0.9144f;             // m
+        constexpr float DEGREE = 3.14159265f / 180; // rad
+        constexpr float RPM = 3.14159265f / 30;     // rad/s
+
+        // By UnitSystem, then by member
+        constexpr float BALL_SCALES[UNIT_SYSTEM_COUNT][BALL_FLOATS] = {
+            // Speed, SpinAxis, TotalSpin, BackSpin, SideSpin, HLA, VLA, CarryDistance
+            { MPH, DEGREE, RPM, RPM, RPM, DEGREE, DEGREE, YARD },
+            { 1, DEGREE, RPM, RPM, RPM, DEGREE, DEGREE, 1 },
+            { MPH, DEGREE, RPM, RPM, RPM, DEGREE, DEGREE, YARD }
+        };
+        constexpr float CLUB_SCALES[UNIT_SYSTEM_COUNT][CLUB_FLOATS] = {
+            // Speed, AngleOfAttack, FaceToTarget, Lie, Loft, Path, SpeedAtImpact, VerticalFaceImpact,
+            // HorizontalFaceImpact, ClosureRate (deg/s)
+            { MPH, DEGREE, DEGREE, DEGREE, DEGREE, DEGREE, MPH, 1, 1, DEGREE },
+            { 1, DEGREE, DEGREE, DEGREE, DEGREE, DEGREE, 1, 1, 1, DEGREE },
+            { MPH, DEGREE, DEGREE, DEGREE, DEGREE, DEGREE, MPH, 1, 1, DEGREE }
+        };
+
+        bool equalsIgnoringCase(std::string_view a, const char* b) {
+            size_t length = strlen(b);
+            if (a.size() != length) {
+                return false;
+            }
+            for (size_t i = 0; i < length; i++) {
+                if (std::tolower(static_cast<unsigned char>(a[i])) != b[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template <typename T, size_t N>
+        T scaled(const T& data, const float (&scales)[N]) {
+            float values[N];
+            memcpy(values, &data, sizeof(values));
+            for (size_t i = 0; i < N; i++) {
+                values[i] *= scales[i];
+            }
+            T result;
+            memcpy(&result, values, sizeof(values));
+            return result;
+        }
+
+        size_t indexOf(UnitSystem units) {
+            size_t index = static_cast<size_t>(units);
+            return index < UNIT_SYSTEM_COUNT ? index : static_cast<size_t>(UnitSystem::Unknown);
+        }
+    }
+
+    UnitSystem parseUnitSystem(std::string_view units) {
+        if (units.empty()) {
+            return UnitSystem::Yards;
+        }
+        for (const char* yards : { "yards", "yard", "yds", "yd", "imperial" }) {
+            if (equalsIgnoringCase(units, yards)) {
+                return UnitSystem::Yards;
+            }
+        }
+        for (const char* meters : { "meters", "metres", "meter", "metre", "m", "metric" }) {
+            if (equalsIgnoringCase(units, meters)) {
+                return UnitSystem::Meters;
+            }
+        }
+        return UnitSystem::Unknown;
+    }
+
+    const char* toString(UnitSystem units) {
+        switch (units) {
+        case UnitSystem::Yards: return "Yards";
+        case UnitSystem::Meters: return "Meters";
+        default: return "Unknown";
+        }
+    }
+
+    const float* ballScales(UnitSystem units) {
+        return BALL_SCALES[indexOf(units)];
+    }
+
+    const float* clubScales(UnitSystem units) {
+        return CLUB_SCALES[indexOf(units)];
+    }
+
+    BallData normalized(const BallData& ball, UnitSystem units) {
+        return scaled(ball, BALL_SCALES[indexOf(units)]);
+    }
+
+    ClubData normalized(const ClubData& club, UnitSystem units) {
+        return scaled(club, CLUB_SCALES[indexOf(units)]);
+    }
+
+    void normalize(const ShotData* shots, size_t count, BallData* balls, ClubData* clubs) {
+        for (size_t i = 0; i < count; i++) {
+            size_t units = indexOf(shots[i].unitSystem());
+            if (balls != nullptr) {
+                balls[i] = scaled(shots[i].BallData, BALL_SCALES[units]);
+            }
+            if (clubs != nullptr) {
+                clubs[i] = scaled(shots[i].ClubData, CLUB_SCALES[units]);
+            }
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef OPEN_CONNECT_UNITS_H
+#define OPEN_CONNECT_UNITS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "InternedString.h"
+
+namespace OpenConnectV1 {
+    struct BallData;
+    struct ClubData;
+    struct ShotData;
+
+    /**
+     * What ShotData::Units says the BallData/ClubData are reported in.  Yards: speeds in mph, distances in
+     * yards.  Meters: speeds in m/s, distances in metres.  Angles are degrees and spin rpm either way.  A
+     * missing Units is the spec's default, Yards; one that isn't recognized is Unknown and converted as Yards.
+     */
+    enum class UnitSystem : uint8_t {
+        Yards = 0,
+        Meters = 1,
+        Unknown = 2
+    };
+    constexpr size_t UNIT_SYSTEM_COUNT = 3;
+
+    // Case insensitive; "Yards", "Yard", "Yds", "Yd" or "Imperial", "Meters", "Metres", "Meter", "Metre", "M" or "Metric"
+    UnitSystem parseUnitSystem(std::string_view units);
+    // Same as parseUnitSystem(), read off the handle: a string is parsed once, when it's first interned
+    inline UnitSystem unitSystemOf(const InternedString& units) { return static_cast<UnitSystem>(units.unitSystemCode()); }
+    const char* toString(UnitSystem units);
+
+    // Factors from a unit system to SI (m/s, m, rad, rad/s), one per float of BallData (8) and ClubData (10)
+    // in member order.  The face impact offsets aren't dimensioned by Units and keep a factor of 1.
+    const float* ballScales(UnitSystem units);
+    const float* clubScales(UnitSystem units);
+
+    // The same data in SI.  NaN stays NaN.
+    BallData normalized(const BallData& ball, UnitSystem units);
+    ClubData normalized(const ClubData& club, UnitSystem units);
+    // Every shot's BallData/ClubData in SI, by each shot's UnitSystem; either output may be null
+    void normalize(const ShotData* shots, size_t count, BallData* balls, ClubData* clubs);
+}
+
+#endif
@@ -0,0 +1,339 @@
+#ifdef _WIN32
+
+#include <climits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <ws2tcpip.h>
+
+#include "WinsockTransport.h"
+#include "Logger.h"
+
+#pragma comment(lib, "Ws2_32.lib")
+
+namespace OpenConnectV1 {
+    namespace {
+        constexpr INT POLL_TIMEOUT_MS = 100;
+        constexpr size_t MAX_SEND_BUFFERS = 64;
+        constexpr ConnectionId WAKE_CONNECTION = UINT64_MAX;
+    }
+
+    WinsockTransport::WinsockTransport()
+        : serverAddress{} {
+        OC_LOG_DEBUG("Initializing Winsock; should get a popup asking for access to the network...");
+        int startupResult = WSAStartup(MAKEWORD(2, 2), &this->wsaData);
+        if (startupResult != 0) {
+            std::string errorMsg = "Failed to initialize WSAStartup, due to: " + std::to_string(WSAGetLastError());
+            OC_LOG_ERROR(errorMsg.c_str());
+            throw std::runtime_error(errorMsg);
+        }
+        this->initializeWakeSocket();
+    }
+
+    WinsockTransport::~WinsockTransport() {
+        OC_LOG_DEBUG("Shutting down Winsock.");
+        this->closeAll();
+        if (this->wakeSocket != INVALID_SOCKET) {
+            closesocket(this->wakeSocket);
+        }
+        WSACleanup();
+    }
+
+    // Without it wake() falls back to the poll timeout
+    void WinsockTransport::initializeWakeSocket() {
+        SOCKET wake = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (wake == INVALID_SOCKET) {
+            OC_LOG_ERROR("Unable to create the wake socket: %d", WSAGetLastError());
+            return;
+        }
+
+        SOCKADDR_IN address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+        int addressSize = sizeof(address);
+        u_long nonBlocking = 1;
+        if (bind(wake, reinterpret_cast<SOCKADDR*>(&address), sizeof(address)) == SOCKET_ERROR
+            || getsockname(wake, reinterpret_cast<SOCKADDR*>(&address), &addressSize) == SOCKET_ERROR
+            || connect(wake, reinterpret_cast<SOCKADDR*>(&address), sizeof(address)) == SOCKET_ERROR
+            || ioctlsocket(wake, FIONBIO, &nonBlocking) == SOCKET_ERROR) {
+            OC_LOG_ERROR("Unable to set up the wake socket: %d", WSAGetLastError());
+            closesocket(wake);
+            return;
+        }
+        this->wakeSocket = wake;
+    }
+
+    void WinsockTransport::open(int port) {
+        this->port = port;
+
+        try {
+            initializeSocket();
+            bindSocket();
+            listenOnSocket();
+        }
+        catch (const std::runtime_error&) {
+            this->closeAll();
+            throw;
+        }
+    }
+
+    void WinsockTransport::initializeSocket() {
+        OC_LOG_DEBUG("Creating listening socket...");
+        this->listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+        if (this->listenSocket == INVALID_SOCKET) {
+            std::string errorMsg = "Error at socket(): " + std::to_string(WSAGetLastError());
+            OC_LOG_ERROR(errorMsg.c_str());
+            throw std::runtime_error(errorMsg);
+        }
+
+        u_long nonBlocking = 1;
+        ioctlsocket(this->listenSocket, FIONBIO, &nonBlocking);
+    }
+
+    void WinsockTransport::bindSocket() {
+        this->serverAddress.sin_addr.s_addr = INADDR_ANY;
+        this->serverAddress.sin_family = AF_INET;
+        this->serverAddress.sin_port = htons(this->port);
+
+        OC_LOG_DEBUG("Attempting to bind to socket...");
+        auto bindResult = bind(this->listenSocket, reinterpret_cast<SOCKADDR*>(&this->serverAddress), sizeof(this->serverAddress));
+        if (bindResult == SOCKET_ERROR) {
+            std::string errorMsg = "Bind failed with error: " + std::to_string(WSAGetLastError());
+            OC_LOG_ERROR(errorMsg.c_str());
+            throw std::runtime_error(errorMsg);
+        }
+    }
+
+    void WinsockTransport::listenOnSocket() {
+        OC_LOG_DEBUG("Start listening on the requested port: %d...", this->port);
+        auto listenResult = listen(this->listenSocket, SOMAXCONN);
+        if (listenResult == SOCKET_ERROR) {
+            std::string errorMsg = "Listen failed with error: " + std::to_string(WSAGetLastError());
+            OC_LOG_ERROR(errorMsg.c_str());
+            throw std::runtime_error(errorMsg);
+        }
+    }
+
+    void WinsockTransport::run(TransportHandler& handler) {
+        std::vector<WSAPOLLFD> pollFds;
+        std::vector<ConnectionId> pollConnections;
+
+        while (!this->stopRequested.load()) {
+            pollFds.clear();
+            pollConnections.clear();
+            if (this->wakeSocket != INVALID_SOCKET) {
+                pollFds.push_back(WSAPOLLFD{ this->wakeSocket, POLLRDNORM, 0 });
+                pollConnections.push_back(WAKE_CONNECTION);
+            }
+            {
+                std::lock_guard<std::mutex> lock(this->connectionsMutex);
+                // Only poll the listen socket while below capacity, further clients wait in the backlog
+                if (this->connections.size() < this->maxConnections.load()) {
+                    pollFds.push_back(WSAPOLLFD{ this->listenSocket, POLLRDNORM, 0 });
+                    pollConnections.push_back(INVALID_CONNECTION);
+                }
+                for (auto& connection : this->connections) {
+                    SHORT events = static_cast<SHORT>(this->writableWatched.count(connection.first) ? POLLRDNORM | POLLWRNORM : POLLRDNORM);
+                    pollFds.push_back(WSAPOLLFD{ connection.second, events, 0 });
+                    pollConnections.push_back(connection.first);
+                }
+            }
+
+            // Polls at least every POLL_TIMEOUT_MS, to notice stop() and room for more connections
+            int timeout = handler.onTimer();
+            if (timeout < 0 || timeout > POLL_TIMEOUT_MS) {
+                timeout = POLL_TIMEOUT_MS;
+            }
+            int count = WSAPoll(pollFds.data(), static_cast<ULONG>(pollFds.size()), timeout);
+            if (count == SOCKET_ERROR) {
+                OC_LOG_ERROR("WSAPoll failed with error: %d", WSAGetLastError());
+                OC_LOG_DEBUG("See: https://learn.microsoft.com/en-us/windows/win32/api/winsock2/nf-winsock2-wsapoll ");
+                break;
+            }
+
+            for (size_t i = 0; i < pollFds.size() && count > 0 && !this->stopRequested.load(); i++) {
+                if (pollFds[i].revents == 0) {
+                    continue;
+                }
+                if (pollConnections[i] == WAKE_CONNECTION) {
+                    char datagram[64];
+                    while (recv(this->wakeSocket, datagram, sizeof(datagram), 0) > 0) {}
+                    handler.onWake();
+                }
+                else if (pollConnections[i] == INVALID_CONNECTION) {
+                    this->acceptConnections(handler);
+                }
+                else {
+                    // Errors and hang ups show up as readable, the receive() reports them
+                    if ((pollFds[i].revents & ~POLLWRNORM) != 0 && this->socketFor(pollConnections[i]) != INVALID_SOCKET) {
+                        handler.onReadable(pollConnections[i]);
+                    }
+                    if ((pollFds[i].revents & POLLWRNORM) != 0 && this->socketFor(pollConnections[i]) != INVALID_SOCKET) {
+                        handler.onWritable(pollConnections[i]);
+                    }
+                }
+            }
+        }
+
+        this->closeAll();
+    }
+
+    void WinsockTransport::stop() {
+        this->stopRequested.store(true);
+        this->wake();
+    }
+
+    void WinsockTransport::wake() {
+        if (this->wakeSocket != INVALID_SOCKET) {
+            char datagram = 1;
+            ::send(this->wakeSocket, &datagram, 1, 0);
+        }
+    }
+
+    void WinsockTransport::acceptConnections(TransportHandler& handler) {
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(this->connectionsMutex);
+                if (this->connections.size() >= this->maxConnections.load()) {
+                    return;
+                }
+            }
+
+            SOCKADDR_IN clientAddress{};
+            int clientAddressSize = sizeof(clientAddress);
+
+            OC_LOG_DEBUG("Attempting to accept client connection...");
+            SOCKET clientSocket = accept(this->listenSocket, reinterpret_cast<SOCKADDR*>(&clientAddress), &clientAddressSize);
+            if (clientSocket == INVALID_SOCKET) {
+                int error = WSAGetLastError();
+                if (error != WSAEWOULDBLOCK) {
+                    OC_LOG_ERROR("Accepting connection failed with error: %d", error);
+                    OC_LOG_DEBUG("See: https://learn.microsoft.com/en-us/windows/win32/api/winsock2/nf-winsock2-accept ");
+                }
+                return;
+            }
+
+            u_long nonBlocking = 1;
+            ioctlsocket(clientSocket, FIONBIO, &nonBlocking);
+
+            ConnectionId connection = this->nextConnectionId++;
+            {
+                std::lock_guard<std::mutex> lock(this->connectionsMutex);
+                this->connections[connection] = clientSocket;
+            }
+
+            char host[INET_ADDRSTRLEN]{};
+            inet_ntop(AF_INET, &clientAddress.sin_addr, host, sizeof(host));
+            handler.onAccepted(connection, std::string(host) + ":" + std::to_string(ntohs(clientAddress.sin_port)));
+        }
+    }
+
+    int WinsockTransport::receive(ConnectionId connection, char* buffer, size_t length) {
+        SOCKET clientSocket = this->socketFor(connection);
+        if (clientSocket == INVALID_SOCKET) {
+            return -1;
+        }
+
+        int bytesReceived = recv(clientSocket, buffer, static_cast<int>(length), 0);
+        if (bytesReceived > 0) {
+            return bytesReceived;
+        }
+        if (bytesReceived == 0) {
+            OC_LOG_DEBUG("Client closed the connection");
+            return -1;
+        }
+
+        int error = WSAGetLastError();
+        if (error == WSAEWOULDBLOCK) {
+            return 0;
+        }
+        OC_LOG_ERROR("Client disconnect or error: %d", error);
+        OC_LOG_DEBUG("See: https://learn.microsoft.com/en-us/windows/win32/api/winsock2/nf-winsock2-recv ");
+        return -1;
+    }
+
+    int WinsockTransport::sendSome(ConnectionId connection, const SendBuffer* buffers, size_t count) {
+        SOCKET clientSocket = this->socketFor(connection);
+        if (clientSocket == INVALID_SOCKET) {
+            return -1;
+        }
+
+        WSABUF wsaBuffers[MAX_SEND_BUFFERS];
+        DWORD bufferCount = 0;
+        size_t total = 0;
+        for (size_t i = 0; i < count && i < MAX_SEND_BUFFERS; i++) {
+            // The result has to fit the int, a shorter write is reported like any partial write
+            size_t length = buffers[i].Length;
+            if (total + length > static_cast<size_t>(INT_MAX)) {
+                if (bufferCount > 0) {
+                    break;
+                }
+                length = INT_MAX;
+            }
+            wsaBuffers[bufferCount].buf = const_cast<CHAR*>(buffers[i].Data);
+            wsaBuffers[bufferCount].len = static_cast<ULONG>(length);
+            bufferCount++;
+            total += length;
+        }
+
+        DWORD bytesSent = 0;
+        if (WSASend(clientSocket, wsaBuffers, bufferCount, &bytesSent, 0, nullptr, nullptr) == SOCKET_ERROR) {
+            int error = WSAGetLastError();
+            if (error == WSAEWOULDBLOCK) {
+                return 0;
+            }
+            OC_LOG_ERROR("Unable to send response to monitor/client: %d", error);
+            OC_LOG_DEBUG("See: https://learn.microsoft.com/en-us/windows/win32/api/winsock2/nf-winsock2-wsasend ");
+            return -1;
+        }
+        return static_cast<int>(bytesSent);
+    }
+
+    void WinsockTransport::watchWritable(ConnectionId connection, bool enabled) {
+        std::lock_guard<std::mutex> lock(this->connectionsMutex);
+        if (enabled && this->connections.count(connection)) {
+            this->writableWatched.insert(connection);
+        }
+        else {
+            this->writableWatched.erase(connection);
+        }
+    }
+
+    void WinsockTransport::close(ConnectionId connection) {
+        std::lock_guard<std::mutex> lock(this->connectionsMutex);
+        auto it = this->connections.find(connection);
+        if (it != this->connections.end()) {
+            closesocket(it->second);
+            this->connections.erase(it);
+        }
+        this->writableWatched.erase(connection);
+    }
+
+    void WinsockTransport::setMaxConnections(size_t maxConnections) {
+        this->maxConnections.store(maxConnections > 0 ? maxConnections : 1);
+    }
+
+    void WinsockTransport::closeAll() {
+        std::lock_guard<std::mutex> lock(this->connectionsMutex);
+        for (auto& connection : this->connections) {
+            closesocket(connection.second);
+        }
+        this->connections.clear();
+        this->writableWatched.clear();
+
+        if (this->listenSocket != INVALID_SOCKET) {
+            closesocket(this->listenSocket);
+            this->listenSocket = INVALID_SOCKET;
+        }
+        memset(&this->serverAddress, 0, sizeof(this->serverAddress));
+    }
+
+    SOCKET WinsockTransport::socketFor(ConnectionId connection) {
+        std::lock_guard<std::mutex> lock(this->connectionsMutex);
+        auto it = this->connections.find(connection);
+        return it == this->connections.end() ? INVALID_SOCKET : it->second;
+    }
+}
+
+#endif
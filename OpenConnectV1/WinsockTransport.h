@@ -0,0 +1,65 @@
+#ifndef OPEN_CONNECT_WINSOCK_TRANSPORT_H
+#define OPEN_CONNECT_WINSOCK_TRANSPORT_H
+
+#ifdef _WIN32
+
+#include <winsock2.h>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include "Transport.h"
+
+namespace OpenConnectV1 {
+    /**
+     * Windows Transport built on non-blocking Winsock sockets and WSAPoll.  WSAPoll can't be woken from another
+     * thread directly: wake() sends a datagram to a loopback UDP socket in the poll set, and the loop still polls
+     * with a short timeout to notice stop().
+     */
+    class WinsockTransport : public Transport {
+    public:
+        WinsockTransport();
+        ~WinsockTransport() override;
+
+        void open(int port) override;
+        void run(TransportHandler& handler) override;
+        void stop() override;
+        void wake() override;
+
+        int receive(ConnectionId connection, char* buffer, size_t length) override;
+        int sendSome(ConnectionId connection, const SendBuffer* buffers, size_t count) override;
+        void watchWritable(ConnectionId connection, bool enabled) override;
+        void close(ConnectionId connection) override;
+
+        void setMaxConnections(size_t maxConnections) override;
+
+    private:
+        int port = 0;
+        WSADATA wsaData;
+
+        SOCKET listenSocket = INVALID_SOCKET;
+        SOCKET wakeSocket = INVALID_SOCKET;     // Connected to itself
+        SOCKADDR_IN serverAddress;
+
+        std::atomic<bool> stopRequested{ false };
+        std::atomic<size_t> maxConnections{ 1 };
+
+        ConnectionId nextConnectionId = 1;
+        std::unordered_map<ConnectionId, SOCKET> connections;
+        std::unordered_set<ConnectionId> writableWatched;     // Guarded by connectionsMutex
+        std::mutex connectionsMutex;
+
+        void initializeWakeSocket();
+        void initializeSocket();
+        void bindSocket();
+        void listenOnSocket();
+        void acceptConnections(TransportHandler& handler);
+        void closeAll();
+
+        SOCKET socketFor(ConnectionId connection);
+    };
+}
+
+#endif
+
+#endif
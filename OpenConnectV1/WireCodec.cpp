@@ -0,0 +1,60 @@
+#include <algorithm>
+
+#include "BinaryCodec.h"
+#include "JsonCodec.h"
+#include "WireCodec.h"
+
+namespace OpenConnectV1 {
+    namespace {
+        const JsonCodec JSON_CODEC;
+        const BinaryCodec BINARY_CODEC;
+
+        template<typename Message>
+        std::string encodeString(const WireCodec& codec, const Message& message) {
+            std::string bytes(256, '\0');
+            size_t length = codec.encode(message, bytes.data(), bytes.size());
+            if (length > bytes.size()) {
+                bytes.resize(length);
+                codec.encode(message, bytes.data(), bytes.size());
+            }
+            bytes.resize(length);
+            return bytes;
+        }
+    }
+
+    const char* toString(WireFormat format) {
+        switch (format) {
+        case WireFormat::Json: return "Json";
+        case WireFormat::Binary: return "Binary";
+        default: return "Unknown";
+        }
+    }
+
+    std::string WireCodec::encodeToString(const ShotData& shotData) const {
+        return encodeString(*this, shotData);
+    }
+
+    std::string WireCodec::encodeToString(const Response& response) const {
+        return encodeString(*this, response);
+    }
+
+    const WireCodec& codecFor(WireFormat format) {
+        return format == WireFormat::Binary ? static_cast<const WireCodec&>(BINARY_CODEC) : JSON_CODEC;
+    }
+
+    bool negotiateWireFormat(std::string_view firstBytes, WireFormat& format, size_t& prefixLength) {
+        const std::string_view magic = BinaryCodec::MAGIC;
+        size_t compared = std::min(firstBytes.size(), magic.size());
+        if (firstBytes.substr(0, compared) != magic.substr(0, compared)) {
+            format = WireFormat::Json;
+            prefixLength = 0;
+            return true;
+        }
+        if (compared < magic.size()) {
+            return false;
+        }
+        format = WireFormat::Binary;
+        prefixLength = magic.size();
+        return true;
+    }
+}
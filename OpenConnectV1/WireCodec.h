@@ -0,0 +1,57 @@
+#ifndef OPEN_CONNECT_WIRE_CODEC_H
+#define OPEN_CONNECT_WIRE_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "Data.h"
+#include "MessageFramer.h"
+
+namespace OpenConnectV1 {
+    enum class WireFormat : uint8_t {
+        Json = 0,           // Open Connect V1, what launch monitors speak
+        Binary = 1          // Fixed layout little endian records, see BinaryCodec
+    };
+    constexpr size_t WIRE_FORMAT_COUNT = 2;
+
+    const char* toString(WireFormat format);
+
+    /**
+     * How ShotData and Response travel over a connection.  Every codec carries the same model, a message
+     * encoded by one decodes to what the other would have decoded from its own encoding.  Codecs are stateless,
+     * the instances from codecFor() are shared by every connection and thread.
+     */
+    class WireCodec {
+    public:
+        virtual ~WireCodec() = default;
+
+        virtual WireFormat format() const = 0;
+        // How a MessageFramer splits this codec's stream into the messages decode() takes
+        virtual MessageFramer::Framing framing() const = 0;
+
+        // Complete wire messages, framing included (a JSON document ends in a newline).  Returns the length of the
+        // message; when that is larger than cap the call should be repeated with a larger buffer.
+        virtual size_t encode(const ShotData& shotData, char* buf, size_t cap) const = 0;
+        virtual size_t encode(const Response& response, char* buf, size_t cap) const = 0;
+
+        // A message as MessageFramer::next() returns it.  Throw std::runtime_error when it is malformed.
+        virtual void decode(std::string_view message, ShotData& shotData) const = 0;
+        // decode(), but a heartbeat's BallData and ClubData may be left missing, for a caller that only wants its options
+        virtual void decodeSkippingHeartbeatData(std::string_view message, ShotData& shotData) const = 0;
+        virtual Response decodeResponse(std::string_view message) const = 0;
+
+        // encode() into a string of the right size
+        std::string encodeToString(const ShotData& shotData) const;
+        std::string encodeToString(const Response& response) const;
+    };
+
+    const WireCodec& codecFor(WireFormat format);
+
+    // Picks a connection's format from its first bytes: Binary when they are BinaryCodec::MAGIC (prefixLength
+    // is then its size, to be consumed), Json for anything else.  Returns false while the bytes received so far
+    // could still be the start of the magic.
+    bool negotiateWireFormat(std::string_view firstBytes, WireFormat& format, size_t& prefixLength);
+}
+
+#endif
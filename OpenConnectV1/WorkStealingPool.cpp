@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+
+#include "Logger.h"
+#include "WorkStealingPool.h"
+
+namespace OpenConnectV1 {
+    namespace {
+        // The pool whose loop the current thread is taking part in, if any
+        thread_local const WorkStealingPool* currentPool = nullptr;
+
+        uint64_t pack(uint64_t begin, uint64_t end) {
+            return begin << 32 | end;
+        }
+
+        size_t beginOf(uint64_t bounds) {
+            return static_cast<size_t>(bounds >> 32);
+        }
+
+        size_t endOf(uint64_t bounds) {
+            return static_cast<size_t>(bounds & 0xFFFFFFFFu);
+        }
+    }
+
+    WorkStealingPool::WorkStealingPool(size_t threads) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        this->participants = threads;
+        this->ranges = std::make_unique<Range[]>(threads);
+        this->workers.reserve(threads - 1);
+        for (size_t participant = 1; participant < threads; participant++) {
+            this->workers.emplace_back(&WorkStealingPool::workerLoop, this, participant);
+        }
+    }
+
+    WorkStealingPool::~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(this->stateMutex);
+            this->stopping = true;
+        }
+        this->wakeWorkers.notify_all();
+        for (std::thread& worker : this->workers) {
+            worker.join();
+        }
+    }
+
+    size_t WorkStealingPool::threadCount() const {
+        return this->participants;
+    }
+
+    void WorkStealingPool::parallelFor(size_t count, const std::function<void(size_t)>& item) {
+        if (count > std::numeric_limits<uint32_t>::max()) {
+            OC_LOG_ERROR("parallelFor over %zu items, at most %u are supported", count, std::numeric_limits<uint32_t>::max());
+            throw std::runtime_error("Too many items for one parallelFor");
+        }
+        if (this->workers.empty() || count <= 1 || currentPool == this) {
+            for (size_t i = 0; i < count; i++) {
+                item(i);
+            }
+            return;
+        }
+
+        std::lock_guard<std::mutex> loop(this->loopMutex);
+        for (size_t participant = 0; participant < this->participants; participant++) {
+            uint64_t begin = static_cast<uint64_t>(count) * participant / this->participants;
+            uint64_t end = static_cast<uint64_t>(count) * (participant + 1) / this->participants;
+            this->ranges[participant].bounds.store(pack(begin, end), std::memory_order_relaxed);
+        }
+        {
+            std::lock_guard<std::mutex> lock(this->stateMutex);
+            this->body = &item;
+            this->failed.store(false, std::memory_order_relaxed);
+            this->active = true;
+            this->generation++;
+        }
+        this->wakeWorkers.notify_all();
+
+        this->participate(0);
+
+        std::exception_ptr error;
+        {
+            // Every range is empty by now, what is left are items still running on the workers
+            std::unique_lock<std::mutex> lock(this->stateMutex);
+            while (this->busy > 0) {
+                this->workersDone.wait_for(lock, std::chrono::milliseconds(10));
+            }
+            this->active = false;
+            this->body = nullptr;
+            std::swap(error, this->failure);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void WorkStealingPool::workerLoop(size_t participant) {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(this->stateMutex);
+                while (!this->stopping && !(this->active && this->generation != seen)) {
+                    this->wakeWorkers.wait_for(lock, std::chrono::milliseconds(100));
+                }
+                if (this->stopping) {
+                    return;
+                }
+                seen = this->generation;
+                this->busy++;
+            }
+
+            this->participate(participant);
+
+            std::lock_guard<std::mutex> lock(this->stateMutex);
+            if (--this->busy == 0) {
+                this->workersDone.notify_all();
+            }
+        }
+    }
+
+    void WorkStealingPool::participate(size_t participant) {
+        const WorkStealingPool* previous = currentPool;
+        currentPool = this;
+
+        size_t item;
+        while (true) {
+            if (!this->takeFront(participant, item)) {
+                if (!this->steal(participant)) {
+                    break;
+                }
+                continue;
+            }
+            if (this->failed.load(std::memory_order_relaxed)) {
+                continue;
+            }
+            try {
+                (*this->body)(item);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(this->stateMutex);
+                if (!this->failure) {
+                    this->failure = std::current_exception();
+                }
+                this->failed.store(true, std::memory_order_relaxed);
+            }
+        }
+
+        currentPool = previous;
+    }
+
+    bool WorkStealingPool::takeFront(size_t participant, size_t& item) {
+        std::atomic<uint64_t>& bounds = this->ranges[participant].bounds;
+        uint64_t current = bounds.load(std::memory_order_acquire);
+        while (beginOf(current) < endOf(current)) {
+            if (bounds.compare_exchange_weak(current, pack(beginOf(current) + 1, endOf(current)), std::memory_order_acq_rel)) {
+                item = beginOf(current);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool WorkStealingPool::steal(size_t participant) {
+        while (true) {
+            size_t victim = participant;
+            uint64_t victimBounds = 0;
+            size_t largest = 0;
+            for (size_t other = 0; other < this->participants; other++) {
+                uint64_t bounds = this->ranges[other].bounds.load(std::memory_order_acquire);
+                size_t size = endOf(bounds) > beginOf(bounds) ? endOf(bounds) - beginOf(bounds) : 0;
+                if (other != participant && size > largest) {
+                    victim = other;
+                    victimBounds = bounds;
+                    largest = size;
+                }
+            }
+            if (largest == 0) {
+                return false;
+            }
+
+            // Items only ever leave a range, so its bounds can't come back to a value a stale CAS would match
+            size_t begin = beginOf(victimBounds);
+            size_t end = endOf(victimBounds);
+            size_t taken = (end - begin + 1) / 2;
+            if (this->ranges[victim].bounds.compare_exchange_strong(victimBounds, pack(begin, end - taken), std::memory_order_acq_rel)) {
+                // Our own range is empty, nobody else writes to it
+                this->ranges[participant].bounds.store(pack(end - taken, end), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+}
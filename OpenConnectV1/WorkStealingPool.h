@@ -0,0 +1,71 @@
+#ifndef OPEN_CONNECT_WORK_STEALING_POOL_H
+#define OPEN_CONNECT_WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace OpenConnectV1 {
+    /**
+     * Fixed set of worker threads for fork/join loops over independent items.
+     *
+     * parallelFor() hands every participant (the workers and the calling thread) a contiguous range of the
+     * items.  A participant takes items from the front of its own range and, once that is empty, steals the back
+     * half of the largest range left.  A range is a begin/end pair packed in one atomic word, so taking and
+     * stealing are a single CAS and no lock is held while items run.
+     *
+     * One loop runs at a time, concurrent callers wait their turn.  A parallelFor() from inside one of the
+     * pool's own items runs inline on that thread.
+     */
+    class WorkStealingPool {
+    public:
+        // Threads counts the calling thread, 0 uses every hardware thread
+        explicit WorkStealingPool(size_t threads = 0);
+        ~WorkStealingPool();
+
+        WorkStealingPool(const WorkStealingPool&) = delete;
+        WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+        // Runs item(i) for every i in [0, count) and returns once they are all done.  The first exception thrown
+        // by an item is rethrown here, items not yet started by then are skipped.
+        void parallelFor(size_t count, const std::function<void(size_t)>& item);
+
+        size_t threadCount() const;
+
+    private:
+        struct alignas(64) Range {
+            std::atomic<uint64_t> bounds{ 0 };     // Begin in the high half, end in the low half
+        };
+
+        std::vector<std::thread> workers;
+        std::unique_ptr<Range[]> ranges;
+        size_t participants;
+
+        std::mutex loopMutex;               // Held by the caller for the whole of a parallelFor()
+        std::mutex stateMutex;
+        std::condition_variable wakeWorkers;
+        std::condition_variable workersDone;
+        uint64_t generation = 0;            // Bumped for every loop, guarded by stateMutex
+        bool active = false;
+        bool stopping = false;
+        size_t busy = 0;                    // Workers inside the current loop
+
+        const std::function<void(size_t)>* body = nullptr;
+        std::atomic<bool> failed{ false };
+        std::exception_ptr failure;         // Guarded by stateMutex
+
+        void workerLoop(size_t participant);
+        void participate(size_t participant);
+        bool takeFront(size_t participant, size_t& item);
+        bool steal(size_t participant);
+    };
+}
+
+#endif
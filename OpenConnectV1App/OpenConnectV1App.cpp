@@ -14,7 +14,9 @@ private:
 public:
     ConsoleApp() : server() {}
 
-    void onShotDataReceived(const OpenConnectV1::ShotData& shotData) override {
+    void onShotDataReceived(const OpenConnectV1::ShotData& shotData) override {}
+
+    void onShotDataReceived(OpenConnectV1::ConnectionId connection, const OpenConnectV1::ShotData& shotData) override {
         std::cout << "Received ShotData:\n"
             << "DeviceID: " << shotData.DeviceID << "\n"
             << "Units: " << shotData.Units << "\n"
@@ -23,11 +25,16 @@ public:
             << std::endl;
 
         OpenConnectV1::Response response(OpenConnectV1::ResponseCode::OK, "Within the Listener", OpenConnectV1::PlayerData("RH", "DR"));
-        this->server.sendResponse(response);
+        this->server.sendResponse(connection, response);
     }
 
     void onStatusChanged(const OpenConnectV1::ServerStatus& status) override {
-        OpenConnectV1::Logger::info("Server Status: %s", status);
+        OpenConnectV1::Logger::info("Server Status: %d", static_cast<int>(status));
+    }
+
+    void onConnectionStatusChanged(const OpenConnectV1::ConnectionInfo& connection) override {
+        OpenConnectV1::Logger::info("Launch monitor %s: %s", connection.Address.c_str(),
+            connection.Status == OpenConnectV1::ServerStatus::Connected ? "connected" : "disconnected");
     }
 
     void run() {
@@ -89,8 +96,12 @@ public:
 
 int main() {
     OpenConnectV1::Logger::minLogLevel = OpenConnectV1::LogLevel::Debug;
+    // Keep the debug output off the network thread
+    OpenConnectV1::Logger::startAsync();
 
     ConsoleApp app;
     app.run();
+
+    OpenConnectV1::Logger::stopAsync();
     return 0;
 }
@@ -0,0 +1,46 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "AllocationCounter.h"
+
+namespace {
+    std::atomic<uint64_t> allocationCount{ 0 };
+    std::atomic<uint64_t> allocationBytes{ 0 };
+
+    void* countedAllocate(size_t size) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocationBytes.fetch_add(size, std::memory_order_relaxed);
+        if (void* p = std::malloc(size ? size : 1)) {
+            return p;
+        }
+        throw std::bad_alloc();
+    }
+}
+
+namespace OpenConnectV1Benchmarks {
+    uint64_t AllocationCounter::allocations() {
+        return allocationCount.load(std::memory_order_relaxed);
+    }
+
+    uint64_t AllocationCounter::bytes() {
+        return allocationBytes.load(std::memory_order_relaxed);
+    }
+}
+
+// Replacement global allocation functions, the aligned overloads are left alone since nothing on the paths we
+// measure uses over-aligned types.
+void* operator new(size_t size) { return countedAllocate(size); }
+void* operator new[](size_t size) { return countedAllocate(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAllocate(size); }
+    catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAllocate(size); }
+    catch (...) { return nullptr; }
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
@@ -0,0 +1,18 @@
+#ifndef OPEN_CONNECT_BENCHMARKS_ALLOCATION_COUNTER_H
+#define OPEN_CONNECT_BENCHMARKS_ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+namespace OpenConnectV1Benchmarks {
+    /**
+     * Counts every call to the global operator new made by the benchmark executable (see AllocationCounter.cpp)
+     * so benchmarks can report heap allocations per operation.
+     */
+    class AllocationCounter {
+    public:
+        static uint64_t allocations();
+        static uint64_t bytes();
+    };
+}
+
+#endif
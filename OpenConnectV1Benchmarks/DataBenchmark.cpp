@@ -0,0 +1,383 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "../OpenConnectV1/Data.h"
+#include "../OpenConnectV1/ResponseCache.h"
+#include "../OpenConnectV1/ShotValidator.h"
+#include "AllocationCounter.h"
+
+using namespace OpenConnectV1;
+using OpenConnectV1Benchmarks::AllocationCounter;
+
+namespace {
+    // Heartbeats carry zeroed ball/club data, ClubData::from_json requires every field to be present
+    const std::string HEARTBEAT = R"({"DeviceID":"GSPro LM 1.1","Units":"Yards","ShotNumber":0,"APIversion":"1","BallData":{"Speed":0.0,"SpinAxis":0.0,"TotalSpin":0.0,"BackSpin":0.0,"SideSpin":0.0,"HLA":0.0,"VLA":0.0,"CarryDistance":0.0},"ClubData":{"Speed":0.0,"AngleOfAttack":0.0,"FaceToTarget":0.0,"Lie":0.0,"Loft":0.0,"Path":0.0,"SpeedAtImpact":0.0,"VerticalFaceImpact":0.0,"HorizontalFaceImpact":0.0,"ClosureRate":0.0},"ShotDataOptions":{"ContainsBallData":false,"ContainsClubData":false,"LaunchMonitorIsReady":true,"LaunchMonitorBallDetected":true,"IsHeartBeat":true}})";
+    // Monitors without club tracking still send a zeroed ClubData
+    const std::string BALL_ONLY = R"({"DeviceID":"GSPro LM 1.1","Units":"Yards","ShotNumber":12,"APIversion":"1","BallData":{"Speed":147.5,"SpinAxis":-13.2,"TotalSpin":3250.0,"BackSpin":2500.0,"SideSpin":-800.0,"HLA":2.3,"VLA":14.3,"CarryDistance":256.5},"ClubData":{"Speed":0.0,"AngleOfAttack":0.0,"FaceToTarget":0.0,"Lie":0.0,"Loft":0.0,"Path":0.0,"SpeedAtImpact":0.0,"VerticalFaceImpact":0.0,"HorizontalFaceImpact":0.0,"ClosureRate":0.0},"ShotDataOptions":{"ContainsBallData":true,"ContainsClubData":false,"LaunchMonitorIsReady":true,"LaunchMonitorBallDetected":true,"IsHeartBeat":false}})";
+    const std::string FULL_SHOT = R"({"DeviceID":"GSPro LM 1.1","Units":"Yards","ShotNumber":13,"APIversion":"1","BallData":{"Speed":147.5,"SpinAxis":-13.2,"TotalSpin":3250.0,"BackSpin":2500.0,"SideSpin":-800.0,"HLA":2.3,"VLA":14.3,"CarryDistance":256.5},"ClubData":{"Speed":105.2,"AngleOfAttack":-1.2,"FaceToTarget":0.5,"Lie":60.1,"Loft":13.2,"Path":3.1,"SpeedAtImpact":104.9,"VerticalFaceImpact":-0.3,"HorizontalFaceImpact":0.2,"ClosureRate":1.5},"ShotDataOptions":{"ContainsBallData":true,"ContainsClubData":true,"LaunchMonitorIsReady":true,"LaunchMonitorBallDetected":true,"IsHeartBeat":false}})";
+    // NaN is written as null; fields the monitor didn't measure missing altogether, ClubData included
+    const std::string MISSING_FIELDS = R"({"DeviceID":"GSPro LM 1.1","Units":"Yards","ShotNumber":14,"APIversion":"1","BallData":{"Speed":147.5,"SpinAxis":null,"TotalSpin":3250.0,"BackSpin":null,"SideSpin":null,"HLA":2.3,"VLA":14.3},"ShotDataOptions":{"ContainsBallData":true,"ContainsClubData":false,"LaunchMonitorIsReady":true,"LaunchMonitorBallDetected":true,"IsHeartBeat":false}})";
+
+    struct Corpus {
+        const char* Name;
+        const std::string& Raw;
+        bool Complete;      // Every field present, as the json DOM from_json path requires
+    };
+
+    const Corpus CORPORA[] = {
+        { "heartbeat", HEARTBEAT, true },
+        { "ball", BALL_ONLY, true },
+        { "ball+club", FULL_SHOT, true },
+        { "missing", MISSING_FIELDS, false },
+    };
+
+    const Corpus& corpus(benchmark::State& state) {
+        const Corpus& corpus = CORPORA[state.range(0)];
+        state.SetLabel(corpus.Name);
+        return corpus;
+    }
+
+    void reportAllocations(benchmark::State& state, uint64_t before) {
+        state.counters["allocs/op"] = benchmark::Counter(
+            static_cast<double>(AllocationCounter::allocations() - before), benchmark::Counter::kAvgIterations);
+    }
+
+    void reportBytes(benchmark::State& state, size_t bytes) {
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+    }
+
+    const Response PLAYER_INFO(ResponseCode::PlayerInfo, "GSPro Player Information", PlayerData("RH", "DR"));
+    const std::string PLAYER_INFO_JSON = R"({"Code":201,"Message":"GSPro Player Information","Player":{"Club":"DR","Handed":"RH"}})";
+}
+
+// Current Server path prior to ShotData::decode: copy, json DOM, keyed lookups
+static void BM_ShotDataFromJsonDom(benchmark::State& state) {
+    const Corpus& shot = corpus(state);
+    if (!shot.Complete) {
+        // from_json looks missing keys up through const operator[], which asserts
+        state.SkipWithError("ShotData::from_json needs every field present");
+        return;
+    }
+    const std::string& raw = shot.Raw;
+    uint64_t before = AllocationCounter::allocations();
+
+    for (auto _ : state) {
+        std::string jsonStr(raw.data(), raw.size());
+        json j = json::parse(jsonStr);
+        ShotData shotData;
+        ShotData::from_json(j, shotData);
+        benchmark::DoNotOptimize(shotData);
+    }
+
+    reportAllocations(state, before);
+    reportBytes(state, raw.size());
+}
+BENCHMARK(BM_ShotDataFromJsonDom)->DenseRange(0, 3)->ArgName("corpus");
+
+static void BM_ShotDataDecode(benchmark::State& state) {
+    const std::string& raw = corpus(state).Raw;
+    ShotData shotData;
+    uint64_t before = AllocationCounter::allocations();
+
+    for (auto _ : state) {
+        ShotData::decode(raw, shotData);
+        benchmark::DoNotOptimize(shotData);
+    }
+
+    reportAllocations(state, before);
+    reportBytes(state, raw.size());
+}
+BENCHMARK(BM_ShotDataDecode)->DenseRange(0, 3)->ArgName("corpus");
+
+// What the server's validation stage adds to BM_ShotDataDecode, the duplicate check included
+static void BM_ShotDataValidate(benchmark::State& state) {
+    const std::string& raw = corpus(state).Raw;
+    ShotData shotData;
+    ShotData::decode(raw, shotData);
+    ShotValidator validator;
+    ShotHistory history;
+
+    for (auto _ : state) {
+        history.HasShot = false;
+        ShotVerdict verdict = validator.validate(shotData, history);
+        benchmark::DoNotOptimize(verdict);
+    }
+}
+BENCHMARK(BM_ShotDataValidate)->DenseRange(0, 3)->ArgName("corpus");
+
+// What the server pays per message while no listener wants heartbeats as ShotData, compare with
+// BM_ShotDataDecode on the same corpus: a heartbeat skips its data, a shot should cost what it always did
+static void BM_ShotDataDecodeSkippingHeartbeatData(benchmark::State& state) {
+    const std::string& raw = corpus(state).Raw;
+    ShotData shotData;
+    uint64_t before = AllocationCounter::allocations();
+
+    for (auto _ : state) {
+        ShotData::decodeSkippingHeartbeatData(raw, shotData);
+        benchmark::DoNotOptimize(shotData);
+    }
+
+    reportAllocations(state, before);
+    reportBytes(state, raw.size());
+}
+BENCHMARK(BM_ShotDataDecodeSkippingHeartbeatData)->DenseRange(0, 3)->ArgName("corpus");
+
+// What a listener pays to keep a shot; the strings are interned handles, so this is a plain copy
+static void BM_ShotDataCopy(benchmark::State& state) {
+    ShotData shotData;
+    ShotData::decode(FULL_SHOT, shotData);
+    std::vector<ShotData> kept;
+    kept.reserve(1024);
+    uint64_t before = AllocationCounter::allocations();
+
+    for (auto _ : state) {
+        if (kept.size() == kept.capacity()) {
+            kept.clear();
+        }
+        kept.push_back(shotData);
+        benchmark::DoNotOptimize(kept.back());
+    }
+
+    reportAllocations(state, before);
+    reportBytes(state, sizeof(ShotData));
+}
+BENCHMARK(BM_ShotDataCopy);
+
+static void BM_ShotDataToJsonDump(benchmark::State& state) {
+    ShotData shotData;
+    ShotData::decode(corpus(state).Raw, shotData);
+    uint64_t before = AllocationCounter::allocations();
+
+    size_t length = 0;
+
+    for (auto _ : state) {
+        json j;
+        to_json(j, shotData);
+        std::string jsonStr = j.dump();
+        length = jsonStr.size();
+        benchmark::DoNotOptimize(jsonStr);
+    }
+
+    reportAllocations(state, before);
+    reportBytes(state, length);
+}
+BENCHMARK(BM_ShotDataToJsonDump)->DenseRange(0, 3)->ArgName("corpus");
+
+static void BM_ShotDataEncode(benchmark::State& state) {
+    ShotData shotData;
+    ShotData::decode(corpus(state).Raw, shotData);
+    char buffer[1024];
+    size_t length = 0;
+    uint64_t before = AllocationCounter::allocations();
+
+    for (auto _ : state) {
+        length = encode(shotData, buffer, sizeof(buffer));
+        benchmark::DoNotOptimize(buffer);
+    }
+
+    reportAllocations(state, before);
+    reportBytes(state, length);
+}
+BENCHMARK(BM_ShotDataEncode)->DenseRange(0, 3)->ArgName("corpus");
+
+// The nested objects on their own, through the json DOM
+static void BM_BallDataFromJsonDom(benchmark::State& state) {
+    json shot = json::parse(corpus(state).Raw);
+    const std::string raw = shot["BallData"].dump();
+    uint64_t before = AllocationCounter::allocations();
+
+    for (auto _ : state) {
+        json j = json::parse(raw);
+        BallData ballData;
+        BallData::from_json(j, ballData);
+        benchmark::DoNotOptimize(ballData);
+    }
+
+    reportAllocations(state, before);
+    reportBytes(state, raw.size());
+}
+BENCHMARK(BM_BallDataFromJsonDom)->DenseRange(0, 3)->ArgName("corpus");
+
+static void BM_BallDataToJsonDump(benchmark::State& state) {
+    ShotData shotData;
+    ShotData::decode(corpus(state).Raw, shotData);
+    uint64_t before = AllocationCounter::allocations();
+    size_t length = 0;
+
+    for (auto _ : state) {
+        json j;
+        to_json(j, shotData.BallData);
+        std::string jsonStr = j.dump();
+        length = jsonStr.size();
+        benchmark::DoNotOptimize(jsonStr);
+    }
+
+    reportAllocations(state, before);
+    reportBytes(state, length);
+}
+BENCHMARK(BM_BallDataToJsonDump)->DenseRange(0, 3)->ArgName("corpus");
+
+static void BM_ClubDataFromJsonDom(benchmark::State& state) {
+    const Corpus& shot = corpus(state);
+    if (!shot.Complete) {
+        state.SkipWithError("ClubData::from_json needs every field present");
+        return;
+    }
+    const std::string raw = json::parse(shot.Raw)["ClubData"].dump();
+    uint64_t before = AllocationCounter::allocations();
+
+    for (auto _ : state) {
+        json j = json::parse(raw);
+        ClubData clubData;
+        ClubData::from_json(j, clubData);
+        benchmark::DoNotOptimize(clubData);
+    }
+
+    reportAllocations(state, before);
+    reportBytes(state, raw.size());
+}
+BENCHMARK(BM_ClubDataFromJsonDom)->DenseRange(0, 3)->ArgName("corpus");
+
+static void BM_ClubDataToJsonDump(benchmark::State& state) {
+    ShotData shotData;
+    ShotData::decode(corpus(state).Raw, shotData);
+    uint64_t before = AllocationCounter::allocations();
+    size_t length = 0;
+
+    for (auto _ : state) {
+        json j;
+        to_json(j, shotData.ClubData);
+        std::string jsonStr = j.dump();
+        length = jsonStr.size();
+        benchmark::DoNotOptimize(jsonStr);
+    }
+
+    reportAllocations(state, before);
+    reportBytes(state, length);
+}
+BENCHMARK(BM_ClubDataToJsonDump)->DenseRange(0, 3)->ArgName("corpus");
+
+static void BM_ShotDataOptionsFromJsonDom(benchmark::State& state) {
+    const std::string raw = json::parse(corpus(state).Raw)["ShotDataOptions"].dump();
+    uint64_t before = AllocationCounter::allocations();
+
+    for (auto _ : state) {
+        json j = json::parse(raw);
+        ShotDataOptions options;
+        ShotDataOptions::from_json(j, options);
+        benchmark::DoNotOptimize(options);
+    }
+
+    reportAllocations(state, before);
+    reportBytes(state, raw.size());
+}
+BENCHMARK(BM_ShotDataOptionsFromJsonDom)->DenseRange(0, 3)->ArgName("corpus");
+
+static void BM_ShotDataOptionsToJsonDump(benchmark::State& state) {
+    ShotData shotData;
+    ShotData::decode(corpus(state).Raw, shotData);
+    uint64_t before = AllocationCounter::allocations();
+    size_t length = 0;
+
+    for (auto _ : state) {
+        json j;
+        to_json(j, shotData.ShotDataOptions);
+        std::string jsonStr = j.dump();
+        length = jsonStr.size();
+        benchmark::DoNotOptimize(jsonStr);
+    }
+
+    reportAllocations(state, before);
+    reportBytes(state, length);
+}
+BENCHMARK(BM_ShotDataOptionsToJsonDump)->DenseRange(0, 3)->ArgName("corpus");
+
+// What a launch monitor does with the Server's reply
+static void BM_ResponseFromJsonDom(benchmark::State& state) {
+    uint64_t before = AllocationCounter::allocations();
+
+    for (auto _ : state) {
+        json j = json::parse(PLAYER_INFO_JSON);
+        Response response(static_cast<ResponseCode>(j["Code"].get<int>()), j["Message"].get<std::string>(),
+            PlayerData(j["Player"]["Handed"].get<std::string>(), j["Player"]["Club"].get<std::string>()));
+        benchmark::DoNotOptimize(response);
+    }
+
+    reportAllocations(state, before);
+    reportBytes(state, PLAYER_INFO_JSON.size());
+}
+BENCHMARK(BM_ResponseFromJsonDom);
+
+// Server::createJsonResponse prior to encode()
+static void BM_ResponseToJsonDump(benchmark::State& state) {
+    uint64_t before = AllocationCounter::allocations();
+    size_t length = 0;
+
+    for (auto _ : state) {
+        json j = {
+            {"Code", PLAYER_INFO.Code},
+            {"Message", PLAYER_INFO.Message},
+            {"Player", {
+                {"Handed", PLAYER_INFO.Player.Handed},
+                {"Club", PLAYER_INFO.Player.Club}
+            }}
+        };
+        std::string jsonStr = j.dump();
+        length = jsonStr.size();
+        benchmark::DoNotOptimize(jsonStr);
+    }
+
+    reportAllocations(state, before);
+    reportBytes(state, length);
+}
+BENCHMARK(BM_ResponseToJsonDump);
+
+static void BM_ResponseEncode(benchmark::State& state) {
+    char buffer[256];
+    size_t length = 0;
+    uint64_t before = AllocationCounter::allocations();
+
+    for (auto _ : state) {
+        length = encode(PLAYER_INFO, buffer, sizeof(buffer));
+        benchmark::DoNotOptimize(buffer);
+    }
+
+    reportAllocations(state, before);
+    reportBytes(state, length);
+}
+BENCHMARK(BM_ResponseEncode);
+
+// What Server::sendResponse pays for a response it has sent before
+static void BM_ResponseCacheHit(benchmark::State& state) {
+    ResponseCache cache;
+    size_t length = cache.get(PLAYER_INFO)->size();
+    uint64_t before = AllocationCounter::allocations();
+
+    for (auto _ : state) {
+        std::shared_ptr<const std::string> bytes = cache.get(PLAYER_INFO);
+        benchmark::DoNotOptimize(bytes);
+    }
+
+    reportAllocations(state, before);
+    reportBytes(state, length);
+}
+BENCHMARK(BM_ResponseCacheHit);
+
+// The same with the cache turned off: an encode into a freshly allocated buffer
+static void BM_ResponseCacheMiss(benchmark::State& state) {
+    ResponseCache cache(0);
+    size_t length = 0;
+    uint64_t before = AllocationCounter::allocations();
+
+    for (auto _ : state) {
+        std::shared_ptr<const std::string> bytes = cache.get(PLAYER_INFO);
+        length = bytes->size();
+        benchmark::DoNotOptimize(bytes);
+    }
+
+    reportAllocations(state, before);
+    reportBytes(state, length);
+}
+BENCHMARK(BM_ResponseCacheMiss);
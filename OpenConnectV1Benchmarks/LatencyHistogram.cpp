@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <limits>
+
+#include "LatencyHistogram.h"
+
+namespace OpenConnectV1Benchmarks {
+    namespace {
+        int highestBit(uint64_t value) {
+            int bit = 0;
+            for (int shift = 32; shift > 0; shift >>= 1) {
+                if (value >> shift) {
+                    value >>= shift;
+                    bit += shift;
+                }
+            }
+            return bit;
+        }
+    }
+
+    LatencyHistogram::LatencyHistogram() : counts(BUCKET_COUNT, 0) {
+        this->reset();
+    }
+
+    // Values below SUB_BUCKETS get a bucket each, above that every power of two is split into SUB_BUCKETS
+    size_t LatencyHistogram::indexOf(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return static_cast<size_t>(value);
+        }
+        int shift = highestBit(value) - SUB_BUCKET_BITS;
+        size_t subBucket = static_cast<size_t>(value >> shift) - SUB_BUCKETS;
+        return (static_cast<size_t>(shift) + 1) * SUB_BUCKETS + subBucket;
+    }
+
+    uint64_t LatencyHistogram::highestValueAt(size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+        uint64_t subBucket = index % SUB_BUCKETS + SUB_BUCKETS;
+        return ((subBucket + 1) << shift) - 1;
+    }
+
+    void LatencyHistogram::record(int64_t valueNs) {
+        int64_t value = std::max<int64_t>(valueNs, 0);
+        this->counts[indexOf(static_cast<uint64_t>(value))]++;
+        this->total++;
+        this->minValue = std::min(this->minValue, value);
+        this->maxValue = std::max(this->maxValue, value);
+        this->sum += static_cast<double>(value);
+    }
+
+    void LatencyHistogram::merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            this->counts[i] += other.counts[i];
+        }
+        this->total += other.total;
+        this->minValue = std::min(this->minValue, other.minValue);
+        this->maxValue = std::max(this->maxValue, other.maxValue);
+        this->sum += other.sum;
+    }
+
+    void LatencyHistogram::reset() {
+        std::fill(this->counts.begin(), this->counts.end(), 0);
+        this->total = 0;
+        this->minValue = std::numeric_limits<int64_t>::max();
+        this->maxValue = 0;
+        this->sum = 0;
+    }
+
+    uint64_t LatencyHistogram::count() const {
+        return this->total;
+    }
+
+    int64_t LatencyHistogram::min() const {
+        return this->total == 0 ? 0 : this->minValue;
+    }
+
+    int64_t LatencyHistogram::max() const {
+        return this->maxValue;
+    }
+
+    double LatencyHistogram::mean() const {
+        return this->total == 0 ? 0 : this->sum / static_cast<double>(this->total);
+    }
+
+    int64_t LatencyHistogram::percentile(double percentile) const {
+        if (this->total == 0) {
+            return 0;
+        }
+
+        double clamped = std::min(std::max(percentile, 0.0), 100.0);
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(clamped / 100.0 * static_cast<double>(this->total) + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            seen += this->counts[i];
+            if (seen >= rank) {
+                // The bucket bound can overshoot the largest value actually recorded
+                return std::min(static_cast<int64_t>(highestValueAt(i)), this->maxValue);
+            }
+        }
+        return this->maxValue;
+    }
+}
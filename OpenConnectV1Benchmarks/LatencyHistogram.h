@@ -0,0 +1,46 @@
+#ifndef OPEN_CONNECT_BENCHMARKS_LATENCY_HISTOGRAM_H
+#define OPEN_CONNECT_BENCHMARKS_LATENCY_HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace OpenConnectV1Benchmarks {
+    /**
+     * HDR style histogram of nanosecond values: log-linear buckets, 128 per power of two, so every recorded value
+     * is kept to within 1% over the whole 64 bit range in a fixed 58KB of counts.  Recording is a couple of shifts
+     * and an increment; not thread safe, merge() per thread histograms instead.
+     */
+    class LatencyHistogram {
+    public:
+        LatencyHistogram();
+
+        // Negative values (clock skew between threads) are recorded as 0
+        void record(int64_t valueNs);
+        void merge(const LatencyHistogram& other);
+        void reset();
+
+        uint64_t count() const;
+        int64_t min() const;
+        int64_t max() const;
+        double mean() const;
+        // Smallest value that percentile (0-100) of the recorded values are less than or equal to, within 1%
+        int64_t percentile(double percentile) const;
+
+    private:
+        static constexpr int SUB_BUCKET_BITS = 7;
+        static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+        static constexpr size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+        std::vector<uint64_t> counts;
+        uint64_t total;
+        int64_t minValue;
+        int64_t maxValue;
+        double sum;
+
+        static size_t indexOf(uint64_t value);
+        static uint64_t highestValueAt(size_t index);
+    };
+}
+
+#endif
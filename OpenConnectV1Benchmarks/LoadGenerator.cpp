@@ -0,0 +1,335 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "../OpenConnectV1/Data.h"
+#include "LoadGenerator.h"
+
+using namespace OpenConnectV1;
+
+namespace OpenConnectV1Benchmarks {
+    namespace {
+#ifdef _WIN32
+        using NativeSocket = SOCKET;
+        constexpr NativeSocket INVALID_NATIVE_SOCKET = INVALID_SOCKET;
+        int lastSocketError() { return WSAGetLastError(); }
+        void closeNativeSocket(NativeSocket s) { closesocket(s); }
+#else
+        using NativeSocket = int;
+        constexpr NativeSocket INVALID_NATIVE_SOCKET = -1;
+        int lastSocketError() { return errno; }
+        void closeNativeSocket(NativeSocket s) { close(s); }
+#endif
+
+        int64_t nowNs() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        ShotData makeMessage(bool heartbeat) {
+            ShotData shotData;
+            shotData.DeviceID = "OpenConnectV1 Load Generator";
+            shotData.Units = "Yards";
+            shotData.APIversion = "1";
+            if (heartbeat) {
+                shotData.ShotDataOptions = ShotDataOptions(false, false, true, false, true);
+            }
+            else {
+                shotData.BallData = BallData(147.5f, -13.2f, 3250.0f, 2500.0f, -800.0f, 2.3f, 14.3f, 256.5f);
+                shotData.ClubData = ClubData(105.2f, -1.2f, 0.5f, 60.1f, 13.2f, 3.1f, 104.9f, -0.3f, 0.2f, 1.5f);
+                shotData.ShotDataOptions = ShotDataOptions(true, true, true, true, false);
+            }
+            return shotData;
+        }
+
+        // Heartbeats are spread evenly through the stream rather than sent in a block
+        bool isHeartbeat(size_t message, double ratio) {
+            return std::floor((message + 1) * ratio) > std::floor(message * ratio);
+        }
+
+        void sendAll(NativeSocket s, const char* data, size_t length) {
+            while (length > 0) {
+                int sent = send(s, data, static_cast<int>(length), 0);
+                if (sent <= 0) {
+                    throw std::runtime_error("Load generator send failed, error code: " + std::to_string(lastSocketError()));
+                }
+                data += sent;
+                length -= static_cast<size_t>(sent);
+            }
+        }
+    }
+
+    class LoadGenerator::LatencyListener : public ServerListener {
+    public:
+        LatencyListener(const std::vector<std::atomic<int64_t>>& sendTimes, bool heartbeatsOnly)
+            : sendTimes(sendTimes), heartbeatsOnly(heartbeatsOnly) {}
+
+        void onShotDataReceived(const ShotData& shotData) override {}
+        void onStatusChanged(const ServerStatus& status) override {}
+
+        void onShotDataReceived(ConnectionId connection, const ShotData& shotData) override {
+            int64_t now = nowNs();
+            size_t sequence = static_cast<size_t>(shotData.ShotNumber);
+            if (shotData.ShotNumber < 0 || sequence >= this->sendTimes.size()) {
+                return;
+            }
+            this->latency.record(now - this->sendTimes[sequence].load(std::memory_order_acquire));
+            this->lastReceivedNs.store(now, std::memory_order_relaxed);
+            this->received.fetch_add(1, std::memory_order_release);
+        }
+
+        void onHeartbeat(ConnectionId connection, const ShotDataOptions& options) override {
+            if (this->heartbeatsOnly) {
+                this->lastReceivedNs.store(nowNs(), std::memory_order_relaxed);
+                this->received.fetch_add(1, std::memory_order_release);
+            }
+        }
+
+        // Only called while the listener isn't subscribed, or once received() shows every message arrived
+        void reset() {
+            this->latency.reset();
+            this->received.store(0);
+        }
+
+        uint64_t receivedCount() const { return this->received.load(std::memory_order_acquire); }
+        int64_t lastReceived() const { return this->lastReceivedNs.load(std::memory_order_relaxed); }
+        const LatencyHistogram& histogram() const { return this->latency; }
+
+    private:
+        const std::vector<std::atomic<int64_t>>& sendTimes;
+        bool heartbeatsOnly;    // Heartbeats come through onHeartbeat() alone
+        LatencyHistogram latency;
+        std::atomic<uint64_t> received{ 0 };
+        std::atomic<int64_t> lastReceivedNs{ 0 };
+    };
+
+    LoadGenerator::LoadGenerator(Server& server, const LoadProfile& profile)
+        : server(server), profile(profile), sendTimes(profile.Connections * profile.MessagesPerConnection) {
+        this->profile.Coalesce = std::max<size_t>(this->profile.Coalesce, 1);
+        if (this->profile.Threads == 0) {
+            this->profile.Threads = std::min<size_t>(this->profile.Connections, 4);
+        }
+        this->profile.Threads = std::max<size_t>(std::min(this->profile.Threads, this->profile.Connections), 1);
+        if (this->sendTimes.size() > static_cast<size_t>(INT32_MAX)) {
+            throw std::runtime_error("Load profile has more messages than fit in a ShotNumber");
+        }
+
+        this->listener = std::make_shared<LatencyListener>(this->sendTimes, !this->profile.HeartbeatShotData);
+        this->listenerToken = this->server.addListener(this->listener, this->filter());
+    }
+
+    ListenerFilter LoadGenerator::filter() const {
+        return this->profile.HeartbeatShotData ? ListenerFilter::All : ListenerFilter::ShotsOnly;
+    }
+
+    LoadGenerator::~LoadGenerator() {
+        this->disconnect();
+        this->server.removeListener(this->listenerToken);
+    }
+
+    void LoadGenerator::connect() {
+#ifdef _WIN32
+        WSADATA wsaData;
+        WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+        size_t existing = this->server.getConnections().size();
+
+        sockaddr_in serverAddr{};
+        serverAddr.sin_family = AF_INET;
+        serverAddr.sin_port = htons(static_cast<uint16_t>(this->profile.Port));
+        inet_pton(AF_INET, this->profile.Host.c_str(), &serverAddr.sin_addr);
+
+        for (size_t i = 0; i < this->profile.Connections; i++) {
+            NativeSocket s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            if (s == INVALID_NATIVE_SOCKET) {
+                throw std::runtime_error("Load generator failed to create a socket, error code: " + std::to_string(lastSocketError()));
+            }
+            // Launch monitors send small messages one at a time, don't let Nagle hold them back
+            int noDelay = 1;
+            setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+            if (::connect(s, reinterpret_cast<sockaddr*>(&serverAddr), sizeof(serverAddr)) != 0) {
+                int error = lastSocketError();
+                closeNativeSocket(s);
+                throw std::runtime_error("Load generator failed to connect, error code: " + std::to_string(error));
+            }
+            this->sockets.push_back(static_cast<intptr_t>(s));
+        }
+
+        size_t expected = existing + this->profile.Connections;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (this->server.getConnections().size() < expected) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                throw std::runtime_error("Server didn't accept every load generator connection");
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    void LoadGenerator::disconnect() {
+        if (this->sockets.empty()) {
+            return;
+        }
+        for (intptr_t s : this->sockets) {
+            closeNativeSocket(static_cast<NativeSocket>(s));
+        }
+        this->sockets.clear();
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+
+    LoadResult LoadGenerator::run(std::chrono::milliseconds timeout) {
+        if (this->sockets.empty()) {
+            throw std::runtime_error("LoadGenerator::connect() must be called before run()");
+        }
+        this->listener->reset();
+
+        LoadResult result;
+        result.Sent = this->sendTimes.size();
+
+        std::vector<std::thread> threads;
+        std::vector<std::string> errors(this->profile.Threads);
+        int64_t start = nowNs();
+        for (size_t t = 0; t < this->profile.Threads; t++) {
+            threads.emplace_back(&LoadGenerator::sendConnections, this, t, this->profile.Threads, std::ref(errors[t]));
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (auto& error : errors) {
+            if (!error.empty()) {
+                throw std::runtime_error(error);
+            }
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (this->listener->receivedCount() < result.Sent && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+
+        result.Received = this->listener->receivedCount();
+        if (result.Received < result.Sent) {
+            // Stop the listener before reading its histogram, messages still in flight would race with the copy
+            this->server.removeListener(this->listenerToken);
+            result.Received = this->listener->receivedCount();
+            result.Latency = this->listener->histogram();
+            this->listenerToken = this->server.addListener(this->listener, this->filter());
+        }
+        else {
+            result.Latency = this->listener->histogram();
+        }
+
+        result.Seconds = std::max<int64_t>(this->listener->lastReceived() - start, 1) / 1e9;
+        result.MessagesPerSecond = static_cast<double>(result.Received) / result.Seconds;
+        return result;
+    }
+
+    // Every connection this thread owns sends one batch of Coalesce messages per round
+    void LoadGenerator::sendConnections(size_t thread, size_t threads, std::string& error) {
+        try {
+            const size_t messages = this->profile.MessagesPerConnection;
+            const size_t coalesce = this->profile.Coalesce;
+            const ShotData heartbeat = makeMessage(true);
+            const ShotData shot = makeMessage(false);
+
+            ShotData message;
+            std::vector<char> buffer(coalesce * 1024);
+            std::vector<size_t> sequences;
+            sequences.reserve(coalesce);
+
+            auto next = std::chrono::steady_clock::now();
+            auto interval = std::chrono::nanoseconds(this->profile.MessagesPerSecond > 0
+                ? static_cast<int64_t>(1e9 * coalesce / this->profile.MessagesPerSecond) : 0);
+
+            for (size_t first = 0; first < messages; first += coalesce) {
+                size_t last = std::min(first + coalesce, messages);
+
+                for (size_t connection = thread; connection < this->sockets.size(); connection += threads) {
+                    size_t length = 0;
+                    sequences.clear();
+                    for (size_t i = first; i < last; i++) {
+                        size_t sequence = connection * messages + i;
+                        message = isHeartbeat(i, this->profile.HeartbeatRatio) ? heartbeat : shot;
+                        message.ShotNumber = static_cast<int>(sequence);
+                        length += encode(message, buffer.data() + length, buffer.size() - length);
+                        sequences.push_back(sequence);
+                    }
+
+                    int64_t sent = nowNs();
+                    for (size_t sequence : sequences) {
+                        this->sendTimes[sequence].store(sent, std::memory_order_release);
+                    }
+                    sendAll(static_cast<NativeSocket>(this->sockets[connection]), buffer.data(), length);
+                }
+
+                if (interval.count() > 0) {
+                    next += interval;
+                    std::this_thread::sleep_until(next);
+                }
+            }
+        }
+        catch (const std::exception& e) {
+            error = e.what();
+        }
+    }
+
+    int64_t threadCpuTimeNs(std::thread& thread) {
+#ifdef _WIN32
+        FILETIME creation, exit, kernel, user;
+        if (!GetThreadTimes(thread.native_handle(), &creation, &exit, &kernel, &user)) {
+            return 0;
+        }
+        auto ticks = [](const FILETIME& time) {
+            return (static_cast<int64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+        };
+        return (ticks(kernel) + ticks(user)) * 100;
+#else
+        clockid_t clock;
+        timespec time;
+        if (pthread_getcpuclockid(thread.native_handle(), &clock) != 0 || clock_gettime(clock, &time) != 0) {
+            return 0;
+        }
+        return static_cast<int64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+#endif
+    }
+
+    int64_t processCpuTimeNs() {
+#ifdef _WIN32
+        FILETIME creation, exit, kernel, user;
+        if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+            return 0;
+        }
+        auto ticks = [](const FILETIME& time) {
+            return (static_cast<int64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+        };
+        return (ticks(kernel) + ticks(user)) * 100;
+#else
+        timespec time;
+        if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0) {
+            return 0;
+        }
+        return static_cast<int64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+#endif
+    }
+}
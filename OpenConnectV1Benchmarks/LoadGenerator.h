@@ -0,0 +1,76 @@
+#ifndef OPEN_CONNECT_BENCHMARKS_LOAD_GENERATOR_H
+#define OPEN_CONNECT_BENCHMARKS_LOAD_GENERATOR_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../OpenConnectV1/Server.h"
+#include "LatencyHistogram.h"
+
+namespace OpenConnectV1Benchmarks {
+    struct LoadProfile {
+        std::string Host = "127.0.0.1";
+        int Port = 0;
+        size_t Connections = 1;
+        size_t MessagesPerConnection = 1000;
+        double HeartbeatRatio = 0.0;        // Fraction of the messages that are heartbeats, the rest are full shots
+        double MessagesPerSecond = 0.0;     // Per connection, 0 sends as fast as the sockets accept the data
+        size_t Coalesce = 1;                // Messages written back to back with a single send()
+        size_t Threads = 0;                 // Client threads the connections are spread over, 0 for min(Connections, 4)
+        // False subscribes to shots only and counts heartbeats through onHeartbeat(), which lets the server skip
+        // decoding them; heartbeats then have no latency (their sequence number is never decoded)
+        bool HeartbeatShotData = true;
+    };
+
+    struct LoadResult {
+        uint64_t Sent = 0;
+        uint64_t Received = 0;
+        double Seconds = 0;                 // From the first send until the last message reached the listener
+        double MessagesPerSecond = 0;
+        LatencyHistogram Latency;           // send() to onShotDataReceived(), in nanoseconds
+    };
+
+    /**
+     * Synthetic launch monitor pool for load testing a Server in the same process.  Every message carries a
+     * sequence number in ShotNumber, the generator's listener (subscribed to the server for the generator's
+     * lifetime) looks up when that message was sent to measure the end to end latency.
+     */
+    class LoadGenerator {
+    public:
+        LoadGenerator(OpenConnectV1::Server& server, const LoadProfile& profile);
+        ~LoadGenerator();
+
+        LoadGenerator(const LoadGenerator&) = delete;
+        LoadGenerator& operator=(const LoadGenerator&) = delete;
+
+        // Opens every connection and waits for the server to accept them, throws std::runtime_error on failure
+        void connect();
+        // Sends the profile on every connection and waits (up to timeout) for the listener to see all of it
+        LoadResult run(std::chrono::milliseconds timeout = std::chrono::seconds(30));
+        void disconnect();
+
+    private:
+        class LatencyListener;
+
+        OpenConnectV1::Server& server;
+        LoadProfile profile;
+        std::vector<intptr_t> sockets;
+        std::vector<std::atomic<int64_t>> sendTimes;    // Indexed by sequence number
+        std::shared_ptr<LatencyListener> listener;
+        OpenConnectV1::ListenerToken listenerToken;
+
+        OpenConnectV1::ListenerFilter filter() const;
+        void sendConnections(size_t thread, size_t threads, std::string& error);
+    };
+
+    // CPU time consumed so far by a thread, or by the whole process, in nanoseconds
+    int64_t threadCpuTimeNs(std::thread& thread);
+    int64_t processCpuTimeNs();
+}
+
+#endif
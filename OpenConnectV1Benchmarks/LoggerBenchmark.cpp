@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+#include <string>
+
+#include "../OpenConnectV1/Data.h"
+#include "../OpenConnectV1/Logger.h"
+#include "AllocationCounter.h"
+
+using namespace OpenConnectV1;
+using OpenConnectV1Benchmarks::AllocationCounter;
+
+namespace {
+    // Stands in for the kind of argument the Server logs, building it allocates
+    std::string describe(const ShotData& shotData) {
+        return shotData.DeviceID.str() + " #" + std::to_string(shotData.ShotNumber) + " (" + shotData.Units.str() + ")";
+    }
+
+    ShotData sampleShot() {
+        ShotData shotData;
+        shotData.DeviceID = "GSPro LM 1.1 with a name too long for SSO";
+        shotData.Units = "Yards";
+        shotData.ShotNumber = 13;
+        return shotData;
+    }
+
+    void reportAllocations(benchmark::State& state, uint64_t before) {
+        state.counters["allocs/op"] = benchmark::Counter(
+            static_cast<double>(AllocationCounter::allocations() - before), benchmark::Counter::kAvgIterations);
+    }
+
+    class LogLevelScope {
+    public:
+        explicit LogLevelScope(LogLevel level) : previous(Logger::minLogLevel.load()) { Logger::minLogLevel = level; }
+        ~LogLevelScope() { Logger::minLogLevel = this->previous; }
+
+    private:
+        LogLevel previous;
+    };
+}
+
+// Disabled Logger::debug() call: the arguments are evaluated and the variadic call made before the level check
+static void BM_DisabledDebugFunctionCall(benchmark::State& state) {
+    LogLevelScope scope(LogLevel::Info);
+    ShotData shotData = sampleShot();
+    uint64_t before = AllocationCounter::allocations();
+
+    for (auto _ : state) {
+        Logger::debug("Shot %s, ball data: %s", describe(shotData).c_str(), shotData.ShotDataOptions.ContainsBallData ? "true" : "false");
+        benchmark::ClobberMemory();
+    }
+
+    reportAllocations(state, before);
+}
+BENCHMARK(BM_DisabledDebugFunctionCall);
+
+// Compiled in but disabled at runtime: one relaxed atomic load, the arguments are never evaluated
+static void BM_DisabledInfoMacro(benchmark::State& state) {
+    LogLevelScope scope(LogLevel::Error);
+    ShotData shotData = sampleShot();
+    uint64_t before = AllocationCounter::allocations();
+
+    for (auto _ : state) {
+        OC_LOG_INFO("Shot %s, ball data: %s", describe(shotData).c_str(), shotData.ShotDataOptions.ContainsBallData ? "true" : "false");
+        benchmark::ClobberMemory();
+    }
+
+    reportAllocations(state, before);
+}
+BENCHMARK(BM_DisabledInfoMacro);
+
+// Compiled out entirely when OPEN_CONNECT_LOG_LEVEL is below Debug (the release default)
+static void BM_DisabledDebugMacro(benchmark::State& state) {
+    LogLevelScope scope(LogLevel::Info);
+    ShotData shotData = sampleShot();
+    uint64_t before = AllocationCounter::allocations();
+
+    for (auto _ : state) {
+        OC_LOG_DEBUG("Shot %s, ball data: %s", describe(shotData).c_str(), shotData.ShotDataOptions.ContainsBallData ? "true" : "false");
+        benchmark::ClobberMemory();
+    }
+
+    reportAllocations(state, before);
+    state.SetLabel(OPEN_CONNECT_LOG_LEVEL >= 2 ? "compiled in" : "compiled out");
+}
+BENCHMARK(BM_DisabledDebugMacro);
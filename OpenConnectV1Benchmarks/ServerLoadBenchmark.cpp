@@ -0,0 +1,122 @@
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <thread>
+
+#include "../OpenConnectV1/Logger.h"
+#include "../OpenConnectV1/Server.h"
+#include "LoadGenerator.h"
+
+using namespace OpenConnectV1;
+using namespace OpenConnectV1Benchmarks;
+
+namespace {
+    // Every run listens on its own port so a previous run's sockets in TIME_WAIT can't get in the way
+    int nextPort = 5301;
+
+    const size_t MESSAGES_PER_RUN = 50000;
+
+    void reportPercentile(benchmark::State& state, const char* name, const LatencyHistogram& latency, double percentile) {
+        state.counters[name] = benchmark::Counter(latency.percentile(percentile) / 1000.0);
+    }
+
+    void runLoad(benchmark::State& state, const LoadProfile& profile) {
+        // Connection churn is logged at info, keep it out of the measurement
+        LogLevel previousLevel = Logger::minLogLevel.load();
+        Logger::minLogLevel = LogLevel::Error;
+
+        Server server;
+        std::thread serverThread([&server, &profile] { server.startup(profile.Port); });
+        while (server.getStatus() == ServerStatus::Disconnected) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        LoadResult total;
+        int64_t serverCpu = 0;
+        int64_t processCpu = 0;
+        {
+            LoadGenerator generator(server, profile);
+            generator.connect();
+
+            for (auto _ : state) {
+                int64_t serverCpuBefore = threadCpuTimeNs(serverThread);
+                int64_t processCpuBefore = processCpuTimeNs();
+                LoadResult result = generator.run();
+                serverCpu += threadCpuTimeNs(serverThread) - serverCpuBefore;
+                processCpu += processCpuTimeNs() - processCpuBefore;
+
+                state.SetIterationTime(result.Seconds);
+                total.Sent += result.Sent;
+                total.Received += result.Received;
+                total.Seconds += result.Seconds;
+                total.Latency.merge(result.Latency);
+            }
+        }
+
+        server.shutdown();
+        serverThread.join();
+        Logger::minLogLevel = previousLevel;
+
+        double received = static_cast<double>(std::max<uint64_t>(total.Received, 1));
+        state.SetItemsProcessed(static_cast<int64_t>(total.Received));
+        state.counters["msgs/s"] = benchmark::Counter(received / total.Seconds);
+        state.counters["lost"] = benchmark::Counter(static_cast<double>(total.Sent - total.Received));
+        state.counters["server_cpu_ns/msg"] = benchmark::Counter(serverCpu / received);
+        state.counters["process_cpu_ns/msg"] = benchmark::Counter(processCpu / received);
+        reportPercentile(state, "p50_us", total.Latency, 50);
+        reportPercentile(state, "p90_us", total.Latency, 90);
+        reportPercentile(state, "p99_us", total.Latency, 99);
+        reportPercentile(state, "p99.9_us", total.Latency, 99.9);
+        state.counters["max_us"] = benchmark::Counter(total.Latency.max() / 1000.0);
+    }
+}
+
+// End to end ingest: N synthetic launch monitors streaming to a real Server over loopback.
+// Args: connections, heartbeat percentage, messages/sec per connection (0 = unpaced), messages per send()
+static void BM_ServerIngest(benchmark::State& state) {
+    LoadProfile profile;
+    profile.Port = nextPort++;
+    profile.Connections = static_cast<size_t>(state.range(0));
+    profile.HeartbeatRatio = state.range(1) / 100.0;
+    profile.MessagesPerSecond = static_cast<double>(state.range(2));
+    profile.Coalesce = static_cast<size_t>(state.range(3));
+    profile.MessagesPerConnection = std::max<size_t>(MESSAGES_PER_RUN / profile.Connections, profile.Coalesce);
+    if (profile.MessagesPerSecond > 0) {
+        // Paced runs last about a second
+        profile.MessagesPerConnection = std::min(profile.MessagesPerConnection, static_cast<size_t>(profile.MessagesPerSecond));
+    }
+    runLoad(state, profile);
+}
+BENCHMARK(BM_ServerIngest)
+    ->ArgNames({ "conns", "hb%", "rate", "coalesce" })
+    ->Args({ 1, 0, 0, 1 })              // One monitor, shots as fast as possible
+    ->Args({ 1, 0, 0, 16 })             // Back to back messages arriving in one read
+    ->Args({ 16, 90, 0, 1 })            // Mostly heartbeats, the typical mix
+    ->Args({ 64, 90, 0, 1 })
+    ->Args({ 256, 90, 0, 1 })
+    ->Args({ 16, 90, 1000, 1 })         // Paced, latency without queueing
+    ->Args({ 64, 90, 200, 4 })
+    ->UseManualTime()
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
+
+// Bays with nobody hitting balls: nothing but heartbeats.  server_cpu_ns/msg is the cost of one heartbeat, with
+// and without a listener that wants them as ShotData (which forces the full decode).
+// Args: connections, heartbeats delivered as ShotData (0/1)
+static void BM_ServerIdleBays(benchmark::State& state) {
+    LoadProfile profile;
+    profile.Port = nextPort++;
+    profile.Connections = static_cast<size_t>(state.range(0));
+    profile.HeartbeatRatio = 1.0;
+    profile.HeartbeatShotData = state.range(1) != 0;
+    profile.MessagesPerConnection = MESSAGES_PER_RUN / profile.Connections;
+    runLoad(state, profile);
+}
+BENCHMARK(BM_ServerIdleBays)
+    ->ArgNames({ "conns", "shotdata" })
+    ->Args({ 16, 0 })
+    ->Args({ 16, 1 })
+    ->Args({ 256, 0 })
+    ->Args({ 256, 1 })
+    ->UseManualTime()
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,226 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "../OpenConnectV1/ColumnStats.h"
+#include "../OpenConnectV1/ShotStore.h"
+#include "../OpenConnectV1/Units.h"
+#include "AllocationCounter.h"
+
+using namespace OpenConnectV1;
+using OpenConnectV1Benchmarks::AllocationCounter;
+
+namespace {
+    ShotData randomShot(std::mt19937& random, int shotNumber) {
+        std::normal_distribution<float> speed(140.0f, 12.0f);
+        std::normal_distribution<float> spin(3000.0f, 600.0f);
+        std::uniform_int_distribution<int> missing(0, 9);
+
+        ShotData shotData;
+        shotData.DeviceID = "GSPro LM 1.1";
+        shotData.Units = "Yards";
+        shotData.ShotNumber = shotNumber;
+        shotData.BallData = BallData(speed(random), -5.0f, spin(random), spin(random) * 0.8f, -600.0f, 1.5f, 13.0f,
+            speed(random) * 1.7f);
+        if (missing(random) == 0) {
+            shotData.BallData.CarryDistance = NAN;
+        }
+        shotData.ClubData = ClubData(speed(random) / 1.45f, -1.0f, 0.5f, 60.0f, 12.0f, 2.0f, 100.0f, 0.0f, 0.0f, 1.0f);
+        shotData.ShotDataOptions = ShotDataOptions(true, true, true, true, false);
+        return shotData;
+    }
+
+    std::vector<ShotData> randomShots(size_t count) {
+        std::mt19937 random(42);
+        std::vector<ShotData> shots;
+        shots.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            shots.push_back(randomShot(random, static_cast<int>(i)));
+        }
+        return shots;
+    }
+}
+
+// What a listener pays to add a shot from onShotDataReceived
+static void BM_ShotStoreAppend(benchmark::State& state) {
+    std::vector<ShotData> shots = randomShots(1024);
+    ShotStore store;
+    size_t i = 0;
+    uint64_t before = AllocationCounter::allocations();
+
+    for (auto _ : state) {
+        store.append(1, shots[i++ & 1023]);
+        if (store.size() == 1 << 20) {
+            store.clear();
+        }
+    }
+
+    state.counters["allocs/op"] = benchmark::Counter(
+        static_cast<double>(AllocationCounter::allocations() - before), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_ShotStoreAppend);
+
+// Mean carry over every shot kept as ShotData, each read drags the rest of the shot into the cache with it
+static void BM_ShotDataArrayMean(benchmark::State& state) {
+    std::vector<ShotData> shots = randomShots(static_cast<size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        double sum = 0;
+        size_t count = 0;
+        for (const ShotData& shot : shots) {
+            if (!std::isnan(shot.BallData.CarryDistance)) {
+                sum += shot.BallData.CarryDistance;
+                count++;
+            }
+        }
+        benchmark::DoNotOptimize(sum / count);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ShotDataArrayMean)->Arg(1 << 12)->Arg(1 << 20);
+
+// The same over the CarryDistance column
+static void BM_ShotStoreMean(benchmark::State& state) {
+    std::vector<ShotData> shots = randomShots(static_cast<size_t>(state.range(0)));
+    ShotStore store;
+    for (const ShotData& shot : shots) {
+        store.append(1, shot);
+    }
+    ShotColumn carry = store.column(ShotField::CarryDistance);
+
+    for (auto _ : state) {
+        double sum = 0;
+        for (float value : carry) {
+            if (!std::isnan(value)) {
+                sum += value;
+            }
+        }
+        benchmark::DoNotOptimize(sum / carry.validCount());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ShotStoreMean)->Arg(1 << 12)->Arg(1 << 20);
+
+// Scalar baseline for BM_ColumnStats: mean, variance, min and max of the carry kept as ShotData
+static void BM_ShotDataArrayStats(benchmark::State& state) {
+    std::vector<ShotData> shots = randomShots(static_cast<size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        double sum = 0;
+        double squares = 0;
+        float min = INFINITY;
+        float max = -INFINITY;
+        size_t count = 0;
+        for (const ShotData& shot : shots) {
+            float carry = shot.BallData.CarryDistance;
+            if (!std::isnan(carry)) {
+                sum += carry;
+                squares += static_cast<double>(carry) * carry;
+                min = std::min(min, carry);
+                max = std::max(max, carry);
+                count++;
+            }
+        }
+        benchmark::DoNotOptimize(sum / count);
+        benchmark::DoNotOptimize((squares - sum * sum / count) / (count - 1));
+        benchmark::DoNotOptimize(min);
+        benchmark::DoNotOptimize(max);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ShotDataArrayStats)->Arg(1 << 20);
+
+// The fused pass over the carry column at every SIMD level (0 scalar, 1 SSE2, 2 AVX2)
+static void BM_ColumnStats(benchmark::State& state) {
+    SimdLevel level = static_cast<SimdLevel>(state.range(1));
+    if (setSimdLevel(level) != level) {
+        state.SkipWithError("SIMD level not supported by this CPU");
+        return;
+    }
+    std::vector<ShotData> shots = randomShots(static_cast<size_t>(state.range(0)));
+    ShotStore store;
+    for (const ShotData& shot : shots) {
+        store.append(1, shot);
+    }
+    ShotColumn carry = store.column(ShotField::CarryDistance);
+
+    for (auto _ : state) {
+        ColumnStats stats = columnStats(carry);
+        benchmark::DoNotOptimize(stats);
+    }
+
+    setSimdLevel(supportedSimdLevel());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ColumnStats)->ArgsProduct({ { 1 << 12, 1 << 20 }, { 0, 1, 2 } })->ArgNames({ "shots", "simd" });
+
+// Smash factor, BallSpeed over ClubSpeed without materializing the ratios
+static void BM_RatioStats(benchmark::State& state) {
+    SimdLevel level = static_cast<SimdLevel>(state.range(0));
+    if (setSimdLevel(level) != level) {
+        state.SkipWithError("SIMD level not supported by this CPU");
+        return;
+    }
+    std::vector<ShotData> shots = randomShots(1 << 20);
+    ShotStore store;
+    for (const ShotData& shot : shots) {
+        store.append(1, shot);
+    }
+    ShotColumn ballSpeed = store.column(ShotField::BallSpeed);
+    ShotColumn clubSpeed = store.column(ShotField::ClubSpeed);
+
+    for (auto _ : state) {
+        ColumnStats stats = ratioStats(ballSpeed, clubSpeed);
+        benchmark::DoNotOptimize(stats);
+    }
+
+    setSimdLevel(supportedSimdLevel());
+    state.SetItemsProcessed(state.iterations() * ballSpeed.Size);
+}
+BENCHMARK(BM_RatioStats)->DenseRange(0, 2)->ArgName("simd");
+
+// A history converted to SI shot by shot, half of it reported in metres
+static void BM_NormalizeShots(benchmark::State& state) {
+    std::vector<ShotData> shots = randomShots(static_cast<size_t>(state.range(0)));
+    for (size_t i = 0; i < shots.size(); i += 2) {
+        shots[i].Units = "Meters";
+    }
+    std::vector<BallData> balls(shots.size());
+    std::vector<ClubData> clubs(shots.size());
+
+    for (auto _ : state) {
+        normalize(shots.data(), shots.size(), balls.data(), clubs.data());
+        benchmark::DoNotOptimize(balls.data());
+        benchmark::DoNotOptimize(clubs.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_NormalizeShots)->Arg(1 << 16);
+
+// The same conversion for one stored column
+static void BM_ShotStoreNormalizedColumn(benchmark::State& state) {
+    std::vector<ShotData> shots = randomShots(static_cast<size_t>(state.range(0)));
+    ShotStore store;
+    for (size_t i = 0; i < shots.size(); i++) {
+        if (i % 2 == 0) {
+            shots[i].Units = "Meters";
+        }
+        store.append(1, shots[i]);
+    }
+    std::vector<float> carry(store.size());
+
+    for (auto _ : state) {
+        store.normalizedColumn(ShotField::CarryDistance, carry.data());
+        benchmark::DoNotOptimize(carry.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ShotStoreNormalizedColumn)->Arg(1 << 16);
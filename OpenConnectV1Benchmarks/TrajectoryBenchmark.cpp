@@ -0,0 +1,91 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../OpenConnectV1/ColumnStats.h"
+#include "../OpenConnectV1/Trajectory.h"
+#include "../OpenConnectV1/TrajectorySolver.h"
+
+using namespace OpenConnectV1;
+
+namespace {
+    std::vector<BallData> randomBalls(size_t count) {
+        std::mt19937 random(42);
+        std::normal_distribution<float> speed(140.0f, 20.0f);
+        std::normal_distribution<float> angle(14.0f, 4.0f);
+        std::normal_distribution<float> spin(4000.0f, 1500.0f);
+        std::normal_distribution<float> side(0.0f, 500.0f);
+
+        std::vector<BallData> balls;
+        balls.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            BallData ball;
+            ball.Speed = speed(random);
+            ball.VLA = angle(random);
+            ball.HLA = side(random) / 200;
+            ball.BackSpin = std::max(500.0f, spin(random));
+            ball.SideSpin = side(random);
+            balls.push_back(ball);
+        }
+        return balls;
+    }
+}
+
+// One shot with its flight path, what a listener pays to draw a shot as it comes in
+static void BM_TrajectorySingle(benchmark::State& state) {
+    std::vector<BallData> balls = randomBalls(64);
+    TrajectoryEngine engine;
+    size_t i = 0;
+
+    for (auto _ : state) {
+        Trajectory trajectory = engine.simulate(balls[i++ & 63]);
+        benchmark::DoNotOptimize(trajectory.Summary);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TrajectorySingle);
+
+// Summaries for a session of shots at every SIMD level (0 scalar, 1 SSE2, 2 AVX2)
+static void BM_TrajectoryBatch(benchmark::State& state) {
+    SimdLevel level = static_cast<SimdLevel>(state.range(1));
+    if (setSimdLevel(level) != level) {
+        state.SkipWithError("SIMD level not supported by this CPU");
+        return;
+    }
+    std::vector<BallData> balls = randomBalls(static_cast<size_t>(state.range(0)));
+    std::vector<FlightSummary> summaries(balls.size());
+    TrajectoryEngine engine;
+
+    for (auto _ : state) {
+        engine.simulate(balls.data(), balls.size(), summaries.data());
+        benchmark::DoNotOptimize(summaries.data());
+    }
+
+    setSimdLevel(supportedSimdLevel());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TrajectoryBatch)->ArgsProduct({ { 1 << 10 }, { 0, 1, 2 } })->ArgNames({ "shots", "simd" });
+
+// A recorded history flown across 1 to every hardware thread, wall time so the scaling shows
+static void BM_TrajectorySolver(benchmark::State& state) {
+    std::vector<BallData> balls = randomBalls(1 << 14);
+    FlightSummaryColumns results(balls.size());
+    TrajectorySolver solver(TrajectoryOptions(), static_cast<size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        solver.solve(balls.data(), nullptr, balls.size(), results);
+        benchmark::DoNotOptimize(results.Carry.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * balls.size());
+}
+BENCHMARK(BM_TrajectorySolver)->Apply([](benchmark::internal::Benchmark* benchmark) {
+    int hardwareThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int threads = 1; threads < hardwareThreads; threads *= 2) {
+        benchmark->Arg(threads);
+    }
+    benchmark->Arg(hardwareThreads);
+})->ArgName("threads")->UseRealTime()->Unit(benchmark::kMillisecond);
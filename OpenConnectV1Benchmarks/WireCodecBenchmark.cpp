@@ -0,0 +1,72 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+#include "../OpenConnectV1/WireCodec.h"
+#include "AllocationCounter.h"
+
+using namespace OpenConnectV1;
+using OpenConnectV1Benchmarks::AllocationCounter;
+
+namespace {
+    ShotData fullShot() {
+        return ShotData("GSPro LM 1.1", "Yards", 13, "1",
+            BallData(147.5f, -13.2f, 3250.0f, 2500.0f, -800.0f, 2.3f, 14.3f, 256.5f),
+            ClubData(105.2f, -1.2f, 0.5f, 60.1f, 13.2f, 3.1f, 104.9f, -0.3f, 0.2f, 1.5f),
+            ShotDataOptions(true, true, true, true, false));
+    }
+
+    const WireCodec& codec(benchmark::State& state) {
+        WireFormat format = static_cast<WireFormat>(state.range(0));
+        state.SetLabel(toString(format));
+        return codecFor(format);
+    }
+
+    // What one shot costs on the wire, framing included, next to the time per shot
+    void reportBytes(benchmark::State& state, size_t bytes) {
+        state.counters["bytes/shot"] = static_cast<double>(bytes);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+static void BM_WireEncodeShot(benchmark::State& state) {
+    const WireCodec& wire = codec(state);
+    ShotData shotData = fullShot();
+    std::vector<char> buffer(1024);
+    size_t length = 0;
+    uint64_t before = AllocationCounter::allocations();
+
+    for (auto _ : state) {
+        length = wire.encode(shotData, buffer.data(), buffer.size());
+        benchmark::DoNotOptimize(buffer.data());
+    }
+
+    state.counters["allocs/op"] = benchmark::Counter(
+        static_cast<double>(AllocationCounter::allocations() - before), benchmark::Counter::kAvgIterations);
+    reportBytes(state, length);
+}
+BENCHMARK(BM_WireEncodeShot)->DenseRange(0, 1)->ArgName("format");
+
+// Framing and decoding, what the server does per received shot
+static void BM_WireDecodeShot(benchmark::State& state) {
+    const WireCodec& wire = codec(state);
+    std::string bytes = wire.encodeToString(fullShot());
+    MessageFramer framer;
+    framer.setFraming(wire.framing());
+    ShotData shotData;
+    uint64_t before = AllocationCounter::allocations();
+
+    for (auto _ : state) {
+        framer.append(bytes.data(), bytes.size());
+        std::string_view message;
+        framer.next(message);
+        wire.decode(message, shotData);
+        benchmark::DoNotOptimize(shotData);
+    }
+
+    state.counters["allocs/op"] = benchmark::Counter(
+        static_cast<double>(AllocationCounter::allocations() - before), benchmark::Counter::kAvgIterations);
+    reportBytes(state, bytes.size());
+}
+BENCHMARK(BM_WireDecodeShot)->DenseRange(0, 1)->ArgName("format");
@@ -0,0 +1,171 @@
+#include "pch.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "../OpenConnectV1/ColumnStats.h"
+
+using namespace OpenConnectV1;
+
+namespace {
+    const float NOT_A_NUMBER = std::numeric_limits<float>::quiet_NaN();
+
+    std::vector<float> randomColumn(size_t count, unsigned seed) {
+        std::mt19937 random(seed);
+        std::normal_distribution<float> speed(140.0f, 15.0f);
+        std::uniform_int_distribution<int> missing(0, 4);
+        std::vector<float> values(count);
+        for (float& value : values) {
+            value = missing(random) == 0 ? NOT_A_NUMBER : speed(random);
+        }
+        return values;
+    }
+
+    // Straightforward two pass reference
+    ColumnStats reference(const std::vector<float>& values) {
+        ColumnStats stats;
+        double sum = 0;
+        for (float value : values) {
+            if (std::isnan(value)) {
+                continue;
+            }
+            if (stats.Count == 0 || value < stats.Min) {
+                stats.Min = value;
+            }
+            if (stats.Count == 0 || value > stats.Max) {
+                stats.Max = value;
+            }
+            stats.Count++;
+            sum += value;
+        }
+        if (stats.Count > 0) {
+            stats.Mean = sum / stats.Count;
+        }
+        if (stats.Count > 1) {
+            double squares = 0;
+            for (float value : values) {
+                if (!std::isnan(value)) {
+                    squares += (value - stats.Mean) * (value - stats.Mean);
+                }
+            }
+            stats.Variance = squares / (stats.Count - 1);
+        }
+        return stats;
+    }
+
+    std::vector<SimdLevel> supportedLevels() {
+        std::vector<SimdLevel> levels;
+        for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 }) {
+            if (level <= supportedSimdLevel()) {
+                levels.push_back(level);
+            }
+        }
+        return levels;
+    }
+
+    class SimdLevelGuard {
+    public:
+        SimdLevelGuard() : level(simdLevel()) {}
+        ~SimdLevelGuard() { setSimdLevel(this->level); }
+
+    private:
+        SimdLevel level;
+    };
+}
+
+TEST(ColumnStatsTest, EveryLevelMatchesTheReference) {
+    SimdLevelGuard guard;
+    for (size_t count : { 0, 1, 2, 3, 7, 8, 9, 15, 16, 17, 33, 1001, 100'000 }) {
+        std::vector<float> values = randomColumn(count, static_cast<unsigned>(count));
+        ColumnStats expected = reference(values);
+
+        for (SimdLevel level : supportedLevels()) {
+            SCOPED_TRACE(testing::Message() << "count " << count << " level " << static_cast<int>(level));
+            ASSERT_EQ(setSimdLevel(level), level);
+            ColumnStats stats = columnStats(values.data(), values.size());
+            EXPECT_EQ(stats.Count, expected.Count);
+            if (expected.Count == 0) {
+                EXPECT_TRUE(std::isnan(stats.Mean));
+                EXPECT_TRUE(std::isnan(stats.Min));
+                continue;
+            }
+            EXPECT_EQ(stats.Min, expected.Min);
+            EXPECT_EQ(stats.Max, expected.Max);
+            EXPECT_NEAR(stats.Mean, expected.Mean, 1e-9 * std::fabs(expected.Mean));
+            if (expected.Count > 1) {
+                EXPECT_NEAR(stats.Variance, expected.Variance, 1e-7 * expected.Variance);
+            }
+            else {
+                EXPECT_TRUE(std::isnan(stats.Variance));
+            }
+        }
+    }
+}
+
+TEST(ColumnStatsTest, RatiosSkipMissingValuesAndZeroDenominators) {
+    SimdLevelGuard guard;
+    std::vector<float> ballSpeed = randomColumn(1003, 1);
+    std::vector<float> clubSpeed = randomColumn(1003, 2);
+    for (size_t i = 0; i < clubSpeed.size(); i += 10) {
+        clubSpeed[i] = 0;
+    }
+
+    std::vector<float> smash(ballSpeed.size());
+    for (size_t i = 0; i < smash.size(); i++) {
+        smash[i] = clubSpeed[i] != 0 ? ballSpeed[i] / clubSpeed[i] : NOT_A_NUMBER;
+    }
+    ColumnStats expected = reference(smash);
+    ASSERT_GT(expected.Count, 500u);
+
+    for (SimdLevel level : supportedLevels()) {
+        SCOPED_TRACE(testing::Message() << "level " << static_cast<int>(level));
+        setSimdLevel(level);
+        ColumnStats stats = ratioStats(ballSpeed.data(), clubSpeed.data(), ballSpeed.size());
+        EXPECT_EQ(stats.Count, expected.Count);
+        EXPECT_EQ(stats.Min, expected.Min);
+        EXPECT_EQ(stats.Max, expected.Max);
+        EXPECT_NEAR(stats.Mean, expected.Mean, 1e-9);
+        EXPECT_NEAR(stats.Variance, expected.Variance, 1e-7 * expected.Variance);
+    }
+}
+
+TEST(ColumnStatsTest, WorksOnShotStoreColumns) {
+    ShotStore store;
+    for (int i = 0; i < 100; i++) {
+        ShotData shotData;
+        shotData.BallData.Speed = 150.0f + (i % 10);
+        shotData.ClubData.Speed = 100.0f;
+        shotData.ShotDataOptions = ShotDataOptions(true, i < 50, true, true, false);
+        store.append(1, shotData);
+    }
+
+    ColumnStats speed = columnStats(store.column(ShotField::BallSpeed));
+    EXPECT_EQ(speed.Count, 100u);
+    EXPECT_DOUBLE_EQ(speed.Mean, 154.5);
+    EXPECT_EQ(speed.Min, 150.0f);
+    EXPECT_EQ(speed.Max, 159.0f);
+
+    ColumnStats smash = ratioStats(store.column(ShotField::BallSpeed), store.column(ShotField::ClubSpeed));
+    EXPECT_EQ(smash.Count, 50u);
+    EXPECT_NEAR(smash.Mean, 1.545, 1e-6);
+
+    std::vector<float> quartiles = percentiles(store.column(ShotField::BallSpeed), { 50, 0, 100, 25 });
+    EXPECT_EQ(quartiles, (std::vector<float>{ 154.5f, 150.0f, 159.0f, 152.0f }));
+}
+
+TEST(ColumnStatsTest, Percentiles) {
+    std::vector<float> values = { NOT_A_NUMBER, 5, 1, NOT_A_NUMBER, 4, 2, 3 };
+    EXPECT_EQ(percentiles(values.data(), values.size(), { 0, 25, 50, 62.5, 100 }),
+        (std::vector<float>{ 1, 2, 3, 3.5f, 5 }));
+
+    std::vector<float> missing = { NOT_A_NUMBER, NOT_A_NUMBER };
+    std::vector<float> none = percentiles(missing.data(), missing.size(), { 50 });
+    ASSERT_EQ(none.size(), 1u);
+    EXPECT_TRUE(std::isnan(none[0]));
+
+    EXPECT_THROW(percentiles(values.data(), values.size(), { 101 }), std::runtime_error);
+    EXPECT_THROW(percentiles(values.data(), values.size(), { NOT_A_NUMBER }), std::runtime_error);
+}
@@ -1,6 +1,7 @@
 #include "pch.h"
 
 #include <gtest/gtest.h>
+#include <cmath>
 #include <nlohmann/json.hpp>
 #include "../OpenConnectV1/Data.h"
 
@@ -218,3 +219,249 @@ TEST(ShotDataTest, FromJson) {
     EXPECT_TRUE(shotData.ShotDataOptions.ContainsBallData);
 }
 
+
+namespace {
+    const char* FULL_SHOT_JSON = R"({
+        "DeviceID": "TestDevice",
+        "Units": "Yards",
+        "ShotNumber": 1,
+        "APIversion": "1",
+        "BallData": {
+            "Speed": 120.5,
+            "SpinAxis": 10.2,
+            "TotalSpin": 3000,
+            "BackSpin": 1500,
+            "SideSpin": 100,
+            "HLA": 5.0,
+            "VLA": 10.0,
+            "CarryDistance": 250.0
+        },
+        "ClubData": {
+            "Speed": 95.5,
+            "AngleOfAttack": 3.0,
+            "FaceToTarget": 0.5,
+            "Lie": 1.5,
+            "Loft": 12.0,
+            "Path": 1.0,
+            "SpeedAtImpact": 98.5,
+            "VerticalFaceImpact": 0.2,
+            "HorizontalFaceImpact": 0.1,
+            "ClosureRate": 1.2
+        },
+        "ShotDataOptions": {
+            "ContainsBallData": true,
+            "ContainsClubData": true,
+            "LaunchMonitorIsReady": false,
+            "LaunchMonitorBallDetected": true,
+            "IsHeartBeat": false
+        }
+    })";
+}
+
+// Test that the DOM-less decoder produces exactly what from_json does
+TEST(ShotDataTest, DecodeMatchesFromJson) {
+    ShotData expected;
+    ShotData::from_json(json::parse(FULL_SHOT_JSON), expected);
+
+    ShotData shotData;
+    ShotData::decode(FULL_SHOT_JSON, shotData);
+
+    EXPECT_EQ(shotData.DeviceID, expected.DeviceID);
+    EXPECT_EQ(shotData.Units, expected.Units);
+    EXPECT_EQ(shotData.unitSystem(), expected.unitSystem());
+    EXPECT_EQ(shotData.ShotNumber, expected.ShotNumber);
+    EXPECT_EQ(shotData.APIversion, expected.APIversion);
+
+    EXPECT_EQ(shotData.BallData.Speed, expected.BallData.Speed);
+    EXPECT_EQ(shotData.BallData.SpinAxis, expected.BallData.SpinAxis);
+    EXPECT_EQ(shotData.BallData.TotalSpin, expected.BallData.TotalSpin);
+    EXPECT_EQ(shotData.BallData.BackSpin, expected.BallData.BackSpin);
+    EXPECT_EQ(shotData.BallData.SideSpin, expected.BallData.SideSpin);
+    EXPECT_EQ(shotData.BallData.HLA, expected.BallData.HLA);
+    EXPECT_EQ(shotData.BallData.VLA, expected.BallData.VLA);
+    EXPECT_EQ(shotData.BallData.CarryDistance, expected.BallData.CarryDistance);
+
+    EXPECT_EQ(shotData.ClubData.Speed, expected.ClubData.Speed);
+    EXPECT_EQ(shotData.ClubData.AngleOfAttack, expected.ClubData.AngleOfAttack);
+    EXPECT_EQ(shotData.ClubData.FaceToTarget, expected.ClubData.FaceToTarget);
+    EXPECT_EQ(shotData.ClubData.Lie, expected.ClubData.Lie);
+    EXPECT_EQ(shotData.ClubData.Loft, expected.ClubData.Loft);
+    EXPECT_EQ(shotData.ClubData.Path, expected.ClubData.Path);
+    EXPECT_EQ(shotData.ClubData.SpeedAtImpact, expected.ClubData.SpeedAtImpact);
+    EXPECT_EQ(shotData.ClubData.VerticalFaceImpact, expected.ClubData.VerticalFaceImpact);
+    EXPECT_EQ(shotData.ClubData.HorizontalFaceImpact, expected.ClubData.HorizontalFaceImpact);
+    EXPECT_EQ(shotData.ClubData.ClosureRate, expected.ClubData.ClosureRate);
+
+    EXPECT_EQ(shotData.ShotDataOptions.ContainsBallData, expected.ShotDataOptions.ContainsBallData);
+    EXPECT_EQ(shotData.ShotDataOptions.ContainsClubData, expected.ShotDataOptions.ContainsClubData);
+    EXPECT_EQ(shotData.ShotDataOptions.LaunchMonitorIsReady, expected.ShotDataOptions.LaunchMonitorIsReady);
+    EXPECT_EQ(shotData.ShotDataOptions.LaunchMonitorBallDetected, expected.ShotDataOptions.LaunchMonitorBallDetected);
+    EXPECT_EQ(shotData.ShotDataOptions.IsHeartBeat, expected.ShotDataOptions.IsHeartBeat);
+}
+
+TEST(ShotDataTest, DecodeHandlesMissingAndNullValuesAsNaN) {
+    ShotData shotData;
+    ShotData::decode(R"({"DeviceID":"TestDevice","Units":"Yards","ShotNumber":2,"APIversion":"1",
+        "BallData":{"Speed":120.5,"SpinAxis":null,"HLA":"n/a"},
+        "ShotDataOptions":{"ContainsBallData":true,"IsHeartBeat":false}})", shotData);
+
+    EXPECT_FLOAT_EQ(shotData.BallData.Speed, 120.5f);
+    EXPECT_TRUE(std::isnan(shotData.BallData.SpinAxis));
+    EXPECT_TRUE(std::isnan(shotData.BallData.HLA));
+    EXPECT_TRUE(std::isnan(shotData.BallData.BackSpin));
+    EXPECT_TRUE(std::isnan(shotData.ClubData.Speed));
+    EXPECT_TRUE(std::isnan(shotData.ClubData.ClosureRate));
+    EXPECT_TRUE(shotData.ShotDataOptions.ContainsBallData);
+    EXPECT_FALSE(shotData.ShotDataOptions.ContainsClubData);
+}
+
+TEST(ShotDataTest, DecodeResetsReusedShotData) {
+    ShotData shotData;
+    ShotData::decode(FULL_SHOT_JSON, shotData);
+    ShotData::decode(R"({"DeviceID":"Other","Units":"Meters","ShotNumber":7,"APIversion":"1",
+        "ShotDataOptions":{"LaunchMonitorIsReady":true,"IsHeartBeat":true}})", shotData);
+
+    EXPECT_EQ(shotData.DeviceID, "Other");
+    EXPECT_EQ(shotData.Units, "Meters");
+    EXPECT_EQ(shotData.unitSystem(), UnitSystem::Meters);
+    EXPECT_EQ(shotData.ShotNumber, 7);
+    EXPECT_TRUE(std::isnan(shotData.BallData.Speed));
+    EXPECT_TRUE(std::isnan(shotData.ClubData.Speed));
+    EXPECT_FALSE(shotData.ShotDataOptions.ContainsBallData);
+    EXPECT_TRUE(shotData.ShotDataOptions.IsHeartBeat);
+}
+
+TEST(ShotDataTest, DecodeHandlesEscapesAndUnknownKeys) {
+    ShotData shotData;
+    ShotData::decode(R"({"DeviceID":"Bay \"1\" \\ é🏌","Extra":{"Nested":[1,{"a":"}"}]},
+        "Units":"Yards","ShotNumber":3.0,"APIversion":"1"})", shotData);
+
+    EXPECT_EQ(shotData.DeviceID, "Bay \"1\" \\ \xC3\xA9\xF0\x9F\x8F\x8C");
+    EXPECT_EQ(shotData.Units, "Yards");
+    EXPECT_EQ(shotData.ShotNumber, 3);
+}
+
+TEST(ShotDataTest, DecodeThrowsOnMalformedJson) {
+    ShotData shotData;
+    EXPECT_THROW(ShotData::decode(R"({"DeviceID":"TestDevice")", shotData), std::runtime_error);
+    EXPECT_THROW(ShotData::decode(R"({"ShotNumber":})", shotData), std::runtime_error);
+    EXPECT_THROW(ShotData::decode(R"({"BallData":{"Speed":1.0}} trailing)", shotData), std::runtime_error);
+    EXPECT_THROW(ShotData::decode(R"({"ShotDataOptions":{"IsHeartBeat":tru}})", shotData), std::runtime_error);
+}
+
+TEST(ShotDataTest, SkipsOnlyAHeartbeatsData) {
+    ShotData expected;
+    ShotData::decode(FULL_SHOT_JSON, expected);
+    ShotData shotData;
+    ShotData::decodeSkippingHeartbeatData(FULL_SHOT_JSON, shotData);
+    EXPECT_EQ(shotData.BallData.Speed, expected.BallData.Speed);
+    EXPECT_EQ(shotData.BallData.CarryDistance, expected.BallData.CarryDistance);
+    EXPECT_EQ(shotData.ClubData.Speed, expected.ClubData.Speed);
+    EXPECT_EQ(shotData.ClubData.Path, expected.ClubData.Path);
+
+    ShotData::decodeSkippingHeartbeatData(R"({"DeviceID":"TestDevice","BallData":{"Speed":1.0},"ClubData":{"Speed":2.0},
+        "ShotDataOptions":{"IsHeartBeat":true,"LaunchMonitorIsReady":true},"ShotNumber":4})", shotData);
+    EXPECT_TRUE(shotData.ShotDataOptions.IsHeartBeat);
+    EXPECT_TRUE(shotData.ShotDataOptions.LaunchMonitorIsReady);
+    EXPECT_EQ(shotData.DeviceID, "TestDevice");
+    EXPECT_EQ(shotData.ShotNumber, 4);
+    EXPECT_TRUE(std::isnan(shotData.BallData.Speed));
+    EXPECT_TRUE(std::isnan(shotData.ClubData.Speed));
+
+    // Options ahead of the data they describe
+    ShotData::decodeSkippingHeartbeatData(R"({"ShotDataOptions":{"IsHeartBeat":false},"BallData":{"Speed":1.0}})", shotData);
+    EXPECT_EQ(shotData.BallData.Speed, 1.0f);
+    EXPECT_THROW(ShotData::decodeSkippingHeartbeatData(R"({"BallData":{"Speed":tru}})", shotData), std::runtime_error);
+}
+
+namespace {
+    std::string encodeToString(const ShotData& shotData) {
+        char buffer[2048];
+        size_t length = encode(shotData, buffer, sizeof(buffer));
+        EXPECT_LE(length, sizeof(buffer));
+        return std::string(buffer, length);
+    }
+
+    std::string dumpToString(const ShotData& shotData) {
+        json j;
+        to_json(j, shotData);
+        return j.dump();
+    }
+}
+
+// Test that encode writes exactly what the to_json path produces
+TEST(ShotDataTest, EncodeMatchesToJson) {
+    ShotData shotData;
+    ShotData::from_json(json::parse(FULL_SHOT_JSON), shotData);
+
+    EXPECT_EQ(encodeToString(shotData), dumpToString(shotData));
+}
+
+TEST(ShotDataTest, EncodeMatchesToJsonWithNaNValues) {
+    json ball = {
+        {"Speed", 120.5},
+        {"SpinAxis", std::numeric_limits<float>::quiet_NaN()},
+        {"TotalSpin", 2500},
+        {"BackSpin", std::numeric_limits<float>::quiet_NaN()},
+        {"SideSpin", 300},
+        {"HLA", std::numeric_limits<float>::quiet_NaN()},
+        {"VLA", 15.2},
+        {"CarryDistance", 250.7}
+    };
+    json club = {
+        {"Speed", 120.5},
+        {"AngleOfAttack", std::numeric_limits<float>::quiet_NaN()},
+        {"FaceToTarget", 0.5},
+        {"Lie", std::numeric_limits<float>::quiet_NaN()},
+        {"Loft", 15.0},
+        {"Path", std::numeric_limits<float>::quiet_NaN()},
+        {"SpeedAtImpact", 130.2},
+        {"VerticalFaceImpact", std::numeric_limits<float>::quiet_NaN()},
+        {"HorizontalFaceImpact", 0.7},
+        {"ClosureRate", std::numeric_limits<float>::quiet_NaN()}
+    };
+
+    ShotData shotData;
+    BallData::from_json(ball, shotData.BallData);
+    ClubData::from_json(club, shotData.ClubData);
+
+    EXPECT_EQ(encodeToString(shotData), dumpToString(shotData));
+}
+
+TEST(ShotDataTest, EncodeMatchesToJsonForEdgeCaseValues) {
+    ShotData shotData("Bay \"7\"\\\n\t\x01 \xC3\xA9", "Meters", -12, "1",
+        BallData(-0.0f, 1e20f, 1e-7f, 0.0001f, 0.00001f, 123456789012345678.0f, -3.4e38f, 1e15f),
+        ClubData(1e16f, 0.1f, -0.3f, 100000.0f, 7.0f, std::numeric_limits<float>::infinity(),
+            std::numeric_limits<float>::denorm_min(), 33.333f, -1.5e-5f, 2.5f),
+        ShotDataOptions(true, false, true, false, true));
+
+    EXPECT_EQ(encodeToString(shotData), dumpToString(shotData));
+}
+
+TEST(ShotDataTest, EncodeReportsLengthWhenBufferTooSmall) {
+    ShotData shotData;
+    std::string expected = dumpToString(shotData);
+
+    char buffer[16];
+    size_t length = encode(shotData, buffer, sizeof(buffer));
+
+    EXPECT_EQ(length, expected.size());
+    EXPECT_EQ(std::string(buffer, sizeof(buffer)), expected.substr(0, sizeof(buffer)));
+}
+
+TEST(ResponseTest, EncodeMatchesJsonDump) {
+    Response response(ResponseCode::PlayerInfo, "GSPro \"Player\" Information", PlayerData("LH", "7I"));
+    json j = {
+        {"Code", response.Code},
+        {"Message", response.Message},
+        {"Player", {
+            {"Handed", response.Player.Handed},
+            {"Club", response.Player.Club}
+        }}
+    };
+
+    char buffer[256];
+    size_t length = encode(response, buffer, sizeof(buffer));
+
+    EXPECT_EQ(std::string(buffer, length), j.dump());
+}
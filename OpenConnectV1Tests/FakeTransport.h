@@ -0,0 +1,213 @@
+#ifndef OPEN_CONNECT_FAKE_TRANSPORT_H
+#define OPEN_CONNECT_FAKE_TRANSPORT_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include "../OpenConnectV1/Transport.h"
+
+/**
+ * In memory Transport so Server behaviour can be tested without sockets.  connect()/deliver()/disconnect()
+ * are called from the test thread and replayed on the thread running the Server's event loop; everything
+ * the server sends is captured per connection.  limitSends() makes a connection's socket fill up, to test
+ * partial writes.
+ */
+class FakeTransport : public OpenConnectV1::Transport {
+public:
+    void open(int port) override {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->opened = true;
+        this->stopped = false;
+    }
+
+    void run(OpenConnectV1::TransportHandler& handler) override {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->running = true;
+        this->changed.notify_all();
+
+        while (!this->stopped) {
+            lock.unlock();
+            int timeout = handler.onTimer();
+            lock.lock();
+            if (this->stopped) {
+                break;
+            }
+            if (this->events.empty()) {
+                this->changed.wait_for(lock, std::chrono::milliseconds(timeout < 0 || timeout > 100 ? 100 : timeout));
+                continue;
+            }
+            auto event = std::move(this->events.front());
+            this->events.pop_front();
+
+            lock.unlock();
+            event(handler);
+            lock.lock();
+            this->processed++;
+            this->changed.notify_all();
+        }
+
+        this->running = false;
+        this->changed.notify_all();
+    }
+
+    void stop() override {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopped = true;
+        this->changed.notify_all();
+    }
+
+    void wake() override {
+        this->post([](OpenConnectV1::TransportHandler& handler) { handler.onWake(); }, [] {});
+    }
+
+    int receive(OpenConnectV1::ConnectionId connection, char* buffer, size_t length) override {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto it = this->inboxes.find(connection);
+        if (it == this->inboxes.end()) {
+            return -1;
+        }
+        std::string& inbox = it->second;
+        if (inbox.empty()) {
+            return this->closing.count(connection) ? -1 : 0;
+        }
+        size_t count = inbox.size() < length ? inbox.size() : length;
+        inbox.copy(buffer, count);
+        inbox.erase(0, count);
+        return static_cast<int>(count);
+    }
+
+    int sendSome(OpenConnectV1::ConnectionId connection, const OpenConnectV1::SendBuffer* buffers, size_t count) override {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (!this->inboxes.count(connection)) {
+            return -1;
+        }
+        this->sendCallCounts[connection]++;
+
+        auto budget = this->sendBudgets.find(connection);
+        size_t room = budget == this->sendBudgets.end() ? SIZE_MAX : budget->second;
+        size_t written = 0;
+        for (size_t i = 0; i < count && written < room; i++) {
+            size_t length = std::min(buffers[i].Length, room - written);
+            this->outboxes[connection].append(buffers[i].Data, length);
+            written += length;
+        }
+        if (budget != this->sendBudgets.end()) {
+            budget->second -= written;
+        }
+        return static_cast<int>(written);
+    }
+
+    void watchWritable(OpenConnectV1::ConnectionId connection, bool enabled) override {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->writableWatched[connection] = enabled;
+    }
+
+    void close(OpenConnectV1::ConnectionId connection) override {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->inboxes.erase(connection);
+        this->closing.erase(connection);
+        this->writableWatched.erase(connection);
+    }
+
+    void setMaxConnections(size_t maxConnections) override {}
+
+    // Test thread helpers
+
+    void waitUntilRunning() {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        while (!this->running) {
+            this->changed.wait_for(lock, std::chrono::milliseconds(100));
+        }
+    }
+
+    // Waits until every event posted so far has been handled by the server
+    void flush() {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        size_t target = this->posted;
+        while (this->processed < target && !this->stopped) {
+            this->changed.wait_for(lock, std::chrono::milliseconds(100));
+        }
+    }
+
+    void connect(OpenConnectV1::ConnectionId connection, const std::string& address) {
+        this->post([connection, address](OpenConnectV1::TransportHandler& handler) { handler.onAccepted(connection, address); },
+            [this, connection] { this->inboxes[connection]; });
+    }
+
+    void deliver(OpenConnectV1::ConnectionId connection, const std::string& bytes) {
+        this->post([connection](OpenConnectV1::TransportHandler& handler) { handler.onReadable(connection); },
+            [this, connection, bytes] { this->inboxes[connection] += bytes; });
+    }
+
+    void disconnect(OpenConnectV1::ConnectionId connection) {
+        this->post([connection](OpenConnectV1::TransportHandler& handler) { handler.onReadable(connection); },
+            [this, connection] { this->closing.insert({ connection, true }); });
+    }
+
+    std::string sent(OpenConnectV1::ConnectionId connection) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->outboxes[connection];
+    }
+
+    // The connection's socket takes this many more bytes before it's full
+    void limitSends(OpenConnectV1::ConnectionId connection, size_t bytes) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->sendBudgets[connection] = bytes;
+    }
+
+    // Makes room for more bytes (all of them with SIZE_MAX) and reports the connection writable if it's watched
+    void drainSends(OpenConnectV1::ConnectionId connection, size_t bytes = SIZE_MAX) {
+        this->post([connection](OpenConnectV1::TransportHandler& handler) { handler.onWritable(connection); },
+            [this, connection, bytes] {
+                if (bytes == SIZE_MAX) {
+                    this->sendBudgets.erase(connection);
+                }
+                else {
+                    this->sendBudgets[connection] += bytes;
+                }
+            });
+    }
+
+    size_t sendCalls(OpenConnectV1::ConnectionId connection) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->sendCallCounts[connection];
+    }
+
+    bool watchingWritable(OpenConnectV1::ConnectionId connection) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto it = this->writableWatched.find(connection);
+        return it != this->writableWatched.end() && it->second;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::function<void(OpenConnectV1::TransportHandler&)>> events;
+    std::map<OpenConnectV1::ConnectionId, std::string> inboxes;
+    std::map<OpenConnectV1::ConnectionId, std::string> outboxes;
+    std::map<OpenConnectV1::ConnectionId, bool> closing;
+    std::map<OpenConnectV1::ConnectionId, size_t> sendBudgets;
+    std::map<OpenConnectV1::ConnectionId, size_t> sendCallCounts;
+    std::map<OpenConnectV1::ConnectionId, bool> writableWatched;
+    size_t posted = 0;
+    size_t processed = 0;
+    bool opened = false;
+    bool running = false;
+    bool stopped = false;
+
+    void post(std::function<void(OpenConnectV1::TransportHandler&)> event, std::function<void()> update) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        update();
+        this->events.push_back(std::move(event));
+        this->posted++;
+        this->changed.notify_all();
+    }
+};
+
+#endif
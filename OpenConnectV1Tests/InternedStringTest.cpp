@@ -0,0 +1,129 @@
+#include "pch.h"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "TestServer.h"
+#include "../OpenConnectV1/Data.h"
+#include "../OpenConnectV1/InternedString.h"
+
+using namespace OpenConnectV1;
+
+TEST(InternedStringTest, EqualStringsShareAHandle) {
+    std::string device = "Interned Test Device";
+    InternedString a(device);
+    InternedString b("Interned Test Device");
+    InternedString c(std::string_view("Interned Test Device, Bay 2").substr(0, device.size()));
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.view().data(), b.view().data());
+    EXPECT_EQ(a.view().data(), c.view().data());
+    EXPECT_NE(a.view().data(), device.data());
+
+    EXPECT_EQ(a, "Interned Test Device");
+    EXPECT_EQ(a, device);
+    EXPECT_EQ(a.str(), device);
+    EXPECT_EQ(a.size(), device.size());
+    EXPECT_NE(a, InternedString("Interned Test Device 2"));
+    EXPECT_NE(a, "Interned Test");
+
+    size_t size = InternedString::tableSize();
+    InternedString again(device);
+    EXPECT_EQ(InternedString::tableSize(), size);
+}
+
+TEST(InternedStringTest, EmptyIsTheDefault) {
+    InternedString empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(empty, InternedString(""));
+    EXPECT_EQ(empty, "");
+    EXPECT_EQ(empty.view().size(), 0u);
+    EXPECT_STREQ(empty.c_str(), "");
+    EXPECT_TRUE(std::is_trivially_copyable<ShotData>::value);
+}
+
+TEST(InternedStringTest, ConcurrentInterningAgrees) {
+    constexpr int THREADS = 4;
+    constexpr int STRINGS = 200;
+    std::vector<std::vector<InternedString>> handles(THREADS);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([t, &handles] {
+            // Every thread interns the same strings, starting at a different one
+            for (int i = 0; i < STRINGS; i++) {
+                int n = (i + t * STRINGS / THREADS) % STRINGS;
+                handles[t].push_back(InternedString("Concurrent Device " + std::to_string(n)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int i = 0; i < STRINGS; i++) {
+        InternedString expected("Concurrent Device " + std::to_string(i));
+        for (int t = 0; t < THREADS; t++) {
+            EXPECT_EQ(handles[t][(i - t * STRINGS / THREADS + STRINGS) % STRINGS], expected);
+        }
+    }
+}
+
+TEST(InternedStringTest, DecodeInternsEscapedAndPlainStrings) {
+    ShotData first;
+    ShotData second;
+    ShotData::decode(R"({"DeviceID":"Bay 1","Units":"Yards","APIversion":"1"})", first);
+    ShotData::decode(R"({"DeviceID":"Bay 1","Units":"Yards","APIversion":"1"})", second);
+    EXPECT_EQ(first.DeviceID, "Bay 1");
+    EXPECT_EQ(first.DeviceID.view().data(), second.DeviceID.view().data());
+    EXPECT_EQ(first.Units.view().data(), second.Units.view().data());
+    EXPECT_EQ(first.APIversion, InternedString("1"));
+}
+
+TEST(InternedStringTest, StopsGrowingAtTheTableLimit) {
+    InternedString known("Capped Device 0");
+    size_t limit = InternedString::tableLimit();
+    size_t overflows = InternedString::overflowCount();
+    InternedString::setTableLimit(InternedString::tableSize() + 2);
+
+    // A client changing DeviceID on every message only gets the room that's left, then fails to decode
+    ShotData shotData;
+    for (int i = 1; i <= 5; i++) {
+        std::string message = R"({"DeviceID":"Capped Device )" + std::to_string(i) + R"("})";
+        if (i <= 2) {
+            ShotData::decode(message, shotData);
+            EXPECT_EQ(shotData.DeviceID, "Capped Device " + std::to_string(i));
+        }
+        else {
+            EXPECT_THROW(ShotData::decode(message, shotData), InternTableFull) << i;
+        }
+    }
+    EXPECT_EQ(InternedString::tableSize(), InternedString::tableLimit());
+    EXPECT_EQ(InternedString::overflowCount(), overflows + 3);
+
+    // What's in the table still resolves
+    EXPECT_EQ(InternedString("Capped Device 0"), known);
+    EXPECT_EQ(InternedString("Capped Device 2"), "Capped Device 2");
+
+    InternedString::setTableLimit(limit);
+    EXPECT_EQ(InternedString("Capped Device 3"), "Capped Device 3");
+}
+
+TEST_F(TestServer, ClosesAConnectionThatFillsTheInternTable) {
+    start();
+    InternedString known("Bay 1");
+    size_t limit = InternedString::tableLimit();
+    InternedString::setTableLimit(InternedString::tableSize());
+
+    // A known DeviceID still decodes, a new one is a parse failure rather than a shot from nobody
+    transport->connect(1, "10.0.0.3:50000");
+    transport->deliver(1, R"({"DeviceID":"Bay 1","ShotNumber":1})" R"({"DeviceID":"Overflowing Device","ShotNumber":2})");
+    transport->flush();
+    InternedString::setTableLimit(limit);
+
+    EXPECT_TRUE(server->getConnections().empty());
+    MetricsSnapshot snapshot = server->metricsSnapshot();
+    EXPECT_EQ(snapshot.counter(MetricCounter::MessagesParsed), 1u);
+    EXPECT_EQ(snapshot.counter(MetricCounter::ParseFailures), 1u);
+}
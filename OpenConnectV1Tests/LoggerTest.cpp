@@ -2,7 +2,10 @@
 
 #include "../OpenConnectV1/Logger.h"
 #include <gtest/gtest.h>
+#include <cstdio>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 class LoggerTest : public ::testing::Test {
 protected:
@@ -78,4 +81,141 @@ TEST_F(LoggerTest, HandlesIntParameterCorrectly) {
 
     std::string logOutput = buffer.str();
     EXPECT_NE(logOutput.find("[INFO    ] Int: 921"), std::string::npos);
-}
\ No newline at end of file
+}
+
+TEST_F(LoggerTest, MacrosOnlyEvaluateArgumentsWhenEnabled) {
+    int evaluations = 0;
+    auto argument = [&evaluations] { evaluations++; return 921; };
+
+    OpenConnectV1::Logger::minLogLevel = OpenConnectV1::LogLevel::Error;
+    OC_LOG_INFO("Int: %d", argument());
+    EXPECT_EQ(evaluations, 0);
+    EXPECT_TRUE(buffer.str().empty());
+
+    OpenConnectV1::Logger::minLogLevel = OpenConnectV1::LogLevel::Info;
+    OC_LOG_INFO("Int: %d", argument());
+    EXPECT_EQ(evaluations, 1);
+    EXPECT_NE(buffer.str().find("[INFO    ] Int: 921"), std::string::npos);
+
+    // Debug is only compiled into the macros when OPEN_CONNECT_LOG_LEVEL allows it
+    OpenConnectV1::Logger::minLogLevel = OpenConnectV1::LogLevel::Debug;
+    OC_LOG_DEBUG("Int: %d", argument());
+    EXPECT_EQ(evaluations, OPEN_CONNECT_LOG_LEVEL >= 2 ? 2 : 1);
+}
+
+class AsyncLoggerTest : public LoggerTest {
+protected:
+    void TearDown() override {
+        // The writer thread has to be done with std::cout before it is restored
+        OpenConnectV1::Logger::stopAsync();
+        LoggerTest::TearDown();
+    }
+
+    static void logSamples() {
+        const char raw[] = "{\"ShotNumber\":1}trailing bytes that are not part of the view";
+        OpenConnectV1::Logger::info("String: %s, Int: %d, Negative: %i", "This is a test", 921, -13);
+        OpenConnectV1::Logger::info("Padded [%-8s] [%5d] [%05.1f] [%x] [%c] 100%%", "ab", 42, 3.14159, 255u, 'Z');
+        OpenConnectV1::Logger::info("Raw: %.*s", 16, raw);
+        OpenConnectV1::Logger::info("Sizes %zu %lld %llu %ld %hhd", static_cast<size_t>(4096), -1LL, 18446744073709551615ULL, 123456L, 300);
+        OpenConnectV1::Logger::info("Floats %g %e %.3f", 0.0001, 1234.5, 2.0f);
+        OpenConnectV1::Logger::info("Width %*d|%-*s|%.*f", 6, 7, 4, "x", 2, 1.23456);
+        OpenConnectV1::Logger::info("Null %s", static_cast<const char*>(nullptr));
+        OpenConnectV1::Logger::error("Plain error message");
+    }
+};
+
+TEST_F(AsyncLoggerTest, FormatsLikeSynchronousLogging) {
+    OpenConnectV1::Logger::minLogLevel = OpenConnectV1::LogLevel::Info;
+
+    logSamples();
+    std::string expected = buffer.str();
+    buffer.str("");
+
+    OpenConnectV1::Logger::startAsync();
+    logSamples();
+    OpenConnectV1::Logger::flush();
+
+    EXPECT_EQ(buffer.str(), expected);
+    EXPECT_NE(expected.find("[INFO    ] Raw: {\"ShotNumber\":1}\n"), std::string::npos);
+}
+
+TEST_F(AsyncLoggerTest, RespectsMinLogLevel) {
+    OpenConnectV1::Logger::minLogLevel = OpenConnectV1::LogLevel::Error;
+    OpenConnectV1::Logger::startAsync();
+
+    OpenConnectV1::Logger::error("Error message");
+    OpenConnectV1::Logger::info("Info message");
+    OpenConnectV1::Logger::flush();
+
+    EXPECT_EQ(buffer.str(), "[ERROR   ] Error message\n");
+}
+
+TEST_F(AsyncLoggerTest, KeepsPerThreadOrderAcrossThreads) {
+    const int THREADS = 4;
+    const int MESSAGES = 2000;
+    OpenConnectV1::Logger::minLogLevel = OpenConnectV1::LogLevel::Info;
+
+    OpenConnectV1::AsyncLoggerOptions options;
+    options.BlockWhenFull = true;
+    OpenConnectV1::Logger::startAsync(options);
+    OpenConnectV1::LoggerStats before = OpenConnectV1::Logger::stats();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < MESSAGES; i++) {
+                OpenConnectV1::Logger::info("thread %d message %d", t, i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    OpenConnectV1::Logger::flush();
+
+    std::vector<int> next(THREADS, 0);
+    std::string line;
+    std::istringstream lines(buffer.str());
+    while (std::getline(lines, line)) {
+        int t, i;
+        ASSERT_EQ(sscanf(line.c_str(), "[INFO    ] thread %d message %d", &t, &i), 2) << line;
+        ASSERT_EQ(i, next[t]) << "Out of order for thread " << t;
+        next[t]++;
+    }
+    for (int t = 0; t < THREADS; t++) {
+        EXPECT_EQ(next[t], MESSAGES);
+    }
+
+    OpenConnectV1::LoggerStats after = OpenConnectV1::Logger::stats();
+    EXPECT_EQ(after.Enqueued - before.Enqueued, static_cast<uint64_t>(THREADS * MESSAGES));
+    EXPECT_EQ(after.Dropped, before.Dropped);
+    EXPECT_EQ(after.Written, after.Enqueued);
+}
+
+TEST_F(AsyncLoggerTest, DropsAndCountsWhenRingIsFull) {
+    const int MESSAGES = 20000;
+    OpenConnectV1::Logger::minLogLevel = OpenConnectV1::LogLevel::Debug;
+
+    OpenConnectV1::AsyncLoggerOptions options;
+    options.RingBytes = 1;              // Rounded up to the minimum ring size
+    options.FlushIntervalMs = 1000;     // The writer won't come around while the ring fills up
+    OpenConnectV1::Logger::startAsync(options);
+    OpenConnectV1::LoggerStats before = OpenConnectV1::Logger::stats();
+
+    std::thread logger([] {
+        for (int i = 0; i < MESSAGES; i++) {
+            OpenConnectV1::Logger::debug("Heartbeat %d", i);
+        }
+        OpenConnectV1::Logger::error("Errors are never dropped");
+    });
+    logger.join();
+    OpenConnectV1::Logger::flush();
+
+    OpenConnectV1::LoggerStats after = OpenConnectV1::Logger::stats();
+    uint64_t enqueued = after.Enqueued - before.Enqueued;
+    uint64_t dropped = after.Dropped - before.Dropped;
+    EXPECT_GT(dropped, 0u);
+    EXPECT_EQ(enqueued + dropped, static_cast<uint64_t>(MESSAGES + 1));
+    EXPECT_EQ(after.Written, after.Enqueued);
+    EXPECT_NE(buffer.str().find("[ERROR   ] Errors are never dropped"), std::string::npos);
+}
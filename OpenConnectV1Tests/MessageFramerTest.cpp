@@ -0,0 +1,171 @@
+#include "pch.h"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "../OpenConnectV1/MessageFramer.h"
+
+using namespace OpenConnectV1;
+
+namespace {
+    const std::string HEARTBEAT = R"({"DeviceID":"GSPro LM 1.1","Units":"Yards","ShotNumber":0,"APIversion":"1","ShotDataOptions":{"ContainsBallData":false,"ContainsClubData":false,"LaunchMonitorIsReady":true,"IsHeartBeat":true}})";
+    const std::string SHOT = R"({"DeviceID":"GSPro LM 1.1","Units":"Yards","ShotNumber":13,"APIversion":"1","BallData":{"Speed":147.5,"SpinAxis":-13.2,"TotalSpin":3250.0,"HLA":2.3,"VLA":14.3},"ClubData":{"Speed":0.0},"ShotDataOptions":{"ContainsBallData":true,"ContainsClubData":false,"IsHeartBeat":false}})";
+    const std::string TRICKY = R"({"DeviceID":"Brace } and { \"quoted\" \\","Units":"[Meters]","ShotNumber":2,"APIversion":"1"})";
+
+    std::vector<std::string> drain(MessageFramer& framer) {
+        std::vector<std::string> messages;
+        std::string_view message;
+        while (framer.next(message)) {
+            messages.emplace_back(message);
+        }
+        return messages;
+    }
+}
+
+TEST(MessageFramerTest, ExtractsSingleMessage) {
+    MessageFramer framer;
+    framer.append(SHOT.data(), SHOT.size());
+
+    auto messages = drain(framer);
+
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_EQ(messages[0], SHOT);
+    EXPECT_EQ(framer.buffered(), 0u);
+}
+
+TEST(MessageFramerTest, ExtractsCoalescedMessages) {
+    MessageFramer framer;
+    std::string stream = HEARTBEAT + SHOT + "\r\n" + TRICKY + "\n" + HEARTBEAT;
+    framer.append(stream.data(), stream.size());
+
+    auto messages = drain(framer);
+
+    ASSERT_EQ(messages.size(), 4u);
+    EXPECT_EQ(messages[0], HEARTBEAT);
+    EXPECT_EQ(messages[1], SHOT);
+    EXPECT_EQ(messages[2], TRICKY);
+    EXPECT_EQ(messages[3], HEARTBEAT);
+}
+
+TEST(MessageFramerTest, IgnoresBracesInsideStrings) {
+    MessageFramer framer;
+    std::string partial = TRICKY.substr(0, TRICKY.find("\\\\") + 2);
+    framer.append(partial.data(), partial.size());
+
+    EXPECT_TRUE(drain(framer).empty());
+
+    framer.append(TRICKY.data() + partial.size(), TRICKY.size() - partial.size());
+    auto messages = drain(framer);
+
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_EQ(messages[0], TRICKY);
+}
+
+TEST(MessageFramerTest, SplitAtEveryOffset) {
+    std::string stream = HEARTBEAT + "\n" + SHOT + TRICKY + " " + SHOT;
+    std::vector<std::string> expected = { HEARTBEAT, SHOT, TRICKY, SHOT };
+
+    for (size_t split = 0; split <= stream.size(); split++) {
+        MessageFramer framer(16);
+        std::vector<std::string> messages;
+
+        framer.append(stream.data(), split);
+        for (auto& m : drain(framer)) messages.push_back(m);
+        framer.append(stream.data() + split, stream.size() - split);
+        for (auto& m : drain(framer)) messages.push_back(m);
+
+        ASSERT_EQ(messages, expected) << "Split at offset " << split;
+        ASSERT_EQ(framer.buffered(), 0u) << "Split at offset " << split;
+    }
+}
+
+TEST(MessageFramerTest, SplitAtEveryPairOfOffsets) {
+    std::string stream = SHOT + TRICKY;
+    std::vector<std::string> expected = { SHOT, TRICKY };
+
+    for (size_t first = 0; first <= stream.size(); first++) {
+        for (size_t second = first; second <= stream.size(); second++) {
+            MessageFramer framer(8);
+            std::vector<std::string> messages;
+
+            size_t bounds[] = { 0, first, second, stream.size() };
+            for (int i = 0; i < 3; i++) {
+                framer.append(stream.data() + bounds[i], bounds[i + 1] - bounds[i]);
+                for (auto& m : drain(framer)) messages.push_back(m);
+            }
+
+            ASSERT_EQ(messages, expected) << "Split at offsets " << first << ", " << second;
+        }
+    }
+}
+
+TEST(MessageFramerTest, ByteAtATimeReceive) {
+    std::string stream = HEARTBEAT + SHOT + TRICKY;
+    MessageFramer framer(1);
+    std::vector<std::string> messages;
+
+    for (char c : stream) {
+        char* dst = framer.prepare(1);
+        *dst = c;
+        framer.commit(1);
+        for (auto& m : drain(framer)) messages.push_back(m);
+    }
+
+    ASSERT_EQ(messages.size(), 3u);
+    EXPECT_EQ(messages[0], HEARTBEAT);
+    EXPECT_EQ(messages[1], SHOT);
+    EXPECT_EQ(messages[2], TRICKY);
+}
+
+TEST(MessageFramerTest, DiscardsOversizedMessageAndRecovers) {
+    MessageFramer framer(64, 128);
+    std::string oversized = "{\"DeviceID\":\"" + std::string(256, 'x');
+    framer.append(oversized.data(), oversized.size());
+
+    std::string_view message;
+    EXPECT_THROW(framer.next(message), std::runtime_error);
+
+    std::string rest = "\"}" + HEARTBEAT;
+    framer.append(rest.data(), rest.size());
+    auto messages = drain(framer);
+
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_EQ(messages[0], HEARTBEAT);
+}
+
+TEST(MessageFramerTest, SplitsLengthPrefixedMessagesAfterAPrefix) {
+    std::string stream = "OCB1";
+    for (const std::string& body : { std::string("abc"), std::string(), std::string(300, 'x') }) {
+        uint32_t length = static_cast<uint32_t>(body.size());
+        char prefix[] = { static_cast<char>(length), static_cast<char>(length >> 8), static_cast<char>(length >> 16), static_cast<char>(length >> 24) };
+        stream += std::string(prefix, sizeof(prefix)) + body;
+    }
+
+    MessageFramer framer(1);
+    std::vector<std::string> messages;
+    for (char c : stream) {
+        framer.append(&c, 1);
+        // Sniffed before anything is scanned, next() would skip the prefix as junk between JSON objects
+        if (framer.framing() == MessageFramer::Framing::JsonObjects) {
+            if (framer.pending() == "OCB1") {
+                framer.consume(4);
+                framer.setFraming(MessageFramer::Framing::LengthPrefixed);
+            }
+            continue;
+        }
+        for (auto& m : drain(framer)) messages.push_back(m);
+    }
+
+    ASSERT_EQ(messages.size(), 3u);
+    EXPECT_EQ(messages[0], "abc");
+    EXPECT_EQ(messages[1], "");
+    EXPECT_EQ(messages[2], std::string(300, 'x'));
+    EXPECT_EQ(framer.buffered(), 0u);
+
+    MessageFramer small(64, 128);
+    small.setFraming(MessageFramer::Framing::LengthPrefixed);
+    small.append("\xFF\x00\x00\x00", 4);
+    std::string_view message;
+    EXPECT_THROW(small.next(message), std::runtime_error);
+    EXPECT_EQ(small.buffered(), 0u);
+}
@@ -0,0 +1,260 @@
+#include "pch.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FakeTransport.h"
+#include "TestServer.h"
+
+#include "../OpenConnectV1/MetricsExporter.h"
+#include "../OpenConnectV1/Server.h"
+
+using namespace OpenConnectV1;
+
+TEST(MetricsTest, SumsEveryThreadsCounters) {
+    Metrics metrics;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&metrics] {
+            for (int i = 0; i < 10000; i++) {
+                metrics.add(MetricCounter::MessagesParsed);
+                metrics.add(MetricCounter::BytesReceived, 10);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    MetricsSnapshot snapshot;
+    metrics.collect(snapshot);
+    EXPECT_EQ(snapshot.counter(MetricCounter::MessagesParsed), 40000u);
+    EXPECT_EQ(snapshot.counter(MetricCounter::BytesReceived), 400000u);
+    EXPECT_EQ(snapshot.counter(MetricCounter::ParseFailures), 0u);
+}
+
+TEST(MetricsTest, KeepsOneShardPerThreadAndFoldsItInOnExit) {
+    // More instances than a thread would ever have cached, recorded into round robin
+    std::vector<std::unique_ptr<Metrics>> instances;
+    for (int m = 0; m < 6; m++) {
+        instances.push_back(std::make_unique<Metrics>());
+    }
+    for (int round = 0; round < 3; round++) {
+        std::thread([&instances] {
+            for (int i = 0; i < 100; i++) {
+                for (auto& metrics : instances) {
+                    metrics->add(MetricCounter::ResponsesSent);
+                }
+            }
+            EXPECT_EQ(instances.front()->shardCount(), 1u);
+        }).join();
+    }
+
+    for (auto& metrics : instances) {
+        EXPECT_EQ(metrics->shardCount(), 0u);
+        MetricsSnapshot snapshot;
+        metrics->collect(snapshot);
+        EXPECT_EQ(snapshot.counter(MetricCounter::ResponsesSent), 300u);
+    }
+}
+
+TEST(MetricsTest, RecordsDurationsIntoFixedBuckets) {
+    Metrics metrics;
+    for (int i = 0; i < 98; i++) {
+        metrics.record(MetricHistogram::ListenerDuration, 2'000);
+    }
+    metrics.record(MetricHistogram::ListenerDuration, 3'000'000);
+    metrics.record(MetricHistogram::ListenerDuration, 60'000'000'000);
+
+    MetricsSnapshot snapshot;
+    metrics.collect(snapshot);
+    const HistogramSnapshot& histogram = snapshot.histogram(MetricHistogram::ListenerDuration);
+    EXPECT_EQ(histogram.Count, 100u);
+    EXPECT_EQ(histogram.SumNs, 98u * 2'000 + 3'000'000 + 60'000'000'000);
+    EXPECT_EQ(histogram.percentileNs(50), 2'500);
+    EXPECT_EQ(histogram.percentileNs(99), 5'000'000);
+    EXPECT_EQ(histogram.Buckets.back(), 1u);
+    EXPECT_EQ(snapshot.histogram(MetricHistogram::RecvToParse).Count, 0u);
+}
+
+TEST(MetricsTest, FormatsPrometheusText) {
+    Metrics metrics;
+    metrics.add(MetricCounter::ParseFailures, 3);
+    metrics.record(MetricHistogram::SendResponse, 400);
+    metrics.record(MetricHistogram::SendResponse, 7'000'000'000);
+
+    MetricsSnapshot snapshot;
+    metrics.collect(snapshot);
+    snapshot.ActiveConnections = 2;
+    std::string text = formatPrometheus(snapshot);
+
+    EXPECT_NE(text.find("# TYPE openconnect_parse_failures_total counter\nopenconnect_parse_failures_total 3\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE openconnect_send_response_duration_seconds histogram\n"), std::string::npos);
+    EXPECT_NE(text.find("openconnect_send_response_duration_seconds_bucket{le=\"2.5e-07\"} 0\n"), std::string::npos);
+    EXPECT_NE(text.find("openconnect_send_response_duration_seconds_bucket{le=\"5e-07\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("openconnect_send_response_duration_seconds_bucket{le=\"+Inf\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("openconnect_send_response_duration_seconds_count 2\n"), std::string::npos);
+    EXPECT_NE(text.find("openconnect_connections 2\n"), std::string::npos);
+
+    // Every counter is described
+    for (size_t counter = 0; counter < METRIC_COUNTERS; counter++) {
+        std::string name = metricName(static_cast<MetricCounter>(counter));
+        EXPECT_EQ(text.find("# HELP " + name + "_total \n"), std::string::npos) << name;
+    }
+}
+
+class ServerMetricsTest : public TestServer {
+protected:
+    class ThrowingListener : public ServerListener {
+    public:
+        void onShotDataReceived(const ShotData& shotData) override {
+            if (shotData.ShotNumber == 13) {
+                throw std::runtime_error("Unlucky shot");
+            }
+        }
+        void onStatusChanged(const ServerStatus& status) override {}
+    };
+
+    void SetUp() override {
+        TestServer::SetUp();
+        server->addListener(std::make_shared<ThrowingListener>());
+        start();
+    }
+
+    static std::string message(int shotNumber, bool isHeartBeat) {
+        ShotData shotData;
+        shotData.ShotNumber = shotNumber;
+        shotData.ShotDataOptions.IsHeartBeat = isHeartBeat;
+        return jsonMessage(shotData);
+    }
+};
+
+TEST_F(ServerMetricsTest, CountsTheIngestPath) {
+    transport->connect(1, "127.0.0.1:50000");
+    std::string bytes = message(1, false) + message(2, true) + "{\"ShotNumber\":tru}" + message(13, false);
+    transport->deliver(1, bytes);
+    transport->flush();
+
+    MetricsSnapshot snapshot = server->metricsSnapshot();
+    EXPECT_EQ(snapshot.counter(MetricCounter::BytesReceived), bytes.size());
+    EXPECT_EQ(snapshot.counter(MetricCounter::MessagesParsed), 3u);
+    EXPECT_EQ(snapshot.counter(MetricCounter::ShotsReceived), 2u);
+    EXPECT_EQ(snapshot.counter(MetricCounter::HeartbeatsReceived), 1u);
+    EXPECT_EQ(snapshot.counter(MetricCounter::ParseFailures), 1u);
+    EXPECT_EQ(snapshot.counter(MetricCounter::ListenerErrors), 1u);
+    EXPECT_EQ(snapshot.histogram(MetricHistogram::RecvToParse).Count, 3u);
+    EXPECT_EQ(snapshot.histogram(MetricHistogram::ParseToDispatch).Count, 3u);
+    EXPECT_EQ(snapshot.histogram(MetricHistogram::ListenerDuration).Count, 2u);
+    EXPECT_EQ(snapshot.ActiveConnections, 1u);
+}
+
+TEST_F(ServerMetricsTest, CountsConnectionsAndResponses) {
+    transport->connect(1, "127.0.0.1:50000");
+    transport->disconnect(1);
+    transport->connect(2, "127.0.0.1:50001");
+    transport->connect(3, "10.0.0.5:50000");
+    transport->flush();
+
+    Response response(ResponseCode::OK, "Shot received successfully");
+    server->sendResponse(response);
+    server->sendResponse(1, response);
+    transport->flush();
+
+    MetricsSnapshot snapshot = server->metricsSnapshot();
+    EXPECT_EQ(snapshot.counter(MetricCounter::ConnectionsAccepted), 3u);
+    EXPECT_EQ(snapshot.counter(MetricCounter::Disconnects), 1u);
+    EXPECT_EQ(snapshot.counter(MetricCounter::Reconnects), 1u);
+    EXPECT_EQ(snapshot.counter(MetricCounter::ResponsesSent), 2u);
+    EXPECT_EQ(snapshot.counter(MetricCounter::BytesSent), transport->sent(2).size() + transport->sent(3).size());
+    EXPECT_EQ(snapshot.counter(MetricCounter::SendErrors), 1u);
+    EXPECT_EQ(snapshot.histogram(MetricHistogram::SendResponse).Count, 2u);
+}
+
+TEST_F(ServerMetricsTest, LatencyMetricsCanBeSwitchedOff) {
+    server->setLatencyMetrics(false);
+    transport->connect(1, "127.0.0.1:50000");
+    transport->deliver(1, message(1, false));
+    transport->flush();
+
+    MetricsSnapshot snapshot = server->metricsSnapshot();
+    EXPECT_EQ(snapshot.counter(MetricCounter::MessagesParsed), 1u);
+    EXPECT_EQ(snapshot.histogram(MetricHistogram::RecvToParse).Count, 0u);
+    EXPECT_EQ(snapshot.histogram(MetricHistogram::ListenerDuration).Count, 0u);
+}
+
+TEST_F(ServerMetricsTest, ReporterWritesPrometheusFile) {
+    auto path = std::filesystem::temp_directory_path() / "openconnect-metrics-test.prom";
+    transport->connect(1, "127.0.0.1:50000");
+    transport->deliver(1, message(1, false));
+    transport->flush();
+
+    {
+        MetricsReporter reporter(*server, std::make_shared<PrometheusFileExporter>(path.string()), std::chrono::hours(1));
+    }
+
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    EXPECT_NE(contents.str().find("openconnect_messages_parsed_total 1\n"), std::string::npos);
+    EXPECT_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+    file.close();
+    std::filesystem::remove(path);
+}
+
+TEST(PrometheusEndpointTest, AnswersLoopbackScrapes) {
+    auto fake = std::make_unique<FakeTransport>();
+    FakeTransport* transport = fake.get();
+    PrometheusEndpoint endpoint(9100, std::move(fake));
+    transport->waitUntilRunning();
+
+    MetricsSnapshot snapshot;
+    snapshot.Counters[static_cast<size_t>(MetricCounter::Reconnects)] = 4;
+    endpoint.exportMetrics(snapshot);
+
+    transport->connect(1, "127.0.0.1:40000");
+    transport->deliver(1, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n");
+    transport->flush();
+    EXPECT_EQ(transport->sent(1), "");
+
+    transport->deliver(1, "\r\n");
+    transport->flush();
+    std::string response = transport->sent(1);
+    EXPECT_EQ(response.rfind("HTTP/1.0 200 OK\r\n", 0), 0u);
+    EXPECT_NE(response.find("openconnect_reconnects_total 4\n"), std::string::npos);
+
+    transport->connect(2, "192.168.1.20:40000");
+    transport->deliver(2, "GET /metrics HTTP/1.1\r\n\r\n");
+    transport->flush();
+    EXPECT_EQ(transport->sent(2), "");
+}
+
+TEST(PrometheusEndpointTest, SlowScraperDoesntHoldUpOthers) {
+    auto fake = std::make_unique<FakeTransport>();
+    FakeTransport* transport = fake.get();
+    PrometheusEndpoint endpoint(9100, std::move(fake));
+    transport->waitUntilRunning();
+    endpoint.exportMetrics(MetricsSnapshot());
+
+    // The first scraper's socket fills after 16 bytes, the rest waits for it to be writable
+    transport->limitSends(1, 16);
+    transport->connect(1, "127.0.0.1:40000");
+    transport->deliver(1, "GET /metrics HTTP/1.1\r\n\r\n");
+    transport->connect(2, "127.0.0.1:40001");
+    transport->deliver(2, "GET /metrics HTTP/1.1\r\n\r\n");
+    transport->flush();
+    EXPECT_EQ(transport->sent(1).size(), 16u);
+    EXPECT_TRUE(transport->watchingWritable(1));
+    EXPECT_NE(transport->sent(2).find("openconnect_connections 0\n"), std::string::npos);
+
+    transport->drainSends(1);
+    transport->flush();
+    EXPECT_EQ(transport->sent(1), transport->sent(2));
+    EXPECT_FALSE(transport->watchingWritable(1));
+}
@@ -0,0 +1,108 @@
+#include "pch.h"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../OpenConnectV1/ResponseCache.h"
+
+using namespace OpenConnectV1;
+
+namespace {
+    Response playerInfo(const std::string& club) {
+        return Response(ResponseCode::PlayerInfo, "GSPro Player Information", PlayerData("RH", club));
+    }
+}
+
+TEST(ResponseCacheTest, HitsShareTheEncodedBytes) {
+    ResponseCache cache;
+    std::shared_ptr<const std::string> first = cache.get(playerInfo("DR"));
+    std::shared_ptr<const std::string> second = cache.get(playerInfo("DR"));
+    EXPECT_EQ(first, second);
+
+    char buffer[256];
+    size_t length = encode(playerInfo("DR"), buffer, sizeof(buffer));
+    EXPECT_EQ(*first, std::string(buffer, length) + "\n");
+
+    // Every field is part of the key
+    EXPECT_NE(cache.get(playerInfo("7I")), first);
+    EXPECT_NE(cache.get(Response(ResponseCode::PlayerInfo, "GSPro Player Information", PlayerData("LH", "DR"))), first);
+    EXPECT_NE(cache.get(Response(ResponseCode::OK, "GSPro Player Information", PlayerData("RH", "DR"))), first);
+
+    ResponseCacheStats stats = cache.stats();
+    EXPECT_EQ(stats.Capacity, ResponseCache::DEFAULT_CAPACITY);
+    EXPECT_EQ(stats.Size, 4u);
+    EXPECT_EQ(stats.Hits, 1u);
+    EXPECT_EQ(stats.Misses, 4u);
+    EXPECT_EQ(stats.Evictions, 0u);
+}
+
+TEST(ResponseCacheTest, EvictsTheLeastRecentlyUsed) {
+    ResponseCache cache(2);
+    auto driver = cache.get(playerInfo("DR"));
+    auto wood = cache.get(playerInfo("3W"));
+    EXPECT_EQ(cache.get(playerInfo("DR")), driver);
+
+    // 3W is the older of the two now
+    auto iron = cache.get(playerInfo("7I"));
+    EXPECT_EQ(cache.get(playerInfo("DR")), driver);
+    EXPECT_EQ(cache.get(playerInfo("7I")), iron);
+    EXPECT_NE(cache.get(playerInfo("3W")), wood);
+    EXPECT_EQ(*cache.get(playerInfo("3W")), *wood);
+
+    ResponseCacheStats stats = cache.stats();
+    EXPECT_EQ(stats.Size, 2u);
+    EXPECT_EQ(stats.Evictions, 2u);
+
+    cache.setCapacity(1);
+    stats = cache.stats();
+    EXPECT_EQ(stats.Size, 1u);
+    EXPECT_EQ(stats.Evictions, 3u);
+    EXPECT_EQ(cache.get(playerInfo("3W")), cache.get(playerInfo("3W")));
+}
+
+TEST(ResponseCacheTest, ConcurrentMissesInsertTheKeyOnce) {
+    ResponseCache cache;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&cache] {
+            for (int i = 0; i < 200; i++) {
+                cache.get(playerInfo(std::to_string(i % 4) + "I"));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ResponseCacheStats stats = cache.stats();
+    EXPECT_EQ(stats.Size, 4u);
+    EXPECT_EQ(stats.Evictions, 0u);
+    EXPECT_EQ(stats.Hits + stats.Misses, 8u * 200);
+    EXPECT_EQ(cache.get(playerInfo("0I")), cache.get(playerInfo("0I")));
+}
+
+TEST(ResponseCacheTest, ZeroCapacityEncodesEveryResponse) {
+    ResponseCache cache(0);
+    auto first = cache.get(playerInfo("DR"));
+    auto second = cache.get(playerInfo("DR"));
+    EXPECT_NE(first, second);
+    EXPECT_EQ(*first, *second);
+    EXPECT_EQ(*first, codecFor(WireFormat::Json).encodeToString(playerInfo("DR")));
+
+    ResponseCacheStats stats = cache.stats();
+    EXPECT_EQ(stats.Size, 0u);
+    EXPECT_EQ(stats.Hits, 0u);
+    EXPECT_EQ(stats.Misses, 2u);
+}
+
+TEST(ResponseCacheTest, EncodesResponsesLongerThanTheFirstBuffer) {
+    ResponseCache cache;
+    Response response(ResponseCode::Error, std::string(1000, 'x'));
+    std::shared_ptr<const std::string> bytes = cache.get(response);
+
+    std::string expected(2048, '\0');
+    expected.resize(encode(response, expected.data(), expected.size()));
+    EXPECT_EQ(*bytes, expected + "\n");
+}
@@ -1,6 +1,14 @@
 #include "pch.h"
 
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "FakeTransport.h"
+#include "TestServer.h"
 #include "../OpenConnectV1/Server.h"
 #include "../OpenConnectV1/Data.h"
 
@@ -93,3 +101,199 @@ TEST_F(ShotDataListenerTest, TestOnShotDataReceived) {
     EXPECT_FALSE(testListener.receivedShotData.ShotDataOptions.LaunchMonitorBallDetected);
     EXPECT_FALSE(testListener.receivedShotData.ShotDataOptions.IsHeartBeat);
 }
+
+class ServerListenersTest : public TestServer {
+protected:
+    class RecordingListener : public OpenConnectV1::ServerListener {
+    public:
+        std::vector<int> shotNumbers;
+        std::vector<OpenConnectV1::ServerStatus> statuses;
+        std::function<void()> onShot;
+        int heartbeats = 0;
+
+        void onShotDataReceived(const OpenConnectV1::ShotData& shotData) override {
+            shotNumbers.push_back(shotData.ShotNumber);
+            if (onShot) {
+                onShot();
+            }
+        }
+
+        void onStatusChanged(const OpenConnectV1::ServerStatus& status) override {
+            statuses.push_back(status);
+        }
+
+        void onHeartbeat(OpenConnectV1::ConnectionId connection, const OpenConnectV1::ShotDataOptions& options) override {
+            heartbeats++;
+        }
+    };
+
+    void start() {
+        TestServer::start();
+        transport->connect(1, "127.0.0.1:50000");
+    }
+
+    void deliver(int shotNumber, bool isHeartBeat, bool containsBallData, bool ready = false) {
+        OpenConnectV1::ShotData shotData;
+        shotData.DeviceID = "TestDevice";
+        shotData.ShotNumber = shotNumber;
+        shotData.ShotDataOptions.IsHeartBeat = isHeartBeat;
+        shotData.ShotDataOptions.ContainsBallData = containsBallData;
+        shotData.ShotDataOptions.LaunchMonitorIsReady = ready;
+
+        transport->deliver(1, jsonMessage(shotData));
+        transport->flush();
+    }
+};
+
+TEST_F(ServerListenersTest, NotifiesEveryListenerThroughItsFilter) {
+    auto all = std::make_shared<RecordingListener>();
+    auto heartbeats = std::make_shared<RecordingListener>();
+    auto shots = std::make_shared<RecordingListener>();
+    auto ballData = std::make_shared<RecordingListener>();
+    server->addListener(all);
+    server->addListener(heartbeats, OpenConnectV1::ListenerFilter::HeartBeatsOnly);
+    server->addListener(shots, OpenConnectV1::ListenerFilter::ShotsOnly);
+    server->addListener(ballData, OpenConnectV1::ListenerFilter::BallDataOnly);
+
+    start();
+    deliver(0, true, false);
+    deliver(1, false, true);
+    deliver(2, false, false);
+
+    EXPECT_EQ(all->shotNumbers, (std::vector<int>{ 0, 1, 2 }));
+    EXPECT_EQ(heartbeats->shotNumbers, (std::vector<int>{ 0 }));
+    EXPECT_EQ(shots->shotNumbers, (std::vector<int>{ 1, 2 }));
+    EXPECT_EQ(ballData->shotNumbers, (std::vector<int>{ 1 }));
+
+    // Status changes go to every listener regardless of the filter
+    std::vector<OpenConnectV1::ServerStatus> expected = { OpenConnectV1::ServerStatus::Listening, OpenConnectV1::ServerStatus::Connected };
+    EXPECT_EQ(all->statuses, expected);
+    EXPECT_EQ(heartbeats->statuses, expected);
+}
+
+TEST_F(ServerListenersTest, HeartbeatsSkipShotDataWhenNobodySubscribes) {
+    auto shots = std::make_shared<RecordingListener>();
+    auto ballData = std::make_shared<RecordingListener>();
+    server->addListener(shots, OpenConnectV1::ListenerFilter::ShotsOnly);
+    server->addListener(ballData, OpenConnectV1::ListenerFilter::BallDataOnly);
+
+    start();
+    deliver(0, true, false, true);
+    deliver(1, false, true, true);
+    deliver(0, true, false, false);
+
+    EXPECT_EQ(shots->shotNumbers, (std::vector<int>{ 1 }));
+    EXPECT_EQ(ballData->shotNumbers, (std::vector<int>{ 1 }));
+    EXPECT_EQ(shots->heartbeats, 2);
+    EXPECT_EQ(ballData->heartbeats, 2);
+
+    std::vector<OpenConnectV1::ConnectionInfo> connections = server->getConnections();
+    ASSERT_EQ(connections.size(), 1u);
+    EXPECT_EQ(connections[0].Heartbeats, 2u);
+    EXPECT_EQ(connections[0].LastShotNumber, 1);
+    EXPECT_FALSE(connections[0].LaunchMonitorIsReady);
+
+    OpenConnectV1::MetricsSnapshot metrics = server->metricsSnapshot();
+    EXPECT_EQ(metrics.counter(OpenConnectV1::MetricCounter::HeartbeatsReceived), 2u);
+    EXPECT_EQ(metrics.counter(OpenConnectV1::MetricCounter::ShotsReceived), 1u);
+}
+
+TEST_F(ServerListenersTest, HeartbeatSubscribersStillGetShotData) {
+    auto heartbeats = std::make_shared<RecordingListener>();
+    auto shots = std::make_shared<RecordingListener>();
+    server->addListener(heartbeats, OpenConnectV1::ListenerFilter::HeartBeatsOnly);
+    server->addListener(shots, OpenConnectV1::ListenerFilter::ShotsOnly);
+
+    start();
+    deliver(0, true, false, true);
+    deliver(1, false, true, true);
+
+    EXPECT_EQ(heartbeats->shotNumbers, (std::vector<int>{ 0 }));
+    EXPECT_EQ(heartbeats->heartbeats, 1);
+    EXPECT_EQ(shots->shotNumbers, (std::vector<int>{ 1 }));
+    EXPECT_EQ(shots->heartbeats, 1);
+
+    std::vector<OpenConnectV1::ConnectionInfo> connections = server->getConnections();
+    ASSERT_EQ(connections.size(), 1u);
+    EXPECT_EQ(connections[0].Heartbeats, 1u);
+    EXPECT_TRUE(connections[0].LaunchMonitorIsReady);
+}
+
+TEST_F(ServerListenersTest, RemovedListenerIsNoLongerNotified) {
+    auto first = std::make_shared<RecordingListener>();
+    auto second = std::make_shared<RecordingListener>();
+    OpenConnectV1::ListenerToken firstToken = server->addListener(first);
+    OpenConnectV1::ListenerToken secondToken = server->addListener(second);
+    EXPECT_NE(firstToken, secondToken);
+
+    start();
+    deliver(1, false, true);
+    EXPECT_TRUE(server->removeListener(firstToken));
+    EXPECT_FALSE(server->removeListener(firstToken));
+    deliver(2, false, true);
+
+    EXPECT_EQ(first->shotNumbers, (std::vector<int>{ 1 }));
+    EXPECT_EQ(second->shotNumbers, (std::vector<int>{ 1, 2 }));
+}
+
+TEST_F(ServerListenersTest, ListenerCanUnsubscribeItselfFromCallback) {
+    auto once = std::make_shared<RecordingListener>();
+    auto other = std::make_shared<RecordingListener>();
+    OpenConnectV1::ListenerToken onceToken = server->addListener(once);
+    server->addListener(other);
+    once->onShot = [this, onceToken] { server->removeListener(onceToken); };
+
+    start();
+    deliver(1, false, true);
+    deliver(2, false, true);
+
+    EXPECT_EQ(once->shotNumbers, (std::vector<int>{ 1 }));
+    EXPECT_EQ(other->shotNumbers, (std::vector<int>{ 1, 2 }));
+}
+
+TEST_F(ServerListenersTest, SetListenerReplacesEveryListener) {
+    auto first = std::make_shared<RecordingListener>();
+    auto second = std::make_shared<RecordingListener>();
+    server->addListener(first);
+    server->setListener(second);
+
+    start();
+    deliver(1, false, true);
+
+    EXPECT_TRUE(first->shotNumbers.empty());
+    EXPECT_EQ(second->shotNumbers, (std::vector<int>{ 1 }));
+}
+
+TEST_F(ServerListenersTest, WritersDontWaitForReadersThatStartAfterThem) {
+    // Overlapping callbacks on several threads, so some reader is always inside a snapshot
+    class SlowListener : public OpenConnectV1::ServerListener {
+    public:
+        void onShotDataReceived(const OpenConnectV1::ShotData& shotData) override {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        void onStatusChanged(const OpenConnectV1::ServerStatus& status) override {}
+    };
+    server->addListener(std::make_shared<SlowListener>());
+
+    std::atomic<int> readersRunning{ 0 };
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; t++) {
+        readersRunning++;
+        readers.emplace_back([this, &readersRunning] {
+            OpenConnectV1::ShotData shotData;
+            for (int i = 0; i < 500; i++) {
+                server->injectShotData(1, shotData);
+            }
+            readersRunning--;
+        });
+        std::this_thread::sleep_for(std::chrono::microseconds(700));
+    }
+
+    for (int i = 0; i < 10; i++) {
+        server->removeListener(server->addListener(std::make_shared<RecordingListener>()));
+    }
+    EXPECT_EQ(readersRunning.load(), 3);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+}
@@ -3,16 +3,18 @@
 #include <gtest/gtest.h>
 #include <thread>
 #include <chrono>
-#include <winsock2.h>
-#include <ws2tcpip.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include "FakeTransport.h"
+#include "TestServer.h"
+#include "TestSockets.h"
 #include <nlohmann/json.hpp>
 
 #include "../OpenConnectV1/Server.h"
 #include "../OpenConnectV1/Data.h"
 #include "../OpenConnectV1/Logger.h"
 
-#pragma comment(lib, "Ws2_32.lib")
-
 class ServerTest : public ::testing::Test {
 protected:
     static constexpr int TEST_PORT = 5001;
@@ -58,8 +60,27 @@ protected:
             return -1;
         }
 
+        // connect() completes in the kernel backlog, give the server loop a moment to accept it
+        size_t expected = connectedClients + 1;
+        for (int i = 0; i < 100 && server->getConnections().size() < expected; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        connectedClients = server->getConnections().size();
+
         return clientSocket;
     }
+
+    std::string receiveLine(SOCKET clientSocket) {
+        std::string line;
+        char c;
+        while (recv(clientSocket, &c, 1, 0) == 1 && c != '\n') {
+            line += c;
+        }
+        return line;
+    }
+
+private:
+    size_t connectedClients = 0;
 };
 
 TEST_F(ServerTest, TestServerStartupAndShotDataReception) {
@@ -108,3 +129,137 @@ TEST_F(ServerTest, TestServerSendResponse) {
     closesocket(clientSocket);
     WSACleanup();
 }
+
+
+TEST_F(ServerTest, TestServerMultipleClients) {
+    SOCKET firstSocket = createClientSocket();
+    SOCKET secondSocket = createClientSocket();
+
+    auto connections = server->getConnections();
+    ASSERT_EQ(connections.size(), 2u);
+    EXPECT_EQ(server->getStatus(), OpenConnectV1::ServerStatus::Connected);
+    for (auto& connection : connections) {
+        EXPECT_EQ(connection.Status, OpenConnectV1::ServerStatus::Connected);
+        EXPECT_EQ(connection.Address.rfind("127.0.0.1", 0), 0u);
+    }
+
+    // The second client connected last, the ids are handed out in accept order
+    OpenConnectV1::ConnectionId secondId = std::max(connections[0].Id, connections[1].Id);
+
+    OpenConnectV1::Response targeted(OpenConnectV1::ResponseCode::PlayerInfo, "Targeted", OpenConnectV1::PlayerData("LH", "I7"));
+    OpenConnectV1::Response broadcast(OpenConnectV1::ResponseCode::OK, "Broadcast", OpenConnectV1::PlayerData("RH", "DR"));
+    server->sendResponse(secondId, targeted);
+    server->sendResponse(broadcast);
+
+    EXPECT_EQ(nlohmann::json::parse(receiveLine(firstSocket))["Message"], "Broadcast");
+    EXPECT_EQ(nlohmann::json::parse(receiveLine(secondSocket))["Message"], "Targeted");
+    EXPECT_EQ(nlohmann::json::parse(receiveLine(secondSocket))["Message"], "Broadcast");
+
+    closesocket(secondSocket);
+    for (int i = 0; i < 100 && server->getConnections().size() != 1; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(server->getConnections().size(), 1u);
+    EXPECT_EQ(server->getStatus(), OpenConnectV1::ServerStatus::Connected);
+
+    closesocket(firstSocket);
+    for (int i = 0; i < 100 && server->getStatus() != OpenConnectV1::ServerStatus::Listening; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(server->getStatus(), OpenConnectV1::ServerStatus::Listening);
+
+    WSACleanup();
+}
+
+class ServerOutboundTest : public TestServer {
+protected:
+    void SetUp() override {
+        TestServer::SetUp();
+        start();
+        transport->connect(1, "127.0.0.1:50000");
+        transport->flush();
+    }
+
+    static std::string line(OpenConnectV1::Response response) {
+        char buffer[512];
+        size_t length = OpenConnectV1::encode(response, buffer, sizeof(buffer));
+        return std::string(buffer, length) + "\n";
+    }
+
+    uint64_t counter(OpenConnectV1::MetricCounter counter) {
+        return server->metricsSnapshot().counter(counter);
+    }
+};
+
+TEST_F(ServerOutboundTest, FinishesPartialWritesOnceTheSocketDrains) {
+    OpenConnectV1::Response response(OpenConnectV1::ResponseCode::OK, "Shot received successfully");
+    transport->limitSends(1, 10);
+    server->sendResponse(1, response);
+    transport->flush();
+    EXPECT_EQ(transport->sent(1), line(response).substr(0, 10));
+    EXPECT_TRUE(transport->watchingWritable(1));
+    EXPECT_EQ(counter(OpenConnectV1::MetricCounter::ResponsesSent), 0u);
+
+    transport->drainSends(1, 5);
+    transport->flush();
+    EXPECT_EQ(transport->sent(1), line(response).substr(0, 15));
+
+    transport->drainSends(1);
+    transport->flush();
+    EXPECT_EQ(transport->sent(1), line(response));
+    EXPECT_FALSE(transport->watchingWritable(1));
+    EXPECT_EQ(counter(OpenConnectV1::MetricCounter::ResponsesSent), 1u);
+    EXPECT_EQ(counter(OpenConnectV1::MetricCounter::BytesSent), line(response).size());
+}
+
+TEST_F(ServerOutboundTest, CoalescesQueuedPlayerInfoIntoOneWrite) {
+    OpenConnectV1::Response ok(OpenConnectV1::ResponseCode::OK, "Shot received successfully");
+    OpenConnectV1::Response driver(OpenConnectV1::ResponseCode::PlayerInfo, "GSPro Player Information", OpenConnectV1::PlayerData("RH", "DR"));
+    OpenConnectV1::Response wood(OpenConnectV1::ResponseCode::PlayerInfo, "GSPro Player Information", OpenConnectV1::PlayerData("RH", "W3"));
+    OpenConnectV1::Response iron(OpenConnectV1::ResponseCode::PlayerInfo, "GSPro Player Information", OpenConnectV1::PlayerData("RH", "I7"));
+
+    transport->limitSends(1, 0);
+    server->sendResponse(1, driver);
+    server->sendResponse(1, ok);
+    server->sendResponse(1, wood);
+    server->sendResponse(iron);
+    transport->flush();
+    EXPECT_EQ(transport->sent(1), "");
+
+    transport->drainSends(1);
+    transport->flush();
+    EXPECT_EQ(transport->sent(1), line(ok) + line(iron));
+    EXPECT_EQ(counter(OpenConnectV1::MetricCounter::ResponsesCoalesced), 2u);
+    EXPECT_EQ(counter(OpenConnectV1::MetricCounter::ResponsesSent), 2u);
+    // The write that found the socket full and the one that sent both responses
+    EXPECT_EQ(transport->sendCalls(1), 2u);
+}
+
+TEST_F(ServerOutboundTest, DropsResponsesOverTheHighWaterMark) {
+    OpenConnectV1::Response response(OpenConnectV1::ResponseCode::OK, "Shot received successfully");
+    server->setOutboundHighWaterMark(line(response).size() + 1);
+    transport->limitSends(1, 0);
+    for (int i = 0; i < 5; i++) {
+        server->sendResponse(1, response);
+    }
+    transport->flush();
+    EXPECT_EQ(counter(OpenConnectV1::MetricCounter::ResponsesDropped), 4u);
+
+    transport->drainSends(1);
+    transport->flush();
+    EXPECT_EQ(transport->sent(1), line(response));
+}
+
+TEST_F(ServerOutboundTest, ClosesTheConnectionWhenAWriteFails) {
+    OpenConnectV1::Response response(OpenConnectV1::ResponseCode::OK, "Shot received successfully");
+    transport->limitSends(1, 0);
+    server->sendResponse(1, response);
+    transport->flush();
+
+    // The socket goes away under the queued response
+    transport->close(1);
+    transport->drainSends(1);
+    transport->flush();
+    EXPECT_TRUE(server->getConnections().empty());
+    EXPECT_EQ(counter(OpenConnectV1::MetricCounter::SendErrors), 1u);
+}
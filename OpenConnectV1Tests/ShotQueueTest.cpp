@@ -0,0 +1,174 @@
+#include "pch.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "TestShots.h"
+#include "../OpenConnectV1/ShotQueue.h"
+
+using namespace OpenConnectV1;
+
+namespace {
+    ShotData heartbeat(int shotNumber) {
+        ShotData shotData = makeShot(shotNumber);
+        shotData.ShotDataOptions = ShotDataOptions(false, false, true, false, true);
+        return shotData;
+    }
+
+    std::vector<int> drain(ShotQueue& queue) {
+        std::vector<int> shotNumbers;
+        ConnectionId connection;
+        ShotData shotData;
+        while (queue.tryPop(connection, shotData)) {
+            shotNumbers.push_back(shotData.ShotNumber);
+        }
+        return shotNumbers;
+    }
+}
+
+TEST(ShotQueueTest, DeliversInOrder) {
+    ShotQueue queue(4);
+    ASSERT_TRUE(queue.push(7, makeShot(1)));
+    ASSERT_TRUE(queue.push(8, makeShot(2)));
+
+    ConnectionId connection;
+    ShotData shotData;
+    ASSERT_TRUE(queue.tryPop(connection, shotData));
+    EXPECT_EQ(connection, 7u);
+    EXPECT_EQ(shotData.ShotNumber, 1);
+    EXPECT_EQ(shotData.DeviceID, "GSPro LM 1.1");
+    ASSERT_TRUE(queue.tryPop(connection, shotData));
+    EXPECT_EQ(connection, 8u);
+    EXPECT_EQ(shotData.ShotNumber, 2);
+    EXPECT_FALSE(queue.tryPop(connection, shotData));
+
+    auto stats = queue.stats();
+    EXPECT_EQ(stats.Enqueued, 2u);
+    EXPECT_EQ(stats.Depth, 0u);
+    EXPECT_EQ(stats.HighWatermark, 2u);
+    EXPECT_EQ(stats.Dropped, 0u);
+}
+
+TEST(ShotQueueTest, RoundsCapacityUpToPowerOfTwo) {
+    EXPECT_EQ(ShotQueue(5).capacity(), 8u);
+    EXPECT_EQ(ShotQueue(8).capacity(), 8u);
+    EXPECT_EQ(ShotQueue(0).capacity(), 1u);
+}
+
+TEST(ShotQueueTest, DropOldestKeepsNewestEntries) {
+    ShotQueue queue(4, OverflowPolicy::DropOldest);
+    for (int i = 1; i <= 10; i++) {
+        ASSERT_TRUE(queue.push(1, makeShot(i)));
+    }
+
+    EXPECT_EQ(queue.depth(), 4u);
+    EXPECT_EQ(drain(queue), (std::vector<int>{ 7, 8, 9, 10 }));
+    EXPECT_EQ(queue.stats().Dropped, 6u);
+}
+
+TEST(ShotQueueTest, DropHeartbeatsDropsIncomingHeartbeatsWhenFull) {
+    ShotQueue queue(2, OverflowPolicy::DropHeartbeats);
+    ASSERT_TRUE(queue.push(1, makeShot(1)));
+    ASSERT_TRUE(queue.push(1, makeShot(2)));
+
+    EXPECT_FALSE(queue.push(1, heartbeat(0)));
+
+    auto stats = queue.stats();
+    EXPECT_EQ(stats.Dropped, 1u);
+    EXPECT_EQ(stats.DroppedHeartbeats, 1u);
+    EXPECT_EQ(drain(queue), (std::vector<int>{ 1, 2 }));
+}
+
+TEST(ShotQueueTest, DropHeartbeatsEvictsQueuedHeartbeatForShot) {
+    ShotQueue queue(2, OverflowPolicy::DropHeartbeats);
+    ASSERT_TRUE(queue.push(1, heartbeat(100)));
+    ASSERT_TRUE(queue.push(1, makeShot(1)));
+
+    ASSERT_TRUE(queue.push(1, makeShot(2)));
+
+    EXPECT_EQ(queue.stats().DroppedHeartbeats, 1u);
+    EXPECT_EQ(drain(queue), (std::vector<int>{ 1, 2 }));
+}
+
+TEST(ShotQueueTest, BlockWaitsForConsumer) {
+    ShotQueue queue(2, OverflowPolicy::Block);
+    ASSERT_TRUE(queue.push(1, makeShot(1)));
+    ASSERT_TRUE(queue.push(1, makeShot(2)));
+
+    std::atomic<bool> pushed{ false };
+    std::thread producer([&] {
+        queue.push(1, makeShot(3));
+        pushed = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(pushed.load());
+
+    ConnectionId connection;
+    ShotData shotData;
+    ASSERT_TRUE(queue.pop(connection, shotData));
+    EXPECT_EQ(shotData.ShotNumber, 1);
+
+    producer.join();
+    EXPECT_TRUE(pushed.load());
+    EXPECT_EQ(drain(queue), (std::vector<int>{ 2, 3 }));
+    EXPECT_EQ(queue.stats().Dropped, 0u);
+}
+
+TEST(ShotQueueTest, CloseWakesConsumerAfterDraining) {
+    ShotQueue queue(4);
+    ASSERT_TRUE(queue.push(1, makeShot(1)));
+
+    std::vector<int> received;
+    std::thread consumer([&] {
+        ConnectionId connection;
+        ShotData shotData;
+        while (queue.pop(connection, shotData)) {
+            received.push_back(shotData.ShotNumber);
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.close();
+    consumer.join();
+
+    EXPECT_EQ(received, (std::vector<int>{ 1 }));
+    EXPECT_FALSE(queue.push(1, makeShot(2)));
+}
+
+TEST(ShotQueueTest, ConcurrentProducerAndConsumer) {
+    const int COUNT = 100000;
+
+    for (OverflowPolicy policy : { OverflowPolicy::Block, OverflowPolicy::DropOldest }) {
+        ShotQueue queue(64, policy);
+        std::vector<int> received;
+
+        std::thread consumer([&] {
+            ConnectionId connection;
+            ShotData shotData;
+            while (queue.pop(connection, shotData)) {
+                received.push_back(shotData.ShotNumber);
+            }
+        });
+
+        ShotData shotData = makeShot(0);
+        for (int i = 1; i <= COUNT; i++) {
+            shotData.ShotNumber = i;
+            queue.push(1, shotData);
+        }
+        queue.close();
+        consumer.join();
+
+        // Whatever made it through has to be in order, and nothing may go missing without being counted
+        for (size_t i = 1; i < received.size(); i++) {
+            ASSERT_LT(received[i - 1], received[i]);
+        }
+        auto stats = queue.stats();
+        EXPECT_EQ(received.size() + stats.Dropped, static_cast<size_t>(COUNT));
+        if (policy == OverflowPolicy::Block) {
+            EXPECT_EQ(received.size(), static_cast<size_t>(COUNT));
+        }
+    }
+}
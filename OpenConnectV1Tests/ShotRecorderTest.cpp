@@ -0,0 +1,201 @@
+#include "pch.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include "FakeTransport.h"
+#include "TestShots.h"
+#include "../OpenConnectV1/ShotLogReader.h"
+#include "../OpenConnectV1/ShotRecorder.h"
+#include "../OpenConnectV1/ShotReplayer.h"
+
+using namespace OpenConnectV1;
+
+class ShotRecorderTest : public ::testing::Test {
+protected:
+    std::filesystem::path directory;
+
+    void SetUp() override {
+        directory = std::filesystem::temp_directory_path() /
+            ("ocshots-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    }
+
+    void TearDown() override {
+        std::error_code error;
+        std::filesystem::remove_all(directory, error);
+    }
+
+    ShotRecorderOptions options(size_t segmentBytes = 64 * 1024 * 1024) {
+        ShotRecorderOptions options;
+        options.Directory = directory.string();
+        options.SegmentBytes = segmentBytes;
+        return options;
+    }
+
+    static std::vector<ShotData> readAll(ShotLogReader& reader) {
+        std::vector<ShotData> shots;
+        RecordedShot recorded;
+        while (reader.next(recorded)) {
+            shots.emplace_back();
+            recorded.toShotData(shots.back());
+        }
+        return shots;
+    }
+};
+
+TEST_F(ShotRecorderTest, RoundTripsEveryField) {
+    ShotData heartbeat;
+    heartbeat.DeviceID = "Other Monitor";
+    heartbeat.BallData.Speed = std::numeric_limits<float>::quiet_NaN();
+    heartbeat.ShotDataOptions = ShotDataOptions(false, false, true, true, true);
+    {
+        ShotRecorder recorder(options());
+        recorder.record(7, makeShot(1), 1000);
+        recorder.record(8, heartbeat, 2000);
+        recorder.record(7, makeShot(2), 3000);
+        EXPECT_EQ(recorder.recordedShots(), 3u);
+    }
+
+    ShotLogReader reader(directory.string());
+    RecordedShot recorded;
+
+    ASSERT_TRUE(reader.next(recorded));
+    EXPECT_EQ(recorded.timestampNs(), 1000);
+    EXPECT_EQ(recorded.connection(), 7u);
+    EXPECT_EQ(recorded.DeviceID, "GSPro LM 1.1");
+    ShotData shot;
+    recorded.toShotData(shot);
+    ShotData expected = makeShot(1);
+    EXPECT_EQ(shot.Units, "Yards");
+    EXPECT_EQ(shot.APIversion, "1");
+    EXPECT_EQ(shot.ShotNumber, 1);
+    EXPECT_EQ(shot.BallData.Speed, expected.BallData.Speed);
+    EXPECT_EQ(shot.BallData.CarryDistance, expected.BallData.CarryDistance);
+    EXPECT_EQ(shot.ClubData.Speed, expected.ClubData.Speed);
+    EXPECT_EQ(shot.ClubData.ClosureRate, expected.ClubData.ClosureRate);
+    EXPECT_TRUE(std::isnan(shot.ClubData.Loft));
+    EXPECT_TRUE(shot.ShotDataOptions.ContainsBallData);
+    EXPECT_FALSE(shot.ShotDataOptions.LaunchMonitorBallDetected);
+    EXPECT_FALSE(shot.ShotDataOptions.IsHeartBeat);
+
+    ASSERT_TRUE(reader.next(recorded));
+    recorded.toShotData(shot);
+    EXPECT_EQ(shot.DeviceID, "Other Monitor");
+    EXPECT_EQ(shot.Units, "");
+    EXPECT_TRUE(std::isnan(shot.BallData.Speed));
+    EXPECT_TRUE(shot.ShotDataOptions.IsHeartBeat);
+    EXPECT_TRUE(shot.ShotDataOptions.LaunchMonitorBallDetected);
+
+    ASSERT_TRUE(reader.next(recorded));
+    EXPECT_EQ(recorded.Record->ShotNumber, 2);
+    EXPECT_EQ(recorded.DeviceID, "GSPro LM 1.1");
+    EXPECT_FALSE(reader.next(recorded));
+}
+
+TEST_F(ShotRecorderTest, RollsOverSegmentsAndContinuesExistingRecording) {
+    const size_t RECORDS_PER_SEGMENT = 10;
+    size_t segmentBytes = sizeof(ShotLog::SegmentHeader) + RECORDS_PER_SEGMENT * ShotLog::RECORD_SIZE;
+    {
+        ShotRecorder recorder(options(segmentBytes));
+        for (int i = 0; i < 25; i++) {
+            recorder.record(1, makeShot(i), i);
+        }
+    }
+    {
+        // A second session appends new segments instead of touching the old ones
+        ShotRecorder recorder(options(segmentBytes));
+        recorder.record(1, makeShot(25, "Second Session"), 25);
+    }
+
+    ShotLogReader reader(directory.string());
+    EXPECT_GT(reader.segmentCount(), 3u);
+
+    auto shots = readAll(reader);
+    ASSERT_EQ(shots.size(), 26u);
+    for (int i = 0; i < 26; i++) {
+        EXPECT_EQ(shots[i].ShotNumber, i);
+        // Strings are interned per segment, every segment has to resolve them on its own
+        EXPECT_EQ(shots[i].DeviceID, i < 25 ? "GSPro LM 1.1" : "Second Session");
+    }
+
+    reader.rewind();
+    EXPECT_EQ(readAll(reader).size(), 26u);
+}
+
+TEST_F(ShotRecorderTest, IgnoresPartiallyWrittenRecord) {
+    {
+        ShotRecorder recorder(options());
+        recorder.record(1, makeShot(1), 1);
+        recorder.record(1, makeShot(2), 2);
+    }
+
+    auto segment = directory / ShotLog::segmentFileName(1);
+    std::filesystem::resize_file(segment, std::filesystem::file_size(segment) - ShotLog::RECORD_SIZE / 2);
+
+    ShotLogReader reader(directory.string());
+    auto shots = readAll(reader);
+    ASSERT_EQ(shots.size(), 1u);
+    EXPECT_EQ(shots[0].ShotNumber, 1);
+}
+
+TEST_F(ShotRecorderTest, RejectsMissingOrForeignRecordings) {
+    EXPECT_THROW(ShotLogReader(directory.string()), std::runtime_error);
+
+    std::filesystem::create_directories(directory);
+    std::ofstream(directory / ShotLog::segmentFileName(1)) << std::string(200, 'x');
+    EXPECT_THROW(ShotLogReader(directory.string()), std::runtime_error);
+}
+
+TEST_F(ShotRecorderTest, ReplaysThroughServerListeners) {
+    class CollectingListener : public ServerListener {
+    public:
+        std::vector<std::pair<ConnectionId, int>> shots;
+
+        void onShotDataReceived(const ShotData& shotData) override {}
+        void onShotDataReceived(ConnectionId connection, const ShotData& shotData) override {
+            shots.emplace_back(connection, shotData.ShotNumber);
+        }
+        void onStatusChanged(const ServerStatus& status) override {}
+    };
+
+    {
+        ShotRecorder recorder(options());
+        recorder.record(3, makeShot(1), 0);
+        ShotData heartbeat = makeShot(0);
+        heartbeat.ShotDataOptions.IsHeartBeat = true;
+        recorder.record(3, heartbeat, 10'000'000);
+        recorder.record(4, makeShot(2), 50'000'000);
+    }
+
+    Server server(std::make_unique<FakeTransport>());
+    auto listener = std::make_shared<CollectingListener>();
+    server.addListener(listener, ListenerFilter::ShotsOnly);
+
+    ShotLogReader reader(directory.string());
+    ShotReplayer replayer(server);
+    EXPECT_EQ(replayer.replay(reader, ReplayTiming::MaxSpeed), 3u);
+    EXPECT_EQ(listener->shots, (std::vector<std::pair<ConnectionId, int>>{ { 3, 1 }, { 4, 2 } }));
+
+    // Original timing keeps the 50ms the recording spans
+    listener->shots.clear();
+    reader.rewind();
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(replayer.replay(reader, ReplayTiming::Original), 3u);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+    EXPECT_EQ(listener->shots.size(), 2u);
+
+    // A stop() before the replay starts holds until reset()
+    listener->shots.clear();
+    reader.rewind();
+    replayer.stop();
+    EXPECT_EQ(replayer.replay(reader), 0u);
+    replayer.reset();
+    EXPECT_EQ(replayer.replay(reader), 3u);
+    EXPECT_EQ(listener->shots.size(), 2u);
+}
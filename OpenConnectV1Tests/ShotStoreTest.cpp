@@ -0,0 +1,131 @@
+#include "pch.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include "TestShots.h"
+#include "../OpenConnectV1/ShotLogReader.h"
+#include "../OpenConnectV1/ShotRecorder.h"
+#include "../OpenConnectV1/ShotStore.h"
+
+using namespace OpenConnectV1;
+
+namespace {
+    // Club data on every other shot only
+    ShotData storedShot(int shotNumber) {
+        ShotData shotData = makeShot(shotNumber);
+        shotData.ShotDataOptions.ContainsClubData = shotNumber % 2 == 0;
+        return shotData;
+    }
+}
+
+TEST(ShotStoreTest, StoresEveryFieldInItsColumn) {
+    ShotStore store;
+    EXPECT_EQ(store.size(), 0u);
+    EXPECT_EQ(store.column(ShotField::BallSpeed).Size, 0u);
+
+    for (int i = 0; i < 10; i++) {
+        EXPECT_TRUE(store.append(i % 3, storedShot(i), 1000 + i));
+    }
+    ShotData heartbeat;
+    heartbeat.ShotDataOptions.IsHeartBeat = true;
+    EXPECT_FALSE(store.append(0, heartbeat));
+    ASSERT_EQ(store.size(), 10u);
+
+    ShotColumn speed = store.column(ShotField::BallSpeed);
+    ShotColumn carry = store.column(ShotField::CarryDistance);
+    ShotColumn clubSpeed = store.column(ShotField::ClubSpeed);
+    ShotColumn loft = store.column(ShotField::Loft);
+    ASSERT_EQ(speed.Size, 10u);
+    for (size_t row = 0; row < 10; row++) {
+        EXPECT_EQ(speed[row], 140.0f + row);
+        EXPECT_TRUE(speed.valid(row));
+        EXPECT_EQ(carry[row], 250.0f);
+        EXPECT_EQ(clubSpeed.valid(row), row % 2 == 0);
+        EXPECT_EQ(std::isnan(clubSpeed[row]), row % 2 != 0);
+        EXPECT_FALSE(loft.valid(row));
+        EXPECT_EQ(store.shotNumbers()[row], static_cast<int32_t>(row));
+        EXPECT_EQ(store.connections()[row], row % 3);
+        EXPECT_EQ(store.timestamps()[row], static_cast<int64_t>(1000 + row));
+        EXPECT_EQ(store.deviceIds()[row], "GSPro LM 1.1");
+        EXPECT_EQ(store.units()[row], "Yards");
+    }
+    EXPECT_EQ(speed.validCount(), 10u);
+    EXPECT_EQ(clubSpeed.validCount(), 5u);
+    EXPECT_EQ(store.column(ShotField::ClosureRate).validCount(), 5u);
+    EXPECT_EQ(loft.validCount(), 0u);
+
+    float sum = 0;
+    for (float value : speed) {
+        sum += value;
+    }
+    EXPECT_EQ(sum, 1445.0f);
+}
+
+TEST(ShotStoreTest, ColumnsStayAlignedAndPaddedAsTheyGrow) {
+    ShotStore store;
+    const size_t ROWS = 10'000;
+    for (size_t i = 0; i < ROWS; i++) {
+        store.append(1, storedShot(static_cast<int>(i)));
+    }
+    ASSERT_EQ(store.size(), ROWS);
+    EXPECT_GE(store.capacity(), ROWS);
+    EXPECT_EQ(store.capacity() % 16, 0u);
+
+    for (size_t field = 0; field < SHOT_FIELD_COUNT; field++) {
+        ShotColumn column = store.column(static_cast<ShotField>(field));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(column.Data) % ShotStore::ALIGNMENT, 0u);
+        for (size_t row = ROWS; row < (ROWS + 15) / 16 * 16; row++) {
+            EXPECT_TRUE(std::isnan(column.Data[row]));
+            EXPECT_FALSE(column.valid(row));
+        }
+    }
+    ShotColumn speed = store.column(ShotField::BallSpeed);
+    EXPECT_EQ(speed[0], 140.0f);
+    EXPECT_EQ(speed[ROWS - 1], 140.0f + (ROWS - 1));
+    EXPECT_EQ(store.column(ShotField::ClubSpeed).validCount(), ROWS / 2);
+
+    store.clear();
+    EXPECT_EQ(store.size(), 0u);
+    EXPECT_TRUE(std::isnan(store.column(ShotField::BallSpeed).Data[0]));
+    store.append(1, storedShot(1));
+    EXPECT_EQ(store.column(ShotField::BallSpeed).validCount(), 1u);
+    EXPECT_EQ(store.column(ShotField::ClubSpeed).validCount(), 0u);
+}
+
+TEST(ShotStoreTest, LoadsARecording) {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() /
+        ("ocstore-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    {
+        ShotRecorderOptions options;
+        options.Directory = directory.string();
+        ShotRecorder recorder(options);
+        ShotData heartbeat;
+        heartbeat.ShotDataOptions.IsHeartBeat = true;
+        for (int i = 0; i < 50; i++) {
+            recorder.record(7, storedShot(i), i);
+            recorder.record(7, heartbeat, i);
+        }
+    }
+
+    ShotStore store;
+    {
+        ShotLogReader reader(directory.string());
+        EXPECT_EQ(store.load(reader), 50u);
+    }
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+
+    ASSERT_EQ(store.size(), 50u);
+    ShotColumn speed = store.column(ShotField::BallSpeed);
+    ShotColumn clubSpeed = store.column(ShotField::ClubSpeed);
+    for (size_t row = 0; row < 50; row++) {
+        EXPECT_EQ(speed[row], 140.0f + row);
+        EXPECT_EQ(clubSpeed.valid(row), row % 2 == 0);
+        EXPECT_EQ(store.connections()[row], 7u);
+        EXPECT_EQ(store.deviceIds()[row], "GSPro LM 1.1");
+    }
+}
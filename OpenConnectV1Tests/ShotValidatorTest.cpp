@@ -0,0 +1,214 @@
+#include "pch.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "FakeTransport.h"
+#include "TestServer.h"
+#include "TestShots.h"
+#include "../OpenConnectV1/Server.h"
+#include "../OpenConnectV1/ShotValidator.h"
+
+using namespace OpenConnectV1;
+
+namespace {
+    const float NOT_A_NUMBER = std::numeric_limits<float>::quiet_NaN();
+
+    uint32_t bit(ShotField field) {
+        return 1u << static_cast<size_t>(field);
+    }
+}
+
+TEST(ShotValidatorTest, AcceptsPlausibleShotsAndHeartbeats) {
+    ShotValidator validator;
+    EXPECT_TRUE(validator.check(makeShot(1)).accepted());
+
+    // Optional fields may be missing, and nothing is checked in data the shot doesn't contain
+    ShotData partial = makeShot(1);
+    partial.BallData.CarryDistance = NOT_A_NUMBER;
+    partial.BallData.TotalSpin = NOT_A_NUMBER;
+    partial.ClubData.Speed = -40.0f;
+    partial.ShotDataOptions.ContainsClubData = false;
+    EXPECT_TRUE(validator.check(partial).accepted());
+
+    ShotData heartbeat;
+    heartbeat.ShotDataOptions = ShotDataOptions(true, false, true, false, true);
+    heartbeat.BallData.Speed = NOT_A_NUMBER;
+    EXPECT_TRUE(validator.check(heartbeat).accepted());
+}
+
+TEST(ShotValidatorTest, RejectsMissingAndImpossibleFields) {
+    ShotValidator validator;
+
+    ShotData noSpeed = makeShot(1);
+    noSpeed.BallData.Speed = NOT_A_NUMBER;
+    noSpeed.BallData.VLA = 95.0f;
+    ShotVerdict verdict = validator.check(noSpeed);
+    EXPECT_EQ(verdict.Rejection, ShotRejection::MissingValue);
+    EXPECT_EQ(verdict.Fields, bit(ShotField::BallSpeed));
+
+    ShotData steep = makeShot(1);
+    steep.BallData.VLA = 95.0f;
+    steep.ClubData.Loft = -45.0f;
+    verdict = validator.check(steep);
+    EXPECT_EQ(verdict.Rejection, ShotRejection::OutOfRange);
+    EXPECT_EQ(verdict.Fields, bit(ShotField::VLA) | bit(ShotField::Loft));
+
+    ShotValidationRules rules;
+    rules[ShotField::VLA].Max = 100.0f;
+    rules[ShotField::Loft].Min = -std::numeric_limits<float>::infinity();
+    rules[ShotField::SpeedAtImpact].Required = true;
+    verdict = ShotValidator(rules).check(steep);
+    EXPECT_EQ(verdict.Rejection, ShotRejection::MissingValue);
+    EXPECT_EQ(verdict.Fields, bit(ShotField::SpeedAtImpact));
+}
+
+TEST(ShotValidatorTest, ChecksTotalSpinAgainstItsComponents) {
+    ShotValidationRules rules;
+    rules.SpinToleranceRpm = 100.0f;
+    ShotValidator validator(rules);
+    ShotData shotData = makeShot(1);
+    shotData.BallData.TotalSpin = 4000.0f;
+    ShotVerdict verdict = validator.check(shotData);
+    EXPECT_EQ(verdict.Rejection, ShotRejection::SpinMismatch);
+    EXPECT_EQ(verdict.Fields, bit(ShotField::TotalSpin) | bit(ShotField::BackSpin) | bit(ShotField::SideSpin));
+
+    // Off by default
+    EXPECT_TRUE(ShotValidator().check(shotData).accepted());
+
+    // Within 5%, with a component missing or with both components 0, there is nothing to compare
+    shotData.BallData.TotalSpin = 2700.0f;
+    EXPECT_TRUE(validator.check(shotData).accepted());
+    shotData.BallData.TotalSpin = 4000.0f;
+    shotData.BallData.SideSpin = NOT_A_NUMBER;
+    EXPECT_TRUE(validator.check(shotData).accepted());
+    shotData.BallData.BackSpin = 0.0f;
+    shotData.BallData.SideSpin = 0.0f;
+    EXPECT_TRUE(validator.check(shotData).accepted());
+}
+
+TEST(ShotValidatorTest, ConvertsTheBoundsForMetersShots) {
+    ShotValidator validator;
+    ShotData shotData = makeShot(1);
+    shotData.Units = "Meters";
+    shotData.ClubData.Speed = 46.0f;
+    shotData.BallData.Speed = 100.0f;         // 224 mph
+    shotData.BallData.CarryDistance = 400.0f; // 437 yards
+    EXPECT_TRUE(validator.check(shotData).accepted());
+
+    shotData.BallData.Speed = 120.0f;         // 268 mph
+    ShotVerdict verdict = validator.check(shotData);
+    EXPECT_EQ(verdict.Rejection, ShotRejection::OutOfRange);
+    EXPECT_EQ(verdict.Fields, bit(ShotField::BallSpeed));
+
+    shotData.Units = "Yards";
+    EXPECT_TRUE(validator.check(shotData).accepted());
+}
+
+TEST(ShotValidatorTest, SuppressesRepeatedShotNumbers) {
+    ShotValidator validator;
+    ShotHistory history;
+    EXPECT_TRUE(validator.validate(makeShot(1), history).accepted());
+    EXPECT_EQ(validator.validate(makeShot(1), history).Rejection, ShotRejection::DuplicateShotNumber);
+
+    // A rejected shot isn't remembered, its corrected resend goes through
+    ShotData junk = makeShot(2);
+    junk.BallData.Speed = NOT_A_NUMBER;
+    EXPECT_EQ(validator.validate(junk, history).Rejection, ShotRejection::MissingValue);
+    EXPECT_TRUE(validator.validate(makeShot(2), history).accepted());
+    EXPECT_EQ(history.LastShotNumber, 2);
+
+    ShotValidationRules rules;
+    rules.RejectDuplicates = false;
+    EXPECT_TRUE(ShotValidator(rules).validate(makeShot(2), history).accepted());
+}
+
+class ServerValidationTest : public TestServer {
+protected:
+    class CountingListener : public ServerListener {
+    public:
+        std::atomic<int> shots{ 0 };
+
+        void onShotDataReceived(const ShotData& shotData) override {
+            if (!shotData.ShotDataOptions.IsHeartBeat) {
+                shots++;
+            }
+        }
+        void onStatusChanged(const ServerStatus& status) override {}
+    };
+
+    std::shared_ptr<CountingListener> listener = std::make_shared<CountingListener>();
+
+    void SetUp() override {
+        TestServer::SetUp();
+        server->addListener(listener);
+        server->setShotValidation(true);
+        start();
+    }
+};
+
+TEST_F(ServerValidationTest, DropsJunkAndShotsResentAfterAReconnect) {
+    ShotData junk = makeShot(2);
+    junk.BallData.VLA = 120.0f;
+    transport->connect(1, "127.0.0.1:50000");
+    transport->deliver(1, jsonMessage(makeShot(1)) + jsonMessage(junk) + jsonMessage(makeShot(1)));
+    transport->disconnect(1);
+    transport->connect(2, "127.0.0.1:50001");
+    transport->deliver(2, jsonMessage(makeShot(1)) + jsonMessage(makeShot(2)));
+    transport->flush();
+
+    EXPECT_EQ(listener->shots.load(), 2);
+    MetricsSnapshot snapshot = server->metricsSnapshot();
+    EXPECT_EQ(snapshot.counter(MetricCounter::ShotsReceived), 5u);
+    EXPECT_EQ(snapshot.counter(MetricCounter::ShotsRejectedRange), 1u);
+    EXPECT_EQ(snapshot.counter(MetricCounter::ShotsRejectedDuplicate), 2u);
+    EXPECT_EQ(server->getConnections().at(0).LastShotNumber, 2);
+}
+
+TEST_F(ServerValidationTest, KeepsTheHistoryOfEachMonitorOnAHost) {
+    ShotData bay1 = makeShot(1);
+    bay1.DeviceID = "Bay 1";
+    ShotData bay2 = makeShot(7);
+    bay2.DeviceID = "Bay 2";
+    transport->connect(1, "127.0.0.1:50000");
+    transport->connect(2, "127.0.0.1:50001");
+    transport->deliver(1, jsonMessage(bay1));
+    transport->deliver(2, jsonMessage(bay2));
+    transport->disconnect(1);
+    transport->disconnect(2);
+
+    // Bay 1's next shot has the number Bay 2 left off at, only each bay's own resend is a duplicate
+    transport->connect(3, "127.0.0.1:50002");
+    transport->connect(4, "127.0.0.1:50003");
+    bay1.ShotNumber = 7;
+    transport->deliver(3, jsonMessage(bay1) + jsonMessage(bay1));
+    transport->deliver(4, jsonMessage(bay2));
+    transport->flush();
+
+    EXPECT_EQ(listener->shots.load(), 3);
+    MetricsSnapshot snapshot = server->metricsSnapshot();
+    EXPECT_EQ(snapshot.counter(MetricCounter::ShotsRejectedDuplicate), 2u);
+    EXPECT_EQ(snapshot.counter(MetricCounter::Reconnects), 2u);
+}
+
+TEST_F(ServerValidationTest, AcceptsTheSampleShots) {
+    // The DataTest sample and a LoadGenerator shot, neither with TotalSpin the magnitude of its components
+    transport->connect(1, "127.0.0.1:50000");
+    transport->deliver(1, R"({"DeviceID":"TestDevice","Units":"Yards","ShotNumber":1,"APIversion":"1",)"
+        R"("BallData":{"Speed":120.5,"SpinAxis":10.2,"TotalSpin":3000,"BackSpin":1500,"SideSpin":100,"HLA":5.0,)"
+        R"("VLA":10.0,"CarryDistance":250.0},"ClubData":{"Speed":95.5,"AngleOfAttack":3.0,"FaceToTarget":0.5,)"
+        R"("Lie":1.5,"Loft":12.0,"Path":1.0,"SpeedAtImpact":98.5,"VerticalFaceImpact":0.2,"HorizontalFaceImpact":0.1,)"
+        R"("ClosureRate":1.2},"ShotDataOptions":{"ContainsBallData":true,"ContainsClubData":true,)"
+        R"("LaunchMonitorIsReady":false,"LaunchMonitorBallDetected":true,"IsHeartBeat":false}})");
+    ShotData generated = makeShot(2);
+    generated.BallData.TotalSpin = 3250.0f;
+    generated.BallData.BackSpin = 2500.0f;
+    generated.BallData.SideSpin = -800.0f;
+    transport->deliver(1, jsonMessage(generated));
+    transport->flush();
+
+    EXPECT_EQ(listener->shots.load(), 2);
+    EXPECT_EQ(server->metricsSnapshot().counter(MetricCounter::ShotsRejectedSpin), 0u);
+}
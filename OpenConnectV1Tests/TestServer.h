@@ -0,0 +1,49 @@
+#ifndef OPEN_CONNECT_TEST_SERVER_H
+#define OPEN_CONNECT_TEST_SERVER_H
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <nlohmann/json.hpp>
+#include "FakeTransport.h"
+
+#include "../OpenConnectV1/Server.h"
+
+/**
+ * Fixture for a Server on a FakeTransport.  SetUp() only creates the server; a test (or a derived fixture's
+ * SetUp()) adds its listeners and options, then start() runs the event loop on serverThread.
+ */
+class TestServer : public ::testing::Test {
+protected:
+    FakeTransport* transport = nullptr;
+    std::unique_ptr<OpenConnectV1::Server> server;
+    std::thread serverThread;
+
+    void SetUp() override {
+        auto fake = std::make_unique<FakeTransport>();
+        transport = fake.get();
+        server = std::make_unique<OpenConnectV1::Server>(std::move(fake));
+    }
+
+    void TearDown() override {
+        server->shutdown();
+        if (serverThread.joinable()) {
+            serverThread.join();
+        }
+    }
+
+    void start(const OpenConnectV1::LivenessOptions& liveness = OpenConnectV1::LivenessOptions()) {
+        serverThread = std::thread([this, liveness] { server->startup(921, liveness); });
+        transport->waitUntilRunning();
+    }
+};
+
+// A shot as a launch monitor sends it
+inline std::string jsonMessage(const OpenConnectV1::ShotData& shotData) {
+    nlohmann::json json;
+    OpenConnectV1::to_json(json, shotData);
+    return json.dump();
+}
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef OPEN_CONNECT_TEST_SHOTS_H
+#define OPEN_CONNECT_TEST_SHOTS_H
+
+#include <limits>
+#include <string>
+
+#include "../OpenConnectV1/Data.h"
+
+// A plausible full shot as a launch monitor reports it (Loft and SpeedAtImpact not measured); the ball speed
+// grows with the shot number so rows can be told apart.  Tests change what they check from there.
+inline OpenConnectV1::ShotData makeShot(int shotNumber, const std::string& deviceID = "GSPro LM 1.1") {
+    const float NOT_MEASURED = std::numeric_limits<float>::quiet_NaN();
+    OpenConnectV1::ShotData shotData;
+    shotData.DeviceID = deviceID;
+    shotData.Units = "Yards";
+    shotData.APIversion = "1";
+    shotData.ShotNumber = shotNumber;
+    shotData.BallData = OpenConnectV1::BallData(140.0f + shotNumber, -13.2f, 3250.0f, 2500.0f, -800.0f, 2.3f, 14.3f, 250.0f);
+    shotData.ClubData = OpenConnectV1::ClubData(105.2f, -1.0f, 0.5f, 58.0f, NOT_MEASURED, 1.5f, NOT_MEASURED, 4.0f, -6.0f, 1.5f);
+    shotData.ShotDataOptions = OpenConnectV1::ShotDataOptions(true, true, true, false, false);
+    return shotData;
+}
+
+#endif
@@ -0,0 +1,37 @@
+//
+// TestSockets.h
+//
+// Lets the socket based tests use the Winsock API on every platform; on POSIX the handful of Winsock names
+// they use are mapped onto BSD sockets.
+//
+
+#pragma once
+
+#ifdef _WIN32
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#pragma comment(lib, "Ws2_32.lib")
+
+#else
+
+#include <cerrno>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using SOCKET = int;
+struct WSADATA {};
+
+constexpr SOCKET INVALID_SOCKET = -1;
+constexpr int SOCKET_ERROR = -1;
+
+inline int MAKEWORD(int low, int high) { return (high << 8) | low; }
+inline int WSAStartup(int, WSADATA*) { return 0; }
+inline int WSACleanup() { return 0; }
+inline int WSAGetLastError() { return errno; }
+inline int closesocket(SOCKET s) { return close(s); }
+
+#endif
@@ -0,0 +1,215 @@
+#include "pch.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include "FakeTransport.h"
+#include "TestServer.h"
+
+#include "../OpenConnectV1/Server.h"
+#include "../OpenConnectV1/TimerWheel.h"
+
+using namespace OpenConnectV1;
+
+TEST(TimerWheelTest, FiresOnceTheDeadlineHasPassed) {
+    TimerWheel wheel(10, 1000);
+    wheel.schedule(1, 1055);
+    wheel.schedule(2, 1100);
+    EXPECT_EQ(wheel.size(), 2u);
+
+    std::vector<uint64_t> expired;
+    wheel.advance(1050, expired);
+    EXPECT_TRUE(expired.empty());
+    wheel.advance(1060, expired);
+    EXPECT_EQ(expired, (std::vector<uint64_t>{ 1 }));
+    EXPECT_FALSE(wheel.contains(1));
+
+    expired.clear();
+    wheel.advance(1100, expired);
+    EXPECT_EQ(expired, (std::vector<uint64_t>{ 2 }));
+    EXPECT_EQ(wheel.size(), 0u);
+    EXPECT_EQ(wheel.nextExpiryMs(1100), -1);
+}
+
+TEST(TimerWheelTest, ReschedulingAndCancelling) {
+    TimerWheel wheel(1, 0);
+    wheel.schedule(1, 100);
+    wheel.schedule(2, 100);
+    wheel.schedule(1, 5000);
+    EXPECT_TRUE(wheel.cancel(2));
+    EXPECT_FALSE(wheel.cancel(2));
+
+    std::vector<uint64_t> expired;
+    wheel.advance(4999, expired);
+    EXPECT_TRUE(expired.empty());
+    EXPECT_EQ(wheel.nextExpiryMs(4999), 1);
+    wheel.advance(5000, expired);
+    EXPECT_EQ(expired, (std::vector<uint64_t>{ 1 }));
+
+    // A deadline already in the past fires on the next tick
+    expired.clear();
+    wheel.schedule(3, 10);
+    wheel.advance(5001, expired);
+    EXPECT_EQ(expired, (std::vector<uint64_t>{ 3 }));
+}
+
+TEST(TimerWheelTest, CascadesAcrossEveryLevel) {
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<int64_t> deadlines(1, 20'000'000);
+    std::uniform_int_distribution<int64_t> steps(1, 40'000);
+    std::uniform_int_distribution<int> coin(0, 9);
+
+    TimerWheel wheel(1, 0);
+    std::map<uint64_t, int64_t> armed;
+    for (uint64_t key = 1; key <= 2000; key++) {
+        armed[key] = deadlines(random);
+        wheel.schedule(key, armed[key]);
+    }
+
+    int64_t now = 0;
+    std::vector<uint64_t> expired;
+    while (!armed.empty()) {
+        int64_t earliest = INT64_MAX;
+        for (const auto& timer : armed) {
+            earliest = std::min(earliest, timer.second);
+        }
+        ASSERT_LE(wheel.nextExpiryMs(now), earliest - now);
+
+        int64_t next = now + steps(random);
+        expired.clear();
+        wheel.advance(next, expired);
+        for (uint64_t key : expired) {
+            ASSERT_EQ(armed.count(key), 1u);
+            EXPECT_GT(armed[key], now);
+            EXPECT_LE(armed[key], next);
+            armed.erase(key);
+        }
+        for (const auto& timer : armed) {
+            ASSERT_GT(timer.second, next) << "timer " << timer.first << " missed";
+        }
+        now = next;
+
+        // Push some deadlines back, the way heartbeats do
+        for (auto& timer : armed) {
+            if (coin(random) == 0) {
+                timer.second = now + deadlines(random) / 100;
+                wheel.schedule(timer.first, timer.second);
+            }
+        }
+        ASSERT_EQ(wheel.size(), armed.size());
+    }
+}
+
+class ServerLivenessTest : public TestServer {
+protected:
+    class RecordingListener : public ServerListener {
+    public:
+        std::mutex mutex;
+        std::vector<ConnectionInfo> connections;
+
+        void onShotDataReceived(const ShotData& shotData) override {}
+        void onStatusChanged(const ServerStatus& status) override {}
+        void onConnectionStatusChanged(const ConnectionInfo& connection) override {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->connections.push_back(connection);
+        }
+    };
+
+    std::shared_ptr<RecordingListener> listener = std::make_shared<RecordingListener>();
+
+    void SetUp() override {
+        TestServer::SetUp();
+        server->addListener(listener);
+    }
+
+    void heartbeat(ConnectionId connection) {
+        ShotData shotData;
+        shotData.ShotDataOptions.IsHeartBeat = true;
+        transport->deliver(connection, jsonMessage(shotData));
+        transport->flush();
+    }
+
+    template <typename Predicate>
+    bool waitFor(Predicate predicate) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!predicate()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return true;
+    }
+};
+
+TEST_F(ServerLivenessTest, ClosesConnectionsThatStopSending) {
+    LivenessOptions liveness;
+    liveness.Timeout = std::chrono::milliseconds(300);
+    liveness.Resolution = std::chrono::milliseconds(10);
+    start(liveness);
+
+    transport->connect(1, "127.0.0.1:50000");
+    transport->connect(2, "127.0.0.1:50001");
+    transport->flush();
+
+    // Connection 2 keeps sending heartbeats well within the timeout, connection 1 never sends anything
+    auto begin = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - begin < std::chrono::milliseconds(600)) {
+        heartbeat(2);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    std::vector<ConnectionInfo> connections = server->getConnections();
+    ASSERT_EQ(connections.size(), 1u);
+    EXPECT_EQ(connections[0].Id, 2u);
+    EXPECT_EQ(server->getStatus(), ServerStatus::Connected);
+
+    ASSERT_TRUE(waitFor([this] { return server->getConnections().empty(); }));
+    EXPECT_EQ(server->getStatus(), ServerStatus::Listening);
+    EXPECT_EQ(server->metricsSnapshot().counter(MetricCounter::StaleConnections), 2u);
+
+    std::lock_guard<std::mutex> lock(listener->mutex);
+    ASSERT_EQ(listener->connections.size(), 4u);
+    EXPECT_EQ(listener->connections[2].Id, 1u);
+    EXPECT_EQ(listener->connections[2].Status, ServerStatus::Disconnected);
+    EXPECT_EQ(listener->connections[3].Id, 2u);
+    EXPECT_EQ(listener->connections[3].Status, ServerStatus::Disconnected);
+}
+
+TEST_F(ServerLivenessTest, MarksConnectionsStaleUntilTheySendAgain) {
+    LivenessOptions liveness;
+    liveness.Timeout = std::chrono::milliseconds(200);
+    liveness.Policy = IdlePolicy::MarkStale;
+    liveness.Resolution = std::chrono::milliseconds(10);
+    start(liveness);
+
+    transport->connect(1, "127.0.0.1:50000");
+    transport->flush();
+    ASSERT_TRUE(waitFor([this] { return server->getStatus() == ServerStatus::Listening; }));
+    std::vector<ConnectionInfo> connections = server->getConnections();
+    ASSERT_EQ(connections.size(), 1u);
+    EXPECT_TRUE(connections[0].Stale);
+
+    heartbeat(1);
+    EXPECT_EQ(server->getStatus(), ServerStatus::Connected);
+    EXPECT_FALSE(server->getConnections()[0].Stale);
+
+    std::lock_guard<std::mutex> lock(listener->mutex);
+    ASSERT_GE(listener->connections.size(), 3u);
+    EXPECT_TRUE(listener->connections[1].Stale);
+    EXPECT_EQ(listener->connections[1].Status, ServerStatus::Connected);
+    EXPECT_FALSE(listener->connections[2].Stale);
+}
+
+TEST_F(ServerLivenessTest, RejectsInvalidTimeouts) {
+    auto fake = std::make_unique<FakeTransport>();
+    server = std::make_unique<Server>(std::move(fake));
+    LivenessOptions liveness;
+    liveness.Timeout = std::chrono::milliseconds(-1);
+    EXPECT_THROW(server->startup(921, liveness), std::runtime_error);
+}
@@ -0,0 +1,113 @@
+#include "pch.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "../OpenConnectV1/TrajectorySolver.h"
+
+using namespace OpenConnectV1;
+
+namespace {
+    const float NOT_A_NUMBER = std::numeric_limits<float>::quiet_NaN();
+
+    std::vector<BallData> randomBalls(size_t count) {
+        std::mt19937 random(11);
+        std::normal_distribution<float> speed(130.0f, 25.0f);
+        std::normal_distribution<float> angle(15.0f, 6.0f);
+        std::normal_distribution<float> spin(4000.0f, 2000.0f);
+        std::normal_distribution<float> side(0.0f, 600.0f);
+
+        std::vector<BallData> balls(count);
+        for (size_t i = 0; i < count; i++) {
+            balls[i].Speed = i % 50 == 0 ? NOT_A_NUMBER : speed(random);
+            balls[i].VLA = angle(random);
+            balls[i].HLA = side(random) / 200;
+            balls[i].BackSpin = std::fabs(spin(random));
+            balls[i].SideSpin = side(random);
+        }
+        return balls;
+    }
+
+    // Bit for bit, NaN rows included
+    bool sameBits(const std::vector<float>& a, const std::vector<float>& b) {
+        return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+    }
+}
+
+TEST(TrajectorySolverTest, SameResultsWhateverTheThreadCount) {
+    std::vector<BallData> balls = randomBalls(3001);
+    std::vector<FlightSummary> expected = TrajectoryEngine().simulate(balls);
+
+    FlightSummaryColumns reference(balls.size());
+    TrajectorySolver(TrajectoryOptions(), 1).solve(balls.data(), nullptr, balls.size(), reference);
+    for (size_t i = 0; i < balls.size(); i++) {
+        FlightSummary row = reference.row(i);
+        ASSERT_EQ(std::memcmp(&row, &expected[i], sizeof(FlightSummary)), 0) << "shot " << i;
+    }
+
+    for (size_t threads : { 2, 3, 8 }) {
+        SCOPED_TRACE(testing::Message() << "threads " << threads);
+        TrajectorySolver solver(TrajectoryOptions(), threads);
+        EXPECT_EQ(solver.threadCount(), threads);
+        FlightSummaryColumns results(balls.size());
+        solver.solve(balls.data(), nullptr, balls.size(), results);
+
+        EXPECT_TRUE(sameBits(results.Carry, reference.Carry));
+        EXPECT_TRUE(sameBits(results.Offline, reference.Offline));
+        EXPECT_TRUE(sameBits(results.Apex, reference.Apex));
+        EXPECT_TRUE(sameBits(results.FlightTime, reference.FlightTime));
+        EXPECT_TRUE(sameBits(results.DescentAngle, reference.DescentAngle));
+        EXPECT_TRUE(sameBits(results.Roll, reference.Roll));
+        EXPECT_TRUE(sameBits(results.Total, reference.Total));
+        EXPECT_TRUE(sameBits(results.RestOffline, reference.RestOffline));
+    }
+}
+
+TEST(TrajectorySolverTest, MetricSpeedsAndShotData) {
+    TrajectorySolver solver(TrajectoryOptions(), 2);
+    BallData mph(150.0f, 5.0f, 3000.0f, NOT_A_NUMBER, NOT_A_NUMBER, 1.0f, 12.0f, NOT_A_NUMBER);
+    BallData metric = mph;
+    metric.Speed = 150.0f * 0.44704f;
+
+    std::vector<BallData> balls = { mph, metric, metric };
+    std::vector<UnitSystem> units = { UnitSystem::Yards, UnitSystem::Meters, UnitSystem::Meters };
+    FlightSummaryColumns results(3);
+    solver.solve(balls.data(), units.data(), balls.size(), results);
+    EXPECT_GT(results.Carry[0], 150.0f);
+    EXPECT_NEAR(results.Carry[1], results.Carry[0], 0.01f);
+    EXPECT_NEAR(results.Carry[2], results.Carry[0], 0.01f);
+
+    std::vector<ShotData> shots(3);
+    shots[0].Units = "Yards";
+    shots[0].BallData = mph;
+    shots[0].ShotDataOptions = ShotDataOptions(true, false, true, true, false);
+    shots[1].Units = "Meters";
+    shots[1].BallData = metric;
+    shots[1].ShotDataOptions = ShotDataOptions(true, false, true, true, false);
+    shots[2].BallData = mph;
+    shots[2].ShotDataOptions = ShotDataOptions(false, false, true, false, true);
+    FlightSummaryColumns shotResults(3);
+    solver.solve(shots, shotResults);
+    EXPECT_EQ(shotResults.Carry[0], results.Carry[0]);
+    EXPECT_EQ(shotResults.Carry[1], results.Carry[1]);
+    EXPECT_TRUE(std::isnan(shotResults.Carry[2]));
+    EXPECT_TRUE(std::isnan(shotResults.Total[2]));
+}
+
+TEST(TrajectorySolverTest, ResultsMustBeLargeEnough) {
+    TrajectorySolver solver(TrajectoryOptions(), 2);
+    std::vector<BallData> balls = randomBalls(10);
+    FlightSummaryColumns results(9);
+    EXPECT_THROW(solver.solve(balls.data(), nullptr, balls.size(), results), std::runtime_error);
+    EXPECT_EQ(results.size(), 9u);
+
+    // Larger is fine, the extra rows are left alone
+    FlightSummaryColumns larger(12);
+    solver.solve(balls.data(), nullptr, balls.size(), larger);
+    EXPECT_FALSE(std::isnan(larger.Carry[9]));
+    EXPECT_TRUE(std::isnan(larger.Carry[10]));
+}
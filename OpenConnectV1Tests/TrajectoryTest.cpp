@@ -0,0 +1,184 @@
+#include "pch.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "../OpenConnectV1/ColumnStats.h"
+#include "../OpenConnectV1/Trajectory.h"
+
+using namespace OpenConnectV1;
+
+namespace {
+    const float NOT_A_NUMBER = std::numeric_limits<float>::quiet_NaN();
+    const float YARDS = 0.9144f;
+
+    BallData launch(float speed, float vla, float backSpin, float sideSpin, float hla = 0) {
+        BallData ball;
+        ball.Speed = speed;
+        ball.VLA = vla;
+        ball.HLA = hla;
+        ball.BackSpin = backSpin;
+        ball.SideSpin = sideSpin;
+        return ball;
+    }
+
+    class SimdLevelGuard {
+    public:
+        SimdLevelGuard() : level(simdLevel()) {}
+        ~SimdLevelGuard() { setSimdLevel(this->level); }
+
+    private:
+        SimdLevel level;
+    };
+}
+
+TEST(TrajectoryTest, DriverCarryIsPlausible) {
+    TrajectoryEngine engine;
+    // A tour average drive, 167 mph at 10.9 degrees with 2686 rpm carries about 275 yards
+    Trajectory drive = engine.simulate(launch(167.0f, 10.9f, 2686.0f, 0));
+
+    EXPECT_GT(drive.Summary.Carry / YARDS, 255.0f);
+    EXPECT_LT(drive.Summary.Carry / YARDS, 295.0f);
+    EXPECT_GT(drive.Summary.Apex / YARDS, 25.0f);
+    EXPECT_LT(drive.Summary.Apex / YARDS, 45.0f);
+    EXPECT_GT(drive.Summary.FlightTime, 5.0f);
+    EXPECT_LT(drive.Summary.FlightTime, 8.0f);
+    EXPECT_GT(drive.Summary.DescentAngle, 30.0f);
+    EXPECT_LT(drive.Summary.DescentAngle, 50.0f);
+    EXPECT_NEAR(drive.Summary.Offline, 0.0f, 1e-3f);
+    EXPECT_GT(drive.Summary.Roll, 0.0f);
+    EXPECT_FLOAT_EQ(drive.Summary.Total, drive.Summary.Carry + drive.Summary.Roll);
+
+    // More loft and spin, shorter and steeper
+    Trajectory wedge = engine.simulate(launch(102.0f, 24.2f, 9304.0f, 0));
+    EXPECT_LT(wedge.Summary.Carry, drive.Summary.Carry);
+    EXPECT_GT(wedge.Summary.DescentAngle, drive.Summary.DescentAngle);
+    EXPECT_LT(wedge.Summary.Roll, drive.Summary.Roll);
+}
+
+TEST(TrajectoryTest, SideSpinCurvesTheBall) {
+    TrajectoryEngine engine;
+    FlightSummary slice = engine.simulate(launch(150.0f, 12.0f, 3000.0f, 800.0f)).Summary;
+    FlightSummary draw = engine.simulate(launch(150.0f, 12.0f, 3000.0f, -800.0f)).Summary;
+
+    EXPECT_GT(slice.Offline, 5.0f);
+    EXPECT_GT(slice.RestOffline, slice.Offline);
+    EXPECT_NEAR(draw.Offline, -slice.Offline, 1e-3f);
+    EXPECT_NEAR(draw.Carry, slice.Carry, 1e-3f);
+
+    // Starting left with no side spin stays left
+    FlightSummary pull = engine.simulate(launch(150.0f, 12.0f, 3000.0f, 0, -4.0f)).Summary;
+    EXPECT_LT(pull.Offline, -5.0f);
+}
+
+TEST(TrajectoryTest, TotalSpinAndSpinAxisStandInForBackAndSideSpin) {
+    TrajectoryEngine engine;
+    float axis = 10.0f;
+    float total = 3000.0f;
+    BallData components = launch(150.0f, 12.0f, total * std::cos(axis * 3.14159265f / 180),
+        total * std::sin(axis * 3.14159265f / 180));
+    BallData axial = launch(150.0f, 12.0f, NOT_A_NUMBER, NOT_A_NUMBER);
+    axial.TotalSpin = total;
+    axial.SpinAxis = axis;
+
+    FlightSummary expected = engine.simulate(components).Summary;
+    FlightSummary flight = engine.simulate(axial).Summary;
+    EXPECT_NEAR(flight.Carry, expected.Carry, 1e-2f);
+    EXPECT_NEAR(flight.Offline, expected.Offline, 1e-2f);
+    EXPECT_GT(flight.Offline, 0.0f);
+}
+
+TEST(TrajectoryTest, PathRunsFromTheTeeToTheLandingPoint) {
+    TrajectoryOptions options;
+    options.SampleInterval = 0.1f;
+    TrajectoryEngine engine(options);
+    Trajectory trajectory = engine.simulate(launch(150.0f, 12.0f, 3000.0f, 500.0f));
+
+    ASSERT_GT(trajectory.Path.size(), 2u);
+    EXPECT_EQ(trajectory.Path.front().Time, 0.0f);
+    EXPECT_EQ(trajectory.Path.front().X, 0.0f);
+    EXPECT_EQ(trajectory.Path.front().Y, 0.0f);
+    const TrajectoryPoint& landing = trajectory.Path.back();
+    EXPECT_EQ(landing.Time, trajectory.Summary.FlightTime);
+    EXPECT_EQ(landing.X, trajectory.Summary.Carry);
+    EXPECT_EQ(landing.Y, 0.0f);
+    EXPECT_EQ(landing.Z, trajectory.Summary.Offline);
+
+    float apex = 0;
+    for (size_t i = 1; i < trajectory.Path.size(); i++) {
+        EXPECT_GT(trajectory.Path[i].Time, trajectory.Path[i - 1].Time);
+        EXPECT_GT(trajectory.Path[i].X, trajectory.Path[i - 1].X);
+        EXPECT_GE(trajectory.Path[i].Y, 0.0f);
+        apex = std::max(apex, trajectory.Path[i].Y);
+    }
+    EXPECT_LE(apex, trajectory.Summary.Apex);
+    EXPECT_NEAR(trajectory.Path.size(), trajectory.Summary.FlightTime / options.SampleInterval + 2, 1.0);
+}
+
+TEST(TrajectoryTest, BatchesMatchSingleShotsAtEverySimdLevel) {
+    SimdLevelGuard guard;
+    std::mt19937 random(7);
+    std::normal_distribution<float> speed(130.0f, 25.0f);
+    std::normal_distribution<float> angle(15.0f, 6.0f);
+    std::normal_distribution<float> spin(4000.0f, 2000.0f);
+    std::normal_distribution<float> side(0.0f, 600.0f);
+
+    // 21 shots, so the last batch is short; one has no speed and one no spin at all
+    std::vector<BallData> balls;
+    for (int i = 0; i < 21; i++) {
+        balls.push_back(launch(speed(random), angle(random), std::fabs(spin(random)), side(random), side(random) / 200));
+    }
+    balls[3].Speed = NOT_A_NUMBER;
+    balls[12].BackSpin = NOT_A_NUMBER;
+    balls[12].SideSpin = NOT_A_NUMBER;
+
+    TrajectoryEngine engine;
+    for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 }) {
+        if (level > supportedSimdLevel()) {
+            continue;
+        }
+        SCOPED_TRACE(testing::Message() << "level " << static_cast<int>(level));
+        setSimdLevel(level);
+        std::vector<FlightSummary> summaries = engine.simulate(balls);
+        ASSERT_EQ(summaries.size(), balls.size());
+
+        for (size_t i = 0; i < balls.size(); i++) {
+            SCOPED_TRACE(testing::Message() << "shot " << i);
+            FlightSummary expected = engine.simulate(balls[i]).Summary;
+            if (i == 3) {
+                EXPECT_TRUE(std::isnan(summaries[i].Carry));
+                EXPECT_TRUE(std::isnan(summaries[i].Total));
+                continue;
+            }
+            EXPECT_NEAR(summaries[i].Carry, expected.Carry, 1e-3f * expected.Carry);
+            EXPECT_NEAR(summaries[i].Offline, expected.Offline, 1e-2f);
+            EXPECT_NEAR(summaries[i].Apex, expected.Apex, 1e-3f * expected.Apex);
+            EXPECT_NEAR(summaries[i].FlightTime, expected.FlightTime, 1e-3f);
+            EXPECT_NEAR(summaries[i].Total, expected.Total, 1e-3f * expected.Total);
+        }
+    }
+}
+
+TEST(TrajectoryTest, MissingLaunchDataOrBadOptions) {
+    TrajectoryEngine engine;
+    Trajectory none = engine.simulate(launch(NOT_A_NUMBER, 12.0f, 3000.0f, 0));
+    EXPECT_TRUE(std::isnan(none.Summary.Carry));
+    EXPECT_TRUE(std::isnan(none.Summary.Apex));
+    EXPECT_TRUE(none.Path.empty());
+    EXPECT_TRUE(engine.simulate(launch(150.0f, NOT_A_NUMBER, 3000.0f, 0)).Path.empty());
+    engine.simulate(nullptr, 0, nullptr);
+
+    TrajectoryOptions options;
+    options.TimeStep = 0;
+    EXPECT_THROW(TrajectoryEngine{ options }, std::runtime_error);
+    options = TrajectoryOptions();
+    options.AirDensity = NOT_A_NUMBER;
+    EXPECT_THROW(TrajectoryEngine{ options }, std::runtime_error);
+    options = TrajectoryOptions();
+    options.SpinDecay = 1;
+    EXPECT_THROW(TrajectoryEngine{ options }, std::runtime_error);
+}
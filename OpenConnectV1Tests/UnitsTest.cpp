@@ -0,0 +1,125 @@
+#include "pch.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "../OpenConnectV1/ShotStore.h"
+#include "../OpenConnectV1/Units.h"
+
+using namespace OpenConnectV1;
+
+namespace {
+    const float NOT_A_NUMBER = std::numeric_limits<float>::quiet_NaN();
+    const float DEGREE = 3.14159265f / 180;
+    const float RPM = 3.14159265f / 30;
+
+    ShotData makeShot(const char* units, float ballSpeed, float carry) {
+        ShotData shotData;
+        shotData.Units = units;
+        shotData.BallData = BallData(ballSpeed, 5.0f, 3000.0f, NOT_A_NUMBER, NOT_A_NUMBER, 1.0f, 12.0f, carry);
+        shotData.ClubData = ClubData(ballSpeed / 1.45f, -2.0f, 1.0f, 60.0f, 10.5f, 3.0f, NOT_A_NUMBER, 4.0f, -6.0f, 1000.0f);
+        shotData.ShotDataOptions = ShotDataOptions(true, true, true, true, false);
+        return shotData;
+    }
+}
+
+TEST(UnitsTest, ParsesUnitsOnce) {
+    EXPECT_EQ(parseUnitSystem("Yards"), UnitSystem::Yards);
+    EXPECT_EQ(parseUnitSystem("YDS"), UnitSystem::Yards);
+    EXPECT_EQ(parseUnitSystem(""), UnitSystem::Yards);
+    EXPECT_EQ(parseUnitSystem("Meters"), UnitSystem::Meters);
+    EXPECT_EQ(parseUnitSystem("metres"), UnitSystem::Meters);
+    EXPECT_EQ(parseUnitSystem("Metric"), UnitSystem::Meters);
+    EXPECT_EQ(parseUnitSystem("Furlongs"), UnitSystem::Unknown);
+    EXPECT_EQ(parseUnitSystem("Yardsx"), UnitSystem::Unknown);
+    EXPECT_STREQ(toString(UnitSystem::Meters), "Meters");
+
+    // Every interned string carries its UnitSystem
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(unitSystemOf(InternedString("Meters")), UnitSystem::Meters);
+        EXPECT_EQ(unitSystemOf(InternedString("Yards")), UnitSystem::Yards);
+        EXPECT_EQ(unitSystemOf(InternedString()), UnitSystem::Yards);
+        EXPECT_EQ(unitSystemOf(InternedString("Furlongs")), UnitSystem::Unknown);
+    }
+
+    // unitSystem() follows Units however it was set
+    ShotData decoded;
+    ShotData::decode(R"({"DeviceID":"Bay 1","Units":"Meters","ShotNumber":1,"APIversion":"1"})", decoded);
+    EXPECT_EQ(decoded.unitSystem(), UnitSystem::Meters);
+    ShotData::decode(R"({"DeviceID":"Bay 1","ShotNumber":2,"APIversion":"1"})", decoded);
+    EXPECT_EQ(decoded.unitSystem(), UnitSystem::Yards);
+
+    json document;
+    to_json(document, makeShot("Yards", 150.0f, 250.0f));
+    document["Units"] = "metres";
+    ShotData parsed;
+    ShotData::from_json(document, parsed);
+    EXPECT_EQ(parsed.unitSystem(), UnitSystem::Meters);
+
+    ShotData constructed("Bay 1", "Parsecs", 1, "1", BallData(), ClubData(), ShotDataOptions());
+    EXPECT_EQ(constructed.unitSystem(), UnitSystem::Unknown);
+    constructed.Units = "Yards";
+    EXPECT_EQ(constructed.unitSystem(), UnitSystem::Yards);
+}
+
+TEST(UnitsTest, NormalizesToSI) {
+    ShotData yards = makeShot("Yards", 150.0f, 250.0f);
+    BallData ball = normalized(yards.BallData, yards.unitSystem());
+    EXPECT_FLOAT_EQ(ball.Speed, 150.0f * 0.44704f);
+    EXPECT_FLOAT_EQ(ball.SpinAxis, 5.0f * DEGREE);
+    EXPECT_FLOAT_EQ(ball.TotalSpin, 3000.0f * RPM);
+    EXPECT_TRUE(std::isnan(ball.BackSpin));
+    EXPECT_FLOAT_EQ(ball.VLA, 12.0f * DEGREE);
+    EXPECT_FLOAT_EQ(ball.CarryDistance, 250.0f * 0.9144f);
+
+    ClubData club = normalized(yards.ClubData, yards.unitSystem());
+    EXPECT_FLOAT_EQ(club.Speed, 150.0f / 1.45f * 0.44704f);
+    EXPECT_FLOAT_EQ(club.Loft, 10.5f * DEGREE);
+    EXPECT_TRUE(std::isnan(club.SpeedAtImpact));
+    EXPECT_EQ(club.VerticalFaceImpact, 4.0f);
+    EXPECT_FLOAT_EQ(club.ClosureRate, 1000.0f * DEGREE);
+
+    // Already metric speeds and distances are left alone, angles and spin still convert
+    ShotData meters = makeShot("Meters", 67.0f, 228.6f);
+    BallData metric = normalized(meters.BallData, meters.unitSystem());
+    EXPECT_EQ(metric.Speed, 67.0f);
+    EXPECT_EQ(metric.CarryDistance, 228.6f);
+    EXPECT_FLOAT_EQ(metric.TotalSpin, 3000.0f * RPM);
+
+    std::vector<ShotData> shots = { yards, meters, makeShot("Unknown units", 150.0f, 250.0f) };
+    std::vector<BallData> balls(shots.size());
+    std::vector<ClubData> clubs(shots.size());
+    normalize(shots.data(), shots.size(), balls.data(), clubs.data());
+    for (size_t i = 0; i < shots.size(); i++) {
+        BallData expected = normalized(shots[i].BallData, shots[i].unitSystem());
+        EXPECT_EQ(balls[i].Speed, expected.Speed);
+        EXPECT_EQ(balls[i].CarryDistance, expected.CarryDistance);
+        EXPECT_EQ(clubs[i].Speed, normalized(shots[i].ClubData, shots[i].unitSystem()).Speed);
+    }
+    // Unknown converts as Yards
+    EXPECT_EQ(balls[2].Speed, balls[0].Speed);
+}
+
+TEST(UnitsTest, StoredHistoriesNormalizeByColumn) {
+    ShotStore store;
+    for (int i = 0; i < 100; i++) {
+        store.append(1, i % 2 == 0 ? makeShot("Yards", 150.0f, 250.0f) : makeShot("Meters", 150.0f * 0.44704f, 250.0f * 0.9144f));
+    }
+    ASSERT_EQ(store.unitSystems().size(), 100u);
+    EXPECT_EQ(store.unitSystems()[1], UnitSystem::Meters);
+
+    std::vector<float> speeds(store.size());
+    std::vector<float> carries(store.size());
+    store.normalizedColumn(ShotField::BallSpeed, speeds.data());
+    store.normalizedColumn(ShotField::CarryDistance, carries.data());
+    for (size_t row = 0; row < store.size(); row++) {
+        EXPECT_NEAR(speeds[row], 150.0f * 0.44704f, 1e-4f);
+        EXPECT_NEAR(carries[row], 250.0f * 0.9144f, 1e-4f);
+    }
+
+    std::vector<float> lofts(store.size());
+    store.normalizedColumn(ShotField::Loft, lofts.data());
+    EXPECT_FLOAT_EQ(lofts[0], 10.5f * DEGREE);
+    EXPECT_FLOAT_EQ(lofts[1], 10.5f * DEGREE);
+}
@@ -0,0 +1,271 @@
+#include "pch.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include "FakeTransport.h"
+#include "TestServer.h"
+#include "../OpenConnectV1/BinaryCodec.h"
+#include "../OpenConnectV1/Server.h"
+#include "../OpenConnectV1/WireCodec.h"
+
+using namespace OpenConnectV1;
+
+namespace {
+    const float NOT_A_NUMBER = std::numeric_limits<float>::quiet_NaN();
+
+    ShotData fullShot() {
+        return ShotData("GSPro LM 1.1", "Yards", 13, "1",
+            BallData(147.5f, -13.2f, 3250.0f, 2500.0f, -800.0f, 2.3f, 14.3f, 256.5f),
+            ClubData(105.2f, -1.2f, 0.5f, 60.1f, 13.2f, 3.1f, 104.9f, -0.3f, 0.2f, 1.5f),
+            ShotDataOptions(true, true, true, true, false));
+    }
+
+    ShotData partialShot() {
+        ShotData shotData("Bay \"7\" \\ {east}", "Meters", -2, "",
+            BallData(67.1f, NOT_A_NUMBER, 2800.0f, NOT_A_NUMBER, NOT_A_NUMBER, -0.25f, 1e-7f, NOT_A_NUMBER),
+            ClubData(NOT_A_NUMBER, NOT_A_NUMBER, NOT_A_NUMBER, NOT_A_NUMBER, NOT_A_NUMBER, NOT_A_NUMBER,
+                NOT_A_NUMBER, NOT_A_NUMBER, NOT_A_NUMBER, NOT_A_NUMBER),
+            ShotDataOptions(true, false, false, true, false));
+        return shotData;
+    }
+
+    ShotData heartbeat() {
+        ShotData shotData;
+        shotData.DeviceID = "GSPro LM 1.1";
+        shotData.APIversion = "1";
+        shotData.ShotDataOptions = ShotDataOptions(false, false, true, false, true);
+        return shotData;
+    }
+
+    void expectSameFloats(const float* expected, const float* actual, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            if (std::isnan(expected[i])) {
+                EXPECT_TRUE(std::isnan(actual[i])) << "field " << i;
+            }
+            else {
+                EXPECT_EQ(expected[i], actual[i]) << "field " << i;
+            }
+        }
+    }
+
+    void expectSameShot(const ShotData& expected, const ShotData& actual) {
+        EXPECT_EQ(expected.DeviceID, actual.DeviceID);
+        EXPECT_EQ(expected.Units, actual.Units);
+        EXPECT_EQ(expected.unitSystem(), actual.unitSystem());
+        EXPECT_EQ(expected.ShotNumber, actual.ShotNumber);
+        EXPECT_EQ(expected.APIversion, actual.APIversion);
+        float expectedFloats[18];
+        float actualFloats[18];
+        std::memcpy(expectedFloats, &expected.BallData, sizeof(BallData));
+        std::memcpy(expectedFloats + 8, &expected.ClubData, sizeof(ClubData));
+        std::memcpy(actualFloats, &actual.BallData, sizeof(BallData));
+        std::memcpy(actualFloats + 8, &actual.ClubData, sizeof(ClubData));
+        expectSameFloats(expectedFloats, actualFloats, 18);
+        EXPECT_EQ(expected.ShotDataOptions.ContainsBallData, actual.ShotDataOptions.ContainsBallData);
+        EXPECT_EQ(expected.ShotDataOptions.ContainsClubData, actual.ShotDataOptions.ContainsClubData);
+        EXPECT_EQ(expected.ShotDataOptions.LaunchMonitorIsReady, actual.ShotDataOptions.LaunchMonitorIsReady);
+        EXPECT_EQ(expected.ShotDataOptions.LaunchMonitorBallDetected, actual.ShotDataOptions.LaunchMonitorBallDetected);
+        EXPECT_EQ(expected.ShotDataOptions.IsHeartBeat, actual.ShotDataOptions.IsHeartBeat);
+    }
+
+    void expectSameResponse(const Response& expected, const Response& actual) {
+        EXPECT_EQ(expected.Code, actual.Code);
+        EXPECT_EQ(expected.Message, actual.Message);
+        EXPECT_EQ(expected.Player.Handed, actual.Player.Handed);
+        EXPECT_EQ(expected.Player.Club, actual.Player.Club);
+    }
+}
+
+// Every codec has to pass these, add new ones to the instantiation at the bottom
+class WireCodecConformanceTest : public ::testing::TestWithParam<WireFormat> {
+protected:
+    const WireCodec& codec = codecFor(GetParam());
+
+    // The messages of a stream, as a connection's framer would hand them to decode()
+    std::vector<std::string> frame(const std::string& stream, size_t chunk = SIZE_MAX) {
+        MessageFramer framer(1);
+        framer.setFraming(this->codec.framing());
+        std::vector<std::string> messages;
+        for (size_t offset = 0; offset < stream.size(); offset += chunk) {
+            size_t length = std::min(chunk, stream.size() - offset);
+            framer.append(stream.data() + offset, length);
+            std::string_view message;
+            while (framer.next(message)) {
+                messages.emplace_back(message);
+            }
+        }
+        return messages;
+    }
+
+    ShotData roundTrip(const ShotData& shotData) {
+        std::vector<std::string> messages = this->frame(this->codec.encodeToString(shotData));
+        EXPECT_EQ(messages.size(), 1u);
+        ShotData decoded;
+        this->codec.decode(messages.at(0), decoded);
+        return decoded;
+    }
+};
+
+TEST_P(WireCodecConformanceTest, RoundTripsShots) {
+    for (const ShotData& shotData : { fullShot(), partialShot(), heartbeat() }) {
+        expectSameShot(shotData, this->roundTrip(shotData));
+    }
+}
+
+TEST_P(WireCodecConformanceTest, DecodesIntoAReusedShot) {
+    std::string stream = codec.encodeToString(fullShot()) + codec.encodeToString(partialShot()) + codec.encodeToString(heartbeat());
+    std::vector<std::string> messages = frame(stream);
+    ASSERT_EQ(messages.size(), 3u);
+
+    ShotData decoded;
+    codec.decode(messages[0], decoded);
+    codec.decode(messages[1], decoded);
+    expectSameShot(partialShot(), decoded);
+    codec.decode(messages[2], decoded);
+    expectSameShot(heartbeat(), decoded);
+
+    // Skipping a heartbeat's data never changes what a shot decodes to
+    codec.decodeSkippingHeartbeatData(messages[0], decoded);
+    expectSameShot(fullShot(), decoded);
+    codec.decodeSkippingHeartbeatData(messages[2], decoded);
+    EXPECT_TRUE(decoded.ShotDataOptions.IsHeartBeat);
+    EXPECT_EQ(decoded.DeviceID, heartbeat().DeviceID);
+}
+
+TEST_P(WireCodecConformanceTest, FramesMessagesSplitAnywhere) {
+    std::string stream;
+    for (int i = 0; i < 4; i++) {
+        ShotData shotData = fullShot();
+        shotData.ShotNumber = i;
+        stream += codec.encodeToString(shotData);
+    }
+
+    for (size_t chunk : { static_cast<size_t>(1), static_cast<size_t>(7), static_cast<size_t>(64), stream.size() }) {
+        std::vector<std::string> messages = frame(stream, chunk);
+        ASSERT_EQ(messages.size(), 4u) << "chunk " << chunk;
+        for (int i = 0; i < 4; i++) {
+            ShotData decoded;
+            codec.decode(messages[i], decoded);
+            EXPECT_EQ(decoded.ShotNumber, i);
+        }
+    }
+}
+
+TEST_P(WireCodecConformanceTest, RoundTripsResponses) {
+    std::vector<Response> responses = {
+        Response(ResponseCode::OK, "Shot received successfully"),
+        Response(ResponseCode::PlayerInfo, "GSPro Player Information", PlayerData("LH", "7I")),
+        Response(ResponseCode::Error, std::string(1000, 'x') + "\"\\"),
+    };
+    for (const Response& response : responses) {
+        std::vector<std::string> messages = frame(codec.encodeToString(response));
+        ASSERT_EQ(messages.size(), 1u);
+        expectSameResponse(response, codec.decodeResponse(messages[0]));
+    }
+}
+
+TEST_P(WireCodecConformanceTest, EncodeReportsTheLengthItNeeds) {
+    std::string expected = codec.encodeToString(partialShot());
+    char small[16];
+    EXPECT_EQ(codec.encode(partialShot(), small, sizeof(small)), expected.size());
+
+    std::vector<char> exact(expected.size());
+    ASSERT_EQ(codec.encode(partialShot(), exact.data(), exact.size()), expected.size());
+    EXPECT_EQ(std::string(exact.data(), exact.size()), expected);
+}
+
+TEST_P(WireCodecConformanceTest, RejectsTruncatedMessages) {
+    std::vector<std::string> messages = frame(codec.encodeToString(fullShot()));
+    ASSERT_EQ(messages.size(), 1u);
+    std::string truncated = messages[0].substr(0, messages[0].size() / 2);
+    ShotData decoded;
+    EXPECT_THROW(codec.decode(truncated, decoded), std::runtime_error);
+    EXPECT_THROW(codec.decodeResponse(truncated), std::runtime_error);
+}
+
+INSTANTIATE_TEST_SUITE_P(Codecs, WireCodecConformanceTest, ::testing::Values(WireFormat::Json, WireFormat::Binary),
+    [](const ::testing::TestParamInfo<WireFormat>& info) { return std::string(toString(info.param)); });
+
+TEST(WireCodecTest, NegotiatesTheFormatFromTheFirstBytes) {
+    WireFormat format = WireFormat::Binary;
+    size_t prefixLength = 1;
+    EXPECT_FALSE(negotiateWireFormat("", format, prefixLength));
+    EXPECT_FALSE(negotiateWireFormat("OC", format, prefixLength));
+    ASSERT_TRUE(negotiateWireFormat("{\"DeviceID\"", format, prefixLength));
+    EXPECT_EQ(format, WireFormat::Json);
+    EXPECT_EQ(prefixLength, 0u);
+    ASSERT_TRUE(negotiateWireFormat("OCX", format, prefixLength));
+    EXPECT_EQ(format, WireFormat::Json);
+    ASSERT_TRUE(negotiateWireFormat("OCB1\x56", format, prefixLength));
+    EXPECT_EQ(format, WireFormat::Binary);
+    EXPECT_EQ(prefixLength, BinaryCodec::MAGIC.size());
+
+    // Fixed layout: the record is the header and the strings, nothing else
+    EXPECT_EQ(codecFor(WireFormat::Binary).encodeToString(heartbeat()).size(),
+        MessageFramer::LENGTH_PREFIX_SIZE + BinaryCodec::SHOT_HEADER_SIZE + std::string("GSPro LM 1.1").size() + 1);
+}
+
+class ServerWireFormatTest : public TestServer {
+protected:
+    class RecordingListener : public ServerListener {
+    public:
+        std::vector<ShotData> shots;
+
+        void onShotDataReceived(const ShotData& shotData) override {
+            shots.push_back(shotData);
+        }
+        void onStatusChanged(const ServerStatus& status) override {}
+    };
+
+    std::shared_ptr<RecordingListener> listener = std::make_shared<RecordingListener>();
+
+    void SetUp() override {
+        TestServer::SetUp();
+        server->addListener(listener);
+        start();
+    }
+};
+
+TEST_F(ServerWireFormatTest, SpeaksEachConnectionsFormat) {
+    const WireCodec& binary = codecFor(WireFormat::Binary);
+    const WireCodec& json = codecFor(WireFormat::Json);
+    std::string stream = std::string(BinaryCodec::MAGIC) + binary.encodeToString(fullShot()) + binary.encodeToString(partialShot());
+    transport->connect(1, "10.0.0.2:50000");
+    transport->connect(2, "10.0.0.3:50000");
+    transport->deliver(1, stream.substr(0, 2));
+    transport->flush();
+    transport->deliver(1, stream.substr(2));
+    transport->deliver(2, json.encodeToString(heartbeat()));
+    transport->flush();
+
+    ASSERT_EQ(listener->shots.size(), 3u);
+    expectSameShot(fullShot(), listener->shots[0]);
+    expectSameShot(partialShot(), listener->shots[1]);
+    expectSameShot(heartbeat(), listener->shots[2]);
+    for (const ConnectionInfo& info : server->getConnections()) {
+        EXPECT_EQ(info.Format, info.Id == 1 ? WireFormat::Binary : WireFormat::Json);
+    }
+
+    Response response(ResponseCode::PlayerInfo, "GSPro Player Information", PlayerData("RH", "DR"));
+    server->sendResponse(response);
+    transport->flush();
+    EXPECT_EQ(transport->sent(1), binary.encodeToString(response));
+    EXPECT_EQ(transport->sent(2), json.encodeToString(response));
+}
+
+TEST_F(ServerWireFormatTest, ClosesABinaryConnectionOnAMalformedRecord) {
+    std::string record = codecFor(WireFormat::Binary).encodeToString(fullShot());
+    record[MessageFramer::LENGTH_PREFIX_SIZE] = 9;
+    transport->connect(1, "10.0.0.2:50000");
+    transport->deliver(1, std::string(BinaryCodec::MAGIC) + record);
+    transport->flush();
+
+    EXPECT_TRUE(listener->shots.empty());
+    EXPECT_TRUE(server->getConnections().empty());
+    EXPECT_EQ(server->metricsSnapshot().counter(MetricCounter::ParseFailures), 1u);
+}
@@ -0,0 +1,73 @@
+#include "pch.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "../OpenConnectV1/WorkStealingPool.h"
+
+using namespace OpenConnectV1;
+
+TEST(WorkStealingPoolTest, RunsEveryItemOnce) {
+    for (size_t threads : { 1, 2, 4, 7 }) {
+        WorkStealingPool pool(threads);
+        EXPECT_EQ(pool.threadCount(), threads);
+
+        for (size_t count : { 0, 1, 2, 5, 1000, 100'000 }) {
+            SCOPED_TRACE(testing::Message() << "threads " << threads << " count " << count);
+            std::unique_ptr<std::atomic<int>[]> runs(new std::atomic<int>[count]());
+            pool.parallelFor(count, [&runs](size_t i) {
+                // Uneven items so the ranges drain at different rates and get stolen from
+                if (i % 97 == 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+                runs[i].fetch_add(1, std::memory_order_relaxed);
+            });
+            for (size_t i = 0; i < count; i++) {
+                ASSERT_EQ(runs[i].load(), 1) << "item " << i;
+            }
+        }
+    }
+}
+
+TEST(WorkStealingPoolTest, ExceptionsReachTheCaller) {
+    WorkStealingPool pool(4);
+    EXPECT_THROW(pool.parallelFor(1000, [](size_t i) {
+        if (i == 537) {
+            throw std::runtime_error("item failed");
+        }
+    }), std::runtime_error);
+
+    // The pool is still good for the next loop
+    std::atomic<size_t> sum{ 0 };
+    pool.parallelFor(100, [&sum](size_t i) { sum += i; });
+    EXPECT_EQ(sum.load(), 4950u);
+}
+
+TEST(WorkStealingPoolTest, NestedAndConcurrentLoops) {
+    WorkStealingPool pool(3);
+    std::atomic<size_t> runs{ 0 };
+
+    // A loop started from an item runs inline instead of waiting on its own pool
+    pool.parallelFor(10, [&pool, &runs](size_t) {
+        pool.parallelFor(10, [&runs](size_t) { runs++; });
+    });
+    EXPECT_EQ(runs.load(), 100u);
+
+    runs = 0;
+    std::vector<std::thread> callers;
+    for (int caller = 0; caller < 3; caller++) {
+        callers.emplace_back([&pool, &runs] {
+            for (int loop = 0; loop < 20; loop++) {
+                pool.parallelFor(50, [&runs](size_t) { runs++; });
+            }
+        });
+    }
+    for (std::thread& caller : callers) {
+        caller.join();
+    }
+    EXPECT_EQ(runs.load(), 3000u);
+}